@@ -78,6 +78,8 @@
  * the NAS of the UE acting as L3 UE-to-Network UE.
  * 3/ NrSlRelayDiscoveryTrace.txt: to keep track of discovered relays
  * 4/ NrSlRelaySelectionTrace.txt: to keep track of relay selection attempts
+ * 5/ NrSlProseStats.txt: counters of the ProSe layer of the UEs at the end of
+ * the simulation (see NrSlProseHelper::DumpProseStats)
  *
  */
 
@@ -950,6 +952,10 @@ main(int argc, char* argv[])
                                                 tftRelay,
                                                 bearerRelay);
 
+    // Assign the streams of the ProSe layer once the relay selection algorithm is set
+    stream += streamIncrement;
+    nrSlProseHelper->AssignStreams(remoteUeNetDev, stream);
+
     /*********************** End ProSe configuration ***************************/
 
     /********* Applications configuration ******/
@@ -1075,6 +1081,10 @@ main(int argc, char* argv[])
     Simulator::Stop(simTime);
     Simulator::Run();
 
+    // ProSe layer counters
+    nrSlProseHelper->DumpProseStats(NetDeviceContainer(relayUeNetDev, remoteUeNetDev),
+                                    "NrSlProseStats.txt");
+
     // Write traces
     std::cout << "/*********** Simulation done! ***********/\n" << std::endl;
     std::cout << "Number of packets relayed by the L3 UE-to-Network relays:" << std::endl;
@@ -113,6 +113,9 @@ $ gnuplot nr-prose-l3-relay-on-off-topology.plt
  * 6. NrSlAppRxPacketDelayTrace.txt: Log of the application layer packet delay.
  * 7. NrSlRelayNasRxPacketTrace.txt: Log of the data packets relayed by the
  * relay UEs.
+ * 8. nr-prose-l3-relay-on-off-ProseStats.txt: counters of the ProSe layer of
+ * the relay and remote UEs at the end of the simulation (see
+ * NrSlProseHelper::DumpProseStats).
  *
  * \code{.unparsed}
 $ ./ns3 run "nr-prose-l3-relay-on-off --Help"
@@ -2140,6 +2143,10 @@ main(int argc, char* argv[])
     Simulator::Stop(simTime);
     Simulator::Run();
 
+    // ProSe layer counters
+    nrSlProseHelper->DumpProseStats(NetDeviceContainer(relayUeNetDev, remoteUeNetDev),
+                                    outputDir + exampleName + "-ProseStats.txt");
+
     // SL database dump
     pktStats.EmptyCache();
     pscchStats.EmptyCache();
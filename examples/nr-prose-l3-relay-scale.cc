@@ -0,0 +1,1191 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * NIST-developed software is provided by NIST as a public
+ * service. You may use, copy and distribute copies of the software in
+ * any medium, provided that you keep intact this entire notice. You
+ * may improve, modify and create derivative works of the software or
+ * any portion of the software, and you may copy and distribute such
+ * modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and
+ * nature of any such change. Please explicitly acknowledge the
+ * National Institute of Standards and Technology as the source of the
+ * software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES
+ * NO WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY
+ * OPERATION OF LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+ * WARRANTY OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE,
+ * NON-INFRINGEMENT AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR
+ * WARRANTS THAT THE OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED
+ * OR ERROR-FREE, OR THAT ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT
+ * WARRANT OR MAKE ANY REPRESENTATIONS REGARDING THE USE OF THE
+ * SOFTWARE OR THE RESULTS THEREOF, INCLUDING BUT NOT LIMITED TO THE
+ * CORRECTNESS, ACCURACY, RELIABILITY, OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of
+ * using and distributing the software and you assume all risks
+ * associated with its use, including but not limited to the risks and
+ * costs of program errors, compliance with applicable laws, damage to
+ * or loss of data, programs or equipment, and the unavailability or
+ * interruption of operation. This software is not intended to be used
+ * in any situation where a failure could cause risk of injury or
+ * damage to property. The software developed by NIST employees is not
+ * subject to copyright protection within the United States.
+ */
+
+/**
+ * \file nr-prose-l3-relay-scale.cc
+ * \ingroup examples
+ *
+ * \brief Benchmark scenario with a single L3 UE-to-Network (U2N) relay UE
+ *        serving a large number of remote UEs.
+ *
+ * Channel configuration:
+ * This example setups a simulation using the 3GPP channel model from TR 37.885
+ * and it uses the default configuration of its implementation.
+ *
+ * System configuration:
+ * The scenario uses the same operational band, component carrier and
+ * bandwidth parts as nr-prose-l3-relay.cc. One bandwidth part is used for the
+ * Uu interface of the relay UE and the other one for SL.
+ *
+ * Topology:
+ * The scenario is composed of one gNB, one relay UE attached to it and
+ * 'remoteUeNum' out-of-network remote UEs placed uniformly at random in a disc
+ * of radius 'remoteRadius' centered 10 m below the relay UE.
+ *
+ *        -  gNB              (0.0, 30.0, 10.0)
+ *        |
+ *   20 m |
+ *        -  Relay UE         (0.0, 10.0, 1.5)
+ *   10 m |
+ *        -  (remote UEs)     disc centered at (0.0, 0.0, 1.5)
+ *
+ * Procedures:
+ * All the UEs perform Model B relay discovery from 'startDiscTime', the remote
+ * UEs soliciting the relay service and the relay UE responding. From
+ * 'startRelayConnTime', the remote UEs establish their L3 U2N relay
+ * connection with the relay UE, spread uniformly over 'connSpread' to avoid
+ * a single burst of PC5 signalling. Each remote UE then has one UL and one DL
+ * CBR flow of 'lambda' packets per second towards and from a Remote Host in
+ * the internet. Setting 'lambda' to 0 disables the traffic.
+ *
+ * Output:
+ * The example samples the simulation every 'sampleInterval' and writes in
+ * the file default-nr-prose-l3-relay-scale.txt:
+ * - the wall-clock time per simulated second of the interval,
+ * - the resident memory of the simulation process,
+ * - the number of direct links of the relay UE and of remote UEs accepted by it,
+ * - a static estimate of the memory used by the ProSe layer of the relay UE
+ *   for its direct links, from the type sizes and entry counts given by
+ *   NrSlUeProse::GetDirectLinkMemoryUsage,
+ * - the relay solicitations received and the relay responses transmitted by
+ *   the relay UE in the interval (discovery response load).
+ * At the end, it prints on-screen a summary with the per-link memory (the
+ * static estimate for the ProSe layer of the relay UE, and the measured
+ * memory of the whole process), the average
+ * wall-clock time per simulated second before and after the connection of the
+ * remote UEs, the discovery response load, and the cost of the remote UE table
+ * of the EPC. This cost is measured after the simulation by inserting
+ * 'epcBatches' batches of 'epcBatchSize' extra remote UEs in the table, which
+ * already holds the remote UEs of the scenario, and reporting the average
+ * wall-clock time per insertion of each batch against the size of the table.
+ * The per-link memory of the ProSe layer is not measured: it is the sum of the
+ * sizes of the types of the direct link state multiplied by the number of
+ * entries, and ignores the allocator overhead and the memory of other layers.
+ * The resident memory is only available on Linux.
+ *
+ * Distributed simulation:
+ * With 'useMpi', the scenario is run with the distributed simulator of ns-3
+ * over two processes. This is a partial support: the gNB, all the UEs
+ * (remote and relay) and the EPC are simulated by rank 0, and only the
+ * Remote Host by rank 1, the two partitions being connected by the
+ * point-to-point link between the PGW and the Remote Host, whose delay is
+ * set to 1 ms to give the lookahead of the partitions. The sidelink and the
+ * EPC cannot be split across partitions, thus this is the only supported cut
+ * of this scenario, and the sidelink load is not distributed. The layer 2 IDs
+ * and IMSIs of the UEs come from per-process counters of the nr module, which
+ * is only consistent because all the UEs are on rank 0. Only the UL flows are
+ * configured in this mode, and the output file of rank 0 has '-rank0'
+ * appended to its name (see NrSlProseHelper::GetPartitionFilename). This
+ * mode has not been run with two ranks yet. ns-3 needs to be built with MPI:
+ * \code{.unparsed}
+$ ./ns3 configure --build-profile=optimized --enable-examples --enable-mpi
+$ mpiexec -np 2 ./build/contrib/nr-prose/examples/ns3-dev-nr-prose-l3-relay-scale-optimized \
+    --useMpi=1 --remoteUeNum=1000
+    \endcode
+ *
+ * Profiling:
+ * The scenario is meant to be run with an optimized build, optionally under a
+ * profiler, e.g.:
+ * \code{.unparsed}
+$ ./ns3 configure --build-profile=optimized --enable-examples
+$ ./ns3 run "nr-prose-l3-relay-scale --remoteUeNum=1000"
+$ ./ns3 run nr-prose-l3-relay-scale --command-template="perf record -g %s --remoteUeNum=1000"
+    \endcode
+ * The relay response aggregation of NrSlUeProse can be toggled with
+ * 'relayResponseAggregation' to compare the discovery response load.
+ *
+ * Discovery oracle:
+ * With 'discoveryOracle', the discovery messages are not simulated through
+ * the NR sidelink stack but delivered by a NrSlDiscoveryOracle, with its
+ * default propagation loss model, to measure the cost of the scenario when
+ * the discovery is abstracted. The PC5 signalling and the traffic still go
+ * through the NR sidelink stack.
+ *
+ * \code{.unparsed}
+$ ./ns3 run "nr-prose-l3-relay-scale --Help"
+    \endcode
+ */
+
+#include "ns3/antenna-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/core-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/lte-module.h"
+#include "ns3/network-module.h"
+#include "ns3/nr-module.h"
+#include "ns3/nr-prose-module.h"
+#include "ns3/point-to-point-module.h"
+#ifdef NS3_MPI
+#include "ns3/mpi-interface.h"
+#endif
+
+#include <chrono>
+#include <fstream>
+#include <set>
+#include <vector>
+
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("NrProseL3RelayScale");
+
+/*
+ * \brief Get the resident memory of the simulation process
+ *
+ * \return the resident memory in bytes, or 0 if not available
+ */
+uint64_t
+GetResidentMemory()
+{
+#ifdef __linux__
+    std::ifstream statm("/proc/self/statm");
+    uint64_t size = 0;
+    uint64_t resident = 0;
+    if (statm >> size >> resident)
+    {
+        return resident * static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+    }
+#endif
+    return 0;
+}
+
+uint64_t g_relaySolicitationsRx = 0;  ///< Relay solicitations received by the relay UE
+uint64_t g_relayResponsesTx = 0;      ///< Relay responses transmitted by the relay UE
+std::set<uint32_t> g_acceptedRemotes; ///< Remote UEs to which the relay UE sent an accept
+
+/*
+ * \brief Trace sink function counting the relay discovery messages of the relay UE
+ *
+ * \param senderL2Id the L2 ID of the UE sending the discovery message
+ * \param receiverL2Id the L2 ID of the UE receiving the discovery message
+ * \param isTx flag that indicates if the relay UE is transmitting the message
+ * \param discHeader the discovery message
+ */
+void
+TraceSinkRelayDiscovery(uint32_t senderL2Id,
+                        uint32_t receiverL2Id,
+                        bool isTx,
+                        NrSlDiscoveryHeader discHeader)
+{
+    if (isTx && discHeader.GetDiscoveryMsgType() == NrSlDiscoveryHeader::DISC_RELAY_RESPONSE)
+    {
+        g_relayResponsesTx++;
+    }
+    else if (!isTx &&
+             discHeader.GetDiscoveryMsgType() == NrSlDiscoveryHeader::DISC_RELAY_SOLICITATION)
+    {
+        g_relaySolicitationsRx++;
+    }
+}
+
+/*
+ * \brief Trace sink function keeping track of the remote UEs accepted by the relay UE
+ *
+ * \param srcL2Id the L2 ID of the UE sending the PC5-S packet
+ * \param dstL2Id the L2 ID of the UE receiving the PC5-S packet
+ * \param isTx flag that indicates if the relay UE is transmitting the PC5-S packet
+ * \param p the PC5-S packet
+ */
+void
+TraceSinkRelayPc5Signalling(uint32_t srcL2Id, uint32_t dstL2Id, bool isTx, Ptr<Packet> p)
+{
+    NrSlPc5SignallingMessageType pc5smt;
+    p->PeekHeader(pc5smt);
+    if (isTx && pc5smt.GetMessageType() ==
+                    NrSlPc5SignallingMessageType::ProseDirectLinkEstablishmentAccept)
+    {
+        g_acceptedRemotes.insert(dstL2Id);
+    }
+}
+
+/**
+ * Values of the counters at the last sample
+ */
+struct ScaleSample
+{
+    std::chrono::steady_clock::time_point wallClock; ///< Wall-clock time
+    Time simTime;                                    ///< Simulation time
+    uint64_t solicitationsRx{0};                     ///< Relay solicitations received
+    uint64_t responsesTx{0};                         ///< Relay responses transmitted
+};
+
+ScaleSample g_lastSample; ///< Last sample taken
+
+/*
+ * \brief Sample the cost of the simulation and reschedule the next sample
+ *
+ * \param stream the output stream wrapper where the samples are written
+ * \param relayProse the ProSe layer of the relay UE
+ * \param interval the sampling interval
+ * \param wallClockPerSimSecond the wall-clock time per simulated second of each
+ *        interval, in seconds
+ */
+void
+SampleScale(Ptr<OutputStreamWrapper> stream,
+            Ptr<NrSlUeProse> relayProse,
+            Time interval,
+            std::vector<std::pair<Time, double>>* wallClockPerSimSecond)
+{
+    auto now = std::chrono::steady_clock::now();
+    double wallClock = std::chrono::duration<double>(now - g_lastSample.wallClock).count();
+    double simElapsed = (Simulator::Now() - g_lastSample.simTime).GetSeconds();
+    double perSimSecond = simElapsed > 0 ? wallClock / simElapsed : 0;
+    wallClockPerSimSecond->emplace_back(Simulator::Now(), perSimSecond);
+
+    *stream->GetStream() << Simulator::Now().GetSeconds() << "\t" << perSimSecond << "\t"
+                         << GetResidentMemory() / 1e6 << "\t" << relayProse->GetNumDirectLinks()
+                         << "\t" << g_acceptedRemotes.size() << "\t"
+                         << relayProse->GetDirectLinkMemoryUsage() << "\t"
+                         << g_relaySolicitationsRx - g_lastSample.solicitationsRx << "\t"
+                         << g_relayResponsesTx - g_lastSample.responsesTx << std::endl;
+
+    g_lastSample.simTime = Simulator::Now();
+    g_lastSample.solicitationsRx = g_relaySolicitationsRx;
+    g_lastSample.responsesTx = g_relayResponsesTx;
+    // Do not account for the time spent writing the sample
+    g_lastSample.wallClock = std::chrono::steady_clock::now();
+
+    Simulator::Schedule(interval,
+                        &SampleScale,
+                        stream,
+                        relayProse,
+                        interval,
+                        wallClockPerSimSecond);
+}
+
+/*
+ * \brief Record the resident memory of the process
+ *
+ * \param memory the variable where the resident memory is stored
+ */
+void
+RecordResidentMemory(uint64_t* memory)
+{
+    *memory = GetResidentMemory();
+}
+
+/*
+ * \brief Configure and run the partition of the Remote Host in a distributed
+ *        simulation
+ *
+ * The nodes are created in the same order as in the partition of the radio
+ * nodes and the EPC, so that they have the same IDs in both partitions, but
+ * only the Remote Host, its link to the PGW and its applications are
+ * configured.
+ *
+ * \param remoteUeNum the number of remote UEs
+ * \param p2ph the helper of the link between the PGW and the Remote Host
+ * \param ulPort the port of the UL flows
+ * \param trafficStartTime the start time of the traffic in seconds
+ * \param simTime the simulation time in seconds
+ */
+void
+RunRemoteHostPartition(uint32_t remoteUeNum,
+                       PointToPointHelper p2ph,
+                       uint16_t ulPort,
+                       double trafficStartTime,
+                       double simTime)
+{
+    NodeContainer gNbNodes;
+    gNbNodes.Create(1);
+    NodeContainer relayUeNodes;
+    relayUeNodes.Create(1);
+    NodeContainer remoteUeNodes;
+    remoteUeNodes.Create(remoteUeNum);
+    Ptr<NrPointToPointEpcHelper> epcHelper = CreateObject<NrPointToPointEpcHelper>();
+
+    Ptr<Node> pgw = epcHelper->GetPgwNode();
+    NodeContainer remoteHostContainer;
+    remoteHostContainer.Create(1, Simulator::GetSystemId());
+    Ptr<Node> remoteHost = remoteHostContainer.Get(0);
+    InternetStackHelper internet;
+    internet.Install(remoteHostContainer);
+
+    NetDeviceContainer internetDevices = p2ph.Install(pgw, remoteHost);
+    Ipv4AddressHelper ipv4h;
+    Ipv4StaticRoutingHelper ipv4RoutingHelper;
+    ipv4h.SetBase("1.0.0.0", "255.0.0.0");
+    Ipv4InterfaceContainer internetIpIfaces = ipv4h.Assign(internetDevices);
+    Ptr<Ipv4StaticRouting> remoteHostStaticRouting =
+        ipv4RoutingHelper.GetStaticRouting(remoteHost->GetObject<Ipv4>());
+    remoteHostStaticRouting->AddNetworkRouteTo(Ipv4Address("7.0.0.0"), Ipv4Mask("255.0.0.0"), 1);
+
+    PacketSinkHelper ulPacketSinkHelper("ns3::UdpSocketFactory",
+                                        InetSocketAddress(Ipv4Address::GetAny(), ulPort));
+    ApplicationContainer serverApps = ulPacketSinkHelper.Install(remoteHost);
+    serverApps.Start(Seconds(trafficStartTime));
+    serverApps.Stop(Seconds(simTime));
+
+    Simulator::Stop(Seconds(simTime));
+    Simulator::Run();
+
+    std::cout << "Remote Host partition: "
+              << serverApps.Get(0)->GetObject<PacketSink>()->GetTotalRx() << " UL bytes received"
+              << std::endl;
+    Simulator::Destroy();
+}
+
+int
+main(int argc, char* argv[])
+{
+    // System configuration
+    double centralFrequencyBand = 5.89e9; // band n47
+    double bandwidthBand = 40e6;          // 40 MHz
+    double centralFrequencyCc0 = 5.89e9;
+    double bandwidthCc0 = bandwidthBand;
+    std::string pattern = "DL|DL|DL|F|UL|UL|UL|UL|UL|UL|";
+    double bandwidthCc0Bpw0 = bandwidthCc0 / 2;
+    double bandwidthCc0Bpw1 = bandwidthCc0 / 2;
+    double ueHeight = 1.5;
+
+    // In-network devices configuration
+    uint16_t numerologyCc0Bwp0 = 3; // BWP0 will be used for the in-network
+    double gNBtotalTxPower = 32;    // dBm
+
+    // Scale configuration
+    uint32_t remoteUeNum = 1000;
+    double remoteRadius = 20; // m
+
+    // Applications configuration
+    uint32_t packetSizeDlUl = 100; // bytes
+    double lambda = 1.0;           // packets per second per flow
+    double trafficStartTime = 8.0; // seconds
+
+    // Sidelink configuration
+    uint16_t numerologyCc0Bwp1 = 2;         // BWP1 will be used for SL
+    Time startDiscTime = Seconds(1.0);      // Time to start the relay discovery
+    Time startRelayConnTime = Seconds(2.0); // Time to start the U2N relay connections
+    Time connSpread = Seconds(4.0);         // Time over which the connections are spread
+    bool relayResponseAggregation = false;
+    bool discoveryOracle = false;
+
+    // Simulation configuration
+    std::string simTag = "default";
+    std::string outputDir = "./";
+    double simTime = 12; // seconds
+    Time sampleInterval = Seconds(1.0);
+    uint32_t epcBatches = 10;
+    uint32_t epcBatchSize = 1000;
+    bool useMpi = false;
+
+    CommandLine cmd;
+    cmd.AddValue("remoteUeNum", "Number of remote UEs connected to the relay UE", remoteUeNum);
+    cmd.AddValue("remoteRadius",
+                 "Radius in meters of the disc in which the remote UEs are placed",
+                 remoteRadius);
+    cmd.AddValue("lambda",
+                 "Packets per second of each UL and DL flow of the remote UEs, 0 for no traffic",
+                 lambda);
+    cmd.AddValue("trafficStartTime", "Start time of the traffic in seconds", trafficStartTime);
+    cmd.AddValue("startDiscTime", "Start time of the relay discovery", startDiscTime);
+    cmd.AddValue("startRelayConnTime",
+                 "Start time of the U2N relay connections",
+                 startRelayConnTime);
+    cmd.AddValue("connSpread",
+                 "Time over which the start of the U2N relay connections is spread",
+                 connSpread);
+    cmd.AddValue("relayResponseAggregation",
+                 "Whether the relay UE aggregates its responses to the relay solicitations",
+                 relayResponseAggregation);
+    cmd.AddValue("discoveryOracle",
+                 "Deliver the discovery messages with a discovery oracle instead of the NR "
+                 "sidelink stack",
+                 discoveryOracle);
+    cmd.AddValue("sampleInterval",
+                 "Interval between samples of the simulation cost",
+                 sampleInterval);
+    cmd.AddValue("epcBatches",
+                 "Number of batches of insertions measuring the EPC remote UE table",
+                 epcBatches);
+    cmd.AddValue("epcBatchSize",
+                 "Number of insertions in each batch measuring the EPC remote UE table",
+                 epcBatchSize);
+    cmd.AddValue("simTime", "Simulation time in seconds", simTime);
+    cmd.AddValue("simTag",
+                 "tag to be appended to output filenames to distinguish simulation campaigns",
+                 simTag);
+    cmd.AddValue("outputDir", "directory where to store simulation results", outputDir);
+    cmd.AddValue("useMpi",
+                 "Run the distributed simulator over two processes, the Remote Host being "
+                 "simulated by the second one",
+                 useMpi);
+    cmd.Parse(argc, argv);
+
+    NS_ABORT_MSG_IF(remoteUeNum == 0, "At least one remote UE is needed");
+
+    uint32_t remoteHostSystemId = 0;
+    if (useMpi)
+    {
+#ifdef NS3_MPI
+        GlobalValue::Bind("SimulatorImplementationType",
+                          StringValue("ns3::DistributedSimulatorImpl"));
+        MpiInterface::Enable(&argc, &argv);
+        NS_ABORT_MSG_IF(MpiInterface::GetSize() != 2,
+                        "The distributed simulation needs exactly 2 processes");
+        remoteHostSystemId = 1;
+#else
+        NS_FATAL_ERROR("The distributed simulation needs ns-3 to be built with MPI");
+#endif
+    }
+
+    // The link between the PGW and the Remote Host, which is the cut between
+    // the partitions in a distributed simulation, needs a non-zero delay for
+    // the lookahead of the partitions
+    PointToPointHelper p2ph;
+    p2ph.SetDeviceAttribute("DataRate", DataRateValue(DataRate("100Gb/s")));
+    p2ph.SetDeviceAttribute("Mtu", UintegerValue(2500));
+    p2ph.SetChannelAttribute("Delay", TimeValue(useMpi ? MilliSeconds(1) : Seconds(0.000)));
+    uint16_t dlPort = 100;
+    uint16_t ulPort = 200;
+
+#ifdef NS3_MPI
+    if (useMpi && MpiInterface::GetSystemId() == remoteHostSystemId)
+    {
+        RunRemoteHostPartition(remoteUeNum, p2ph, ulPort, trafficStartTime, simTime);
+        MpiInterface::Disable();
+        return 0;
+    }
+#endif
+
+    // Setup large enough buffer size to avoid overflow
+    Config::SetDefault("ns3::LteRlcUm::MaxTxBufferSize", UintegerValue(999999999));
+    Config::SetDefault("ns3::NrSlUeProse::RelayResponseAggregation",
+                       BooleanValue(relayResponseAggregation));
+
+    // Create gNB and relay UE, configure positions
+    MobilityHelper mobility;
+    mobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
+
+    NodeContainer gNbNodes;
+    gNbNodes.Create(1);
+    Ptr<ListPositionAllocator> gNbPositionAlloc = CreateObject<ListPositionAllocator>();
+    gNbPositionAlloc->Add(Vector(0.0, 30.0, 10));
+    mobility.SetPositionAllocator(gNbPositionAlloc);
+    mobility.Install(gNbNodes);
+
+    NodeContainer relayUeNodes;
+    relayUeNodes.Create(1);
+    Ptr<ListPositionAllocator> relayUesPositionAlloc = CreateObject<ListPositionAllocator>();
+    relayUesPositionAlloc->Add(Vector(0.0, 10.0, ueHeight));
+    mobility.SetPositionAllocator(relayUesPositionAlloc);
+    mobility.Install(relayUeNodes);
+
+    // Create Remote UE nodes, configure positions
+    NodeContainer remoteUeNodes;
+    remoteUeNodes.Create(remoteUeNum);
+    Ptr<UniformDiscPositionAllocator> remoteUesPositionAlloc =
+        CreateObject<UniformDiscPositionAllocator>();
+    remoteUesPositionAlloc->SetX(0.0);
+    remoteUesPositionAlloc->SetY(0.0);
+    remoteUesPositionAlloc->SetZ(ueHeight);
+    remoteUesPositionAlloc->SetRho(remoteRadius);
+    mobility.SetPositionAllocator(remoteUesPositionAlloc);
+    mobility.Install(remoteUeNodes);
+
+    // Setup Helpers
+    Ptr<NrHelper> nrHelper = CreateObject<NrHelper>();
+    Ptr<NrPointToPointEpcHelper> epcHelper = CreateObject<NrPointToPointEpcHelper>();
+    Ptr<IdealBeamformingHelper> idealBeamformingHelper = CreateObject<IdealBeamformingHelper>();
+    nrHelper->SetBeamformingHelper(idealBeamformingHelper);
+    nrHelper->SetEpcHelper(epcHelper);
+
+    /*************************Spectrum division ****************************/
+
+    BandwidthPartInfoPtrVector allBwps;
+    OperationBandInfo band;
+
+    /*
+     * The configured spectrum division is:
+     * |-------------- Band ------------|
+     * |---------------CC0--------------|
+     * |------BWP0------|------BWP1-----|
+     */
+    std::unique_ptr<ComponentCarrierInfo> cc0(new ComponentCarrierInfo());
+    std::unique_ptr<BandwidthPartInfo> bwp0(new BandwidthPartInfo());
+    std::unique_ptr<BandwidthPartInfo> bwp1(new BandwidthPartInfo());
+
+    band.m_centralFrequency = centralFrequencyBand;
+    band.m_channelBandwidth = bandwidthBand;
+    band.m_lowerFrequency = band.m_centralFrequency - band.m_channelBandwidth / 2;
+    band.m_higherFrequency = band.m_centralFrequency + band.m_channelBandwidth / 2;
+
+    // Component Carrier 0
+    cc0->m_ccId = 0;
+    cc0->m_centralFrequency = centralFrequencyCc0;
+    cc0->m_channelBandwidth = bandwidthCc0;
+    cc0->m_lowerFrequency = cc0->m_centralFrequency - cc0->m_channelBandwidth / 2;
+    cc0->m_higherFrequency = cc0->m_centralFrequency + cc0->m_channelBandwidth / 2;
+
+    // BWP 0
+    bwp0->m_bwpId = 0;
+    bwp0->m_centralFrequency = cc0->m_lowerFrequency + cc0->m_channelBandwidth / 4;
+    bwp0->m_channelBandwidth = bandwidthCc0Bpw0;
+    bwp0->m_lowerFrequency = bwp0->m_centralFrequency - bwp0->m_channelBandwidth / 2;
+    bwp0->m_higherFrequency = bwp0->m_centralFrequency + bwp0->m_channelBandwidth / 2;
+    bwp0->m_scenario = BandwidthPartInfo::Scenario::RMa_LoS;
+
+    cc0->AddBwp(std::move(bwp0));
+
+    // BWP 1
+    bwp1->m_bwpId = 1;
+    bwp1->m_centralFrequency = cc0->m_higherFrequency - cc0->m_channelBandwidth / 4;
+    bwp1->m_channelBandwidth = bandwidthCc0Bpw1;
+    bwp1->m_lowerFrequency = bwp1->m_centralFrequency - bwp1->m_channelBandwidth / 2;
+    bwp1->m_higherFrequency = bwp1->m_centralFrequency + bwp1->m_channelBandwidth / 2;
+    bwp1->m_scenario = BandwidthPartInfo::Scenario::RMa_LoS;
+
+    cc0->AddBwp(std::move(bwp1));
+
+    // Add CC to the corresponding operation band.
+    band.AddCc(std::move(cc0));
+
+    /********************* END Spectrum division ****************************/
+
+    nrHelper->SetPathlossAttribute("ShadowingEnabled", BooleanValue(false));
+    epcHelper->SetAttribute("S1uLinkDelay", TimeValue(MilliSeconds(0)));
+
+    // Set gNB scheduler
+    nrHelper->SetSchedulerTypeId(TypeId::LookupByName("ns3::NrMacSchedulerTdmaRR"));
+
+    // gNB Beamforming method
+    idealBeamformingHelper->SetAttribute("BeamformingMethod",
+                                         TypeIdValue(DirectPathBeamforming::GetTypeId()));
+
+    nrHelper->InitializeOperationBand(&band);
+    allBwps = CcBwpCreator::GetAllBwps({band});
+
+    // Antennas for all the UEs
+    nrHelper->SetUeAntennaAttribute("NumRows", UintegerValue(1));    // From SL examples
+    nrHelper->SetUeAntennaAttribute("NumColumns", UintegerValue(2)); // From SL examples
+    nrHelper->SetUeAntennaAttribute("AntennaElement",
+                                    PointerValue(CreateObject<IsotropicAntennaModel>()));
+
+    // Antennas for all the gNbs
+    nrHelper->SetGnbAntennaAttribute("NumRows", UintegerValue(4));
+    nrHelper->SetGnbAntennaAttribute("NumColumns", UintegerValue(8));
+    nrHelper->SetGnbAntennaAttribute("AntennaElement",
+                                     PointerValue(CreateObject<IsotropicAntennaModel>()));
+
+    // gNB bandwidth part manager setup.
+    // The current algorithm multiplexes BWPs depending on the associated bearer QCI
+    nrHelper->SetGnbBwpManagerAlgorithmAttribute(
+        "GBR_CONV_VOICE",
+        UintegerValue(0)); // The BWP index is 0 because only one BWP will be installed in the eNB
+
+    // Install only in the BWP that will be used for in-network
+    uint8_t bwpIdInNet = 0;
+    BandwidthPartInfoPtrVector inNetBwp;
+    inNetBwp.insert(inNetBwp.end(), band.GetBwpAt(/*CC*/ 0, bwpIdInNet));
+    NetDeviceContainer enbNetDev = nrHelper->InstallGnbDevice(gNbNodes, inNetBwp);
+
+    // Setup BWPs numerology, Tx Power and pattern
+    nrHelper->GetGnbPhy(enbNetDev.Get(0), 0)
+        ->SetAttribute("Numerology", UintegerValue(numerologyCc0Bwp0));
+    nrHelper->GetGnbPhy(enbNetDev.Get(0), 0)->SetAttribute("Pattern", StringValue(pattern));
+    nrHelper->GetGnbPhy(enbNetDev.Get(0), 0)->SetAttribute("TxPower", DoubleValue(gNBtotalTxPower));
+
+    // SL BWP manager configuration
+    uint8_t bwpIdSl = 1;
+    nrHelper->SetBwpManagerTypeId(TypeId::LookupByName("ns3::NrSlBwpManagerUe"));
+    nrHelper->SetUeBwpManagerAlgorithmAttribute("GBR_MC_PUSH_TO_TALK", UintegerValue(bwpIdSl));
+
+    // For relays, we need a special configuration with one Bwp configured
+    // with a Mac of type NrUeMac, and one Bwp configured with a Mac of type
+    // NrSlUeMac.  Use a variation of InstallUeDevice to configure that, and
+    // pass in a vector of object factories to account for the different Macs
+    std::vector<ObjectFactory> nrUeMacFactories;
+    ObjectFactory nrUeMacFactory;
+    nrUeMacFactory.SetTypeId(NrUeMac::GetTypeId());
+    nrUeMacFactories.emplace_back(nrUeMacFactory);
+    ObjectFactory nrSlUeMacFactory;
+    nrSlUeMacFactory.SetTypeId(NrSlUeMac::GetTypeId());
+    nrSlUeMacFactory.Set("EnableSensing", BooleanValue(false));
+    nrSlUeMacFactory.Set("T1", UintegerValue(2));
+    nrSlUeMacFactory.Set("ActivePoolId", UintegerValue(0));
+    nrSlUeMacFactory.Set("NumHarqProcess", UintegerValue(255));
+    nrSlUeMacFactory.Set("SlThresPsschRsrp", IntegerValue(-128));
+    nrUeMacFactories.emplace_back(nrSlUeMacFactory);
+
+    // Install both BWPs on U2N relays
+    NetDeviceContainer relayUeNetDev =
+        nrHelper->InstallUeDevice(relayUeNodes, allBwps, nrUeMacFactories);
+
+    // SL UE MAC configuration (for non relay UEs)
+    nrHelper->SetUeMacTypeId(NrSlUeMac::GetTypeId());
+    nrHelper->SetUeMacAttribute("EnableSensing", BooleanValue(false));
+    nrHelper->SetUeMacAttribute("T1", UintegerValue(2));
+    nrHelper->SetUeMacAttribute("ActivePoolId", UintegerValue(0));
+    nrHelper->SetUeMacAttribute("NumHarqProcess", UintegerValue(255));
+    nrHelper->SetUeMacAttribute("SlThresPsschRsrp", IntegerValue(-128));
+
+    // Install both BWPs on remote UEs
+    // This was needed to avoid errors with bwpId and vector indexes during device installation
+    NetDeviceContainer remoteUeNetDev = nrHelper->InstallUeDevice(remoteUeNodes, allBwps);
+    std::set<uint8_t> remoteUesBwpIdContainer;
+    remoteUesBwpIdContainer.insert(bwpIdInNet);
+    remoteUesBwpIdContainer.insert(bwpIdSl);
+
+    // Force update configurations
+    for (auto it = enbNetDev.Begin(); it != enbNetDev.End(); ++it)
+    {
+        DynamicCast<NrGnbNetDevice>(*it)->UpdateConfig();
+    }
+    for (auto it = relayUeNetDev.Begin(); it != relayUeNetDev.End(); ++it)
+    {
+        DynamicCast<NrUeNetDevice>(*it)->UpdateConfig();
+    }
+    for (auto it = remoteUeNetDev.Begin(); it != remoteUeNetDev.End(); ++it)
+    {
+        DynamicCast<NrUeNetDevice>(*it)->UpdateConfig();
+    }
+
+    /* Create NrSlHelper which will configure the UEs protocol stack to be ready to
+     * perform Sidelink related procedures
+     */
+    Ptr<NrSlHelper> nrSlHelper = CreateObject<NrSlHelper>();
+    nrSlHelper->SetEpcHelper(epcHelper);
+
+    // Set the SL error model and AMC
+    std::string errorModel = "ns3::NrEesmIrT1";
+    nrSlHelper->SetSlErrorModel(errorModel);
+    nrSlHelper->SetUeSlAmcAttribute("AmcModel", EnumValue(NrAmc::ErrorModel));
+
+    // Set the SL scheduler attributes
+    nrSlHelper->SetNrSlSchedulerTypeId(NrSlUeMacSchedulerFixedMcs::GetTypeId());
+    nrSlHelper->SetUeSlSchedulerAttribute("Mcs", UintegerValue(14));
+
+    // Configure U2N relay UEs for SL
+    std::set<uint8_t> slBwpIdContainerRelay;
+    slBwpIdContainerRelay.insert(bwpIdSl); // Only in the SL BWP for the relay UEs
+    nrSlHelper->PrepareUeForSidelink(relayUeNetDev, slBwpIdContainerRelay);
+
+    // Configure remote UEs for SL
+    nrSlHelper->PrepareUeForSidelink(remoteUeNetDev, remoteUesBwpIdContainer);
+
+    /***SL IEs configuration **/
+
+    // SlResourcePoolNr IE
+    LteRrcSap::SlResourcePoolNr slResourcePoolNr;
+    // get it from pool factory
+    Ptr<NrSlCommResourcePoolFactory> ptrFactory = Create<NrSlCommResourcePoolFactory>();
+    // Configure specific parameters of interest:
+    std::vector<std::bitset<1>> slBitmap = {1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1};
+    ptrFactory->SetSlTimeResources(slBitmap);
+    ptrFactory->SetSlSensingWindow(100); // T0 in ms
+    ptrFactory->SetSlSelectionWindow(5);
+    ptrFactory->SetSlFreqResourcePscch(10); // PSCCH RBs
+    ptrFactory->SetSlSubchannelSize(10);
+    ptrFactory->SetSlMaxNumPerReserve(3);
+    // Once parameters are configured, we can create the pool
+    LteRrcSap::SlResourcePoolNr pool = ptrFactory->CreatePool();
+    slResourcePoolNr = pool;
+
+    // Configure the SlResourcePoolConfigNr IE, which holds a pool and its id
+    LteRrcSap::SlResourcePoolConfigNr slresoPoolConfigNr;
+    slresoPoolConfigNr.haveSlResourcePoolConfigNr = true;
+    // Pool id, ranges from 0 to 15
+    uint16_t poolId = 0;
+    LteRrcSap::SlResourcePoolIdNr slResourcePoolIdNr;
+    slResourcePoolIdNr.id = poolId;
+    slresoPoolConfigNr.slResourcePoolId = slResourcePoolIdNr;
+    slresoPoolConfigNr.slResourcePool = slResourcePoolNr;
+
+    // Configure the SlBwpPoolConfigCommonNr IE, which holds an array of pools
+    LteRrcSap::SlBwpPoolConfigCommonNr slBwpPoolConfigCommonNr;
+    // Array for pools, we insert the pool in the array as per its poolId
+    slBwpPoolConfigCommonNr.slTxPoolSelectedNormal[slResourcePoolIdNr.id] = slresoPoolConfigNr;
+
+    // Configure the BWP IE
+    LteRrcSap::Bwp bwp;
+    bwp.numerology = numerologyCc0Bwp1;
+    bwp.symbolsPerSlots = 14;
+    bwp.rbPerRbg = 1;
+    bwp.bandwidth =
+        bandwidthCc0Bpw1 / 1000 / 100; // SL configuration requires BW in Multiple of 100 KHz
+
+    // Configure the SlBwpGeneric IE
+    LteRrcSap::SlBwpGeneric slBwpGeneric;
+    slBwpGeneric.bwp = bwp;
+    slBwpGeneric.slLengthSymbols = LteRrcSap::GetSlLengthSymbolsEnum(14);
+    slBwpGeneric.slStartSymbol = LteRrcSap::GetSlStartSymbolEnum(0);
+
+    // Configure the SlBwpConfigCommonNr IE
+    LteRrcSap::SlBwpConfigCommonNr slBwpConfigCommonNr;
+    slBwpConfigCommonNr.haveSlBwpGeneric = true;
+    slBwpConfigCommonNr.slBwpGeneric = slBwpGeneric;
+    slBwpConfigCommonNr.haveSlBwpPoolConfigCommonNr = true;
+    slBwpConfigCommonNr.slBwpPoolConfigCommonNr = slBwpPoolConfigCommonNr;
+
+    // Configure the SlFreqConfigCommonNr IE, which holds the array to store
+    // the configuration of all Sidelink BWP (s).
+    LteRrcSap::SlFreqConfigCommonNr slFreConfigCommonNr;
+    // Array for BWPs. Here we will iterate over the BWPs, which
+    // we want to use for SL.
+    for (const auto& it : remoteUesBwpIdContainer)
+    {
+        // it is the BWP id
+        slFreConfigCommonNr.slBwpList[it] = slBwpConfigCommonNr;
+    }
+
+    // Configure the TddUlDlConfigCommon IE
+    LteRrcSap::TddUlDlConfigCommon tddUlDlConfigCommon;
+    tddUlDlConfigCommon.tddPattern = pattern;
+
+    // Configure the SlPreconfigGeneralNr IE
+    LteRrcSap::SlPreconfigGeneralNr slPreconfigGeneralNr;
+    slPreconfigGeneralNr.slTddConfig = tddUlDlConfigCommon;
+
+    // Configure the SlUeSelectedConfig IE
+    LteRrcSap::SlUeSelectedConfig slUeSelectedPreConfig;
+    slUeSelectedPreConfig.slProbResourceKeep = 0;
+    // Configure the SlPsschTxParameters IE
+    LteRrcSap::SlPsschTxParameters psschParams;
+    psschParams.slMaxTxTransNumPssch = 5;
+    // Configure the SlPsschTxConfigList IE
+    LteRrcSap::SlPsschTxConfigList pscchTxConfigList;
+    pscchTxConfigList.slPsschTxParameters[0] = psschParams;
+    slUeSelectedPreConfig.slPsschTxConfigList = pscchTxConfigList;
+
+    /*
+     * Finally, configure the SidelinkPreconfigNr This is the main structure
+     * that needs to be communicated to NrSlUeRrc class
+     */
+    LteRrcSap::SidelinkPreconfigNr slPreConfigNr;
+    slPreConfigNr.slPreconfigGeneral = slPreconfigGeneralNr;
+    slPreConfigNr.slUeSelectedPreConfig = slUeSelectedPreConfig;
+    slPreConfigNr.slPreconfigFreqInfoList[0] = slFreConfigCommonNr;
+
+    // Communicate the above pre-configuration to the NrSlHelper
+    // For remote UEs
+    nrSlHelper->InstallNrSlPreConfiguration(remoteUeNetDev, slPreConfigNr);
+
+    // For U2N relay UEs we need to modify some parameters to configure *only*
+    // BWP1 on the relay for SL and avoid MAC problems
+    LteRrcSap::SlFreqConfigCommonNr slFreConfigCommonNrRelay;
+    slFreConfigCommonNrRelay.slBwpList[bwpIdSl] = slBwpConfigCommonNr;
+
+    LteRrcSap::SidelinkPreconfigNr slPreConfigNrRelay;
+    slPreConfigNrRelay.slPreconfigGeneral = slPreconfigGeneralNr;
+    slPreConfigNrRelay.slUeSelectedPreConfig = slUeSelectedPreConfig;
+    slPreConfigNrRelay.slPreconfigFreqInfoList[0] = slFreConfigCommonNrRelay;
+
+    nrSlHelper->InstallNrSlPreConfiguration(relayUeNetDev, slPreConfigNrRelay);
+
+    /***END SL IEs configuration **/
+
+    // Set random streams
+    int64_t randomStream = 1;
+    const uint64_t streamIncrement = 1000;
+    nrHelper->AssignStreams(enbNetDev, randomStream);
+    randomStream += streamIncrement;
+    nrHelper->AssignStreams(relayUeNetDev, randomStream);
+    randomStream += streamIncrement;
+    nrSlHelper->AssignStreams(relayUeNetDev, randomStream);
+    randomStream += streamIncrement;
+    nrHelper->AssignStreams(remoteUeNetDev, randomStream);
+    randomStream += streamIncrement;
+    nrSlHelper->AssignStreams(remoteUeNetDev, randomStream);
+    randomStream += streamIncrement;
+    remoteUesPositionAlloc->AssignStreams(randomStream);
+
+    // create the internet and install the IP stack on the UEs
+    // get SGW/PGW and create a single RemoteHost
+    Ptr<Node> pgw = epcHelper->GetPgwNode();
+    NodeContainer remoteHostContainer;
+    remoteHostContainer.Create(1, remoteHostSystemId);
+    Ptr<Node> remoteHost = remoteHostContainer.Get(0);
+    InternetStackHelper internet;
+    internet.Install(remoteHostContainer);
+
+    // connect a remoteHost to pgw. Setup routing too
+    NetDeviceContainer internetDevices = p2ph.Install(pgw, remoteHost);
+    Ipv4AddressHelper ipv4h;
+    Ipv4StaticRoutingHelper ipv4RoutingHelper;
+    ipv4h.SetBase("1.0.0.0", "255.0.0.0");
+    Ipv4InterfaceContainer internetIpIfaces = ipv4h.Assign(internetDevices);
+    Ptr<Ipv4StaticRouting> remoteHostStaticRouting =
+        ipv4RoutingHelper.GetStaticRouting(remoteHost->GetObject<Ipv4>());
+    remoteHostStaticRouting->AddNetworkRouteTo(Ipv4Address("7.0.0.0"), Ipv4Mask("255.0.0.0"), 1);
+    Ipv4Address remoteHostAddr = internetIpIfaces.GetAddress(1);
+
+    // Configure U2N relay UE
+    internet.Install(relayUeNodes);
+    epcHelper->AssignUeIpv4Address(NetDeviceContainer(relayUeNetDev));
+    Ptr<Ipv4StaticRouting> relayStaticRouting =
+        ipv4RoutingHelper.GetStaticRouting(relayUeNodes.Get(0)->GetObject<Ipv4>());
+    relayStaticRouting->SetDefaultRoute(epcHelper->GetUeDefaultGatewayAddress(), 1);
+    Ipv4Address relayIpv4Address =
+        relayUeNodes.Get(0)->GetObject<Ipv4L3Protocol>()->GetAddress(1, 0).GetLocal();
+
+    // Attach U2N relay UE to the gNB
+    nrHelper->AttachToClosestEnb(relayUeNetDev, enbNetDev);
+
+    // Configure out-of-network UEs
+    internet.Install(remoteUeNodes);
+    Ipv4InterfaceContainer ueIpIfaceSl;
+    ueIpIfaceSl = epcHelper->AssignUeIpv4Address(NetDeviceContainer(remoteUeNetDev));
+    for (uint32_t u = 0; u < remoteUeNodes.GetN(); ++u)
+    {
+        // Set the default gateway for the UE
+        Ptr<Ipv4StaticRouting> ueStaticRouting =
+            ipv4RoutingHelper.GetStaticRouting(remoteUeNodes.Get(u)->GetObject<Ipv4>());
+        ueStaticRouting->SetDefaultRoute(epcHelper->GetUeDefaultGatewayAddress(), 1);
+    }
+
+    /******** Configure ProSe layer in the UEs that will do SL  **********/
+    // Create ProSe helper
+    Ptr<NrSlProseHelper> nrSlProseHelper = CreateObject<NrSlProseHelper>();
+    nrSlProseHelper->SetEpcHelper(epcHelper);
+
+    // Install ProSe layer and corresponding SAPs in the UEs
+    nrSlProseHelper->PrepareUesForProse(relayUeNetDev);
+    nrSlProseHelper->PrepareUesForProse(remoteUeNetDev);
+
+    // Configure ProSe Unicast parameters. At the moment it only instruct the MAC
+    // layer (and PHY therefore) to monitor packets directed the UE's own Layer 2 ID
+    nrSlProseHelper->PrepareUesForUnicast(relayUeNetDev);
+    nrSlProseHelper->PrepareUesForUnicast(remoteUeNetDev);
+
+    // Configure the value of timer Timer T5080 (Prose Direct Link Establishment Request
+    // Retransmission) to a lower value than the standard (8.0 s) to speed connection in shorter
+    // simulation time
+    Config::SetDefault("ns3::NrSlUeProseDirectLink::T5080", TimeValue(Seconds(2.0)));
+    /******** END Configure ProSe layer in the UEs that will do SL  **********/
+
+    /******************** Relay discovery configuration ***********************/
+    uint32_t relayServiceCode = 5;
+    uint32_t relayDstL2Id = 500;
+
+    Ptr<NrSlDiscoveryOracle> oracle;
+    if (discoveryOracle)
+    {
+        oracle = CreateObject<NrSlDiscoveryOracle>();
+        nrSlProseHelper->EnableDiscoveryOracle(relayUeNetDev, oracle);
+        nrSlProseHelper->EnableDiscoveryOracle(remoteUeNetDev, oracle);
+    }
+    Simulator::Schedule(startDiscTime,
+                        &NrSlProseHelper::StartRelayDiscovery,
+                        nrSlProseHelper,
+                        relayUeNetDev.Get(0),
+                        relayServiceCode,
+                        relayDstL2Id,
+                        NrSlUeProse::ModelB,
+                        NrSlUeProse::RelayUE);
+    for (uint32_t i = 0; i < remoteUeNetDev.GetN(); ++i)
+    {
+        Simulator::Schedule(startDiscTime,
+                            &NrSlProseHelper::StartRelayDiscovery,
+                            nrSlProseHelper,
+                            remoteUeNetDev.Get(i),
+                            relayServiceCode,
+                            relayDstL2Id,
+                            NrSlUeProse::ModelB,
+                            NrSlUeProse::RemoteUE);
+    }
+    /******************** END Relay discovery configuration *******************/
+
+    /******************** L3 U2N Relay configuration ***************************/
+    //-Configure relay service codes
+    std::set<uint32_t> relaySCs;
+    relaySCs.insert(relayServiceCode);
+
+    //-Configure the UL data radio bearer that the relay UE will use for U2N relaying traffic
+    Ptr<EpcTft> tftRelay = Create<EpcTft>();
+    EpcTft::PacketFilter pfRelay;
+    tftRelay->Add(pfRelay);
+    enum EpsBearer::Qci qciRelay;
+    qciRelay = EpsBearer::GBR_CONV_VOICE;
+    EpsBearer bearerRelay(qciRelay);
+
+    // Apply the configuration on the device acting as relay UE
+    nrSlProseHelper->ConfigureL3UeToNetworkRelay(relayUeNetDev, relaySCs, bearerRelay, tftRelay);
+
+    // Configure direct link connection between remote UEs and relay UE
+    NS_LOG_INFO("Configuring remote UE - relay UE connection...");
+    SidelinkInfo remoteUeSlInfo;
+    remoteUeSlInfo.m_castType = SidelinkInfo::CastType::Unicast;
+    remoteUeSlInfo.m_dynamic = true;
+    remoteUeSlInfo.m_harqEnabled = false;
+    remoteUeSlInfo.m_priority = 0;
+    remoteUeSlInfo.m_rri = Seconds(0);
+    remoteUeSlInfo.m_pdb = MilliSeconds(20);
+
+    SidelinkInfo relayUeSlInfo;
+    relayUeSlInfo.m_castType = SidelinkInfo::CastType::Unicast;
+    relayUeSlInfo.m_dynamic = true;
+    relayUeSlInfo.m_harqEnabled = false;
+    relayUeSlInfo.m_priority = 0;
+    relayUeSlInfo.m_rri = Seconds(0);
+    relayUeSlInfo.m_pdb = MilliSeconds(20);
+
+    for (uint32_t i = 0; i < remoteUeNodes.GetN(); ++i)
+    {
+        Time connTime = startRelayConnTime + connSpread * i / remoteUeNum;
+        nrSlProseHelper->EstablishL3UeToNetworkRelayConnection(
+            connTime,
+            remoteUeNetDev.Get(i),
+            remoteUeNodes.Get(i)->GetObject<Ipv4L3Protocol>()->GetAddress(1, 0).GetLocal(),
+            remoteUeSlInfo, // Remote UE
+            relayUeNetDev.Get(0),
+            relayIpv4Address,
+            relayUeSlInfo, // Relay UE
+            relayServiceCode);
+    }
+    /******************** END L3 U2N Relay configuration ***********************/
+
+    /********* Remote UEs applications configuration ******/
+    // All the remote UEs use the same ports, as the flows are told apart by
+    // the addresses. In a distributed simulation, the applications of the
+    // Remote Host are configured by its partition, thus only the UL flows are
+    // used
+    ApplicationContainer clientApps, serverApps;
+    if (lambda > 0)
+    {
+        // Random variable to randomize a bit start times of the client applications
+        // to avoid simulation artifacts of all the TX UEs transmitting at the same time.
+        Ptr<UniformRandomVariable> startTimeRnd = CreateObject<UniformRandomVariable>();
+        randomStream += streamIncrement;
+        startTimeRnd->SetStream(randomStream);
+        startTimeRnd->SetAttribute("Min", DoubleValue(0));
+        startTimeRnd->SetAttribute("Max", DoubleValue(1.0 / lambda)); // seconds
+
+        if (!useMpi)
+        {
+            PacketSinkHelper ulPacketSinkHelper("ns3::UdpSocketFactory",
+                                                InetSocketAddress(Ipv4Address::GetAny(), ulPort));
+            serverApps.Add(ulPacketSinkHelper.Install(remoteHost));
+
+            PacketSinkHelper dlPacketSinkHelper("ns3::UdpSocketFactory",
+                                                InetSocketAddress(Ipv4Address::GetAny(), dlPort));
+            serverApps.Add(dlPacketSinkHelper.Install(remoteUeNodes));
+        }
+
+        for (uint32_t u = 0; u < remoteUeNodes.GetN(); ++u)
+        {
+            if (!useMpi)
+            {
+                // DL traffic
+                UdpClientHelper dlClient(ueIpIfaceSl.GetAddress(u), dlPort);
+                dlClient.SetAttribute("PacketSize", UintegerValue(packetSizeDlUl));
+                dlClient.SetAttribute("Interval", TimeValue(Seconds(1.0 / lambda)));
+                dlClient.SetAttribute("MaxPackets", UintegerValue(0xFFFFFFFF));
+                ApplicationContainer dlApp = dlClient.Install(remoteHost);
+                dlApp.Start(Seconds(trafficStartTime + startTimeRnd->GetValue()));
+                clientApps.Add(dlApp);
+
+                Ptr<EpcTft> tftDl = Create<EpcTft>();
+                EpcTft::PacketFilter pfDl;
+                pfDl.localPortStart = dlPort;
+                pfDl.localPortEnd = dlPort;
+                tftDl->Add(pfDl);
+                EpsBearer bearerDl(EpsBearer::GBR_CONV_VOICE);
+                nrHelper->ActivateDedicatedEpsBearer(remoteUeNetDev.Get(u), bearerDl, tftDl);
+            }
+
+            // UL traffic
+            UdpClientHelper ulClient(remoteHostAddr, ulPort);
+            ulClient.SetAttribute("PacketSize", UintegerValue(packetSizeDlUl));
+            ulClient.SetAttribute("Interval", TimeValue(Seconds(1.0 / lambda)));
+            ulClient.SetAttribute("MaxPackets", UintegerValue(0xFFFFFFFF));
+            ApplicationContainer ulApp = ulClient.Install(remoteUeNodes.Get(u));
+            ulApp.Start(Seconds(trafficStartTime + startTimeRnd->GetValue()));
+            clientApps.Add(ulApp);
+
+            Ptr<EpcTft> tftUl = Create<EpcTft>();
+            EpcTft::PacketFilter pfUl;
+            pfUl.remoteAddress = remoteHostAddr;
+            pfUl.remotePortStart = ulPort;
+            pfUl.remotePortEnd = ulPort;
+            tftUl->Add(pfUl);
+            EpsBearer bearerUl(EpsBearer::GBR_CONV_VOICE);
+            nrHelper->ActivateDedicatedEpsBearer(remoteUeNetDev.Get(u), bearerUl, tftUl);
+        }
+
+        serverApps.Start(Seconds(trafficStartTime));
+        serverApps.Stop(Seconds(simTime));
+        clientApps.Stop(Seconds(simTime));
+
+        randomStream += streamIncrement;
+        ApplicationHelper::AssignStreamsToAllApps(remoteUeNodes, randomStream);
+        randomStream += streamIncrement;
+        ApplicationHelper::AssignStreamsToAllApps(remoteHostContainer, randomStream);
+    }
+    /********* END Remote UEs applications configuration ******/
+
+    /******************** Scale measurements ***********************************/
+    Ptr<NrSlUeProse> relayProse = relayUeNetDev.Get(0)->GetObject<NrSlUeProse>();
+    relayProse->TraceConnectWithoutContext("DiscoveryTrace",
+                                           MakeCallback(&TraceSinkRelayDiscovery));
+    relayProse->TraceConnectWithoutContext("PC5SignallingPacketTrace",
+                                           MakeCallback(&TraceSinkRelayPc5Signalling));
+
+    std::string exampleName = simTag + "-" + "nr-prose-l3-relay-scale";
+    AsciiTraceHelper ascii;
+    Ptr<OutputStreamWrapper> scaleStream =
+        ascii.CreateFileStream(NrSlProseHelper::GetPartitionFilename(outputDir + exampleName +
+                                                                     ".txt"));
+    *scaleStream->GetStream() << "time(s)\twallClockPerSimSecond(s)\tresidentMemory(MB)\t"
+                                 "directLinks\tacceptedRemotes\tproseLinkMemoryEstimate(B)\t"
+                                 "solicitationsRx\tresponsesTx"
+                              << std::endl;
+
+    // Resident memory before the first connection and at the end of the
+    // connection phase, for the per-link memory of the whole process
+    uint64_t memoryBeforeLinks = 0;
+    uint64_t memoryAfterLinks = 0;
+    Time endConnTime = startRelayConnTime + connSpread + Seconds(1.0);
+    Simulator::Schedule(startRelayConnTime, &RecordResidentMemory, &memoryBeforeLinks);
+    Simulator::Schedule(endConnTime, &RecordResidentMemory, &memoryAfterLinks);
+
+    std::vector<std::pair<Time, double>> wallClockPerSimSecond;
+    Simulator::Schedule(sampleInterval,
+                        &SampleScale,
+                        scaleStream,
+                        relayProse,
+                        sampleInterval,
+                        &wallClockPerSimSecond);
+    /******************** END Scale measurements *******************************/
+
+    // Run simulation
+    Simulator::Stop(Seconds(simTime));
+    auto wallClockStart = std::chrono::steady_clock::now();
+    g_lastSample.wallClock = wallClockStart;
+    Simulator::Run();
+    double wallClockRun =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - wallClockStart).count();
+
+    // Cost of the remote UE table of the EPC: time to add remote UEs to the
+    // table already holding the remote UEs of the scenario, measured over
+    // 'epcBatches' batches of 'epcBatchSize' insertions to see how the cost
+    // evolves with the size of the table. The addresses used do not belong to
+    // any UE of the scenario
+    uint64_t relayImsi = relayUeNetDev.Get(0)->GetObject<NrUeNetDevice>()->GetImsi();
+    Ipv4Address firstEpcSample("10.0.0.1");
+    std::vector<double> epcAddCost; // seconds per insertion, one entry per batch
+    for (uint32_t b = 0; b < epcBatches && epcBatchSize > 0; ++b)
+    {
+        auto epcStart = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < epcBatchSize; ++i)
+        {
+            epcHelper->AddRemoteUe(relayImsi,
+                                   Ipv4Address(firstEpcSample.Get() + b * epcBatchSize + i));
+        }
+        epcAddCost.push_back(
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - epcStart).count() /
+            epcBatchSize);
+    }
+
+    // Average wall-clock time per simulated second before the connections and
+    // once all of them were started
+    double wallClockBefore = 0;
+    uint32_t nBefore = 0;
+    double wallClockAfter = 0;
+    uint32_t nAfter = 0;
+    for (const auto& sample : wallClockPerSimSecond)
+    {
+        if (sample.first <= startRelayConnTime)
+        {
+            wallClockBefore += sample.second;
+            nBefore++;
+        }
+        else if (sample.first > endConnTime)
+        {
+            wallClockAfter += sample.second;
+            nAfter++;
+        }
+    }
+
+    uint32_t nLinks = relayProse->GetNumDirectLinks();
+    double discoveryDuration = (Seconds(simTime) - startDiscTime).GetSeconds();
+
+    std::cout << "Relay scale benchmark with " << remoteUeNum << " remote UEs:" << std::endl;
+    std::cout << " Remote UEs accepted by the relay UE: " << g_acceptedRemotes.size() << std::endl;
+    std::cout << " Direct links of the relay UE: " << nLinks << std::endl;
+    if (nLinks > 0)
+    {
+        std::cout << " ProSe layer memory per link in the relay UE (static estimate): "
+                  << relayProse->GetDirectLinkMemoryUsage() / nLinks << " B" << std::endl;
+    }
+    if (memoryAfterLinks > memoryBeforeLinks && !g_acceptedRemotes.empty())
+    {
+        std::cout << " Process memory per link (both ends, all layers, measured): "
+                  << (memoryAfterLinks - memoryBeforeLinks) / g_acceptedRemotes.size() << " B"
+                  << std::endl;
+    }
+    for (uint32_t b = 0; b < epcAddCost.size(); ++b)
+    {
+        uint64_t tableSize = g_acceptedRemotes.size() + static_cast<uint64_t>(b) * epcBatchSize;
+        std::cout << " EPC remote UE table from " << tableSize << " to "
+                  << tableSize + epcBatchSize << " entries: " << epcAddCost[b] * 1e6
+                  << " us per insertion (average over " << epcBatchSize << ")" << std::endl;
+    }
+    if (discoveryDuration > 0)
+    {
+        std::cout << " Discovery load on the relay UE: "
+                  << g_relaySolicitationsRx / discoveryDuration << " solicitations/s received, "
+                  << g_relayResponsesTx / discoveryDuration << " responses/s transmitted"
+                  << std::endl;
+    }
+    if (oracle)
+    {
+        std::cout << " Discovery oracle: " << oracle->GetTransmissions() << " messages, "
+                  << oracle->GetReceptions() << " receptions, " << oracle->GetCandidates()
+                  << " candidate receivers checked" << std::endl;
+    }
+    if (nBefore > 0)
+    {
+        std::cout << " Wall-clock per simulated second before the connections: "
+                  << wallClockBefore / nBefore << " s" << std::endl;
+    }
+    if (nAfter > 0)
+    {
+        std::cout << " Wall-clock per simulated second with all the connections: "
+                  << wallClockAfter / nAfter << " s" << std::endl;
+    }
+    std::cout << " Total wall-clock: " << wallClockRun << " s for " << simTime
+              << " simulated s" << std::endl;
+
+    Simulator::Destroy();
+#ifdef NS3_MPI
+    if (useMpi)
+    {
+        MpiInterface::Disable();
+    }
+#endif
+    return 0;
+}
@@ -35,6 +35,8 @@
 
 #include "nr-sl-discovery-trace.h"
 
+#include "nr-sl-prose-helper.h"
+
 #include "ns3/string.h"
 #include <ns3/log.h>
 #include <ns3/simulator.h>
@@ -104,17 +106,18 @@ NrSlDiscoveryTrace::DiscoveryTrace(uint32_t senderL2Id,
                                    bool isTx,
                                    NrSlDiscoveryHeader discMsg)
 {
-    NS_LOG_INFO("Writing Discovery Transmission/Reception Stats in "
-                << GetSlDiscoveryOutputFilename().c_str());
+    // The output file of the partition of this process, in a distributed simulation
+    std::string filename = NrSlProseHelper::GetPartitionFilename(GetSlDiscoveryOutputFilename());
+    NS_LOG_INFO("Writing Discovery Transmission/Reception Stats in " << filename);
 
     std::ofstream outFile;
     outFile.precision(10);
     if (m_discoveryFirstWrite == true)
     {
-        outFile.open(GetSlDiscoveryOutputFilename().c_str());
+        outFile.open(filename.c_str());
         if (!outFile.is_open())
         {
-            NS_LOG_ERROR("Can't open file " << GetSlDiscoveryOutputFilename().c_str());
+            NS_LOG_ERROR("Can't open file " << filename.c_str());
             return;
         }
         m_discoveryFirstWrite = false;
@@ -124,10 +127,10 @@ NrSlDiscoveryTrace::DiscoveryTrace(uint32_t senderL2Id,
     }
     else
     {
-        outFile.open(GetSlDiscoveryOutputFilename().c_str(), std::ios_base::app);
+        outFile.open(filename.c_str(), std::ios_base::app);
         if (!outFile.is_open())
         {
-            NS_LOG_ERROR("Can't open file " << GetSlDiscoveryOutputFilename().c_str());
+            NS_LOG_ERROR("Can't open file " << filename.c_str());
             return;
         }
     }
@@ -205,6 +208,21 @@ NrSlDiscoveryTrace::DiscoveryTrace(uint32_t senderL2Id,
         outFile << "RelaySolicitation"
                 << "\t";
     }
+    else if (discMsg.GetDiscoveryContentType() == 6 and discMsg.GetDiscoveryModel() == 1)
+    {
+        outFile << "GroupAnnouncement"
+                << "\t";
+    }
+    else if (discMsg.GetDiscoveryContentType() == 6 and discMsg.GetDiscoveryModel() == 2)
+    {
+        outFile << "GroupResponse"
+                << "\t";
+    }
+    else if (discMsg.GetDiscoveryContentType() == 7)
+    {
+        outFile << "GroupSolicitation"
+                << "\t";
+    }
     else
     {
         NS_FATAL_ERROR("Invalid discovery content type " << discMsg.GetDiscoveryContentType());
@@ -236,6 +254,13 @@ NrSlDiscoveryTrace::DiscoveryTrace(uint32_t senderL2Id,
         outFile << discMsg.GetApplicationCode() << std::endl;
     }
     break;
+    case NrSlDiscoveryHeader::DISC_GROUP_ANNOUNCEMENT:
+    case NrSlDiscoveryHeader::DISC_GROUP_SOLICITATION:
+    case NrSlDiscoveryHeader::DISC_GROUP_RESPONSE: {
+        outFile << discMsg.GetGroup() << ";" << discMsg.GetInfo() << ";"
+                << discMsg.GetGroupInfo() << std::endl;
+    }
+    break;
     default:
         NS_FATAL_ERROR("Invalid discovery message type " << discMsg.GetDiscoveryMsgType());
     }
@@ -35,18 +35,29 @@
 
 #include "nr-sl-prose-helper.h"
 
+#include <ns3/boolean.h>
 #include <ns3/config.h>
 #include <ns3/epc-ue-nas.h>
 #include <ns3/fatal-error.h>
+#include <ns3/global-value.h>
+#include <ns3/ipv4.h>
 #include <ns3/log.h>
 #include <ns3/lte-ue-rrc.h>
 #include <ns3/nr-point-to-point-epc-helper.h>
+#include <ns3/nr-sl-discovery-oracle.h>
+#include <ns3/nr-sl-u2n-relay-scheduler.h>
 #include <ns3/nr-sl-ue-prose.h>
 #include <ns3/nr-sl-ue-rrc.h>
 #include <ns3/nr-sl-ue-service.h>
 #include <ns3/nr-ue-net-device.h>
+#include <ns3/nr-ue-phy.h>
 #include <ns3/pointer.h>
 #include <ns3/simulator.h>
+#include <ns3/string.h>
+
+#include <fstream>
+#include <set>
+#include <sstream>
 
 namespace ns3
 {
@@ -74,7 +85,14 @@ NrSlProseHelper::GetTypeId(void)
     static TypeId tid = TypeId("ns3::NrSlProseHelper")
                             .SetParent<Object>()
                             .SetGroupName("nr")
-                            .AddConstructor<NrSlProseHelper>();
+                            .AddConstructor<NrSlProseHelper>()
+                            .AddAttribute("ShareRelayBearer",
+                                          "If true, ConfigureL3UeToNetworkRelay activates a "
+                                          "single EPS bearer per relay UE, shared by all the "
+                                          "relay service codes, instead of one per code",
+                                          BooleanValue(false),
+                                          MakeBooleanAccessor(&NrSlProseHelper::m_shareRelayBearer),
+                                          MakeBooleanChecker());
     return tid;
 }
 
@@ -92,6 +110,42 @@ NrSlProseHelper::SetEpcHelper(const Ptr<NrPointToPointEpcHelper>& epcHelper)
     m_epcHelper = epcHelper;
 }
 
+bool
+NrSlProseHelper::IsDistributed()
+{
+    StringValue impl;
+    if (!GlobalValue::GetValueByNameFailSafe("SimulatorImplementationType", impl))
+    {
+        return false;
+    }
+    return impl.Get() == "ns3::DistributedSimulatorImpl" ||
+           impl.Get() == "ns3::NullMessageSimulatorImpl";
+}
+
+std::string
+NrSlProseHelper::GetPartitionFilename(const std::string& filename)
+{
+    if (!IsDistributed())
+    {
+        return filename;
+    }
+    std::ostringstream rank;
+    rank << "-rank" << Simulator::GetSystemId();
+    std::size_t dot = filename.find_last_of('.');
+    std::size_t slash = filename.find_last_of('/');
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+    {
+        return filename + rank.str();
+    }
+    return filename.substr(0, dot) + rank.str() + filename.substr(dot);
+}
+
+bool
+NrSlProseHelper::IsLocal(Ptr<NetDevice> device)
+{
+    return device->GetNode()->GetSystemId() == Simulator::GetSystemId();
+}
+
 void
 NrSlProseHelper::PrepareUesForProse(NetDeviceContainer c)
 {
@@ -99,6 +153,10 @@ NrSlProseHelper::PrepareUesForProse(NetDeviceContainer c)
     for (NetDeviceContainer::Iterator i = c.Begin(); i != c.End(); ++i)
     {
         Ptr<NetDevice> netDev = *i;
+        if (!IsLocal(netDev))
+        {
+            continue;
+        }
         Ptr<NrUeNetDevice> nrUeDev = netDev->GetObject<NrUeNetDevice>();
         PrepareSingleUeForProse(nrUeDev);
     }
@@ -132,6 +190,10 @@ NrSlProseHelper::PrepareUesForUnicast(NetDeviceContainer c)
     for (NetDeviceContainer::Iterator i = c.Begin(); i != c.End(); ++i)
     {
         Ptr<NetDevice> netDev = *i;
+        if (!IsLocal(netDev))
+        {
+            continue;
+        }
         Ptr<NrUeNetDevice> nrUeDev = netDev->GetObject<NrUeNetDevice>();
         PrepareSingleUeForUnicast(nrUeDev);
     }
@@ -156,6 +218,13 @@ NrSlProseHelper::EstablishRealDirectLink(Time time,
                                          struct SidelinkInfo& trgtSlInfo)
 {
     NS_LOG_FUNCTION(this);
+    if (!IsLocal(initUe) && !IsLocal(trgtUe))
+    {
+        NS_LOG_LOGIC("Direct link UEs belong to another partition");
+        return;
+    }
+    NS_ABORT_MSG_IF(IsLocal(initUe) != IsLocal(trgtUe),
+                    "The UEs of a direct link cannot belong to different partitions");
     Ptr<NrUeNetDevice> initUeNetDev = initUe->GetObject<NrUeNetDevice>();
     Ptr<NrUeNetDevice> trgtUeNetDev = trgtUe->GetObject<NrUeNetDevice>();
     Ptr<NrSlUeProse> initUeProse = initUeNetDev->GetObject<NrSlUeProse>();
@@ -202,6 +271,29 @@ NrSlProseHelper::EstablishRealDirectLink(Time time,
                         trgtSlInfo);
 }
 
+void
+NrSlProseHelper::EnableAutoDirectLink(NetDeviceContainer ueDevices,
+                                      uint32_t appCode,
+                                      const struct SidelinkInfo& slInfo)
+{
+    NS_LOG_FUNCTION(this << appCode);
+
+    for (NetDeviceContainer::Iterator i = ueDevices.Begin(); i != ueDevices.End(); ++i)
+    {
+        if (!IsLocal(*i))
+        {
+            continue;
+        }
+        Ptr<NrUeNetDevice> nrUeDev = (*i)->GetObject<NrUeNetDevice>();
+        Ptr<NrSlUeProse> ueProse = nrUeDev->GetObject<NrSlUeProse>();
+        Ptr<LteUeRrc> ueRrc = nrUeDev->GetRrc();
+        ueProse->SetL2Id(ueRrc->GetSourceL2Id());
+        ueProse->SetImsi(ueRrc->GetImsi());
+        ueProse->SetNetDevice(*i);
+        ueProse->EnableAutoDirectLink(appCode, slInfo);
+    }
+}
+
 void
 NrSlProseHelper::EstablishL3UeToNetworkRelayConnection(Time t,
                                                        Ptr<NetDevice> remoteUe,
@@ -219,6 +311,13 @@ NrSlProseHelper::EstablishL3UeToNetworkRelayConnection(Time t,
         NS_FATAL_ERROR(
             "Please provide a relay service code greater than zero for U2N relay connection.");
     }
+    if (!IsLocal(remoteUe) && !IsLocal(relayUe))
+    {
+        NS_LOG_LOGIC("Remote and relay UEs belong to another partition");
+        return;
+    }
+    NS_ABORT_MSG_IF(IsLocal(remoteUe) != IsLocal(relayUe),
+                    "The remote UE and the relay UE cannot belong to different partitions");
     Ptr<NrUeNetDevice> remoteUeNetDev = remoteUe->GetObject<NrUeNetDevice>();
     Ptr<NrUeNetDevice> relayUeNetDev = relayUe->GetObject<NrUeNetDevice>();
     Ptr<NrSlUeProse> remoteUeProse = remoteUeNetDev->GetObject<NrSlUeProse>();
@@ -272,23 +371,70 @@ NrSlProseHelper::ConfigureL3UeToNetworkRelay(const NetDeviceContainer relayUeDev
                                              Ptr<EpcTft> tft)
 {
     NS_LOG_FUNCTION(this);
+
+    std::map<uint32_t, uint32_t> relayServiceCodeBearers;
+    std::vector<EpsBearer> bearers;
+    std::vector<Ptr<EpcTft>> tfts;
+    for (auto it = relayServiceCodes.begin(); it != relayServiceCodes.end(); ++it)
+    {
+        if (!m_shareRelayBearer || bearers.empty())
+        {
+            bearers.push_back(bearer);
+            tfts.push_back(tft);
+        }
+        relayServiceCodeBearers[*it] = bearers.size() - 1;
+    }
+    ConfigureL3UeToNetworkRelay(relayUeDevices, relayServiceCodeBearers, bearers, tfts);
+}
+
+void
+NrSlProseHelper::ConfigureL3UeToNetworkRelay(
+    const NetDeviceContainer relayUeDevices,
+    const std::map<uint32_t, uint32_t> relayServiceCodeBearers,
+    const std::vector<EpsBearer> bearers,
+    const std::vector<Ptr<EpcTft>> tfts)
+{
+    NS_LOG_FUNCTION(this);
     NS_ASSERT_MSG(m_epcHelper, "dedicated EPS bearers cannot be set up when the EPC is not used");
+    NS_ABORT_MSG_IF(bearers.size() != tfts.size(), "One TFT is needed per relay bearer");
 
     for (NetDeviceContainer::Iterator devIt = relayUeDevices.Begin(); devIt != relayUeDevices.End();
          ++devIt)
     {
+        if (!IsLocal(*devIt))
+        {
+            continue;
+        }
+        // The relay UE configures the data path of its remote UEs directly in
+        // the PGW application, which therefore needs to be in the same partition
+        NS_ABORT_MSG_IF(m_epcHelper->GetPgwNode()->GetSystemId() != Simulator::GetSystemId(),
+                        "The relay UEs and the PGW cannot belong to different partitions");
         uint64_t imsi = (*devIt)->GetObject<NrUeNetDevice>()->GetImsi();
         Ptr<NrSlUeProse> prose = (*devIt)->GetObject<NrUeNetDevice>()->GetObject<NrSlUeProse>();
 
+        // Activate the Eps dedicated bearers for relaying used by at least one service
+        std::map<uint32_t, uint8_t> relayDrbIds;
+        for (const auto& itCode : relayServiceCodeBearers)
+        {
+            NS_ABORT_MSG_IF(itCode.second >= bearers.size(),
+                            "Relay service code " << itCode.first << " mapped to unknown bearer "
+                                                  << itCode.second);
+            if (relayDrbIds.find(itCode.second) == relayDrbIds.end())
+            {
+                relayDrbIds[itCode.second] = m_epcHelper->ActivateEpsBearer(*devIt,
+                                                                            imsi,
+                                                                            tfts[itCode.second],
+                                                                            bearers[itCode.second]);
+            }
+        }
+
         // Set the relay service codes of the services the relay UE provides and the associated
         // configuration
-        for (auto it = relayServiceCodes.begin(); it != relayServiceCodes.end(); ++it)
+        for (const auto& itCode : relayServiceCodeBearers)
         {
-            // Activate Eps dedicated bearer for relaying
-            uint8_t relayDrbId = m_epcHelper->ActivateEpsBearer(*devIt, imsi, tft, bearer);
             NrSlUeProse::NrSlL3U2nServiceConfiguration config;
-            config.relayDrbId = relayDrbId;
-            prose->AddL3U2nRelayServiceConfiguration(*it, config);
+            config.relayDrbId = relayDrbIds[itCode.second];
+            prose->AddL3U2nRelayServiceConfiguration(itCode.first, config);
         }
         // Set EPC Helper pointer on the ProSe layer, which is used to configure
         // data path in the EpcPgwApplication when a remote UE successfully connects to this relay
@@ -304,6 +450,10 @@ NrSlProseHelper::StartDiscoveryApp(Ptr<NetDevice> ueDevice,
                                    NrSlUeProse::DiscoveryRole role)
 {
     NS_LOG_FUNCTION(this);
+    if (!IsLocal(ueDevice))
+    {
+        return;
+    }
 
     Ptr<NrSlUeProse> ueProse = ueDevice->GetObject<NrUeNetDevice>()->GetObject<NrSlUeProse>();
     ueProse->SetL2Id(ueDevice->GetObject<NrUeNetDevice>()->GetRrc()->GetSourceL2Id());
@@ -317,6 +467,10 @@ NrSlProseHelper::StopDiscoveryApp(Ptr<NetDevice> ueDevice,
                                   NrSlUeProse::DiscoveryRole role)
 {
     NS_LOG_FUNCTION(this);
+    if (!IsLocal(ueDevice))
+    {
+        return;
+    }
 
     Ptr<NrSlUeProse> ueProse = ueDevice->GetObject<NrUeNetDevice>()->GetObject<NrSlUeProse>();
     ueProse->RemoveDiscoveryApp(appCode, role);
@@ -360,6 +514,10 @@ NrSlProseHelper::StartRelayDiscovery(Ptr<NetDevice> ueDevice,
                                      NrSlUeProse::DiscoveryRole role)
 {
     NS_LOG_FUNCTION(this);
+    if (!IsLocal(ueDevice))
+    {
+        return;
+    }
     Ptr<NrSlUeProse> ueProse = ueDevice->GetObject<NrUeNetDevice>()->GetObject<NrSlUeProse>();
     Ptr<LteUeRrc> ueRrc = ueDevice->GetObject<NrUeNetDevice>()->GetRrc();
     uint32_t srcL2Id = ueRrc->GetSourceL2Id();
@@ -369,16 +527,259 @@ NrSlProseHelper::StartRelayDiscovery(Ptr<NetDevice> ueDevice,
     ueProse->SetNetDevice(ueDevice);
 }
 
+void
+NrSlProseHelper::StartRelayDiscoveryCodes(Ptr<NetDevice> ueDevice,
+                                          std::map<uint32_t, uint32_t> relayCodes,
+                                          NrSlUeProse::DiscoveryModel model,
+                                          NrSlUeProse::DiscoveryRole role)
+{
+    NS_LOG_FUNCTION(this << relayCodes.size());
+    if (!IsLocal(ueDevice))
+    {
+        return;
+    }
+    Ptr<NrSlUeProse> ueProse = ueDevice->GetObject<NrUeNetDevice>()->GetObject<NrSlUeProse>();
+    Ptr<LteUeRrc> ueRrc = ueDevice->GetObject<NrUeNetDevice>()->GetRrc();
+    ueProse->SetL2Id(ueRrc->GetSourceL2Id());
+    ueProse->SetImsi(ueRrc->GetImsi());
+    ueProse->AddRelayDiscoveryCodes(relayCodes, model, role);
+    ueProse->SetNetDevice(ueDevice);
+}
+
 void
 NrSlProseHelper::StopRelayDiscovery(Ptr<NetDevice> ueDevice,
                                     uint32_t relayCode,
                                     NrSlUeProse::DiscoveryRole role)
 {
     NS_LOG_FUNCTION(this);
+    if (!IsLocal(ueDevice))
+    {
+        return;
+    }
     Ptr<NrSlUeProse> ueProse = ueDevice->GetObject<NrUeNetDevice>()->GetObject<NrSlUeProse>();
     ueProse->RemoveRelayDiscovery(relayCode, role);
 }
 
+void
+NrSlProseHelper::StartGroupDiscovery(NetDeviceContainer ueDevices,
+                                     uint32_t groupId,
+                                     uint32_t dstL2Id,
+                                     NrSlUeProse::DiscoveryModel model,
+                                     NrSlUeProse::DiscoveryRole role)
+{
+    NS_LOG_FUNCTION(this << groupId << dstL2Id);
+
+    for (NetDeviceContainer::Iterator i = ueDevices.Begin(); i != ueDevices.End(); ++i)
+    {
+        if (!IsLocal(*i))
+        {
+            continue;
+        }
+        Ptr<NrSlUeProse> ueProse = (*i)->GetObject<NrUeNetDevice>()->GetObject<NrSlUeProse>();
+        Ptr<LteUeRrc> ueRrc = (*i)->GetObject<NrUeNetDevice>()->GetRrc();
+        ueProse->SetL2Id(ueRrc->GetSourceL2Id());
+        ueProse->SetImsi(ueRrc->GetImsi());
+        ueProse->AddGroupDiscovery(groupId, dstL2Id, model, role);
+    }
+}
+
+void
+NrSlProseHelper::StopGroupDiscovery(NetDeviceContainer ueDevices,
+                                    uint32_t groupId,
+                                    NrSlUeProse::DiscoveryRole role)
+{
+    NS_LOG_FUNCTION(this << groupId);
+
+    for (NetDeviceContainer::Iterator i = ueDevices.Begin(); i != ueDevices.End(); ++i)
+    {
+        if (!IsLocal(*i))
+        {
+            continue;
+        }
+        Ptr<NrSlUeProse> ueProse = (*i)->GetObject<NrUeNetDevice>()->GetObject<NrSlUeProse>();
+        ueProse->RemoveGroupDiscovery(groupId, role);
+    }
+}
+
+void
+NrSlProseHelper::SetU2nRelayFlowFilter(NetDeviceContainer remoteDevices,
+                                       uint32_t relayServiceCode,
+                                       Ptr<EpcTft> tft)
+{
+    NS_LOG_FUNCTION(this << relayServiceCode);
+
+    for (NetDeviceContainer::Iterator i = remoteDevices.Begin(); i != remoteDevices.End(); ++i)
+    {
+        if (!IsLocal(*i))
+        {
+            continue;
+        }
+        Ptr<NrSlUeProse> ueProse = (*i)->GetObject<NrUeNetDevice>()->GetObject<NrSlUeProse>();
+        NS_ABORT_MSG_IF(ueProse == nullptr, "ProSe is not installed in the UE");
+        ueProse->SetU2nRelayFlowFilter(relayServiceCode, tft);
+    }
+}
+
+void
+NrSlProseHelper::EnableRelayBackhaulAwareness(NetDeviceContainer relayDevices)
+{
+    NS_LOG_FUNCTION(this);
+
+    for (NetDeviceContainer::Iterator i = relayDevices.Begin(); i != relayDevices.End(); ++i)
+    {
+        if (!IsLocal(*i))
+        {
+            continue;
+        }
+        Ptr<NrUeNetDevice> nrUeDev = (*i)->GetObject<NrUeNetDevice>();
+        Ptr<NrSlUeProse> ueProse = nrUeDev->GetObject<NrSlUeProse>();
+        NS_ABORT_MSG_IF(ueProse == nullptr, "ProSe is not installed in the UE");
+        Ptr<LteUeRrc> ueRrc = nrUeDev->GetRrc();
+
+        ueProse->EnableRelayBackhaulAwareness(ueRrc->GetState() == LteUeRrc::CONNECTED_NORMALLY);
+        ConnectUuMonitoring(nrUeDev, ueProse);
+    }
+}
+
+void
+NrSlProseHelper::EnableRemotePathSwitching(NetDeviceContainer remoteDevices)
+{
+    NS_LOG_FUNCTION(this);
+
+    for (NetDeviceContainer::Iterator i = remoteDevices.Begin(); i != remoteDevices.End(); ++i)
+    {
+        if (!IsLocal(*i))
+        {
+            continue;
+        }
+        Ptr<NrUeNetDevice> nrUeDev = (*i)->GetObject<NrUeNetDevice>();
+        Ptr<NrSlUeProse> ueProse = nrUeDev->GetObject<NrSlUeProse>();
+        NS_ABORT_MSG_IF(ueProse == nullptr, "ProSe is not installed in the UE");
+        Ptr<LteUeRrc> ueRrc = nrUeDev->GetRrc();
+
+        ueProse->EnableRemotePathSwitching(ueRrc->GetState() == LteUeRrc::CONNECTED_NORMALLY);
+        ConnectUuMonitoring(nrUeDev, ueProse);
+    }
+}
+
+void
+NrSlProseHelper::EnableU2nRelayScheduling(NetDeviceContainer relayDevices, DataRate serviceRate)
+{
+    NS_LOG_FUNCTION(this << serviceRate);
+    NS_ABORT_MSG_IF(serviceRate.GetBitRate() == 0, "The service rate must be greater than zero");
+
+    for (NetDeviceContainer::Iterator i = relayDevices.Begin(); i != relayDevices.End(); ++i)
+    {
+        if (!IsLocal(*i))
+        {
+            continue;
+        }
+        Ptr<NrSlUeProse> ueProse = (*i)->GetObject<NrUeNetDevice>()->GetObject<NrSlUeProse>();
+        NS_ABORT_MSG_IF(ueProse == nullptr, "ProSe is not installed in the UE");
+        Ptr<Ipv4> ipv4 = (*i)->GetNode()->GetObject<Ipv4>();
+        NS_ABORT_MSG_IF(ipv4 == nullptr, "The internet stack is not installed in the relay UE");
+        Ptr<NrSlU2nRelayScheduler> scheduler = CreateObject<NrSlU2nRelayScheduler>();
+        scheduler->SetAttribute("ServiceRate", DataRateValue(serviceRate));
+        ueProse->SetU2nRelayScheduler(scheduler);
+        // Put the scheduler in the forwarding path of the relay UE
+        Ptr<NrSlU2nRelayRouting> routing = CreateObject<NrSlU2nRelayRouting>();
+        routing->Install(ipv4, scheduler);
+    }
+}
+
+void
+NrSlProseHelper::EnableDiscoveryOracle(NetDeviceContainer ueDevices,
+                                       Ptr<NrSlDiscoveryOracle> oracle)
+{
+    NS_LOG_FUNCTION(this << oracle);
+
+    for (NetDeviceContainer::Iterator i = ueDevices.Begin(); i != ueDevices.End(); ++i)
+    {
+        if (!IsLocal(*i))
+        {
+            continue;
+        }
+        Ptr<NrSlUeProse> ueProse = (*i)->GetObject<NrUeNetDevice>()->GetObject<NrSlUeProse>();
+        NS_ABORT_MSG_IF(ueProse == nullptr, "ProSe is not installed in the UE");
+        oracle->AddUe(ueProse, (*i)->GetNode());
+        ueProse->SetDiscoveryOracle(oracle);
+    }
+}
+
+void
+NrSlProseHelper::ConnectUuMonitoring(Ptr<NrUeNetDevice> nrUeDev, Ptr<NrSlUeProse> ueProse)
+{
+    NS_LOG_FUNCTION(this);
+
+    nrUeDev->GetRrc()->TraceConnectWithoutContext(
+        "StateTransition",
+        MakeCallback(&NrSlUeProse::UuRrcStateTransition, ueProse));
+    for (uint32_t bwp = 0; bwp < nrUeDev->GetCcMapSize(); ++bwp)
+    {
+        nrUeDev->GetPhy(bwp)->TraceConnectWithoutContext(
+            "ReportCurrentCellRsrpSinr",
+            MakeCallback(&NrSlUeProse::ReportUuServingCellRsrp, ueProse));
+    }
+}
+
+void
+NrSlProseHelper::DumpProseStats(NetDeviceContainer ueDevices, std::string filename)
+{
+    NS_LOG_FUNCTION(this << filename);
+
+    filename = GetPartitionFilename(filename);
+    std::ofstream outFile(filename.c_str(), std::ios_base::app);
+    if (!outFile.is_open())
+    {
+        NS_LOG_ERROR("Can't open file " << filename.c_str());
+        return;
+    }
+    if (outFile.tellp() == 0)
+    {
+        outFile << "Time (s)\tL2Id\tCounter\tValue" << std::endl;
+    }
+
+    double now = Simulator::Now().GetSeconds();
+    for (NetDeviceContainer::Iterator i = ueDevices.Begin(); i != ueDevices.End(); ++i)
+    {
+        if (!IsLocal(*i))
+        {
+            continue;
+        }
+        Ptr<NrSlUeProse> ueProse = (*i)->GetObject<NrUeNetDevice>()->GetObject<NrSlUeProse>();
+        NS_ABORT_MSG_IF(ueProse == nullptr, "ProSe is not installed in the UE");
+        std::ostringstream prefix;
+        prefix << now << "\t" << ueProse->GetL2Id() << "\t";
+        ueProse->GetProseStats()->Print(outFile, prefix.str());
+    }
+}
+
+int64_t
+NrSlProseHelper::AssignStreams(NetDeviceContainer ueDevices, int64_t stream)
+{
+    NS_LOG_FUNCTION(this << stream);
+
+    int64_t currentStream = stream;
+    // The same relay selection algorithm instance is usually shared by the
+    // UEs, it gets its streams only once
+    std::set<Ptr<NrSlUeProseRelaySelectionAlgorithm>> assigned;
+    for (NetDeviceContainer::Iterator i = ueDevices.Begin(); i != ueDevices.End(); ++i)
+    {
+        if (!IsLocal(*i))
+        {
+            continue;
+        }
+        Ptr<NrSlUeProse> ueProse = (*i)->GetObject<NrUeNetDevice>()->GetObject<NrSlUeProse>();
+        NS_ABORT_MSG_IF(ueProse == nullptr, "ProSe is not installed in the UE");
+        Ptr<NrSlUeProseRelaySelectionAlgorithm> algorithm = ueProse->GetRelaySelectionAlgorithm();
+        if (algorithm && assigned.insert(algorithm).second)
+        {
+            currentStream += algorithm->AssignStreams(currentStream);
+        }
+    }
+    return currentStream - stream;
+}
+
 void
 NrSlProseHelper::EnableDiscoveryTraces(void)
 {
@@ -416,19 +817,25 @@ NrSlProseHelper::StartRemoteRelayConnection(
                             NrSlUeProse::RelayUE);
     }
 
+    // The remote UEs are interested in the distinct relay codes, which are
+    // configured with a single event per remote UE
+    std::map<uint32_t, uint32_t> remoteCodes;
+    for (uint32_t k = 0; k < relayDevices.GetN(); ++k)
+    {
+        auto it = remoteCodes.emplace(relayCodes[k], dstL2Ids[k]).first;
+        NS_ABORT_MSG_IF(it->second != dstL2Ids[k],
+                        "Relay code " << relayCodes[k]
+                                      << " is used with different destination layer 2 IDs");
+    }
     for (uint32_t j = 0; j < remoteDevices.GetN(); ++j)
     {
-        for (uint32_t k = 0; k < relayDevices.GetN(); ++k)
-        {
-            Simulator::Schedule(remoteTime[j],
-                                &NrSlProseHelper::StartRelayDiscovery,
-                                this,
-                                remoteDevices.Get(j),
-                                relayCodes[k],
-                                dstL2Ids[k],
-                                discoveryModel,
-                                NrSlUeProse::RemoteUE);
-        }
+        Simulator::Schedule(remoteTime[j],
+                            &NrSlProseHelper::StartRelayDiscoveryCodes,
+                            this,
+                            remoteDevices.Get(j),
+                            remoteCodes,
+                            discoveryModel,
+                            NrSlUeProse::RemoteUE);
     }
 
     // Apply the configuration on the devices acting as relay UEs
@@ -441,6 +848,10 @@ NrSlProseHelper::StartRemoteRelayConnection(
     // Define relay selection algorithm and enable RSRP measurements for remote UEs
     for (uint32_t i = 0; i < remoteDevices.GetN(); ++i)
     {
+        if (!IsLocal(remoteDevices.Get(i)))
+        {
+            continue;
+        }
         Ptr<NrSlUeProse> remoteProse =
             remoteDevices.Get(i)->GetObject<NrUeNetDevice>()->GetObject<NrSlUeProse>();
         remoteProse->SetRelaySelectionAlgorithm(selectionAlgorithm);
@@ -478,6 +889,10 @@ NrSlProseHelper::InstallNrSlDiscoveryConfiguration(NetDeviceContainer relays,
     for (auto i = relays.Begin(); i != relays.End(); ++i)
     {
         Ptr<NetDevice> netRelayDev = *i;
+        if (!IsLocal(netRelayDev))
+        {
+            continue;
+        }
         Ptr<NrUeNetDevice> nrRelayDev = netRelayDev->GetObject<NrUeNetDevice>();
         Ptr<LteUeRrc> lteRelayRrc = nrRelayDev->GetRrc();
         Ptr<NrSlUeRrc> nrSlRelayRrc = lteRelayRrc->GetObject<NrSlUeRrc>();
@@ -487,6 +902,10 @@ NrSlProseHelper::InstallNrSlDiscoveryConfiguration(NetDeviceContainer relays,
     for (auto j = remotes.Begin(); j != remotes.End(); ++j)
     {
         Ptr<NetDevice> netRemoteDev = *j;
+        if (!IsLocal(netRemoteDev))
+        {
+            continue;
+        }
         Ptr<NrUeNetDevice> nrRemoteDev = netRemoteDev->GetObject<NrUeNetDevice>();
         Ptr<LteUeRrc> lteRemoteRrc = nrRemoteDev->GetRrc();
         Ptr<NrSlUeRrc> nrSlRemoteRrc = lteRemoteRrc->GetObject<NrSlUeRrc>();
@@ -39,6 +39,7 @@
 #include "nr-sl-discovery-trace.h"
 #include "nr-sl-relay-trace.h"
 
+#include <ns3/data-rate.h>
 #include <ns3/lte-rrc-sap.h>
 #include <ns3/net-device-container.h>
 #include <ns3/nr-sl-helper.h>
@@ -52,6 +53,7 @@ namespace ns3
 class EpcTft;
 class EpsBearer;
 class NrPointToPointEpcHelper;
+class NrSlDiscoveryOracle;
 class NrUeNetDevice;
 
 class NrSlProseHelper : public Object
@@ -59,6 +61,18 @@ class NrSlProseHelper : public Object
     /**
      * \brief Class to help in the configuration of the Proximity Service (ProSe)
      *        functionalities
+     *
+     * The support of the distributed (MPI) simulator is partial. The helper
+     * only configures the devices of the nodes belonging to the partition of
+     * this process, and aborts when the two UEs of a direct link, or a relay
+     * UE and the PGW, are in different partitions, as the sidelink and the
+     * EPC cannot be split across partitions. All the UEs, the relay UEs and
+     * the EPC must therefore be in the same partition (rank 0, as the EPC
+     * helper creates its nodes on system 0), and the only supported cut is
+     * the link between the PGW and the Remote Host. The layer 2 IDs and the
+     * IMSIs of the UEs are assigned by the nr module from per-process
+     * counters, which is consistent only because all the UEs are in one
+     * partition. The trace files are written per partition.
      */
   public:
     /**
@@ -81,6 +95,26 @@ class NrSlProseHelper : public Object
      * \param epcHelper Ptr of type NrPointToPointEpcHelper
      */
     void SetEpcHelper(const Ptr<NrPointToPointEpcHelper>& epcHelper);
+    /**
+     * \brief Whether the simulation runs with a distributed (MPI) simulator
+     *
+     * \return true if the simulator implementation is ns3::DistributedSimulatorImpl
+     *         or ns3::NullMessageSimulatorImpl
+     */
+    static bool IsDistributed();
+    /**
+     * \brief Get the name of the output file of the partition of this process
+     *
+     * In a distributed simulation, "-rank<N>", N being the system ID of this
+     * process, is inserted before the extension of the file name, so that each
+     * process writes its own file. The files of all the processes can be
+     * merged afterwards with utils/merge-rank-traces.py. Otherwise, the file
+     * name is returned unchanged.
+     *
+     * \param filename the name of the output file
+     * \return the name of the output file of this process
+     */
+    static std::string GetPartitionFilename(const std::string& filename);
     /**
      * \brief Prepare UE for ProSe
      *
@@ -126,6 +160,24 @@ class NrSlProseHelper : public Object
                                  Ipv4Address trgtUeIp,
                                  struct SidelinkInfo& trgtSlInfo);
 
+    /**
+     * \brief Establish 5G ProSe direct links automatically upon discovery
+     *
+     * Each UE initiates a direct link with the peers it discovers for the given
+     * application code, i.e., when it monitors (Model A) or discovers (Model B)
+     * it. The UEs must be prepared for unicast, and the devices of the UEs that
+     * can be discovered must be passed too, so they can answer the establishment
+     * requests.
+     *
+     * \param ueDevices the devices of the UEs
+     * \param appCode the application code triggering the establishment
+     * \param slInfo the traffic profile parameters to be used for the sidelink data radio
+     * bearer of the links
+     */
+    void EnableAutoDirectLink(NetDeviceContainer ueDevices,
+                              uint32_t appCode,
+                              const struct SidelinkInfo& slInfo);
+
     /**
      * \brief Establish a 5G ProSe L3 UE-to-Network (U2N) relay connection between
      *        two UEs (a remote UE and a relay UE)
@@ -162,7 +214,9 @@ class NrSlProseHelper : public Object
      *  each relay UE device, and internally sets the pointer to the EpcHelper in
      *  the ProSe layer. The EpcHelper will be used by the ProSe layer to configure
      *  the data path in the EpcPgwApplication when a remote UE successfully connects
-     *  to the relay UE
+     *  to the relay UE. One bearer is activated per relay service code, unless
+     *  the ShareRelayBearer attribute is set, in which case all the relay
+     *  service codes use the same bearer
      *
      * \param ueDevices the devices in which the L3 U2N relay configuration will be installed
      * \param relayServiceCodes the relay service codes to which the configuration will be
@@ -174,6 +228,24 @@ class NrSlProseHelper : public Object
                                      EpsBearer bearer,
                                      Ptr<EpcTft> tft);
 
+    /**
+     * \brief Install configuration on the UEs that will act as L3 UE-to-Network (U2N)
+     *        relay UEs, with a given mapping of relay service codes to bearers
+     *
+     *  Each of the given bearers is activated once on each relay UE device,
+     *  and the relay service codes mapped to it share it for relaying traffic
+     *
+     * \param ueDevices the devices in which the L3 U2N relay configuration will be installed
+     * \param relayServiceCodeBearers the index in bearers and tfts of the bearer used by each
+     *        relay service code
+     * \param bearers the EPS bearers to be used for relaying traffic
+     * \param tfts the traffic flow template of each bearer
+     */
+    void ConfigureL3UeToNetworkRelay(const NetDeviceContainer ueDevices,
+                                     const std::map<uint32_t, uint32_t> relayServiceCodeBearers,
+                                     const std::vector<EpsBearer> bearers,
+                                     const std::vector<Ptr<EpcTft>> tfts);
+
     /**
      * Starts discovery process for given applications depending on the interest (monitoring or
      * announcing) \param ueDevice the targeted device \param appCode application code to be added
@@ -230,6 +302,19 @@ class NrSlProseHelper : public Object
                              NrSlUeProse::DiscoveryModel model,
                              NrSlUeProse::DiscoveryRole role);
 
+    /**
+     * Starts relay discovery process for several relay codes at once, configuring
+     * the UE only once. Codes already started in the UE are ignored.
+     * \param ueDevice the targeted device
+     * \param relayCodes the destination layer 2 ID of each relay code
+     * \param model UE model (A or B)
+     * \param role UE role (relay or remote)
+     */
+    void StartRelayDiscoveryCodes(Ptr<NetDevice> ueDevice,
+                                  std::map<uint32_t, uint32_t> relayCodes,
+                                  NrSlUeProse::DiscoveryModel model,
+                                  NrSlUeProse::DiscoveryRole role);
+
     /**
      * Stops relay discovery process for given code
      * \param ueDevice the targeted device
@@ -240,6 +325,122 @@ class NrSlProseHelper : public Object
                             uint32_t relayCode,
                             NrSlUeProse::DiscoveryRole role);
 
+    /**
+     * Starts group member discovery for all the given devices, which become
+     * members of the group
+     * \param ueDevices the devices of the group members
+     * \param groupId the discovery group ID
+     * \param dstL2Id destination layer 2 ID used by the group
+     * \param model UE model (A or B)
+     * \param role UE role in the group discovery
+     */
+    void StartGroupDiscovery(NetDeviceContainer ueDevices,
+                             uint32_t groupId,
+                             uint32_t dstL2Id,
+                             NrSlUeProse::DiscoveryModel model,
+                             NrSlUeProse::DiscoveryRole role);
+
+    /**
+     * Stops group member discovery for all the given devices
+     * \param ueDevices the devices of the group members
+     * \param groupId the discovery group ID
+     * \param role UE role in the group discovery
+     */
+    void StopGroupDiscovery(NetDeviceContainer ueDevices,
+                            uint32_t groupId,
+                            NrSlUeProse::DiscoveryRole role);
+
+    /**
+     * \brief Set the flows that the given remote UEs redirect through their relay UE
+     *
+     * See NrSlUeProse::SetU2nRelayFlowFilter
+     *
+     * \param remoteDevices the remote UEs
+     * \param relayServiceCode the relay service code
+     * \param tft the TFT identifying the flows to redirect
+     */
+    void SetU2nRelayFlowFilter(NetDeviceContainer remoteDevices,
+                               uint32_t relayServiceCode,
+                               Ptr<EpcTft> tft);
+
+    /**
+     * \brief Make the relay discovery of the given UEs reflect their Uu connectivity
+     *
+     * The RRC state transitions and serving cell RSRP reports of each UE are
+     * connected to its ProSe layer, which then sets the status indicator of
+     * its relay announcements and responses accordingly. See
+     * NrSlUeProse::EnableRelayBackhaulAwareness.
+     *
+     * \param relayDevices the relay UEs
+     */
+    void EnableRelayBackhaulAwareness(NetDeviceContainer relayDevices);
+
+    /**
+     * \brief Make the given remote UEs switch between their relay UE and the Uu
+     *
+     * The RRC state transitions and serving cell RSRP reports of each UE are
+     * connected to its ProSe layer, which then releases its U2N relay
+     * connection when the Uu coverage is good and connects again to a relay
+     * UE when it is lost. See NrSlUeProse::EnableRemotePathSwitching.
+     *
+     * \param remoteDevices the remote UEs
+     */
+    void EnableRemotePathSwitching(NetDeviceContainer remoteDevices);
+
+    /**
+     * \brief Schedule the packets relayed by the given relay UEs per remote UE
+     *
+     * A NrSlU2nRelayScheduler, configured with its attribute defaults and
+     * the given service rate, is created for each relay UE, and inserted in
+     * its IPv4 forwarding path by a NrSlU2nRelayRouting. The internet stack
+     * of the relay UEs must be installed first. See
+     * NrSlUeProse::SetU2nRelayScheduler.
+     *
+     * \param relayDevices the relay UEs
+     * \param serviceRate the uplink rate expected for the relay bearer
+     */
+    void EnableU2nRelayScheduling(NetDeviceContainer relayDevices, DataRate serviceRate);
+
+    /**
+     * \brief Deliver the discovery messages of the given UEs with a discovery oracle
+     *
+     * Each UE is registered with the oracle, and its discovery messages no
+     * longer go through the NR sidelink stack. The UEs only discover the
+     * other UEs registered with the same oracle. See NrSlDiscoveryOracle and
+     * NrSlUeProse::SetDiscoveryOracle.
+     *
+     * \param ueDevices the UEs
+     * \param oracle the discovery oracle
+     */
+    void EnableDiscoveryOracle(NetDeviceContainer ueDevices, Ptr<NrSlDiscoveryOracle> oracle);
+
+    /**
+     * \brief Write the ProSe counters of the given UEs to a file
+     *
+     * The counters of all the UEs are appended in one pass, one per line,
+     * prefixed by the current time and the L2 ID of the UE. This method can
+     * be scheduled several times to obtain snapshots along the simulation.
+     *
+     * \param ueDevices the UEs whose counters are written
+     * \param filename the name of the output file
+     */
+    void DumpProseStats(NetDeviceContainer ueDevices, std::string filename);
+
+    /**
+     * \brief Assign a fixed random variable stream number to the random
+     *        variables used by the ProSe layer of the given UEs
+     *
+     * The streams are assigned in the order of the devices to the relay
+     * selection algorithm of each UE, once per algorithm instance, as the
+     * same instance may be shared by several UEs. This method should be
+     * called once the relay selection algorithms are configured.
+     *
+     * \param ueDevices the UEs using ProSe
+     * \param stream first stream index to use
+     * \return the number of stream indices assigned
+     */
+    int64_t AssignStreams(NetDeviceContainer ueDevices, int64_t stream);
+
     /**
      * Enable trace sinks for ProSe discovery
      */
@@ -294,6 +495,13 @@ class NrSlProseHelper : public Object
     virtual void DoDispose(void) override;
 
   private:
+    /**
+     * \brief Whether a device belongs to the partition of this process
+     *
+     * \param device the device
+     * \return true if the node of the device has the system ID of this process
+     */
+    static bool IsLocal(Ptr<NetDevice> device);
     /**
      * \brief Prepare Single UE for ProSe
      *
@@ -308,12 +516,22 @@ class NrSlProseHelper : public Object
      * \param nrUeDev The Ptr to NR UE NetDevice
      */
     void PrepareSingleUeForUnicast(Ptr<NrUeNetDevice> nrUeDev);
+    /**
+     * \brief Connect the RRC state transitions and serving cell RSRP reports of
+     *        the UE to its ProSe layer
+     *
+     * \param nrUeDev The Ptr to NR UE NetDevice
+     * \param ueProse The ProSe layer of the UE
+     */
+    void ConnectUuMonitoring(Ptr<NrUeNetDevice> nrUeDev, Ptr<NrSlUeProse> ueProse);
 
     Ptr<NrPointToPointEpcHelper> m_epcHelper; //!< pointer to the EPC helper
 
     Ptr<NrSlDiscoveryTrace> m_discoveryTrace; //!< Container of discovery traces.
 
     Ptr<NrSlRelayTrace> m_relayTrace; //!< Container of relay traces
+
+    bool m_shareRelayBearer; //!< Whether all the relay service codes share one relay bearer
 };
 
 } // namespace ns3
@@ -35,6 +35,8 @@
 
 #include "nr-sl-relay-trace.h"
 
+#include "nr-sl-prose-helper.h"
+
 #include "ns3/string.h"
 #include <ns3/log.h>
 #include <ns3/simulator.h>
@@ -104,16 +106,17 @@ NrSlRelayTrace::RelayDiscoveryTrace(uint32_t remoteL2Id,
                                     uint32_t relayCode,
                                     double rsrp)
 {
-    NS_LOG_INFO("Writing Relay Discovery Stats in " << m_nrSlRelayDiscoveryFilename);
+    std::string filename = NrSlProseHelper::GetPartitionFilename(m_nrSlRelayDiscoveryFilename);
+    NS_LOG_INFO("Writing Relay Discovery Stats in " << filename);
 
     std::ofstream outFile;
     outFile.precision(10);
     if (m_relayDiscoveryFirstWrite == true)
     {
-        outFile.open(m_nrSlRelayDiscoveryFilename);
+        outFile.open(filename);
         if (!outFile.is_open())
         {
-            NS_LOG_ERROR("Can't open file " << m_nrSlRelayDiscoveryFilename);
+            NS_LOG_ERROR("Can't open file " << filename);
             return;
         }
         m_relayDiscoveryFirstWrite = false;
@@ -121,10 +124,10 @@ NrSlRelayTrace::RelayDiscoveryTrace(uint32_t remoteL2Id,
     }
     else
     {
-        outFile.open(m_nrSlRelayDiscoveryFilename, std::ios_base::app);
+        outFile.open(filename, std::ios_base::app);
         if (!outFile.is_open())
         {
-            NS_LOG_ERROR("Can't open file " << m_nrSlRelayDiscoveryFilename);
+            NS_LOG_ERROR("Can't open file " << filename);
             return;
         }
     }
@@ -157,16 +160,17 @@ NrSlRelayTrace::RelaySelectionTrace(uint32_t remoteL2Id,
                                     uint32_t relayCode,
                                     double rsrpValue)
 {
-    NS_LOG_INFO("Writing Relay Selection Stats in " << m_nrSlRelaySelectionFilename);
+    std::string filename = NrSlProseHelper::GetPartitionFilename(m_nrSlRelaySelectionFilename);
+    NS_LOG_INFO("Writing Relay Selection Stats in " << filename);
 
     std::ofstream outFile;
     outFile.precision(10);
     if (m_relaySelectionFirstWrite == true)
     {
-        outFile.open(m_nrSlRelaySelectionFilename);
+        outFile.open(filename);
         if (!outFile.is_open())
         {
-            NS_LOG_ERROR("Can't open file " << m_nrSlRelaySelectionFilename);
+            NS_LOG_ERROR("Can't open file " << filename);
             return;
         }
         m_relaySelectionFirstWrite = false;
@@ -175,10 +179,10 @@ NrSlRelayTrace::RelaySelectionTrace(uint32_t remoteL2Id,
     }
     else
     {
-        outFile.open(m_nrSlRelaySelectionFilename, std::ios_base::app);
+        outFile.open(filename, std::ios_base::app);
         if (!outFile.is_open())
         {
-            NS_LOG_ERROR("Can't open file " << m_nrSlRelaySelectionFilename);
+            NS_LOG_ERROR("Can't open file " << filename);
             return;
         }
     }
@@ -202,16 +206,17 @@ NrSlRelayTrace::RelayRsrpTraceCallback(Ptr<NrSlRelayTrace> relayTrace,
 void
 NrSlRelayTrace::RelayRsrpTrace(uint32_t remoteL2Id, uint32_t relayL2Id, double rsrpValue)
 {
-    NS_LOG_INFO("Writing Relay Selection Stats in " << m_nrSlRelayRsrpFilename);
+    std::string filename = NrSlProseHelper::GetPartitionFilename(m_nrSlRelayRsrpFilename);
+    NS_LOG_INFO("Writing Relay Selection Stats in " << filename);
 
     std::ofstream outFile;
     outFile.precision(10);
     if (m_relayRsrpFirstWrite == true)
     {
-        outFile.open(m_nrSlRelayRsrpFilename);
+        outFile.open(filename);
         if (!outFile.is_open())
         {
-            NS_LOG_ERROR("Can't open file " << m_nrSlRelayRsrpFilename);
+            NS_LOG_ERROR("Can't open file " << filename);
             return;
         }
         m_relayRsrpFirstWrite = false;
@@ -219,10 +224,10 @@ NrSlRelayTrace::RelayRsrpTrace(uint32_t remoteL2Id, uint32_t relayL2Id, double r
     }
     else
     {
-        outFile.open(m_nrSlRelayRsrpFilename, std::ios_base::app);
+        outFile.open(filename, std::ios_base::app);
         if (!outFile.is_open())
         {
-            NS_LOG_ERROR("Can't open file " << m_nrSlRelayRsrpFilename);
+            NS_LOG_ERROR("Can't open file " << filename);
             return;
         }
     }
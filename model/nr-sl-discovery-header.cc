@@ -54,6 +54,7 @@ NrSlDiscoveryHeader::NrSlDiscoveryHeader()
       m_statusIndicator(0),
       m_group(0),
       m_groupInfo(0),
+      m_targetUeId(0),
       m_mic(0),
       m_utcBasedCounter(0)
 {
@@ -146,6 +147,100 @@ NrSlDiscoveryHeader::SetRelayResponseParameters(uint32_t serviceCode,
     m_statusIndicator = status;
 }
 
+void
+NrSlDiscoveryHeader::SetGroupAnnouncementParameters(uint32_t group,
+                                                    uint64_t announcerInfo,
+                                                    uint32_t groupInfo)
+{
+    // DISC_GROUP_ANNOUNCEMENT;
+    m_discoveryType = 2;
+    m_discoveryContentType = 6;
+    m_discoveryModel = 1;
+    m_discoveryMsgType = BuildDiscoveryMsgType();
+    m_group = group;
+    m_info = announcerInfo;
+    m_groupInfo = groupInfo;
+}
+
+void
+NrSlDiscoveryHeader::SetGroupSolicitationParameters(uint32_t group,
+                                                    uint64_t discovererInfo,
+                                                    uint32_t groupInfo)
+{
+    // DISC_GROUP_SOLICITATION;
+    m_discoveryType = 2;
+    m_discoveryContentType = 7;
+    m_discoveryModel = 2;
+    m_discoveryMsgType = BuildDiscoveryMsgType();
+    m_group = group;
+    m_info = discovererInfo;
+    m_groupInfo = groupInfo;
+}
+
+void
+NrSlDiscoveryHeader::SetGroupResponseParameters(uint32_t group,
+                                                uint64_t discovereeInfo,
+                                                uint32_t groupInfo)
+{
+    // DISC_GROUP_RESPONSE;
+    m_discoveryType = 2;
+    m_discoveryContentType = 6;
+    m_discoveryModel = 2;
+    m_discoveryMsgType = BuildDiscoveryMsgType();
+    m_group = group;
+    m_info = discovereeInfo;
+    m_groupInfo = groupInfo;
+}
+
+void
+NrSlDiscoveryHeader::SetU2uRelayAnnouncementParameters(uint32_t serviceCode,
+                                                       uint64_t announcerInfo,
+                                                       uint32_t relayUeId,
+                                                       uint32_t targetUeId)
+{
+    // DISC_U2U_RELAY_ANNOUNCEMENT;
+    m_discoveryType = 2;
+    m_discoveryContentType = 8;
+    m_discoveryModel = 1;
+    m_discoveryMsgType = BuildDiscoveryMsgType();
+    m_relayServiceCode = serviceCode;
+    m_info = announcerInfo;
+    m_relayUeId = relayUeId;
+    m_targetUeId = targetUeId;
+}
+
+void
+NrSlDiscoveryHeader::SetU2uRelaySolicitationParameters(uint32_t serviceCode,
+                                                       uint64_t discovererInfo,
+                                                       uint32_t targetUeId)
+{
+    // DISC_U2U_RELAY_SOLICITATION;
+    m_discoveryType = 2;
+    m_discoveryContentType = 9;
+    m_discoveryModel = 2;
+    m_discoveryMsgType = BuildDiscoveryMsgType();
+    m_relayServiceCode = serviceCode;
+    m_info = discovererInfo;
+    m_targetUeId = targetUeId;
+}
+
+void
+NrSlDiscoveryHeader::SetU2uRelayResponseParameters(uint32_t serviceCode,
+                                                   uint64_t discovereeInfo,
+                                                   uint32_t relayUeId,
+                                                   uint32_t targetUeId)
+{
+    // DISC_U2U_RELAY_RESPONSE;
+    m_discoveryType = 2;
+    m_discoveryContentType = 8;
+    m_discoveryModel = 2;
+    m_discoveryMsgType = BuildDiscoveryMsgType();
+    m_relayServiceCode = serviceCode;
+    m_info = discovereeInfo;
+    m_relayUeId = relayUeId;
+    m_targetUeId = targetUeId;
+}
+
 uint8_t
 NrSlDiscoveryHeader::BuildDiscoveryMsgType()
 {
@@ -154,7 +249,12 @@ NrSlDiscoveryHeader::BuildDiscoveryMsgType()
 
     NS_ABORT_MSG_IF(msgType != DISC_OPEN_ANNOUNCEMENT && msgType != DISC_RESTRICTED_QUERY &&
                         msgType != DISC_RESTRICTED_RESPONSE && msgType != DISC_RELAY_ANNOUNCEMENT &&
-                        msgType != DISC_RELAY_SOLICITATION && msgType != DISC_RELAY_RESPONSE,
+                        msgType != DISC_RELAY_SOLICITATION && msgType != DISC_RELAY_RESPONSE &&
+                        msgType != DISC_GROUP_ANNOUNCEMENT && msgType != DISC_GROUP_RESPONSE &&
+                        msgType != DISC_GROUP_SOLICITATION &&
+                        msgType != DISC_U2U_RELAY_ANNOUNCEMENT &&
+                        msgType != DISC_U2U_RELAY_RESPONSE &&
+                        msgType != DISC_U2U_RELAY_SOLICITATION,
                     "unknown discovery message type " << (uint16_t)msgType);
     return msgType;
 }
@@ -223,6 +323,12 @@ NrSlDiscoveryHeader::GetGroupInfo() const
     return m_groupInfo;
 }
 
+uint32_t
+NrSlDiscoveryHeader::GetTargetUeId() const
+{
+    return m_targetUeId;
+}
+
 uint32_t
 NrSlDiscoveryHeader::GetMic() const
 {
@@ -331,7 +437,30 @@ NrSlDiscoveryHeader::Serialize(Buffer::Iterator start) const
             i.WriteU8((m_relayUeId >> 16) & 0xFF);
             i.WriteU8(padding, 10);
         }
-
+        break;
+    case DISC_GROUP_ANNOUNCEMENT:
+    case DISC_GROUP_SOLICITATION:
+    case DISC_GROUP_RESPONSE:
+        i.WriteU16(m_group & 0xFFFF);
+        i.WriteU8((m_group >> 16) & 0xFF);
+        i.WriteU32(m_info & 0xFFFFFFFF);
+        i.WriteU16((m_info >> 32) & 0xFFFF);
+        i.WriteU32(m_groupInfo);
+        i.WriteU8(padding, 10);
+        break;
+    case DISC_U2U_RELAY_ANNOUNCEMENT:
+    case DISC_U2U_RELAY_RESPONSE:
+    case DISC_U2U_RELAY_SOLICITATION:
+        i.WriteU16(m_relayServiceCode & 0xFFFF);
+        i.WriteU8((m_relayServiceCode >> 16) & 0xFF);
+        i.WriteU32(m_info & 0xFFFFFFFF);
+        i.WriteU16((m_info >> 32) & 0xFFFF);
+        i.WriteU16(m_relayUeId & 0xFFFF);
+        i.WriteU8((m_relayUeId >> 16) & 0xFF);
+        i.WriteU16(m_targetUeId & 0xFFFF);
+        i.WriteU8((m_targetUeId >> 16) & 0xFF);
+        i.WriteU8(padding, 8);
+        break;
     default:
         break;
     }
@@ -390,7 +519,32 @@ NrSlDiscoveryHeader::Deserialize(Buffer::Iterator start)
             m_relayUeId += i.ReadU8() << 16;
             i.Read(padding, 10);
         }
-
+        break;
+    case DISC_GROUP_ANNOUNCEMENT:
+    case DISC_GROUP_SOLICITATION:
+    case DISC_GROUP_RESPONSE:
+        m_group = i.ReadU16();
+        m_group += i.ReadU8() << 16;
+        m_info = i.ReadU32();
+        tmp = i.ReadU16();
+        m_info += tmp << 32;
+        m_groupInfo = i.ReadU32();
+        i.Read(padding, 10);
+        break;
+    case DISC_U2U_RELAY_ANNOUNCEMENT:
+    case DISC_U2U_RELAY_RESPONSE:
+    case DISC_U2U_RELAY_SOLICITATION:
+        m_relayServiceCode = i.ReadU16();
+        m_relayServiceCode += i.ReadU8() << 16;
+        m_info = i.ReadU32();
+        tmp = i.ReadU16();
+        m_info += tmp << 32;
+        m_relayUeId = i.ReadU16();
+        m_relayUeId += i.ReadU8() << 16;
+        m_targetUeId = i.ReadU16();
+        m_targetUeId += i.ReadU8() << 16;
+        i.Read(padding, 8);
+        break;
     default:
         break;
     }
@@ -401,4 +555,76 @@ NrSlDiscoveryHeader::Deserialize(Buffer::Iterator start)
     return GetSerializedSize();
 }
 
+NrSlDiscoveryAggregationHeader::NrSlDiscoveryAggregationHeader()
+    : m_marker(DISC_AGGREGATION_MARKER),
+      m_nMessages(0)
+{
+}
+
+NrSlDiscoveryAggregationHeader::~NrSlDiscoveryAggregationHeader()
+{
+}
+
+void
+NrSlDiscoveryAggregationHeader::SetNMessages(uint8_t nMessages)
+{
+    m_nMessages = nMessages;
+}
+
+uint8_t
+NrSlDiscoveryAggregationHeader::GetNMessages() const
+{
+    return m_nMessages;
+}
+
+bool
+NrSlDiscoveryAggregationHeader::IsAggregated() const
+{
+    return m_marker == DISC_AGGREGATION_MARKER;
+}
+
+TypeId
+NrSlDiscoveryAggregationHeader::GetTypeId(void)
+{
+    static TypeId tid = TypeId("ns3::NrSlDiscoveryAggregationHeader")
+                            .SetParent<Header>()
+                            .AddConstructor<NrSlDiscoveryAggregationHeader>();
+    return tid;
+}
+
+TypeId
+NrSlDiscoveryAggregationHeader::GetInstanceTypeId(void) const
+{
+    return GetTypeId();
+}
+
+void
+NrSlDiscoveryAggregationHeader::Print(std::ostream& os) const
+{
+    os << "nMessages=" << +m_nMessages;
+}
+
+uint32_t
+NrSlDiscoveryAggregationHeader::GetSerializedSize(void) const
+{
+    return 2;
+}
+
+void
+NrSlDiscoveryAggregationHeader::Serialize(Buffer::Iterator start) const
+{
+    Buffer::Iterator i = start;
+    i.WriteU8(DISC_AGGREGATION_MARKER);
+    i.WriteU8(m_nMessages);
+}
+
+uint32_t
+NrSlDiscoveryAggregationHeader::Deserialize(Buffer::Iterator start)
+{
+    Buffer::Iterator i = start;
+    m_marker = i.ReadU8();
+    m_nMessages = i.ReadU8();
+    return GetSerializedSize();
+}
+
 } // namespace ns3
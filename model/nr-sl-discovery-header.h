@@ -56,12 +56,18 @@ class NrSlDiscoveryHeader : public Header
      */
     enum DiscoveryMsgType : uint8_t
     {
-        DISC_OPEN_ANNOUNCEMENT = 65,    /* Open discovery announce model A */
-        DISC_RESTRICTED_RESPONSE = 130, /* Restricted discovery response model B */
-        DISC_RESTRICTED_QUERY = 134,    /* Restricted discovery request model B */
-        DISC_RELAY_ANNOUNCEMENT = 145,  /* Relay Discovery Announcement in model A */
-        DISC_RELAY_SOLICITATION = 150,  /* Relay Discovery Announcement in model B */
-        DISC_RELAY_RESPONSE = 146,      /* UE-to-Network Relay Discovery Response in model B */
+        DISC_OPEN_ANNOUNCEMENT = 65,       /* Open discovery announce model A */
+        DISC_RESTRICTED_RESPONSE = 130,    /* Restricted discovery response model B */
+        DISC_RESTRICTED_QUERY = 134,       /* Restricted discovery request model B */
+        DISC_RELAY_ANNOUNCEMENT = 145,     /* Relay Discovery Announcement in model A */
+        DISC_RELAY_SOLICITATION = 150,     /* Relay Discovery Announcement in model B */
+        DISC_RELAY_RESPONSE = 146,         /* UE-to-Network Relay Discovery Response in model B */
+        DISC_GROUP_ANNOUNCEMENT = 153,     /* Group Member Discovery Announcement in model A */
+        DISC_GROUP_RESPONSE = 154,         /* Group Member Discovery Response in model B */
+        DISC_GROUP_SOLICITATION = 158,     /* Group Member Discovery Solicitation in model B */
+        DISC_U2U_RELAY_ANNOUNCEMENT = 161, /* UE-to-UE Relay Discovery Announcement in model A */
+        DISC_U2U_RELAY_RESPONSE = 162,     /* UE-to-UE Relay Discovery Response in model B */
+        DISC_U2U_RELAY_SOLICITATION = 166, /* UE-to-UE Relay Discovery Solicitation in model B */
     };
 
     /**
@@ -191,6 +197,13 @@ class NrSlDiscoveryHeader : public Header
      */
     uint32_t GetGroupInfo() const;
 
+    /**
+     * \brief Get the target UE ID of a UE-to-UE relay discovery message
+     *
+     * \return the layer 2 ID of the end UE reachable through the relay, or 0 if none
+     */
+    uint32_t GetTargetUeId() const;
+
     /**
      * \brief Set the parameters for open discovery announcement
      *
@@ -249,6 +262,72 @@ class NrSlDiscoveryHeader : public Header
                                     uint32_t relayUeId,
                                     uint32_t status);
 
+    /**
+     * \brief Set the parameters for the group member discovery announcement
+     *
+     * \param group the discovery group ID
+     * \param announcerInfo the announcer information
+     * \param groupInfo the group information (e.g., the layer 2 ID of the member)
+     */
+    void SetGroupAnnouncementParameters(uint32_t group, uint64_t announcerInfo, uint32_t groupInfo);
+
+    /**
+     * \brief Set the parameters for the group member discovery solicitation
+     *
+     * \param group the discovery group ID
+     * \param discovererInfo the discoverer information
+     * \param groupInfo the group information (e.g., the layer 2 ID of the member)
+     */
+    void SetGroupSolicitationParameters(uint32_t group,
+                                        uint64_t discovererInfo,
+                                        uint32_t groupInfo);
+
+    /**
+     * \brief Set the parameters for the group member discovery response
+     *
+     * \param group the discovery group ID
+     * \param discovereeInfo the discoveree information
+     * \param groupInfo the group information (e.g., the layer 2 ID of the member)
+     */
+    void SetGroupResponseParameters(uint32_t group, uint64_t discovereeInfo, uint32_t groupInfo);
+
+    /**
+     * \brief Set the parameters for the UE-to-UE relay announcement
+     *
+     * \param serviceCode the relay service code
+     * \param announcerInfo the announcer information
+     * \param relayUeId the layer 2 ID of the relay node
+     * \param targetUeId the layer 2 ID of an end UE reachable through the relay, 0 if none
+     */
+    void SetU2uRelayAnnouncementParameters(uint32_t serviceCode,
+                                           uint64_t announcerInfo,
+                                           uint32_t relayUeId,
+                                           uint32_t targetUeId);
+
+    /**
+     * \brief Set the parameters for the UE-to-UE relay solicitation
+     *
+     * \param serviceCode the relay service code
+     * \param discovererInfo the discoverer information
+     * \param targetUeId the layer 2 ID of the end UE to reach, 0 for any
+     */
+    void SetU2uRelaySolicitationParameters(uint32_t serviceCode,
+                                           uint64_t discovererInfo,
+                                           uint32_t targetUeId);
+
+    /**
+     * \brief Set the parameters for the UE-to-UE relay response
+     *
+     * \param serviceCode the relay service code
+     * \param discovereeInfo the discoveree information
+     * \param relayUeId the layer 2 ID of the relay node
+     * \param targetUeId the layer 2 ID of an end UE reachable through the relay, 0 if none
+     */
+    void SetU2uRelayResponseParameters(uint32_t serviceCode,
+                                       uint64_t discovereeInfo,
+                                       uint32_t relayUeId,
+                                       uint32_t targetUeId);
+
     /**
      * \brief Get the type ID.
      * \return the object TypeId
@@ -277,10 +356,65 @@ class NrSlDiscoveryHeader : public Header
     uint32_t m_group;     ///< Group ID
     uint32_t m_groupInfo; ///< Group information
 
+    uint32_t m_targetUeId; ///< End UE reachable through a UE-to-UE relay
+
     uint32_t m_mic;            ///< Message Integrity Check
     uint8_t m_utcBasedCounter; ///< UTC time associated with the discovery transmission opportunity
 };
 
+/**
+ * \ingroup lte
+ * \brief The header of an aggregated discovery packet
+ *
+ * An aggregated discovery packet carries several discovery messages (i.e.,
+ * NrSlDiscoveryHeader) in a single transmission. This header precedes the
+ * messages and indicates how many of them follow. Its first byte is a
+ * discovery message type with the reserved discovery type 0, thus it cannot
+ * be confused with the first byte of a regular discovery message.
+ */
+class NrSlDiscoveryAggregationHeader : public Header
+{
+  public:
+    /// Value of the first byte identifying an aggregated discovery packet
+    static constexpr uint8_t DISC_AGGREGATION_MARKER = 0;
+
+    NrSlDiscoveryAggregationHeader();
+    ~NrSlDiscoveryAggregationHeader();
+
+    /**
+     * \brief Set the number of discovery messages following this header
+     *
+     * \param nMessages the number of discovery messages
+     */
+    void SetNMessages(uint8_t nMessages);
+
+    /**
+     * \return the number of discovery messages following this header
+     */
+    uint8_t GetNMessages() const;
+
+    /**
+     * \brief Indicate if the deserialized bytes are an aggregation header
+     *
+     * This is used to peek at a received discovery packet and identify its
+     * format
+     *
+     * \return true if the packet is an aggregated discovery packet
+     */
+    bool IsAggregated() const;
+
+    static TypeId GetTypeId(void);
+    virtual TypeId GetInstanceTypeId(void) const;
+    virtual void Print(std::ostream& os) const;
+    virtual uint32_t GetSerializedSize(void) const;
+    virtual void Serialize(Buffer::Iterator start) const;
+    virtual uint32_t Deserialize(Buffer::Iterator start);
+
+  private:
+    uint8_t m_marker;    ///< First byte, equal to DISC_AGGREGATION_MARKER if aggregated
+    uint8_t m_nMessages; ///< Number of discovery messages following the header
+};
+
 } // namespace ns3
 
 #endif
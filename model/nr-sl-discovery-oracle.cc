@@ -0,0 +1,300 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * NIST-developed software is provided by NIST as a public
+ * service. You may use, copy and distribute copies of the software in
+ * any medium, provided that you keep intact this entire notice. You
+ * may improve, modify and create derivative works of the software or
+ * any portion of the software, and you may copy and distribute such
+ * modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and
+ * nature of any such change. Please explicitly acknowledge the
+ * National Institute of Standards and Technology as the source of the
+ * software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES
+ * NO WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY
+ * OPERATION OF LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+ * WARRANTY OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE,
+ * NON-INFRINGEMENT AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR
+ * WARRANTS THAT THE OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED
+ * OR ERROR-FREE, OR THAT ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT
+ * WARRANT OR MAKE ANY REPRESENTATIONS REGARDING THE USE OF THE
+ * SOFTWARE OR THE RESULTS THEREOF, INCLUDING BUT NOT LIMITED TO THE
+ * CORRECTNESS, ACCURACY, RELIABILITY, OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of
+ * using and distributing the software and you assume all risks
+ * associated with its use, including but not limited to the risks and
+ * costs of program errors, compliance with applicable laws, damage to
+ * or loss of data, programs or equipment, and the unavailability or
+ * interruption of operation. This software is not intended to be used
+ * in any situation where a failure could cause risk of injury or
+ * damage to property. The software developed by NIST employees is not
+ * subject to copyright protection within the United States.
+ */
+
+#include "nr-sl-discovery-oracle.h"
+
+#include "nr-sl-ue-prose.h"
+
+#include <ns3/abort.h>
+#include <ns3/double.h>
+#include <ns3/log.h>
+#include <ns3/node.h>
+#include <ns3/pointer.h>
+#include <ns3/simulator.h>
+#include <ns3/uinteger.h>
+
+#include <cmath>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("NrSlDiscoveryOracle");
+NS_OBJECT_ENSURE_REGISTERED(NrSlDiscoveryOracle);
+
+TypeId
+NrSlDiscoveryOracle::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::NrSlDiscoveryOracle")
+            .SetParent<Object>()
+            .SetGroupName("Nr")
+            .AddConstructor<NrSlDiscoveryOracle>()
+            .AddAttribute("PropagationLossModel",
+                          "Propagation loss model used to compute the received power. A log "
+                          "distance model is used if none is set",
+                          PointerValue(),
+                          MakePointerAccessor(&NrSlDiscoveryOracle::m_propagationLoss),
+                          MakePointerChecker<PropagationLossModel>())
+            .AddAttribute("TxPower",
+                          "Transmission power of the discovery messages in dBm",
+                          DoubleValue(23.0),
+                          MakeDoubleAccessor(&NrSlDiscoveryOracle::m_txPower),
+                          MakeDoubleChecker<double>())
+            .AddAttribute("NumRbs",
+                          "Number of resource blocks the transmission power is spread over to "
+                          "compute the RSRP",
+                          UintegerValue(52),
+                          MakeUintegerAccessor(&NrSlDiscoveryOracle::m_numRbs),
+                          MakeUintegerChecker<uint16_t>(1))
+            .AddAttribute("MinRsrp",
+                          "RSRP in dBm below which a discovery message is not received",
+                          DoubleValue(-120.0),
+                          MakeDoubleAccessor(&NrSlDiscoveryOracle::m_minRsrp),
+                          MakeDoubleChecker<double>())
+            .AddAttribute("RelayRsrpThreshold",
+                          "RSRP in dBm below which the transmitter is not an eligible relay",
+                          DoubleValue(-110.0),
+                          MakeDoubleAccessor(&NrSlDiscoveryOracle::m_relayRsrpThreshold),
+                          MakeDoubleChecker<double>())
+            .AddAttribute("MaxRange",
+                          "Distance in m beyond which a discovery message is not received, "
+                          "which is also the side of the cells of the grid",
+                          DoubleValue(1000.0),
+                          MakeDoubleAccessor(&NrSlDiscoveryOracle::m_maxRange),
+                          MakeDoubleChecker<double>(1.0))
+            .AddAttribute("GridUpdatePeriod",
+                          "Minimum period between two rebuilds of the grid from the positions "
+                          "of the UEs",
+                          TimeValue(MilliSeconds(100)),
+                          MakeTimeAccessor(&NrSlDiscoveryOracle::m_gridUpdatePeriod),
+                          MakeTimeChecker())
+            .AddAttribute("Delay",
+                          "Delay between the transmission and the reception of a discovery "
+                          "message",
+                          TimeValue(MilliSeconds(1)),
+                          MakeTimeAccessor(&NrSlDiscoveryOracle::m_delay),
+                          MakeTimeChecker());
+    return tid;
+}
+
+NrSlDiscoveryOracle::NrSlDiscoveryOracle()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+NrSlDiscoveryOracle::~NrSlDiscoveryOracle()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+void
+NrSlDiscoveryOracle::DoDispose()
+{
+    NS_LOG_FUNCTION(this);
+    m_grid.clear();
+    m_ues.clear();
+    m_propagationLoss = nullptr;
+    Object::DoDispose();
+}
+
+void
+NrSlDiscoveryOracle::AddUe(Ptr<NrSlUeProse> prose, Ptr<Node> node)
+{
+    NS_LOG_FUNCTION(this << prose << node);
+
+    Ptr<MobilityModel> mobility = node->GetObject<MobilityModel>();
+    NS_ABORT_MSG_IF(!mobility, "Node " << node->GetId() << " has no mobility model");
+
+    UeInfo ue;
+    ue.prose = prose;
+    ue.mobility = mobility;
+    ue.context = node->GetId();
+    m_ues[PeekPointer(prose)] = ue;
+    m_gridValid = false;
+}
+
+void
+NrSlDiscoveryOracle::RemoveUe(const NrSlUeProse* prose)
+{
+    NS_LOG_FUNCTION(this << prose);
+    if (m_ues.erase(prose) > 0)
+    {
+        m_gridValid = false;
+    }
+}
+
+uint64_t
+NrSlDiscoveryOracle::GetCellKey(int64_t ix, int64_t iy)
+{
+    return (static_cast<uint64_t>(static_cast<uint32_t>(ix)) << 32) | static_cast<uint32_t>(iy);
+}
+
+uint64_t
+NrSlDiscoveryOracle::GetCellKey(double x, double y) const
+{
+    return GetCellKey(static_cast<int64_t>(std::floor(x / m_maxRange)),
+                      static_cast<int64_t>(std::floor(y / m_maxRange)));
+}
+
+void
+NrSlDiscoveryOracle::UpdateGrid()
+{
+    NS_LOG_FUNCTION(this);
+    for (auto& itCell : m_grid)
+    {
+        itCell.second.clear();
+    }
+    for (const auto& itUe : m_ues)
+    {
+        Vector position = itUe.second.mobility->GetPosition();
+        m_grid[GetCellKey(position.x, position.y)].push_back(&itUe.second);
+    }
+    // Erase the cells left by the UEs, so that the grid does not grow with
+    // all the cells ever visited
+    for (auto itCell = m_grid.begin(); itCell != m_grid.end();)
+    {
+        if (itCell->second.empty())
+        {
+            itCell = m_grid.erase(itCell);
+        }
+        else
+        {
+            ++itCell;
+        }
+    }
+    m_lastGridUpdate = Simulator::Now();
+    m_gridValid = true;
+}
+
+void
+NrSlDiscoveryOracle::Transmit(const NrSlUeProse* sender, Ptr<const Packet> packet, uint32_t dstL2Id)
+{
+    NS_LOG_FUNCTION(this << sender << packet << dstL2Id);
+
+    auto itSender = m_ues.find(sender);
+    NS_ABORT_MSG_IF(itSender == m_ues.end(), "The transmitting UE is not registered");
+    const UeInfo& tx = itSender->second;
+    // The L2 ID is read at each transmission, as it may be set after the UE is added
+    uint32_t srcL2Id = tx.prose->GetL2Id();
+    m_transmissions++;
+
+    if (!m_propagationLoss)
+    {
+        m_propagationLoss = CreateObject<LogDistancePropagationLossModel>();
+    }
+    if (!m_gridValid || Simulator::Now() - m_lastGridUpdate >= m_gridUpdatePeriod)
+    {
+        UpdateGrid();
+    }
+
+    // Power per resource element of the RBs the message is spread over
+    double reOffset = 10 * std::log10(12.0 * m_numRbs);
+    Vector txPosition = tx.mobility->GetPosition();
+    int64_t ix = static_cast<int64_t>(std::floor(txPosition.x / m_maxRange));
+    int64_t iy = static_cast<int64_t>(std::floor(txPosition.y / m_maxRange));
+    for (int64_t dx = -1; dx <= 1; ++dx)
+    {
+        for (int64_t dy = -1; dy <= 1; ++dy)
+        {
+            auto itCell = m_grid.find(GetCellKey(ix + dx, iy + dy));
+            if (itCell == m_grid.end())
+            {
+                continue;
+            }
+            for (const UeInfo* rx : itCell->second)
+            {
+                if (rx == &tx || !rx->prose->IsMonitoringDiscoveryL2Id(dstL2Id))
+                {
+                    continue;
+                }
+                m_candidates++;
+                if (CalculateDistance(txPosition, rx->mobility->GetPosition()) > m_maxRange)
+                {
+                    continue;
+                }
+                double rsrp =
+                    m_propagationLoss->CalcRxPower(m_txPower, tx.mobility, rx->mobility) -
+                    reOffset;
+                if (rsrp < m_minRsrp)
+                {
+                    continue;
+                }
+                NS_LOG_LOGIC("Discovery message from " << srcL2Id << " delivered to "
+                                                       << rx->prose->GetL2Id() << " with RSRP "
+                                                       << rsrp << " dBm");
+                m_receptions++;
+                Simulator::ScheduleWithContext(rx->context,
+                                               m_delay,
+                                               &NrSlUeProse::ReceiveOracleDiscovery,
+                                               rx->prose,
+                                               packet->Copy(),
+                                               srcL2Id,
+                                               rsrp,
+                                               rsrp >= m_relayRsrpThreshold);
+            }
+        }
+    }
+}
+
+uint64_t
+NrSlDiscoveryOracle::GetTransmissions() const
+{
+    return m_transmissions;
+}
+
+uint64_t
+NrSlDiscoveryOracle::GetReceptions() const
+{
+    return m_receptions;
+}
+
+uint64_t
+NrSlDiscoveryOracle::GetCandidates() const
+{
+    return m_candidates;
+}
+
+int64_t
+NrSlDiscoveryOracle::AssignStreams(int64_t stream)
+{
+    NS_LOG_FUNCTION(this << stream);
+    if (!m_propagationLoss)
+    {
+        m_propagationLoss = CreateObject<LogDistancePropagationLossModel>();
+    }
+    return m_propagationLoss->AssignStreams(stream);
+}
+
+} // namespace ns3
@@ -0,0 +1,203 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * NIST-developed software is provided by NIST as a public
+ * service. You may use, copy and distribute copies of the software in
+ * any medium, provided that you keep intact this entire notice. You
+ * may improve, modify and create derivative works of the software or
+ * any portion of the software, and you may copy and distribute such
+ * modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and
+ * nature of any such change. Please explicitly acknowledge the
+ * National Institute of Standards and Technology as the source of the
+ * software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES
+ * NO WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY
+ * OPERATION OF LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+ * WARRANTY OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE,
+ * NON-INFRINGEMENT AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR
+ * WARRANTS THAT THE OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED
+ * OR ERROR-FREE, OR THAT ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT
+ * WARRANT OR MAKE ANY REPRESENTATIONS REGARDING THE USE OF THE
+ * SOFTWARE OR THE RESULTS THEREOF, INCLUDING BUT NOT LIMITED TO THE
+ * CORRECTNESS, ACCURACY, RELIABILITY, OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of
+ * using and distributing the software and you assume all risks
+ * associated with its use, including but not limited to the risks and
+ * costs of program errors, compliance with applicable laws, damage to
+ * or loss of data, programs or equipment, and the unavailability or
+ * interruption of operation. This software is not intended to be used
+ * in any situation where a failure could cause risk of injury or
+ * damage to property. The software developed by NIST employees is not
+ * subject to copyright protection within the United States.
+ */
+
+#ifndef NR_SL_DISCOVERY_ORACLE_H
+#define NR_SL_DISCOVERY_ORACLE_H
+
+#include <ns3/mobility-model.h>
+#include <ns3/nstime.h>
+#include <ns3/object.h>
+#include <ns3/packet.h>
+#include <ns3/propagation-loss-model.h>
+
+#include <unordered_map>
+#include <vector>
+
+namespace ns3
+{
+
+class Node;
+class NrSlUeProse;
+
+/**
+ * \ingroup lte
+ *
+ * \brief Abstracted delivery of the discovery messages of the ProSe layers
+ *
+ * The discovery messages of the UEs registered with the oracle do not go
+ * through the NR sidelink stack. When a UE transmits a discovery message,
+ * the oracle delivers it after Delay to every other registered UE that
+ * monitors the destination layer 2 ID and whose RSRP, computed from the
+ * positions of the two UEs with the PropagationLossModel, is not below
+ * MinRsrp. The RSRP is the received power of the TxPower spread over the
+ * resource elements of NumRbs resource blocks, and a UE is reported as an
+ * eligible relay if its RSRP is not below RelayRsrpThreshold. Reception is
+ * otherwise ideal: there is no interference, half duplex constraint or
+ * resource selection.
+ *
+ * The UEs are indexed in a grid of square cells of MaxRange side, so that
+ * only the UEs in the cell of the transmitter and in its 8 neighbouring cells
+ * are considered. The grid is rebuilt at most every GridUpdatePeriod, when
+ * a discovery message is transmitted. Since the distance and the RSRP are
+ * computed from the current positions, a stale grid can only miss the UEs
+ * that left their cell, and its period should be short with respect to the
+ * time the UEs take to travel MaxRange.
+ *
+ * The processing of the received messages by the ProSe layer, including
+ * the relay selection and the traces, is unchanged. PC5 signalling and data
+ * still go through the NR sidelink stack.
+ */
+class NrSlDiscoveryOracle : public Object
+{
+  public:
+    /**
+     * \brief Get the type ID.
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId();
+
+    NrSlDiscoveryOracle();
+    ~NrSlDiscoveryOracle() override;
+
+    /**
+     * \brief Register the ProSe layer of a UE with the oracle
+     *
+     * The node must have a mobility model. The ProSe layer is not told to use
+     * the oracle, see NrSlUeProse::SetDiscoveryOracle.
+     *
+     * \param prose the ProSe layer of the UE
+     * \param node the node of the UE
+     */
+    void AddUe(Ptr<NrSlUeProse> prose, Ptr<Node> node);
+
+    /**
+     * \brief Unregister the ProSe layer of a UE
+     *
+     * \param prose the ProSe layer of the UE
+     */
+    void RemoveUe(const NrSlUeProse* prose);
+
+    /**
+     * \brief Deliver a discovery message to the UEs that can receive it
+     *
+     * \param sender the ProSe layer of the transmitting UE
+     * \param packet the discovery packet
+     * \param dstL2Id the destination layer 2 ID
+     */
+    void Transmit(const NrSlUeProse* sender, Ptr<const Packet> packet, uint32_t dstL2Id);
+
+    /**
+     * \return the number of discovery messages transmitted so far
+     */
+    uint64_t GetTransmissions() const;
+
+    /**
+     * \return the number of discovery messages delivered so far
+     */
+    uint64_t GetReceptions() const;
+
+    /**
+     * \return the number of UEs whose distance to a transmitter was checked so far
+     */
+    uint64_t GetCandidates() const;
+
+    /**
+     * \brief Assign a fixed random variable stream number to the random
+     *        variables of the propagation loss model
+     *
+     * \param stream first stream index to use
+     * \return the number of stream indices assigned
+     */
+    int64_t AssignStreams(int64_t stream);
+
+  protected:
+    void DoDispose() override;
+
+  private:
+    /// Registered UE
+    struct UeInfo
+    {
+        Ptr<NrSlUeProse> prose;      ///< ProSe layer of the UE
+        Ptr<MobilityModel> mobility; ///< Mobility model of the node of the UE
+        uint32_t context{0};         ///< Node ID, context of the delivery events
+    };
+
+    /**
+     * \brief Get the key of the grid cell of a position
+     *
+     * \param x the x coordinate
+     * \param y the y coordinate
+     * \return the key of the cell
+     */
+    uint64_t GetCellKey(double x, double y) const;
+
+    /**
+     * \brief Get the key of a grid cell from its indices
+     *
+     * \param ix the index of the cell along x
+     * \param iy the index of the cell along y
+     * \return the key of the cell
+     */
+    static uint64_t GetCellKey(int64_t ix, int64_t iy);
+
+    /**
+     * \brief Rebuild the grid from the current positions of the UEs
+     */
+    void UpdateGrid();
+
+    /// Registered UEs, indexed by their ProSe layer
+    std::unordered_map<const NrSlUeProse*, UeInfo> m_ues;
+    /// UEs in each cell of the grid, indexed by cell key
+    std::unordered_map<uint64_t, std::vector<const UeInfo*>> m_grid;
+    Time m_lastGridUpdate;   ///< Time the grid was last rebuilt
+    bool m_gridValid{false}; ///< Whether the grid holds all the registered UEs
+
+    Ptr<PropagationLossModel> m_propagationLoss; ///< Propagation loss model
+    double m_txPower;                            ///< Transmission power in dBm
+    uint16_t m_numRbs;                           ///< Number of RBs the power is spread over
+    double m_minRsrp;                            ///< Reception RSRP threshold in dBm
+    double m_relayRsrpThreshold;                 ///< Relay eligibility RSRP threshold in dBm
+    double m_maxRange;                           ///< Maximum range and grid cell side in m
+    Time m_gridUpdatePeriod;                     ///< Minimum period of the grid rebuilds
+    Time m_delay;                                ///< Delivery delay
+
+    uint64_t m_transmissions{0}; ///< Number of transmitted discovery messages
+    uint64_t m_receptions{0};    ///< Number of delivered discovery messages
+    uint64_t m_candidates{0};    ///< Number of distance checks
+};
+
+} // namespace ns3
+
+#endif /* NR_SL_DISCOVERY_ORACLE_H */
@@ -51,9 +51,6 @@ NS_OBJECT_ENSURE_REGISTERED(ProseDirectLinkEstablishmentReject);
 NS_OBJECT_ENSURE_REGISTERED(ProseDirectLinkReleaseRequest);
 NS_OBJECT_ENSURE_REGISTERED(ProseDirectLinkReleaseAccept);
 
-// Initialize static member
-uint8_t NrPc5SignallingHeaderSequenceNumber::s_seqNum = 0;
-
 /** Size of the Nonce field */
 static const uint8_t NonceSize = 16;
 
@@ -1015,6 +1012,8 @@ ProseDirectLinkEstablishmentReject::ProseDirectLinkEstablishmentReject()
     m_msgId = 3;
     m_seqNum = 0;
     m_pc5SignallingProtocolCause = 0;
+    m_hasAlternativeRelayL2Id = false;
+    m_alternativeRelayL2Id = 0;
 }
 
 ProseDirectLinkEstablishmentReject::~ProseDirectLinkEstablishmentReject()
@@ -1042,12 +1041,22 @@ ProseDirectLinkEstablishmentReject::Print(std::ostream& os) const
     os << "msgId: " << (uint16_t)m_msgId << " "
        << "seqNum: " << +m_seqNum << " "
        << "pc5SignallingCauseValue: " << +m_pc5SignallingProtocolCause;
+    if (m_hasAlternativeRelayL2Id)
+    {
+        os << " alternativeRelayL2Id: " << m_alternativeRelayL2Id;
+    }
 }
 
 uint32_t
 ProseDirectLinkEstablishmentReject::GetSerializedSize(void) const
 {
-    return sizeof(m_msgId) + sizeof(m_seqNum) + sizeof(m_pc5SignallingProtocolCause);
+    uint32_t size =
+        sizeof(m_msgId) + sizeof(m_seqNum) + sizeof(m_pc5SignallingProtocolCause);
+    if (m_hasAlternativeRelayL2Id)
+    {
+        size = size + 1 + sizeof(m_alternativeRelayL2Id);
+    }
+    return size;
 }
 
 void
@@ -1058,6 +1067,11 @@ ProseDirectLinkEstablishmentReject::Serialize(Buffer::Iterator start) const
     i.WriteU8(m_msgId);
     i.WriteU8(m_seqNum);
     i.WriteU8(m_pc5SignallingProtocolCause);
+    if (m_hasAlternativeRelayL2Id)
+    {
+        i.WriteU8(126); // Alternative relay IEI octet //TODO: Not defined in the standard
+        i.WriteU32(m_alternativeRelayL2Id);
+    }
 }
 
 uint32_t
@@ -1068,6 +1082,19 @@ ProseDirectLinkEstablishmentReject::Deserialize(Buffer::Iterator start)
     m_msgId = i.ReadU8();
     m_seqNum = i.ReadU8();
     m_pc5SignallingProtocolCause = i.ReadU8();
+    while (!i.IsEnd())
+    {
+        uint8_t opt_vars_iei = i.ReadU8();
+        switch (opt_vars_iei)
+        {
+        case 126: // Alternative relay IEI
+            m_alternativeRelayL2Id = i.ReadU32();
+            m_hasAlternativeRelayL2Id = true;
+            break;
+        default:
+            break;
+        }
+    }
     return GetSerializedSize();
 }
 
@@ -1102,6 +1129,19 @@ ProseDirectLinkEstablishmentReject::GetPc5SignallingProtocolCause()
     return m_pc5SignallingProtocolCause;
 }
 
+void
+ProseDirectLinkEstablishmentReject::SetAlternativeRelayL2Id(uint32_t alternativeRelayL2Id)
+{
+    m_hasAlternativeRelayL2Id = true;
+    m_alternativeRelayL2Id = alternativeRelayL2Id;
+}
+
+uint32_t
+ProseDirectLinkEstablishmentReject::GetAlternativeRelayL2Id()
+{
+    return m_alternativeRelayL2Id;
+}
+
 /*****     ProseDirectLinkReleaseRequest Message       *****/
 
 ProseDirectLinkReleaseRequest::ProseDirectLinkReleaseRequest()
@@ -1112,6 +1152,8 @@ ProseDirectLinkReleaseRequest::ProseDirectLinkReleaseRequest()
     m_msbKnrpId = 0;
     m_hasBackoffValue = false;
     m_backoffValue = 0;
+    m_hasAlternativeRelayL2Id = false;
+    m_alternativeRelayL2Id = 0;
 }
 
 ProseDirectLinkReleaseRequest::~ProseDirectLinkReleaseRequest()
@@ -1142,7 +1184,11 @@ ProseDirectLinkReleaseRequest::Print(std::ostream& os) const
     os << "msbKnrpId: " << +m_msbKnrpId << " ";
     if (m_hasBackoffValue)
     {
-        os << +m_backoffValue;
+        os << +m_backoffValue << " ";
+    }
+    if (m_hasAlternativeRelayL2Id)
+    {
+        os << "alternativeRelayL2Id: " << m_alternativeRelayL2Id;
     }
 }
 
@@ -1156,6 +1202,10 @@ ProseDirectLinkReleaseRequest::GetSerializedSize(void) const
     {
         size = size + sizeof(m_backoffValue);
     }
+    if (m_hasAlternativeRelayL2Id)
+    {
+        size = size + 1 + sizeof(m_alternativeRelayL2Id);
+    }
     return size;
 }
 
@@ -1172,6 +1222,11 @@ ProseDirectLinkReleaseRequest::Serialize(Buffer::Iterator start) const
     {
         i.WriteU16(m_backoffValue);
     }
+    if (m_hasAlternativeRelayL2Id)
+    {
+        i.WriteU8(126); // Alternative relay IEI octet //TODO: Not defined in the standard
+        i.WriteU32(m_alternativeRelayL2Id);
+    }
 }
 
 uint32_t
@@ -1185,6 +1240,19 @@ ProseDirectLinkReleaseRequest::Deserialize(Buffer::Iterator start)
     m_msbKnrpId = i.ReadU16();
     m_backoffValue = i.ReadU16();
     m_hasBackoffValue = true;
+    while (!i.IsEnd())
+    {
+        uint8_t opt_vars_iei = i.ReadU8();
+        switch (opt_vars_iei)
+        {
+        case 126: // Alternative relay IEI
+            m_alternativeRelayL2Id = i.ReadU32();
+            m_hasAlternativeRelayL2Id = true;
+            break;
+        default:
+            break;
+        }
+    }
     return GetSerializedSize();
 }
 
@@ -1243,6 +1311,19 @@ ProseDirectLinkReleaseRequest::GetBackoffValue()
     return m_backoffValue;
 }
 
+void
+ProseDirectLinkReleaseRequest::SetAlternativeRelayL2Id(uint32_t alternativeRelayL2Id)
+{
+    m_hasAlternativeRelayL2Id = true;
+    m_alternativeRelayL2Id = alternativeRelayL2Id;
+}
+
+uint32_t
+ProseDirectLinkReleaseRequest::GetAlternativeRelayL2Id()
+{
+    return m_alternativeRelayL2Id;
+}
+
 /*****     ProseDirectLinkReleaseAccept Message       *****/
 ProseDirectLinkReleaseAccept::ProseDirectLinkReleaseAccept()
 {
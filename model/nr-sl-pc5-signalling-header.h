@@ -129,25 +129,29 @@ class NrSlPc5SignallingMessageType : public Header
  * \ingroup nist
  * \brief sequence number for PC5 signaling headers
  *
- * This class provides a sequential packet number
+ * This class provides a sequential packet number. Each instance keeps its own
+ * counter, so that the sequence numbers of a direct link do not depend on the
+ * other direct links of the simulation (or of the other processes of a
+ * distributed simulation).
  */
 
 class NrPc5SignallingHeaderSequenceNumber
 {
   public:
-    /**
-     * Variable with the last sequence number generated
-     */
-    static uint8_t s_seqNum;
-
     /**
      * Return a new sequence number
      * \return A new sequence number value
      */
-    static uint8_t GenerateSeqNum()
+    uint8_t GenerateSeqNum()
     {
-        return ++s_seqNum;
+        return ++m_seqNum;
     }
+
+  private:
+    /**
+     * Variable with the last sequence number generated
+     */
+    uint8_t m_seqNum{0};
 };
 
 /**
@@ -625,10 +629,26 @@ class ProseDirectLinkEstablishmentReject : public Header
      */
     uint8_t GetPc5SignallingProtocolCause();
 
+    /**
+     * Set the Layer 2 ID of the relay UE the remote UE is redirected to
+     *
+     * \param alternativeRelayL2Id the layer 2 ID of the alternative relay UE
+     */
+    void SetAlternativeRelayL2Id(uint32_t alternativeRelayL2Id);
+
+    /**
+     * Get the Layer 2 ID of the relay UE the remote UE is redirected to
+     *
+     * \return the layer 2 ID of the alternative relay UE, or 0 if not present
+     */
+    uint32_t GetAlternativeRelayL2Id();
+
   private:
     uint8_t m_msgId;                      ///< message identifier
     uint8_t m_seqNum;                     ///< sequence number
     uint8_t m_pc5SignallingProtocolCause; ///< pc5 signalling protocol cause value
+    bool m_hasAlternativeRelayL2Id; ///< flag indicating if the alternative relay is present
+    uint32_t m_alternativeRelayL2Id; ///< optional: alternative relay layer 2 ID
 };
 
 /**
@@ -726,6 +746,20 @@ class ProseDirectLinkReleaseRequest : public Header
      */
     uint16_t GetBackoffValue();
 
+    /**
+     * Set the Layer 2 ID of the relay UE the remote UE is redirected to
+     *
+     * \param alternativeRelayL2Id the layer 2 ID of the alternative relay UE
+     */
+    void SetAlternativeRelayL2Id(uint32_t alternativeRelayL2Id);
+
+    /**
+     * Get the Layer 2 ID of the relay UE the remote UE is redirected to
+     *
+     * \return the layer 2 ID of the alternative relay UE, or 0 if not present
+     */
+    uint32_t GetAlternativeRelayL2Id();
+
   private:
     uint8_t m_msgId;                      ///< message identifier
     uint8_t m_seqNum;                     ///< sequence number
@@ -733,6 +767,8 @@ class ProseDirectLinkReleaseRequest : public Header
     uint16_t m_msbKnrpId;                 ///< MSB Knrp ID
     bool m_hasBackoffValue;               ///< flag inbdicating if the backoff value is present
     uint16_t m_backoffValue;              ///< optional: backoff value
+    bool m_hasAlternativeRelayL2Id; ///< flag indicating if the alternative relay is present
+    uint32_t m_alternativeRelayL2Id; ///< optional: alternative relay layer 2 ID
 };
 
 /**
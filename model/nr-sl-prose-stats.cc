@@ -0,0 +1,236 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * NIST-developed software is provided by NIST as a public
+ * service. You may use, copy and distribute copies of the software in
+ * any medium, provided that you keep intact this entire notice. You
+ * may improve, modify and create derivative works of the software or
+ * any portion of the software, and you may copy and distribute such
+ * modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and
+ * nature of any such change. Please explicitly acknowledge the
+ * National Institute of Standards and Technology as the source of the
+ * software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES
+ * NO WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY
+ * OPERATION OF LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+ * WARRANTY OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE,
+ * NON-INFRINGEMENT AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR
+ * WARRANTS THAT THE OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED
+ * OR ERROR-FREE, OR THAT ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT
+ * WARRANT OR MAKE ANY REPRESENTATIONS REGARDING THE USE OF THE
+ * SOFTWARE OR THE RESULTS THEREOF, INCLUDING BUT NOT LIMITED TO THE
+ * CORRECTNESS, ACCURACY, RELIABILITY, OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of
+ * using and distributing the software and you assume all risks
+ * associated with its use, including but not limited to the risks and
+ * costs of program errors, compliance with applicable laws, damage to
+ * or loss of data, programs or equipment, and the unavailability or
+ * interruption of operation. This software is not intended to be used
+ * in any situation where a failure could cause risk of injury or
+ * damage to property. The software developed by NIST employees is not
+ * subject to copyright protection within the United States.
+ */
+
+#include "nr-sl-prose-stats.h"
+
+#include "nr-sl-discovery-header.h"
+#include "nr-sl-pc5-signalling-header.h"
+
+#include <numeric>
+#include <utility>
+
+namespace ns3
+{
+
+/// Names of the discovery message types, in the order they are printed
+static const std::pair<uint8_t, const char*> g_discoveryMsgNames[] = {
+    {NrSlDiscoveryHeader::DISC_OPEN_ANNOUNCEMENT, "OpenAnnouncement"},
+    {NrSlDiscoveryHeader::DISC_RESTRICTED_QUERY, "RestrictedQuery"},
+    {NrSlDiscoveryHeader::DISC_RESTRICTED_RESPONSE, "RestrictedResponse"},
+    {NrSlDiscoveryHeader::DISC_RELAY_ANNOUNCEMENT, "RelayAnnouncement"},
+    {NrSlDiscoveryHeader::DISC_RELAY_SOLICITATION, "RelaySolicitation"},
+    {NrSlDiscoveryHeader::DISC_RELAY_RESPONSE, "RelayResponse"},
+    {NrSlDiscoveryHeader::DISC_GROUP_ANNOUNCEMENT, "GroupAnnouncement"},
+    {NrSlDiscoveryHeader::DISC_GROUP_SOLICITATION, "GroupSolicitation"},
+    {NrSlDiscoveryHeader::DISC_GROUP_RESPONSE, "GroupResponse"},
+    {NrSlDiscoveryHeader::DISC_U2U_RELAY_ANNOUNCEMENT, "U2uRelayAnnouncement"},
+    {NrSlDiscoveryHeader::DISC_U2U_RELAY_SOLICITATION, "U2uRelaySolicitation"},
+    {NrSlDiscoveryHeader::DISC_U2U_RELAY_RESPONSE, "U2uRelayResponse"},
+};
+
+/// Names of the PC5 signalling message types, in the order they are printed
+static const std::pair<uint8_t, const char*> g_pc5SignallingMsgNames[] = {
+    {NrSlPc5SignallingMessageType::ProseDirectLinkEstablishmentRequest,
+     "DirectLinkEstablishmentRequest"},
+    {NrSlPc5SignallingMessageType::ProseDirectLinkEstablishmentAccept,
+     "DirectLinkEstablishmentAccept"},
+    {NrSlPc5SignallingMessageType::ProseDirectLinkEstablishmentReject,
+     "DirectLinkEstablishmentReject"},
+    {NrSlPc5SignallingMessageType::ProseDirectLinkModificationRequest,
+     "DirectLinkModificationRequest"},
+    {NrSlPc5SignallingMessageType::ProseDirectLinkModificationAccept,
+     "DirectLinkModificationAccept"},
+    {NrSlPc5SignallingMessageType::ProseDirectLinkModificationReject,
+     "DirectLinkModificationReject"},
+    {NrSlPc5SignallingMessageType::ProseDirectLinkReleaseRequest, "DirectLinkReleaseRequest"},
+    {NrSlPc5SignallingMessageType::ProseDirectLinkReleaseAccept, "DirectLinkReleaseAccept"},
+};
+
+NrSlProseStats::NrSlProseStats()
+{
+    Reset();
+}
+
+void
+NrSlProseStats::Reset()
+{
+    m_discoveryTx.fill(0);
+    m_discoveryRx.fill(0);
+    m_discoveryRxDropped = 0;
+    m_discoveryRxDuplicates = 0;
+    m_discoveryAggregatedTx = 0;
+    m_discoveryAggregatedRx = 0;
+    m_pc5SignallingTx.fill(0);
+    m_pc5SignallingRx.fill(0);
+    m_pc5SignallingRtx = 0;
+    m_relaySelections = 0;
+    m_relayReselections = 0;
+    m_linkEstablishments = 0;
+    m_linkEstablishmentFailures = 0;
+}
+
+void
+NrSlProseStats::Print(std::ostream& os, const std::string& linePrefix) const
+{
+    for (const auto& msg : g_discoveryMsgNames)
+    {
+        if (GetDiscoveryTx(msg.first) != 0)
+        {
+            os << linePrefix << "DiscoveryTx_" << msg.second << "\t" << GetDiscoveryTx(msg.first)
+               << "\n";
+        }
+        if (GetDiscoveryRx(msg.first) != 0)
+        {
+            os << linePrefix << "DiscoveryRx_" << msg.second << "\t" << GetDiscoveryRx(msg.first)
+               << "\n";
+        }
+    }
+    os << linePrefix << "DiscoveryTx\t" << GetDiscoveryTx() << "\n";
+    os << linePrefix << "DiscoveryRx\t" << GetDiscoveryRx() << "\n";
+    os << linePrefix << "DiscoveryRxDropped\t" << m_discoveryRxDropped << "\n";
+    os << linePrefix << "DiscoveryRxDuplicates\t" << m_discoveryRxDuplicates << "\n";
+    os << linePrefix << "DiscoveryAggregatedTx\t" << m_discoveryAggregatedTx << "\n";
+    os << linePrefix << "DiscoveryAggregatedRx\t" << m_discoveryAggregatedRx << "\n";
+    for (const auto& msg : g_pc5SignallingMsgNames)
+    {
+        if (GetPc5SignallingTx(msg.first) != 0)
+        {
+            os << linePrefix << "Pc5SignallingTx_" << msg.second << "\t"
+               << GetPc5SignallingTx(msg.first) << "\n";
+        }
+        if (GetPc5SignallingRx(msg.first) != 0)
+        {
+            os << linePrefix << "Pc5SignallingRx_" << msg.second << "\t"
+               << GetPc5SignallingRx(msg.first) << "\n";
+        }
+    }
+    os << linePrefix << "Pc5SignallingRetransmissions\t" << m_pc5SignallingRtx << "\n";
+    os << linePrefix << "RelaySelections\t" << m_relaySelections << "\n";
+    os << linePrefix << "RelayReselections\t" << m_relayReselections << "\n";
+    os << linePrefix << "LinkEstablishments\t" << m_linkEstablishments << "\n";
+    os << linePrefix << "LinkEstablishmentFailures\t" << m_linkEstablishmentFailures << "\n";
+}
+
+uint64_t
+NrSlProseStats::GetDiscoveryTx(uint8_t msgType) const
+{
+    return m_discoveryTx[DiscoveryIndex(msgType)];
+}
+
+uint64_t
+NrSlProseStats::GetDiscoveryRx(uint8_t msgType) const
+{
+    return m_discoveryRx[DiscoveryIndex(msgType)];
+}
+
+uint64_t
+NrSlProseStats::GetDiscoveryTx() const
+{
+    return std::accumulate(m_discoveryTx.begin(), m_discoveryTx.end(), uint64_t(0));
+}
+
+uint64_t
+NrSlProseStats::GetDiscoveryRx() const
+{
+    return std::accumulate(m_discoveryRx.begin(), m_discoveryRx.end(), uint64_t(0));
+}
+
+uint64_t
+NrSlProseStats::GetDiscoveryAggregatedTx() const
+{
+    return m_discoveryAggregatedTx;
+}
+
+uint64_t
+NrSlProseStats::GetDiscoveryAggregatedRx() const
+{
+    return m_discoveryAggregatedRx;
+}
+
+uint64_t
+NrSlProseStats::GetDiscoveryRxDuplicates() const
+{
+    return m_discoveryRxDuplicates;
+}
+
+uint64_t
+NrSlProseStats::GetDiscoveryRxDropped() const
+{
+    return m_discoveryRxDropped;
+}
+
+uint64_t
+NrSlProseStats::GetPc5SignallingTx(uint8_t msgType) const
+{
+    return m_pc5SignallingTx[Pc5SignallingIndex(msgType)];
+}
+
+uint64_t
+NrSlProseStats::GetPc5SignallingRx(uint8_t msgType) const
+{
+    return m_pc5SignallingRx[Pc5SignallingIndex(msgType)];
+}
+
+uint64_t
+NrSlProseStats::GetPc5SignallingRetransmissions() const
+{
+    return m_pc5SignallingRtx;
+}
+
+uint64_t
+NrSlProseStats::GetRelaySelections() const
+{
+    return m_relaySelections;
+}
+
+uint64_t
+NrSlProseStats::GetRelayReselections() const
+{
+    return m_relayReselections;
+}
+
+uint64_t
+NrSlProseStats::GetLinkEstablishments() const
+{
+    return m_linkEstablishments;
+}
+
+uint64_t
+NrSlProseStats::GetLinkEstablishmentFailures() const
+{
+    return m_linkEstablishmentFailures;
+}
+
+} // namespace ns3
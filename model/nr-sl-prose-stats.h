@@ -0,0 +1,261 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * NIST-developed software is provided by NIST as a public
+ * service. You may use, copy and distribute copies of the software in
+ * any medium, provided that you keep intact this entire notice. You
+ * may improve, modify and create derivative works of the software or
+ * any portion of the software, and you may copy and distribute such
+ * modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and
+ * nature of any such change. Please explicitly acknowledge the
+ * National Institute of Standards and Technology as the source of the
+ * software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES
+ * NO WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY
+ * OPERATION OF LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+ * WARRANTY OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE,
+ * NON-INFRINGEMENT AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR
+ * WARRANTS THAT THE OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED
+ * OR ERROR-FREE, OR THAT ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT
+ * WARRANT OR MAKE ANY REPRESENTATIONS REGARDING THE USE OF THE
+ * SOFTWARE OR THE RESULTS THEREOF, INCLUDING BUT NOT LIMITED TO THE
+ * CORRECTNESS, ACCURACY, RELIABILITY, OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of
+ * using and distributing the software and you assume all risks
+ * associated with its use, including but not limited to the risks and
+ * costs of program errors, compliance with applicable laws, damage to
+ * or loss of data, programs or equipment, and the unavailability or
+ * interruption of operation. This software is not intended to be used
+ * in any situation where a failure could cause risk of injury or
+ * damage to property. The software developed by NIST employees is not
+ * subject to copyright protection within the United States.
+ */
+
+#ifndef NR_SL_PROSE_STATS_H
+#define NR_SL_PROSE_STATS_H
+
+#include <ns3/simple-ref-count.h>
+
+#include <array>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+namespace ns3
+{
+
+/**
+ * \ingroup lte
+ *
+ * \brief Counters of the ProSe activity of a UE
+ *
+ * The counters are plain integers incremented by the ProSe layer and its
+ * direct links, so they are cheap to maintain and can be read from the
+ * scenario at any time, without connecting traces.
+ */
+class NrSlProseStats : public SimpleRefCount<NrSlProseStats>
+{
+  public:
+    NrSlProseStats();
+
+    /**
+     * \brief Set all the counters to zero
+     */
+    void Reset();
+
+    /**
+     * \brief Print the counters, one per line as "name<TAB>value"
+     *
+     * Per message type counters are only printed if not zero, named after the
+     * message type, e.g., "DiscoveryTx_RelayAnnouncement"
+     *
+     * \param os the output stream
+     * \param linePrefix the string written at the beginning of each line
+     */
+    void Print(std::ostream& os, const std::string& linePrefix = "") const;
+
+    /// Count the transmission of a discovery message of the given type
+    void NotifyDiscoveryTx(uint8_t msgType)
+    {
+        m_discoveryTx[DiscoveryIndex(msgType)]++;
+    }
+
+    /// Count the reception of a discovery message of the given type
+    void NotifyDiscoveryRx(uint8_t msgType)
+    {
+        m_discoveryRx[DiscoveryIndex(msgType)]++;
+    }
+
+    /// Count the transmission of a packet aggregating several discovery messages
+    void NotifyDiscoveryAggregatedTx()
+    {
+        m_discoveryAggregatedTx++;
+    }
+
+    /// Count the reception of a packet aggregating several discovery messages
+    void NotifyDiscoveryAggregatedRx()
+    {
+        m_discoveryAggregatedRx++;
+    }
+
+    /// Count a discovery message suppressed as duplicate of a recent one
+    void NotifyDiscoveryRxDuplicate()
+    {
+        m_discoveryRxDuplicates++;
+    }
+
+    /// Count a discovery message dropped because no role was listening
+    void NotifyDiscoveryRxDropped()
+    {
+        m_discoveryRxDropped++;
+    }
+
+    /// Count the transmission of a PC5-S message of the given type
+    void NotifyPc5SignallingTx(uint8_t msgType)
+    {
+        m_pc5SignallingTx[Pc5SignallingIndex(msgType)]++;
+    }
+
+    /// Count the reception of a PC5-S message of the given type
+    void NotifyPc5SignallingRx(uint8_t msgType)
+    {
+        m_pc5SignallingRx[Pc5SignallingIndex(msgType)]++;
+    }
+
+    /// Count the retransmission of a PC5-S message
+    void NotifyPc5SignallingRetransmission()
+    {
+        m_pc5SignallingRtx++;
+    }
+
+    /// Count the first selection of a relay
+    void NotifyRelaySelection()
+    {
+        m_relaySelections++;
+    }
+
+    /// Count the selection of a relay replacing the current one
+    void NotifyRelayReselection()
+    {
+        m_relayReselections++;
+    }
+
+    /// Count the establishment of a direct link
+    void NotifyLinkEstablishment()
+    {
+        m_linkEstablishments++;
+    }
+
+    /// Count a failed direct link establishment (rejected or not answered)
+    void NotifyLinkEstablishmentFailure()
+    {
+        m_linkEstablishmentFailures++;
+    }
+
+    /**
+     * \param msgType the discovery message type
+     * \return the number of discovery messages of the given type transmitted
+     */
+    uint64_t GetDiscoveryTx(uint8_t msgType) const;
+    /**
+     * \param msgType the discovery message type
+     * \return the number of discovery messages of the given type received
+     */
+    uint64_t GetDiscoveryRx(uint8_t msgType) const;
+    /**
+     * \return the total number of discovery messages transmitted
+     */
+    uint64_t GetDiscoveryTx() const;
+    /**
+     * \return the total number of discovery messages received
+     */
+    uint64_t GetDiscoveryRx() const;
+    /**
+     * \return the number of aggregated discovery packets transmitted
+     */
+    uint64_t GetDiscoveryAggregatedTx() const;
+    /**
+     * \return the number of aggregated discovery packets received
+     */
+    uint64_t GetDiscoveryAggregatedRx() const;
+    /**
+     * \return the number of discovery messages suppressed as duplicates
+     */
+    uint64_t GetDiscoveryRxDuplicates() const;
+    /**
+     * \return the number of discovery messages dropped outside the listen window
+     */
+    uint64_t GetDiscoveryRxDropped() const;
+    /**
+     * \param msgType the PC5-S message type
+     * \return the number of PC5-S messages of the given type transmitted
+     */
+    uint64_t GetPc5SignallingTx(uint8_t msgType) const;
+    /**
+     * \param msgType the PC5-S message type
+     * \return the number of PC5-S messages of the given type received
+     */
+    uint64_t GetPc5SignallingRx(uint8_t msgType) const;
+    /**
+     * \return the number of PC5-S message retransmissions
+     */
+    uint64_t GetPc5SignallingRetransmissions() const;
+    /**
+     * \return the number of relay selections
+     */
+    uint64_t GetRelaySelections() const;
+    /**
+     * \return the number of relay reselections
+     */
+    uint64_t GetRelayReselections() const;
+    /**
+     * \return the number of direct links established
+     */
+    uint64_t GetLinkEstablishments() const;
+    /**
+     * \return the number of failed direct link establishments
+     */
+    uint64_t GetLinkEstablishmentFailures() const;
+
+  private:
+    /**
+     * The discovery message types differ in their content type and model bits,
+     * which are used as index
+     *
+     * \param msgType the discovery message type
+     * \return the index of the counter
+     */
+    static uint8_t DiscoveryIndex(uint8_t msgType)
+    {
+        return msgType & 0x3F;
+    }
+
+    /**
+     * \param msgType the PC5-S message type
+     * \return the index of the counter
+     */
+    static uint8_t Pc5SignallingIndex(uint8_t msgType)
+    {
+        return msgType & 0x0F;
+    }
+
+    std::array<uint64_t, 64> m_discoveryTx;       ///< discovery messages transmitted per type
+    std::array<uint64_t, 64> m_discoveryRx;       ///< discovery messages received per type
+    uint64_t m_discoveryRxDropped;                ///< discovery messages dropped
+    uint64_t m_discoveryRxDuplicates;             ///< discovery messages suppressed as duplicates
+    uint64_t m_discoveryAggregatedTx;             ///< aggregated discovery packets transmitted
+    uint64_t m_discoveryAggregatedRx;             ///< aggregated discovery packets received
+    std::array<uint64_t, 16> m_pc5SignallingTx;   ///< PC5-S messages transmitted per type
+    std::array<uint64_t, 16> m_pc5SignallingRx;   ///< PC5-S messages received per type
+    uint64_t m_pc5SignallingRtx;                  ///< PC5-S messages retransmitted
+    uint64_t m_relaySelections;                   ///< relay selections
+    uint64_t m_relayReselections;                 ///< relay reselections
+    uint64_t m_linkEstablishments;                ///< direct links established
+    uint64_t m_linkEstablishmentFailures;         ///< failed direct link establishments
+};
+
+} // namespace ns3
+
+#endif /* NR_SL_PROSE_STATS_H */
@@ -0,0 +1,499 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * NIST-developed software is provided by NIST as a public
+ * service. You may use, copy and distribute copies of the software in
+ * any medium, provided that you keep intact this entire notice. You
+ * may improve, modify and create derivative works of the software or
+ * any portion of the software, and you may copy and distribute such
+ * modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and
+ * nature of any such change. Please explicitly acknowledge the
+ * National Institute of Standards and Technology as the source of the
+ * software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES
+ * NO WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY
+ * OPERATION OF LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+ * WARRANTY OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE,
+ * NON-INFRINGEMENT AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR
+ * WARRANTS THAT THE OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED
+ * OR ERROR-FREE, OR THAT ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT
+ * WARRANT OR MAKE ANY REPRESENTATIONS REGARDING THE USE OF THE
+ * SOFTWARE OR THE RESULTS THEREOF, INCLUDING BUT NOT LIMITED TO THE
+ * CORRECTNESS, ACCURACY, RELIABILITY, OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of
+ * using and distributing the software and you assume all risks
+ * associated with its use, including but not limited to the risks and
+ * costs of program errors, compliance with applicable laws, damage to
+ * or loss of data, programs or equipment, and the unavailability or
+ * interruption of operation. This software is not intended to be used
+ * in any situation where a failure could cause risk of injury or
+ * damage to property. The software developed by NIST employees is not
+ * subject to copyright protection within the United States.
+ */
+
+#include "nr-sl-u2n-relay-scheduler.h"
+
+#include <ns3/abort.h>
+#include <ns3/ipv4-header.h>
+#include <ns3/log.h>
+#include <ns3/simulator.h>
+#include <ns3/uinteger.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("NrSlU2nRelayScheduler");
+NS_OBJECT_ENSURE_REGISTERED(NrSlU2nRelayScheduler);
+NS_OBJECT_ENSURE_REGISTERED(NrSlU2nRelayRouting);
+
+TypeId
+NrSlU2nRelayScheduler::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::NrSlU2nRelayScheduler")
+            .SetParent<Object>()
+            .SetGroupName("Nr")
+            .AddConstructor<NrSlU2nRelayScheduler>()
+            .AddAttribute("Quantum",
+                          "DRR quantum in bytes received at each round by a remote UE with a "
+                          "weight of 1",
+                          UintegerValue(1500),
+                          MakeUintegerAccessor(&NrSlU2nRelayScheduler::m_quantum),
+                          MakeUintegerChecker<uint32_t>(1))
+            .AddAttribute("MaxQueueSize",
+                          "Maximum number of packets queued per remote UE, above which the "
+                          "arriving packets are dropped",
+                          UintegerValue(100),
+                          MakeUintegerAccessor(&NrSlU2nRelayScheduler::m_maxQueueSize),
+                          MakeUintegerChecker<uint32_t>(1))
+            .AddAttribute("RateLimitBurst",
+                          "Size in bytes of the token bucket of the remote UEs with a rate limit",
+                          UintegerValue(3000),
+                          MakeUintegerAccessor(&NrSlU2nRelayScheduler::m_burst),
+                          MakeUintegerChecker<uint32_t>(1))
+            .AddAttribute("ServiceRate",
+                          "Rate at which the packets leave the scheduler, which must be set to "
+                          "the uplink rate expected for the relay bearer before queueing "
+                          "packets. The DRR fairness only applies when the packets arrive "
+                          "faster than this rate",
+                          DataRateValue(DataRate(0)),
+                          MakeDataRateAccessor(&NrSlU2nRelayScheduler::m_serviceRate),
+                          MakeDataRateChecker())
+            .AddTraceSource("Drop",
+                            "Packet of a remote UE dropped by the scheduler.",
+                            MakeTraceSourceAccessor(&NrSlU2nRelayScheduler::m_dropTrace),
+                            "ns3::NrSlU2nRelayScheduler::DropTracedCallback")
+            .AddTraceSource("Dequeue",
+                            "Packet of a remote UE leaving the scheduler.",
+                            MakeTraceSourceAccessor(&NrSlU2nRelayScheduler::m_dequeueTrace),
+                            "ns3::NrSlU2nRelayScheduler::DequeueTracedCallback");
+    return tid;
+}
+
+NrSlU2nRelayScheduler::NrSlU2nRelayScheduler()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+NrSlU2nRelayScheduler::~NrSlU2nRelayScheduler()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+void
+NrSlU2nRelayScheduler::DoDispose()
+{
+    NS_LOG_FUNCTION(this);
+    m_serveEvent.Cancel();
+    m_queues.clear();
+    m_remoteL2Ids.clear();
+    m_activeList.clear();
+    m_forwardCallback = MakeNullCallback<void, Ptr<Packet>>();
+    Object::DoDispose();
+}
+
+void
+NrSlU2nRelayScheduler::SetForwardCallback(ForwardCallback cb)
+{
+    NS_LOG_FUNCTION(this);
+    m_forwardCallback = cb;
+}
+
+NrSlU2nRelayScheduler::RemoteUeQueue&
+NrSlU2nRelayScheduler::GetRemoteUeQueue(uint32_t remoteL2Id)
+{
+    auto it = m_queues.find(remoteL2Id);
+    if (it == m_queues.end())
+    {
+        it = m_queues.emplace(remoteL2Id, RemoteUeQueue()).first;
+        it->second.tokens = m_burst;
+        it->second.lastTokenUpdate = Simulator::Now();
+    }
+    return it->second;
+}
+
+void
+NrSlU2nRelayScheduler::AddRemoteUe(uint32_t remoteL2Id, Ipv4Address remoteIp)
+{
+    NS_LOG_FUNCTION(this << remoteL2Id << remoteIp);
+    RemoteUeQueue& queue = GetRemoteUeQueue(remoteL2Id);
+    if (queue.ip != Ipv4Address() && queue.ip != remoteIp)
+    {
+        m_remoteL2Ids.erase(queue.ip);
+    }
+    queue.ip = remoteIp;
+    m_remoteL2Ids[remoteIp] = remoteL2Id;
+}
+
+void
+NrSlU2nRelayScheduler::RemoveRemoteUe(uint32_t remoteL2Id)
+{
+    NS_LOG_FUNCTION(this << remoteL2Id);
+    auto it = m_queues.find(remoteL2Id);
+    if (it == m_queues.end())
+    {
+        return;
+    }
+    RemoteUeQueue& queue = it->second;
+    m_remoteL2Ids.erase(queue.ip);
+    queue.ip = Ipv4Address();
+    for (const auto& item : queue.packets)
+    {
+        queue.dropped++;
+        m_dropTrace(remoteL2Id, item.packet);
+    }
+    queue.packets.clear();
+    queue.bytes = 0;
+    queue.deficit = 0;
+    queue.quantumGranted = false;
+    // An active remote UE is left in the active list, from which Serve removes
+    // it as soon as it finds its queue empty, to avoid a linear search here
+}
+
+void
+NrSlU2nRelayScheduler::SetRemoteUeWeight(uint32_t remoteL2Id, double weight)
+{
+    NS_LOG_FUNCTION(this << remoteL2Id << weight);
+    NS_ABORT_MSG_IF(weight <= 0, "The weight of a remote UE must be positive");
+    GetRemoteUeQueue(remoteL2Id).weight = weight;
+}
+
+void
+NrSlU2nRelayScheduler::SetRemoteUeRateLimit(uint32_t remoteL2Id, DataRate rate)
+{
+    NS_LOG_FUNCTION(this << remoteL2Id << rate);
+    RemoteUeQueue& queue = GetRemoteUeQueue(remoteL2Id);
+    UpdateTokens(queue);
+    queue.rateLimit = rate;
+}
+
+void
+NrSlU2nRelayScheduler::UpdateTokens(RemoteUeQueue& queue)
+{
+    Time now = Simulator::Now();
+    if (queue.rateLimit.GetBitRate() > 0)
+    {
+        queue.tokens += (now - queue.lastTokenUpdate).GetSeconds() *
+                        queue.rateLimit.GetBitRate() / 8.0;
+        queue.tokens = std::min(queue.tokens, static_cast<double>(m_burst));
+    }
+    queue.lastTokenUpdate = now;
+}
+
+void
+NrSlU2nRelayScheduler::Enqueue(Ptr<Packet> packet)
+{
+    NS_LOG_FUNCTION(this << packet);
+    NS_ABORT_MSG_IF(m_forwardCallback.IsNull(), "The forward callback is not set");
+    NS_ABORT_MSG_IF(m_serviceRate.GetBitRate() == 0, "The ServiceRate must be greater than zero");
+
+    Ipv4Header ipHeader;
+    packet->PeekHeader(ipHeader);
+    auto itL2Id = m_remoteL2Ids.find(ipHeader.GetSource());
+    if (itL2Id == m_remoteL2Ids.end())
+    {
+        NS_LOG_LOGIC("Packet from unknown source " << ipHeader.GetSource() << " forwarded");
+        m_forwardCallback(packet);
+        return;
+    }
+
+    uint32_t remoteL2Id = itL2Id->second;
+    RemoteUeQueue& queue = m_queues.at(remoteL2Id);
+    if (queue.packets.size() >= m_maxQueueSize)
+    {
+        NS_LOG_LOGIC("Queue of remote " << remoteL2Id << " full, packet dropped");
+        queue.dropped++;
+        m_dropTrace(remoteL2Id, packet);
+        return;
+    }
+
+    queue.packets.push_back({packet, Simulator::Now()});
+    queue.bytes += packet->GetSize();
+    if (!queue.active)
+    {
+        queue.active = true;
+        queue.quantumGranted = false;
+        m_activeList.push_back(remoteL2Id);
+    }
+
+    // A remote UE that is not rate limited does not wait for the tokens of the others
+    if (!m_serveEvent.IsRunning() || m_waitingForTokens)
+    {
+        m_serveEvent.Cancel();
+        Serve();
+    }
+}
+
+void
+NrSlU2nRelayScheduler::Serve()
+{
+    NS_LOG_FUNCTION(this);
+    m_waitingForTokens = false;
+
+    // Remote UEs skipped in a row because of their rate limit, and the time
+    // at which the first of them has enough tokens
+    uint32_t rateLimited = 0;
+    Time wait = Time::Max();
+    while (!m_activeList.empty())
+    {
+        uint32_t remoteL2Id = m_activeList.front();
+        RemoteUeQueue& queue = m_queues.at(remoteL2Id);
+        if (queue.packets.empty())
+        {
+            queue.deficit = 0;
+            queue.active = false;
+            m_activeList.pop_front();
+            continue;
+        }
+
+        UpdateTokens(queue);
+        uint32_t size = queue.packets.front().packet->GetSize();
+        if (queue.rateLimit.GetBitRate() > 0 && queue.tokens < size)
+        {
+            uint32_t missing = static_cast<uint32_t>(std::ceil(size - queue.tokens));
+            wait = std::min(wait, queue.rateLimit.CalculateBytesTxTime(missing));
+            m_activeList.splice(m_activeList.end(), m_activeList, m_activeList.begin());
+            if (++rateLimited >= m_activeList.size())
+            {
+                NS_LOG_LOGIC("All the backlogged remote UEs are rate limited");
+                m_waitingForTokens = true;
+                m_serveEvent = Simulator::Schedule(wait, &NrSlU2nRelayScheduler::Serve, this);
+                return;
+            }
+            continue;
+        }
+        rateLimited = 0;
+        wait = Time::Max();
+
+        if (!queue.quantumGranted)
+        {
+            queue.deficit += m_quantum * queue.weight;
+            queue.quantumGranted = true;
+        }
+        if (size > queue.deficit)
+        {
+            // End of the turn of this remote UE in this round
+            queue.quantumGranted = false;
+            m_activeList.splice(m_activeList.end(), m_activeList, m_activeList.begin());
+            continue;
+        }
+
+        QueueItem item = queue.packets.front();
+        queue.packets.pop_front();
+        queue.bytes -= size;
+        queue.deficit -= size;
+        if (queue.rateLimit.GetBitRate() > 0)
+        {
+            queue.tokens -= size;
+        }
+        if (queue.packets.empty())
+        {
+            queue.deficit = 0;
+            queue.active = false;
+            m_activeList.pop_front();
+        }
+        queue.forwarded++;
+        m_dequeueTrace(remoteL2Id, item.packet, Simulator::Now() - item.enqueueTime);
+        m_forwardCallback(item.packet);
+
+        m_serveEvent = Simulator::Schedule(m_serviceRate.CalculateBytesTxTime(size),
+                                           &NrSlU2nRelayScheduler::Serve,
+                                           this);
+        return;
+    }
+}
+
+uint32_t
+NrSlU2nRelayScheduler::GetQueueDepth(uint32_t remoteL2Id) const
+{
+    auto it = m_queues.find(remoteL2Id);
+    return it != m_queues.end() ? it->second.packets.size() : 0;
+}
+
+uint32_t
+NrSlU2nRelayScheduler::GetQueueBytes(uint32_t remoteL2Id) const
+{
+    auto it = m_queues.find(remoteL2Id);
+    return it != m_queues.end() ? it->second.bytes : 0;
+}
+
+uint64_t
+NrSlU2nRelayScheduler::GetDroppedPackets(uint32_t remoteL2Id) const
+{
+    auto it = m_queues.find(remoteL2Id);
+    return it != m_queues.end() ? it->second.dropped : 0;
+}
+
+uint64_t
+NrSlU2nRelayScheduler::GetForwardedPackets(uint32_t remoteL2Id) const
+{
+    auto it = m_queues.find(remoteL2Id);
+    return it != m_queues.end() ? it->second.forwarded : 0;
+}
+
+TypeId
+NrSlU2nRelayRouting::GetTypeId()
+{
+    static TypeId tid = TypeId("ns3::NrSlU2nRelayRouting")
+                            .SetParent<Ipv4RoutingProtocol>()
+                            .SetGroupName("Nr")
+                            .AddConstructor<NrSlU2nRelayRouting>();
+    return tid;
+}
+
+NrSlU2nRelayRouting::NrSlU2nRelayRouting()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+NrSlU2nRelayRouting::~NrSlU2nRelayRouting()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+void
+NrSlU2nRelayRouting::DoDispose()
+{
+    NS_LOG_FUNCTION(this);
+    m_routing = nullptr;
+    m_scheduler = nullptr;
+    m_ucb = MakeNullCallback<void, Ptr<Ipv4Route>, Ptr<const Packet>, const Ipv4Header&>();
+    Ipv4RoutingProtocol::DoDispose();
+}
+
+void
+NrSlU2nRelayRouting::Install(Ptr<Ipv4> ipv4, Ptr<NrSlU2nRelayScheduler> scheduler)
+{
+    NS_LOG_FUNCTION(this << ipv4 << scheduler);
+    m_routing = ipv4->GetRoutingProtocol();
+    NS_ABORT_MSG_IF(m_routing == nullptr, "The IPv4 stack has no routing protocol to wrap");
+    m_scheduler = scheduler;
+    m_scheduler->SetForwardCallback(MakeCallback(&NrSlU2nRelayRouting::Forward, this));
+    ipv4->SetRoutingProtocol(this);
+}
+
+Ptr<Ipv4RoutingProtocol>
+NrSlU2nRelayRouting::GetRoutingProtocol() const
+{
+    return m_routing;
+}
+
+Ptr<Ipv4Route>
+NrSlU2nRelayRouting::RouteOutput(Ptr<Packet> p,
+                                 const Ipv4Header& header,
+                                 Ptr<NetDevice> oif,
+                                 Socket::SocketErrno& sockerr)
+{
+    return m_routing->RouteOutput(p, header, oif, sockerr);
+}
+
+bool
+NrSlU2nRelayRouting::RouteInput(Ptr<const Packet> p,
+                                const Ipv4Header& header,
+                                Ptr<const NetDevice> idev,
+                                const UnicastForwardCallback& ucb,
+                                const MulticastForwardCallback& mcb,
+                                const LocalDeliverCallback& lcb,
+                                const ErrorCallback& ecb)
+{
+    NS_LOG_FUNCTION(this << p << header.GetSource() << header.GetDestination());
+    m_ucb = ucb;
+    return m_routing->RouteInput(p,
+                                 header,
+                                 idev,
+                                 MakeCallback(&NrSlU2nRelayRouting::Enqueue, this),
+                                 mcb,
+                                 lcb,
+                                 ecb);
+}
+
+void
+NrSlU2nRelayRouting::Enqueue(Ptr<Ipv4Route> route,
+                             Ptr<const Packet> packet,
+                             const Ipv4Header& header)
+{
+    NS_LOG_FUNCTION(this << packet << header.GetSource() << header.GetDestination());
+    Ptr<Packet> ipPacket = packet->Copy();
+    ipPacket->AddHeader(header);
+    m_scheduler->Enqueue(ipPacket);
+}
+
+void
+NrSlU2nRelayRouting::Forward(Ptr<Packet> packet)
+{
+    NS_LOG_FUNCTION(this << packet);
+    Ipv4Header header;
+    packet->RemoveHeader(header);
+    Socket::SocketErrno sockerr;
+    Ptr<Ipv4Route> route = m_routing->RouteOutput(packet, header, nullptr, sockerr);
+    if (route == nullptr)
+    {
+        NS_LOG_LOGIC("No route to " << header.GetDestination() << ", packet dropped");
+        return;
+    }
+    m_ucb(route, packet, header);
+}
+
+void
+NrSlU2nRelayRouting::NotifyInterfaceUp(uint32_t interface)
+{
+    m_routing->NotifyInterfaceUp(interface);
+}
+
+void
+NrSlU2nRelayRouting::NotifyInterfaceDown(uint32_t interface)
+{
+    m_routing->NotifyInterfaceDown(interface);
+}
+
+void
+NrSlU2nRelayRouting::NotifyAddAddress(uint32_t interface, Ipv4InterfaceAddress address)
+{
+    m_routing->NotifyAddAddress(interface, address);
+}
+
+void
+NrSlU2nRelayRouting::NotifyRemoveAddress(uint32_t interface, Ipv4InterfaceAddress address)
+{
+    m_routing->NotifyRemoveAddress(interface, address);
+}
+
+void
+NrSlU2nRelayRouting::SetIpv4(Ptr<Ipv4> ipv4)
+{
+    NS_LOG_FUNCTION(this << ipv4);
+    // The wrapped protocol already has the IPv4 stack
+}
+
+void
+NrSlU2nRelayRouting::PrintRoutingTable(Ptr<OutputStreamWrapper> stream, Time::Unit unit) const
+{
+    m_routing->PrintRoutingTable(stream, unit);
+}
+
+} // namespace ns3
@@ -0,0 +1,347 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * NIST-developed software is provided by NIST as a public
+ * service. You may use, copy and distribute copies of the software in
+ * any medium, provided that you keep intact this entire notice. You
+ * may improve, modify and create derivative works of the software or
+ * any portion of the software, and you may copy and distribute such
+ * modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and
+ * nature of any such change. Please explicitly acknowledge the
+ * National Institute of Standards and Technology as the source of the
+ * software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES
+ * NO WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY
+ * OPERATION OF LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+ * WARRANTY OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE,
+ * NON-INFRINGEMENT AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR
+ * WARRANTS THAT THE OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED
+ * OR ERROR-FREE, OR THAT ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT
+ * WARRANT OR MAKE ANY REPRESENTATIONS REGARDING THE USE OF THE
+ * SOFTWARE OR THE RESULTS THEREOF, INCLUDING BUT NOT LIMITED TO THE
+ * CORRECTNESS, ACCURACY, RELIABILITY, OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of
+ * using and distributing the software and you assume all risks
+ * associated with its use, including but not limited to the risks and
+ * costs of program errors, compliance with applicable laws, damage to
+ * or loss of data, programs or equipment, and the unavailability or
+ * interruption of operation. This software is not intended to be used
+ * in any situation where a failure could cause risk of injury or
+ * damage to property. The software developed by NIST employees is not
+ * subject to copyright protection within the United States.
+ */
+
+#ifndef NR_SL_U2N_RELAY_SCHEDULER_H
+#define NR_SL_U2N_RELAY_SCHEDULER_H
+
+#include <ns3/callback.h>
+#include <ns3/data-rate.h>
+#include <ns3/event-id.h>
+#include <ns3/ipv4-address.h>
+#include <ns3/ipv4-routing-protocol.h>
+#include <ns3/ipv4.h>
+#include <ns3/nstime.h>
+#include <ns3/object.h>
+#include <ns3/packet.h>
+#include <ns3/traced-callback.h>
+
+#include <deque>
+#include <list>
+#include <unordered_map>
+
+namespace ns3
+{
+
+/**
+ * \ingroup lte
+ *
+ * \brief Scheduler of the packets of each remote UE relayed by an L3 U2N relay UE
+ *
+ * The packets given to Enqueue are classified by their source IPv4 address
+ * into one FIFO queue per remote UE. The queues are served with Deficit Round Robin
+ * (DRR): at each round, a backlogged remote UE receives a quantum of
+ * Quantum bytes times its weight, and transmits its packets as long as its
+ * deficit allows it. A remote UE can also be limited to a rate by a token
+ * bucket, in which case it is skipped while it does not have enough tokens.
+ *
+ * The packets leave the scheduler through the forward callback, one at a
+ * time at ServiceRate, which must be set to the uplink rate expected for the
+ * relay bearer: the queues then build up in the scheduler, where the fairness
+ * is enforced, rather than in the relay bearer. Packets from sources that are
+ * not a known remote UE are forwarded immediately.
+ *
+ * The NAS of the nr module does not hand the relayed packets to the ProSe
+ * layer, so the scheduler is inserted in the IPv4 forwarding path of the
+ * relay UE by a NrSlU2nRelayRouting, which feeds it the forwarded packets
+ * and sets its forward callback. NrSlUeProse keeps its remote UEs up to date.
+ */
+class NrSlU2nRelayScheduler : public Object
+{
+  public:
+    /**
+     * \brief Get the type ID.
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId();
+
+    NrSlU2nRelayScheduler();
+    ~NrSlU2nRelayScheduler() override;
+
+    /**
+     * Callback invoked to forward a packet leaving the scheduler
+     */
+    typedef Callback<void, Ptr<Packet>> ForwardCallback;
+
+    /**
+     * \brief Set the callback forwarding the packets leaving the scheduler
+     *
+     * \param cb the callback
+     */
+    void SetForwardCallback(ForwardCallback cb);
+
+    /**
+     * \brief Start classifying the packets of a remote UE into its own queue
+     *
+     * \param remoteL2Id the layer 2 ID of the remote UE
+     * \param remoteIp the IPv4 address of the remote UE
+     */
+    void AddRemoteUe(uint32_t remoteL2Id, Ipv4Address remoteIp);
+
+    /**
+     * \brief Stop scheduling the packets of a remote UE
+     *
+     * The packets still queued are dropped. The counters, weight and rate
+     * limit of the remote UE are kept in case it connects again.
+     *
+     * \param remoteL2Id the layer 2 ID of the remote UE
+     */
+    void RemoveRemoteUe(uint32_t remoteL2Id);
+
+    /**
+     * \brief Set the DRR weight of a remote UE
+     *
+     * \param remoteL2Id the layer 2 ID of the remote UE
+     * \param weight the weight, by which the quantum is multiplied (1 by default)
+     */
+    void SetRemoteUeWeight(uint32_t remoteL2Id, double weight);
+
+    /**
+     * \brief Limit the rate of the packets of a remote UE
+     *
+     * \param remoteL2Id the layer 2 ID of the remote UE
+     * \param rate the maximum rate, or zero for no limit (default)
+     */
+    void SetRemoteUeRateLimit(uint32_t remoteL2Id, DataRate rate);
+
+    /**
+     * \brief Queue a packet received from a remote UE
+     *
+     * The forward callback and a ServiceRate greater than zero must be set.
+     *
+     * \param packet the IPv4 packet
+     */
+    void Enqueue(Ptr<Packet> packet);
+
+    /**
+     * \param remoteL2Id the layer 2 ID of the remote UE
+     * \return the number of packets queued for the remote UE
+     */
+    uint32_t GetQueueDepth(uint32_t remoteL2Id) const;
+
+    /**
+     * \param remoteL2Id the layer 2 ID of the remote UE
+     * \return the number of bytes queued for the remote UE
+     */
+    uint32_t GetQueueBytes(uint32_t remoteL2Id) const;
+
+    /**
+     * \param remoteL2Id the layer 2 ID of the remote UE
+     * \return the number of packets of the remote UE dropped so far
+     */
+    uint64_t GetDroppedPackets(uint32_t remoteL2Id) const;
+
+    /**
+     * \param remoteL2Id the layer 2 ID of the remote UE
+     * \return the number of packets of the remote UE forwarded so far
+     */
+    uint64_t GetForwardedPackets(uint32_t remoteL2Id) const;
+
+    /**
+     * TracedCallback signature for the packets dropped by the scheduler
+     *
+     * \param [in] remoteL2Id layer 2 ID of the remote UE
+     * \param [in] packet the dropped packet
+     */
+    typedef void (*DropTracedCallback)(uint32_t remoteL2Id, Ptr<const Packet> packet);
+
+    /**
+     * TracedCallback signature for the packets leaving the scheduler
+     *
+     * \param [in] remoteL2Id layer 2 ID of the remote UE
+     * \param [in] packet the packet
+     * \param [in] sojourn time spent by the packet in the queue of the remote UE
+     */
+    typedef void (*DequeueTracedCallback)(uint32_t remoteL2Id,
+                                          Ptr<const Packet> packet,
+                                          Time sojourn);
+
+  protected:
+    void DoDispose() override;
+
+  private:
+    /// A packet queued with its arrival time
+    struct QueueItem
+    {
+        Ptr<Packet> packet; ///< The packet
+        Time enqueueTime;   ///< Time the packet was queued
+    };
+
+    /// Queue and scheduling state of a remote UE
+    struct RemoteUeQueue
+    {
+        Ipv4Address ip;                ///< IPv4 address of the remote UE
+        std::deque<QueueItem> packets; ///< Queued packets
+        uint32_t bytes{0};             ///< Number of queued bytes
+        double weight{1.0};            ///< DRR weight
+        DataRate rateLimit{0};         ///< Rate limit, zero for none
+        double tokens{0.0};            ///< Token bucket level in bytes
+        Time lastTokenUpdate;          ///< Last time the tokens were updated
+        double deficit{0.0};           ///< DRR deficit in bytes
+        bool quantumGranted{false};    ///< Whether the quantum of the round was granted
+        bool active{false};            ///< Whether the remote UE is in the active list
+        uint64_t dropped{0};           ///< Number of dropped packets
+        uint64_t forwarded{0};         ///< Number of forwarded packets
+    };
+
+    /**
+     * \brief Get the state of a remote UE, creating it if needed
+     *
+     * \param remoteL2Id the layer 2 ID of the remote UE
+     * \return the state of the remote UE
+     */
+    RemoteUeQueue& GetRemoteUeQueue(uint32_t remoteL2Id);
+
+    /**
+     * \brief Refill the token bucket of a remote UE up to RateLimitBurst
+     *
+     * \param queue the state of the remote UE
+     */
+    void UpdateTokens(RemoteUeQueue& queue);
+
+    /**
+     * \brief Transmit the next packet according to DRR
+     *
+     * The next service is scheduled at the end of the transmission of the
+     * packet at the service rate.
+     */
+    void Serve();
+
+    ForwardCallback m_forwardCallback; ///< Forwarding of the packets leaving the scheduler
+    std::unordered_map<uint32_t, RemoteUeQueue> m_queues; ///< State of the remote UEs by L2 ID
+    ///< L2 ID of the remote UEs by IPv4 address
+    std::unordered_map<Ipv4Address, uint32_t, Ipv4AddressHash> m_remoteL2Ids;
+    std::list<uint32_t> m_activeList; ///< Backlogged remote UEs in DRR order
+    EventId m_serveEvent;             ///< Next service of the queues
+    bool m_waitingForTokens{false};   ///< Whether the next service waits for tokens
+
+    uint32_t m_quantum;        ///< DRR quantum in bytes for a weight of 1
+    uint32_t m_maxQueueSize;   ///< Maximum number of packets queued per remote UE
+    uint32_t m_burst;          ///< Token bucket size in bytes for the rate limits
+    DataRate m_serviceRate;    ///< Rate at which the packets leave the scheduler
+
+    TracedCallback<uint32_t, Ptr<const Packet>> m_dropTrace;          ///< Dropped packets
+    TracedCallback<uint32_t, Ptr<const Packet>, Time> m_dequeueTrace; ///< Forwarded packets
+};
+
+/**
+ * \ingroup lte
+ *
+ * \brief Routing protocol inserting a NrSlU2nRelayScheduler in the IPv4
+ *        forwarding path of an L3 U2N relay UE
+ *
+ * It wraps the routing protocol of the relay UE, to which it delegates all
+ * the decisions. Only the packets that the wrapped protocol forwards go
+ * through the scheduler, with their IPv4 header, so the packets delivered to
+ * the relay UE itself are not delayed. When a packet leaves the scheduler,
+ * its route is looked up again with the wrapped protocol, and it is handed
+ * back to the IPv4 stack, which forwards it as if it had not been queued.
+ */
+class NrSlU2nRelayRouting : public Ipv4RoutingProtocol
+{
+  public:
+    /**
+     * \brief Get the type ID.
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId();
+
+    NrSlU2nRelayRouting();
+    ~NrSlU2nRelayRouting() override;
+
+    /**
+     * \brief Insert a scheduler in the forwarding path of an IPv4 stack
+     *
+     * The routing protocol of the stack, which must already be set, is
+     * wrapped and replaced by this instance, and the forward callback of the
+     * scheduler is set.
+     *
+     * \param ipv4 the IPv4 stack of the relay UE
+     * \param scheduler the scheduler
+     */
+    void Install(Ptr<Ipv4> ipv4, Ptr<NrSlU2nRelayScheduler> scheduler);
+
+    /**
+     * \return the wrapped routing protocol
+     */
+    Ptr<Ipv4RoutingProtocol> GetRoutingProtocol() const;
+
+    // Inherited from Ipv4RoutingProtocol
+    Ptr<Ipv4Route> RouteOutput(Ptr<Packet> p,
+                               const Ipv4Header& header,
+                               Ptr<NetDevice> oif,
+                               Socket::SocketErrno& sockerr) override;
+    bool RouteInput(Ptr<const Packet> p,
+                    const Ipv4Header& header,
+                    Ptr<const NetDevice> idev,
+                    const UnicastForwardCallback& ucb,
+                    const MulticastForwardCallback& mcb,
+                    const LocalDeliverCallback& lcb,
+                    const ErrorCallback& ecb) override;
+    void NotifyInterfaceUp(uint32_t interface) override;
+    void NotifyInterfaceDown(uint32_t interface) override;
+    void NotifyAddAddress(uint32_t interface, Ipv4InterfaceAddress address) override;
+    void NotifyRemoveAddress(uint32_t interface, Ipv4InterfaceAddress address) override;
+    void SetIpv4(Ptr<Ipv4> ipv4) override;
+    void PrintRoutingTable(Ptr<OutputStreamWrapper> stream,
+                           Time::Unit unit = Time::S) const override;
+
+  protected:
+    void DoDispose() override;
+
+  private:
+    /**
+     * \brief Queue a packet forwarded by the wrapped routing protocol
+     *
+     * \param route the route of the packet
+     * \param packet the packet, without IPv4 header
+     * \param header the IPv4 header of the packet
+     */
+    void Enqueue(Ptr<Ipv4Route> route, Ptr<const Packet> packet, const Ipv4Header& header);
+
+    /**
+     * \brief Forward a packet leaving the scheduler
+     *
+     * \param packet the packet, with its IPv4 header
+     */
+    void Forward(Ptr<Packet> packet);
+
+    Ptr<Ipv4RoutingProtocol> m_routing;     ///< Wrapped routing protocol
+    Ptr<NrSlU2nRelayScheduler> m_scheduler; ///< Scheduler of the forwarded packets
+    UnicastForwardCallback m_ucb;           ///< Forwarding of the IPv4 stack
+};
+
+} // namespace ns3
+
+#endif /* NR_SL_U2N_RELAY_SCHEDULER_H */
@@ -237,6 +237,13 @@ NrSlUeProseDirectLink::SetParameters(uint32_t selfL2Id,
     m_ipInfo.selfIpv4Addr = selfIp;
 }
 
+void
+NrSlUeProseDirectLink::SetTargetUserInfo(uint32_t targetUserInfo)
+{
+    NS_LOG_FUNCTION(this << targetUserInfo);
+    m_targetUserInfo = targetUserInfo;
+}
+
 NrSlUeProseDirLnkSapProvider*
 NrSlUeProseDirectLink::GetNrSlUeProseDirLnkSapProvider()
 {
@@ -251,6 +258,13 @@ NrSlUeProseDirectLink::SetNrSlUeProseDirLnkSapUser(NrSlUeProseDirLnkSapUser* s)
     m_nrSlUeProseDirLnkSapUser = s;
 }
 
+void
+NrSlUeProseDirectLink::SetProseStats(Ptr<NrSlProseStats> stats)
+{
+    NS_LOG_FUNCTION(this);
+    m_stats = stats;
+}
+
 void
 NrSlUeProseDirectLink::SendNrSlPc5SMessage(Ptr<Packet> packet, uint32_t dstL2Id, uint8_t lcId)
 {
@@ -294,6 +308,12 @@ NrSlUeProseDirectLink::DoReceiveNrSlPc5Message(Ptr<Packet> packet)
     }
 }
 
+NrSlUeProseDirectLink::DirectLinkState
+NrSlUeProseDirectLink::GetState() const
+{
+    return m_state;
+}
+
 void
 NrSlUeProseDirectLink::SwitchToState(DirectLinkState newState)
 {
@@ -381,12 +401,17 @@ NrSlUeProseDirectLink::ProcessDirectLinkEstablishmentRequest(Ptr<Packet> packet)
             if (m_isRelayConn && !m_isInitiating // 1. This UE is a Relay UE
                 && relaySC == m_relayServiceCode // 2. It provides the service pointed by the relay
                                                  // service code
-                /*Not implemented at the moment */ // 3. It can accept a new connection
+                && m_establishmentRejectCause == 0 // 3. It can accept a new connection
             )
             {
                 NS_LOG_INFO(" UE does provide this service and can accept the connection");
                 accept = true;
             }
+            else if (m_establishmentRejectCause != 0)
+            {
+                NS_LOG_INFO(" UE cannot accept a new connection");
+                cause = m_establishmentRejectCause;
+            }
             else
             {
                 NS_LOG_INFO(" UE does not provide this service or cannot accept this service");
@@ -409,6 +434,8 @@ NrSlUeProseDirectLink::ProcessDirectLinkEstablishmentRequest(Ptr<Packet> packet)
 
             // Send reject message to the peer UE
             SendDirectLinkEstablishmentReject(cause);
+            m_establishmentRejectCause = 0;
+            m_alternativeRelayL2Id = 0;
 
             // Change of state and notify ProSe layer about change of state
             SwitchToState(RELEASED);
@@ -435,8 +462,33 @@ NrSlUeProseDirectLink::ProcessDirectLinkEstablishmentRequest(Ptr<Packet> packet)
         break;
     case NrSlUeProseDirectLink::ESTABLISHING:
         NS_LOG_INFO("ESTABLISHING");
-        // This should not happen, as ESTABLISHING is an internal state to this function
-        NS_FATAL_ERROR("Invalid state " << ToString(m_state));
+        // For a target UE this should not happen, as ESTABLISHING is an internal
+        // state to this function
+        NS_ABORT_MSG_IF(!m_isInitiating || m_isRelayConn, "Invalid state " << ToString(m_state));
+
+        // Both UEs initiated the establishment of a unicast link towards each other
+        // (e.g., after discovering each other). Only one procedure must complete:
+        // the UE with the lowest L2 ID keeps its request and ignores the one of
+        // the peer, while the other UE withdraws its request and becomes the
+        // target UE of the link
+        if (m_selfL2Id < m_peerL2Id)
+        {
+            NS_LOG_INFO("Crossed establishment requests. Ignoring the request of the peer");
+            break;
+        }
+        NS_LOG_INFO("Crossed establishment requests. Accepting the request of the peer");
+        m_pdlEsParam.t5080->Remove();
+        m_pdlEsParam.rtxCounter = 0;
+        m_isInitiating = false;
+        {
+            // Retrieve tag with Ip of the peer UE and store it.
+            // This may be replaced by proper IP configuration protocols in the future
+            Ipv4AddrTag ipTag;
+            packet->PeekPacketTag(ipTag);
+            m_ipInfo.peerIpv4Addr = ipTag.GetAddress();
+        }
+        SendDirectLinkEstablishmentAccept();
+        SwitchToState(ESTABLISHED);
         break;
     case NrSlUeProseDirectLink::ESTABLISHED:
         NS_LOG_INFO("ESTABLISHED");
@@ -553,6 +605,8 @@ NrSlUeProseDirectLink::ProcessDirectLinkEstablishmentReject(Ptr<Packet> packet)
         break;
     case NrSlUeProseDirectLink::ESTABLISHING:
         // Normal case
+        m_peerReleaseCause = cause;
+        m_peerAlternativeRelayL2Id = pdlEsRjHeader.GetAlternativeRelayL2Id();
 
         // Causes from TS 24.554 Table 11.3.8.1
         switch (cause)
@@ -612,6 +666,11 @@ NrSlUeProseDirectLink::ProcessDirectLinkEstablishmentReject(Ptr<Packet> packet)
         // Cancel request retransmission timer
         m_pdlEsParam.t5080->Remove();
 
+        if (m_stats)
+        {
+            m_stats->NotifyLinkEstablishmentFailure();
+        }
+
         // Change of state and notify ProSe layer about change of state
         SwitchToState(RELEASED);
 
@@ -690,7 +749,7 @@ NrSlUeProseDirectLink::SendDirectLinkEstablishmentRequest()
     pdlEsReqHeader.SetUeSignallingSecurityPolicy(ueSigSecPolicy);
 
     // Optional IEs
-    pdlEsReqHeader.SetTargetUserInfo(m_peerL2Id);
+    pdlEsReqHeader.SetTargetUserInfo(m_targetUserInfo != 0 ? m_targetUserInfo : m_peerL2Id);
     if (m_isRelayConn && m_isInitiating)
     {
         NS_LOG_INFO("Remote UE sending DirectLinkEstablishmentRequest");
@@ -764,6 +823,10 @@ NrSlUeProseDirectLink::SendDirectLinkEstablishmentReject(uint8_t cause)
     // All fields are mandatory fields in the reject message
     pdlEsRjHeader.SetSequenceNumber(m_pc5SigMsgSeqNum.GenerateSeqNum());
     pdlEsRjHeader.SetPc5SignallingProtocolCause(cause);
+    if (m_alternativeRelayL2Id != 0)
+    {
+        pdlEsRjHeader.SetAlternativeRelayL2Id(m_alternativeRelayL2Id);
+    }
 
     // Add header to packet
     pdlEsRjPacket->AddHeader(pdlEsRjHeader);
@@ -817,6 +880,11 @@ NrSlUeProseDirectLink::T5080Expiry()
             NS_LOG_INFO("Maximum number of Prose Direct Link Establishment Request "
                         "retransmissions reached. Releasing link...");
 
+            if (m_stats)
+            {
+                m_stats->NotifyLinkEstablishmentFailure();
+            }
+
             // Release link
             NS_LOG_INFO("Release procedure is initiating.");
             uint8_t cause = 5; // Lack of resources for PC5 unicast link
@@ -849,6 +917,10 @@ NrSlUeProseDirectLink::RetransmitDirectLinkEstablishmentRequest()
     ipTag.SetAddress(m_ipInfo.selfIpv4Addr);
     pdlEsReqPacket->AddPacketTag(ipTag);
 
+    if (m_stats)
+    {
+        m_stats->NotifyPc5SignallingRetransmission();
+    }
     SendNrSlPc5SMessage(pdlEsReqPacket, m_peerL2Id, lcId);
 }
 
@@ -895,6 +967,32 @@ NrSlUeProseDirectLink::StartConnectionRelease(uint8_t cause)
     }
 }
 
+void
+NrSlUeProseDirectLink::SetEstablishmentRejectCause(uint8_t cause)
+{
+    NS_LOG_FUNCTION(this << +cause);
+    m_establishmentRejectCause = cause;
+}
+
+void
+NrSlUeProseDirectLink::SetAlternativeRelayL2Id(uint32_t alternativeRelayL2Id)
+{
+    NS_LOG_FUNCTION(this << alternativeRelayL2Id);
+    m_alternativeRelayL2Id = alternativeRelayL2Id;
+}
+
+uint8_t
+NrSlUeProseDirectLink::GetPeerReleaseCause() const
+{
+    return m_peerReleaseCause;
+}
+
+uint32_t
+NrSlUeProseDirectLink::GetPeerAlternativeRelayL2Id() const
+{
+    return m_peerAlternativeRelayL2Id;
+}
+
 void
 NrSlUeProseDirectLink::SendDirectLinkReleaseRequest(uint8_t cause)
 {
@@ -911,6 +1009,10 @@ NrSlUeProseDirectLink::SendDirectLinkReleaseRequest(uint8_t cause)
     pdlReReqHeader.SetPc5SignallingProtocolCause(cause);
     pdlReReqHeader.SetMsbKnrpId(0);
     pdlReReqHeader.SetBackoffValue(0);
+    if (m_alternativeRelayL2Id != 0)
+    {
+        pdlReReqHeader.SetAlternativeRelayL2Id(m_alternativeRelayL2Id);
+    }
 
     // Store it for retransmission
     m_pdlReParam.rqMsgCopy = pdlReReqHeader;
@@ -1014,6 +1116,10 @@ NrSlUeProseDirectLink::RetransmitDirectLinkReleaseRequest()
     uint8_t lcId = 0;
     pdlReReqPacket->AddHeader(m_pdlReParam.rqMsgCopy);
 
+    if (m_stats)
+    {
+        m_stats->NotifyPc5SignallingRetransmission();
+    }
     SendNrSlPc5SMessage(pdlReReqPacket, m_peerL2Id, lcId);
 }
 
@@ -1035,6 +1141,15 @@ NrSlUeProseDirectLink::ProcessDirectLinkReleaseRequest(Ptr<Packet> packet)
 
     NS_LOG_INFO("In state: " << ToString(m_state));
 
+    if (m_state == NrSlUeProseDirectLink::ESTABLISHING ||
+        m_state == NrSlUeProseDirectLink::ESTABLISHED)
+    {
+        // Keep the cause and the suggested relay for the ProSe layer, which
+        // reads them when notified of the change of state
+        m_peerReleaseCause = cause;
+        m_peerAlternativeRelayL2Id = pdlReReqHeader.GetAlternativeRelayL2Id();
+    }
+
     switch (m_state)
     {
     case NrSlUeProseDirectLink::INIT:
@@ -1160,6 +1275,9 @@ NrSlUeProseDirectLink::ResetCurrentLink()
         // Reset T5087 and related counter
         m_pdlReParam.t5087->Remove();
         m_pdlReParam.rtxCounter = 0;
+        m_alternativeRelayL2Id = 0;
+        m_peerReleaseCause = 0;
+        m_peerAlternativeRelayL2Id = 0;
 
         if (m_isInitiating)
         {
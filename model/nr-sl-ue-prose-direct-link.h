@@ -37,6 +37,7 @@
 #define NR_SL_UE_PROSE_DIRECT_LINK_H
 
 #include "nr-sl-pc5-signalling-header.h"
+#include "nr-sl-prose-stats.h"
 
 #include <ns3/nr-sl-ue-prose-dir-lnk-sap.h>
 #include <ns3/object.h>
@@ -140,6 +141,23 @@ class NrSlUeProseDirectLink : public Object
      */
     void SetNrSlUeProseDirLnkSapUser(NrSlUeProseDirLnkSapUser* s);
 
+    /**
+     * \brief Set the counters of the ProSe layer owning this link
+     *
+     * \param stats the ProSe counters of the UE
+     */
+    void SetProseStats(Ptr<NrSlProseStats> stats);
+
+    /**
+     * \brief Set the target user info of the establishment request
+     *
+     * Used when the peer UE is a UE-to-UE relay, in which case the target is
+     * the end UE on the other side of the relay
+     *
+     * \param targetUserInfo the layer 2 ID of the target UE, 0 for the peer UE
+     */
+    void SetTargetUserInfo(uint32_t targetUserInfo);
+
     /**
      * \brief Start the ProSe direct link establishment procedure
      *
@@ -153,6 +171,44 @@ class NrSlUeProseDirectLink : public Object
      */
     void StartConnectionRelease(uint8_t cause);
 
+    /**
+     * \brief Reject the establishment request being processed
+     *
+     * Used by the ProSe layer of a target UE, when notified of the change to
+     * ESTABLISHING state, to reject the request that triggered it, e.g., a
+     * relay UE that cannot serve more remote UEs. The cause only applies to
+     * the request being processed.
+     *
+     * \param cause The PC5 signalling protocol cause of the reject message
+     */
+    void SetEstablishmentRejectCause(uint8_t cause);
+
+    /**
+     * \brief Set the relay UE suggested to the peer remote UE in the release
+     *        request or establishment reject
+     *
+     * Used by a relay UE redirecting the remote UE to another relay UE
+     *
+     * \param alternativeRelayL2Id the layer 2 ID of the alternative relay UE, 0 for none
+     */
+    void SetAlternativeRelayL2Id(uint32_t alternativeRelayL2Id);
+
+    /**
+     * \brief Get the cause of the release request or establishment reject
+     *        received from the peer UE
+     *
+     * \return the PC5 signalling protocol cause, or 0 if none was received
+     */
+    uint8_t GetPeerReleaseCause() const;
+
+    /**
+     * \brief Get the relay UE suggested by the peer UE in its release request
+     *        or establishment reject
+     *
+     * \return the layer 2 ID of the alternative relay UE, or 0 if none was suggested
+     */
+    uint32_t GetPeerAlternativeRelayL2Id() const;
+
     /**
      * \brief Allow the reinitialization of the link
      *        and trigger the connection establishment
@@ -170,6 +226,13 @@ class NrSlUeProseDirectLink : public Object
         NUM_STATES
     };
 
+    /**
+     * \brief Get the current state of the link
+     *
+     * \return the state of the direct link
+     */
+    DirectLinkState GetState() const;
+
     /**
      * \brief Parameters for the ProSe direct link establishment procedure
      *        to be use by a initiating UE
@@ -201,6 +264,7 @@ class NrSlUeProseDirectLink : public Object
   private:
     // NrSlUeProseDirLink SAPs
     NrSlUeProseDirLnkSapUser* m_nrSlUeProseDirLnkSapUser{nullptr}; ///< ProSe Direct Link SAP user
+    Ptr<NrSlProseStats> m_stats; ///< ProSe counters of the UE, if any
     NrSlUeProseDirLnkSapProvider* m_nrSlUeProseDirLnkSapProvider{
         nullptr}; ///< ProSe Direct Link SAP provider
 
@@ -260,11 +324,16 @@ class NrSlUeProseDirectLink : public Object
     bool m_isRelayConn;  ///< Indicates if the direct link is part of a relay connection
 
     uint32_t m_relayServiceCode; ///< The relay service code associated with this direct link
+    uint32_t m_targetUserInfo{0}; ///< Target of the establishment request, 0 for the peer UE
+    uint32_t m_alternativeRelayL2Id{0}; ///< Alternative relay suggested to the peer UE
+    uint8_t m_establishmentRejectCause{0}; ///< Cause to reject the request being processed
+    uint8_t m_peerReleaseCause{0};       ///< Cause of the release or reject of the peer UE
+    uint32_t m_peerAlternativeRelayL2Id{0}; ///< Alternative relay suggested by the peer UE
 
     DirectLinkState m_state; ///< State of this direct link
 
-    NrPc5SignallingHeaderSequenceNumber m_pc5SigMsgSeqNum; ///< Unique sequence number generator for
-                                                           ///< PC5-S messages to be transmitted
+    NrPc5SignallingHeaderSequenceNumber m_pc5SigMsgSeqNum; ///< Sequence number generator for the
+                                                           ///< PC5-S messages of this link
 
     NrSlUeProseDirLnkSapUser::DirectLinkIpInfo m_ipInfo; ///< IP configuration
 
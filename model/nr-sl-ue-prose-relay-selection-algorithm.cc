@@ -61,6 +61,13 @@ NrSlUeProseRelaySelectionAlgorithm::~NrSlUeProseRelaySelectionAlgorithm()
     NS_LOG_FUNCTION(this);
 }
 
+int64_t
+NrSlUeProseRelaySelectionAlgorithm::AssignStreams(int64_t stream)
+{
+    NS_LOG_FUNCTION(this << stream);
+    return 0;
+}
+
 NS_OBJECT_ENSURE_REGISTERED(NrSlUeProseRelaySelectionAlgorithmFirstAvailable);
 
 TypeId
@@ -200,6 +207,7 @@ NrSlUeProseRelaySelectionAlgorithmMaxRsrp::SelectRelay(
             relay.relayCode = relayIt.relayCode;
             relay.rsrp = relayIt.rsrp;
             relay.eligible = relayIt.eligible;
+            relay.status = relayIt.status;
             found = true;
             NS_LOG_DEBUG("Selection algorithm: found candidate L2Id " << relay.l2Id << " with RSRP "
                                                                       << relay.rsrp);
@@ -73,6 +73,16 @@ class NrSlUeProseRelaySelectionAlgorithm : public Object
     virtual NrSlUeProse::RelayInfo SelectRelay(
         std::vector<NrSlUeProse::RelayInfo> discoveredRelays) = 0;
 
+    /**
+     * \brief Assign a fixed random variable stream number to the random
+     *        variables used by the algorithm
+     *
+     * \param stream first stream index to use
+     * \return the number of stream indices assigned by the algorithm, 0 by
+     *         default for the algorithms not using random variables
+     */
+    virtual int64_t AssignStreams(int64_t stream);
+
 }; // end of NrSlUeProseRelaySelectionAlgorithm
 
 /**
@@ -103,7 +113,7 @@ class NrSlUeProseRelaySelectionAlgorithmRandom : public NrSlUeProseRelaySelectio
     NrSlUeProseRelaySelectionAlgorithmRandom();
     ~NrSlUeProseRelaySelectionAlgorithmRandom() override;
     static TypeId GetTypeId();
-    virtual int64_t AssignStreams(int64_t stream);
+    int64_t AssignStreams(int64_t stream) override;
 
     NrSlUeProse::RelayInfo SelectRelay(
         std::vector<NrSlUeProse::RelayInfo> discoveredRelays) override;
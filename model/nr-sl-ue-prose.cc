@@ -35,10 +35,14 @@
 
 #include "nr-sl-ue-prose.h"
 
+#include "nr-sl-discovery-oracle.h"
 #include "nr-sl-pc5-signalling-header.h"
 #include "nr-sl-ue-prose-relay-selection-algorithm.h"
 
 #include <ns3/abort.h>
+#include <ns3/boolean.h>
+#include <ns3/double.h>
+#include <ns3/enum.h>
 #include <ns3/fatal-error.h>
 #include <ns3/ipv4-l3-protocol.h>
 #include <ns3/log.h>
@@ -51,6 +55,7 @@
 #include <ns3/object-map.h>
 #include <ns3/pointer.h>
 #include <ns3/simulator.h>
+#include <ns3/uinteger.h>
 
 #include <algorithm>
 
@@ -59,12 +64,211 @@ namespace ns3
 
 NS_LOG_COMPONENT_DEFINE("NrSlUeProse");
 NS_OBJECT_ENSURE_REGISTERED(NrSlUeProse);
+NS_OBJECT_ENSURE_REGISTERED(NrSlU2uHopTag);
+NS_OBJECT_ENSURE_REGISTERED(NrSlU2uEndUeTag);
+
+/// Empty table used to iterate over the peers of an application code without discovered peers
+static const NrSlUeProse::DiscoveredPeerMap g_noDiscoveredPeers;
+
+NrSlU2uHopTag::NrSlU2uHopTag()
+    : m_originTime(0),
+      m_hopTime(0),
+      m_hops(0)
+{
+}
+
+void
+NrSlU2uHopTag::SetOriginTime(Time time)
+{
+    m_originTime = time.GetNanoSeconds();
+}
+
+Time
+NrSlU2uHopTag::GetOriginTime() const
+{
+    return NanoSeconds(m_originTime);
+}
+
+void
+NrSlU2uHopTag::SetHopTime(Time time)
+{
+    m_hopTime = time.GetNanoSeconds();
+}
+
+Time
+NrSlU2uHopTag::GetHopTime() const
+{
+    return NanoSeconds(m_hopTime);
+}
+
+void
+NrSlU2uHopTag::SetHops(uint8_t hops)
+{
+    m_hops = hops;
+}
+
+uint8_t
+NrSlU2uHopTag::GetHops() const
+{
+    return m_hops;
+}
+
+TypeId
+NrSlU2uHopTag::GetTypeId(void)
+{
+    static TypeId tid = TypeId("ns3::NrSlU2uHopTag")
+                            .SetParent<Tag>()
+                            .SetGroupName("Nr")
+                            .AddConstructor<NrSlU2uHopTag>();
+    return tid;
+}
+
+TypeId
+NrSlU2uHopTag::GetInstanceTypeId(void) const
+{
+    return GetTypeId();
+}
+
+uint32_t
+NrSlU2uHopTag::GetSerializedSize(void) const
+{
+    return 2 * sizeof(int64_t) + sizeof(uint8_t);
+}
+
+void
+NrSlU2uHopTag::Serialize(TagBuffer i) const
+{
+    i.WriteU64(m_originTime);
+    i.WriteU64(m_hopTime);
+    i.WriteU8(m_hops);
+}
+
+void
+NrSlU2uHopTag::Deserialize(TagBuffer i)
+{
+    m_originTime = i.ReadU64();
+    m_hopTime = i.ReadU64();
+    m_hops = i.ReadU8();
+}
+
+void
+NrSlU2uHopTag::Print(std::ostream& os) const
+{
+    os << "origin=" << m_originTime << "ns hop=" << m_hopTime << "ns hops=" << +m_hops;
+}
+
+/**
+ * \brief Find the hop tag of the last hop of a packet relayed by UE-to-UE relays
+ *
+ * \param packet the packet
+ * \param tag the tag to fill
+ * \return true if the packet has a hop tag
+ */
+static bool
+FindLastU2uHopTag(Ptr<const Packet> packet, NrSlU2uHopTag& tag)
+{
+    bool found = false;
+    ByteTagIterator it = packet->GetByteTagIterator();
+    while (it.HasNext())
+    {
+        ByteTagIterator::Item item = it.Next();
+        if (item.GetTypeId() != NrSlU2uHopTag::GetTypeId())
+        {
+            continue;
+        }
+        NrSlU2uHopTag hopTag;
+        item.GetTag(hopTag);
+        if (!found || hopTag.GetHops() > tag.GetHops())
+        {
+            tag = hopTag;
+            found = true;
+        }
+    }
+    return found;
+}
+
+NrSlU2uEndUeTag::NrSlU2uEndUeTag()
+    : m_l2Id(0),
+      m_addr(Ipv4Address())
+{
+}
+
+void
+NrSlU2uEndUeTag::SetL2Id(uint32_t l2Id)
+{
+    m_l2Id = l2Id;
+}
+
+uint32_t
+NrSlU2uEndUeTag::GetL2Id() const
+{
+    return m_l2Id;
+}
+
+void
+NrSlU2uEndUeTag::SetAddress(Ipv4Address addr)
+{
+    m_addr = addr;
+}
+
+Ipv4Address
+NrSlU2uEndUeTag::GetAddress() const
+{
+    return m_addr;
+}
+
+TypeId
+NrSlU2uEndUeTag::GetTypeId(void)
+{
+    static TypeId tid = TypeId("ns3::NrSlU2uEndUeTag")
+                            .SetParent<Tag>()
+                            .SetGroupName("Nr")
+                            .AddConstructor<NrSlU2uEndUeTag>();
+    return tid;
+}
+
+TypeId
+NrSlU2uEndUeTag::GetInstanceTypeId(void) const
+{
+    return GetTypeId();
+}
+
+uint32_t
+NrSlU2uEndUeTag::GetSerializedSize(void) const
+{
+    return sizeof(uint32_t) + 4;
+}
+
+void
+NrSlU2uEndUeTag::Serialize(TagBuffer i) const
+{
+    i.WriteU32(m_l2Id);
+    uint8_t buf[4];
+    m_addr.Serialize(buf);
+    i.Write(buf, 4);
+}
+
+void
+NrSlU2uEndUeTag::Deserialize(TagBuffer i)
+{
+    m_l2Id = i.ReadU32();
+    uint8_t buf[4];
+    i.Read(buf, 4);
+    m_addr = Ipv4Address::Deserialize(buf);
+}
+
+void
+NrSlU2uEndUeTag::Print(std::ostream& os) const
+{
+    os << "l2Id=" << m_l2Id << " addr=" << m_addr;
+}
 
 NrSlUeProseDirLinkContext::NrSlUeProseDirLinkContext(void)
 {
     NS_LOG_FUNCTION(this);
     m_hasActiveSlDrb = false;
     m_hasPendingSlDrb = false;
+    m_hasU2nRelayDrbs = false;
     m_relayServiceCode = 0;
 }
 
@@ -98,6 +302,130 @@ NrSlUeProse::GetTypeId(void)
                           TimeValue(MilliSeconds(20)), // Magic number; not in standard
                           MakeTimeAccessor(&NrSlUeProse::m_signallingPdb),
                           MakeTimeChecker())
+            .AddAttribute("DiscoveryPriority",
+                          "Default priority of the discovery radio bearers. It can be "
+                          "overridden per application/relay code",
+                          UintegerValue(1),
+                          MakeUintegerAccessor(&NrSlUeProse::m_discoveryPriority),
+                          MakeUintegerChecker<uint8_t>(1, 8))
+            .AddAttribute("DiscoveryPacketDelayBudget",
+                          "Default Packet Delay Budget of the discovery radio bearers. It can be "
+                          "overridden per application/relay code",
+                          TimeValue(MilliSeconds(20)), // Magic number; not in standard
+                          MakeTimeAccessor(&NrSlUeProse::m_discoveryPdb),
+                          MakeTimeChecker())
+            .AddAttribute("DiscoveryAggregationMaxSize",
+                          "Maximum size in bytes of a discovery packet aggregating several "
+                          "discovery messages towards the same destination. Zero disables "
+                          "the aggregation and each message is transmitted in its own packet",
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&NrSlUeProse::m_discoveryAggregationMaxSize),
+                          MakeUintegerChecker<uint32_t>())
+            .AddAttribute("DiscoveryAggregationWindow",
+                          "Time during which the discovery messages towards the same "
+                          "destination, and with the same priority and PDB, are collected "
+                          "before being transmitted in one packet. It is bounded by the PDB of "
+                          "the messages. Zero aggregates only the messages generated at the "
+                          "same time",
+                          TimeValue(Seconds(0)),
+                          MakeTimeAccessor(&NrSlUeProse::m_discoveryAggregationWindow),
+                          MakeTimeChecker())
+            .AddAttribute("DiscoveryDuplicateWindow",
+                          "Time during which a discovery message identical to one already "
+                          "processed (same sender, type, code and status) is suppressed. Zero "
+                          "disables the suppression",
+                          TimeValue(Seconds(0)),
+                          MakeTimeAccessor(&NrSlUeProse::m_discoveryDuplicateWindow),
+                          MakeTimeChecker())
+            .AddAttribute("RelayBackhaulRsrpThreshold",
+                          "Serving cell RSRP (dBm) below which a relay UE with backhaul awareness "
+                          "enabled considers its backhaul as weak",
+                          DoubleValue(-std::numeric_limits<double>::infinity()),
+                          MakeDoubleAccessor(&NrSlUeProse::m_relayBackhaulRsrpThreshold),
+                          MakeDoubleChecker<double>())
+            .AddAttribute("GateRelayAnnouncements",
+                          "If true, a relay UE with backhaul awareness enabled does not transmit "
+                          "relay announcements and responses while its backhaul is weak. "
+                          "Otherwise, they are transmitted with status indicator 0",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&NrSlUeProse::m_gateRelayAnnouncements),
+                          MakeBooleanChecker())
+            .AddAttribute("RelayResponseAggregation",
+                          "If true, a relay UE in Model B answers the solicitations received "
+                          "within a discovery interval with a single response sent to the "
+                          "destination L2 ID of the relay code, instead of one response per "
+                          "solicitor",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&NrSlUeProse::m_relayResponseAggregation),
+                          MakeBooleanChecker())
+            .AddAttribute("U2uDirectPathRsrpThreshold",
+                          "Minimum RSRP (dBm) of an end UE for the direct path to be selected "
+                          "instead of a UE-to-UE relay. Without RSRP measurement of the end UE, "
+                          "the relayed path is used",
+                          DoubleValue(-std::numeric_limits<double>::infinity()),
+                          MakeDoubleAccessor(&NrSlUeProse::m_u2uDirectPathRsrpThreshold),
+                          MakeDoubleChecker<double>())
+            .AddAttribute("RelayMaxRemoteUes",
+                          "Number of connected remote UEs from which a relay UE redirects "
+                          "remote UEs requesting a connection to neighbour relay UEs, as chosen "
+                          "by RelayRedirectionPolicy",
+                          UintegerValue(std::numeric_limits<uint32_t>::max()),
+                          MakeUintegerAccessor(&NrSlUeProse::m_relayMaxRemoteUes),
+                          MakeUintegerChecker<uint32_t>())
+            .AddAttribute("RelayRedirectionPolicy",
+                          "The remote UE a relay UE redirects when a remote UE requests a "
+                          "connection while RelayMaxRemoteUes remote UEs are connected: the "
+                          "requesting one, whose request is rejected, or the one connected for "
+                          "the longest time, which makes room for the requesting one",
+                          EnumValue(NrSlUeProse::RedirectOldest),
+                          MakeEnumAccessor(&NrSlUeProse::m_relayRedirectionPolicy),
+                          MakeEnumChecker(NrSlUeProse::RedirectNewest,
+                                          "RedirectNewest",
+                                          NrSlUeProse::RedirectOldest,
+                                          "RedirectOldest"))
+            .AddAttribute("RelayRedirectionHoldOff",
+                          "Time during which a remote UE redirected by its relay UE does not "
+                          "select this relay UE again",
+                          TimeValue(Seconds(5)), // Magic number; not in standard
+                          MakeTimeAccessor(&NrSlUeProse::m_relayRedirectionHoldOff),
+                          MakeTimeChecker())
+            .AddAttribute("PathSwitchUuRsrpThreshold",
+                          "Serving cell RSRP (dBm) around which a remote UE with path switching "
+                          "enabled switches between its relay UE and the direct Uu path",
+                          DoubleValue(-110.0),
+                          MakeDoubleAccessor(&NrSlUeProse::m_pathSwitchUuRsrpThreshold),
+                          MakeDoubleChecker<double>())
+            .AddAttribute("PathSwitchHysteresis",
+                          "Hysteresis (dB) around PathSwitchUuRsrpThreshold. The remote UE "
+                          "switches to the direct path above the threshold plus the hysteresis "
+                          "and back to the relay path below the threshold minus the hysteresis",
+                          DoubleValue(3.0), // Hysteresis of TS 38.331 ranges from 0 to 15 dB
+                          MakeDoubleAccessor(&NrSlUeProse::m_pathSwitchHysteresis),
+                          MakeDoubleChecker<double>(0.0))
+            .AddAttribute("PathSwitchTimeToTrigger",
+                          "Time during which the condition of a path switch must hold before "
+                          "the remote UE switches",
+                          TimeValue(MilliSeconds(640)), // TimeToTrigger ms640 of TS 38.331
+                          MakeTimeAccessor(&NrSlUeProse::m_pathSwitchTimeToTrigger),
+                          MakeTimeChecker())
+            .AddAttribute("DiscoveredPeerTtl",
+                          "Time after which a peer that was not heard is removed from the "
+                          "discovered peer table. Zero means the peers never expire",
+                          TimeValue(Seconds(5)), // Magic number; not in standard
+                          MakeTimeAccessor(&NrSlUeProse::m_discoveredPeerTtl),
+                          MakeTimeChecker())
+            .AddAttribute("AutoDirectLinkHoldOff",
+                          "Minimum time between two automatic direct link establishment "
+                          "attempts towards the same discovered peer",
+                          TimeValue(Seconds(1)), // Magic number; not in standard
+                          MakeTimeAccessor(&NrSlUeProse::m_autoDirectLinkHoldOff),
+                          MakeTimeChecker())
+            .AddAttribute("AutoDirectLinkMaxLinks",
+                          "Maximum number of direct links above which no more direct links "
+                          "are automatically established",
+                          UintegerValue(std::numeric_limits<uint32_t>::max()),
+                          MakeUintegerAccessor(&NrSlUeProse::m_autoDirectLinkMaxLinks),
+                          MakeUintegerChecker<uint32_t>())
             .AddTraceSource(
                 "PC5SignallingPacketTrace",
                 "Trace fired upon transmission and reception of PC5 Signalling messages",
@@ -107,6 +435,16 @@ NrSlUeProse::GetTypeId(void)
                             "Trace to track the transmission/reception of discovery messages",
                             MakeTraceSourceAccessor(&NrSlUeProse::m_discoveryTrace),
                             "ns3::NrSlUeProse::DiscoveryTracedCallback")
+            .AddTraceSource("DiscoveredPeerTrace",
+                            "Traces when a peer appears in or disappears from the discovered "
+                            "peer table",
+                            MakeTraceSourceAccessor(&NrSlUeProse::m_discoveredPeerTrace),
+                            "ns3::NrSlUeProse::DiscoveredPeerTracedCallback")
+            .AddTraceSource("GroupMemberTrace",
+                            "Traces when a member appears in or disappears from the member "
+                            "table of a discovery group",
+                            MakeTraceSourceAccessor(&NrSlUeProse::m_groupMemberTrace),
+                            "ns3::NrSlUeProse::DiscoveredPeerTracedCallback")
             .AddTraceSource("RelayDiscoveryTrace",
                             "Traces when the Remote UE discovers a new Relay UE.",
                             MakeTraceSourceAccessor(&NrSlUeProse::m_relayDiscoveryTrace),
@@ -119,6 +457,29 @@ NrSlUeProse::GetTypeId(void)
                             "Traces when an RRSP measurement is received.",
                             MakeTraceSourceAccessor(&NrSlUeProse::m_relayRsrpTrace),
                             "ns3::NrSlUeProse::RelayRsrpTracedCallback")
+            .AddTraceSource("U2uRouteSelectionTrace",
+                            "Traces the route selected by an end UE towards another end UE.",
+                            MakeTraceSourceAccessor(&NrSlUeProse::m_u2uRouteSelectionTrace),
+                            "ns3::NrSlUeProse::U2uRouteSelectionTracedCallback")
+            .AddTraceSource("U2uHopLatencyTrace",
+                            "Traces the latency of each hop of the UE-to-UE relayed packets.",
+                            MakeTraceSourceAccessor(&NrSlUeProse::m_u2uHopLatencyTrace),
+                            "ns3::NrSlUeProse::U2uHopLatencyTracedCallback")
+            .AddTraceSource("RelayRedirectionTrace",
+                            "Traces when a relay UE redirects a remote UE to another relay UE.",
+                            MakeTraceSourceAccessor(&NrSlUeProse::m_relayRedirectionTrace),
+                            "ns3::NrSlUeProse::RelayRedirectionTracedCallback")
+            .AddTraceSource("RemotePathSwitchTrace",
+                            "Traces when a remote UE switches between its relay UE and the "
+                            "direct Uu path.",
+                            MakeTraceSourceAccessor(&NrSlUeProse::m_remotePathSwitchTrace),
+                            "ns3::NrSlUeProse::RemotePathSwitchTracedCallback")
+            .AddTraceSource(
+                "RemotePathSwitchInterruptionTrace",
+                "Traces the time between a path switch decision of a remote UE and the "
+                "reconfiguration of its data bearers on the new path.",
+                MakeTraceSourceAccessor(&NrSlUeProse::m_remotePathSwitchInterruptionTrace),
+                "ns3::NrSlUeProse::RemotePathSwitchInterruptionTracedCallback")
 
         ;
     return tid;
@@ -134,6 +495,7 @@ NrSlUeProse::NrSlUeProse()
     m_l2Id = 0;
     m_connectingRelay.l2Id = 0;
     m_currentSelectedRelay.l2Id = 0;
+    m_stats = Create<NrSlProseStats>();
 }
 
 NrSlUeProse::~NrSlUeProse(void)
@@ -145,6 +507,39 @@ void
 NrSlUeProse::DoDispose()
 {
     NS_LOG_FUNCTION(this);
+    for (auto& itCode : m_discoveredPeers)
+    {
+        for (auto& itPeer : itCode.second)
+        {
+            itPeer.second.expiryEvent.Cancel();
+        }
+    }
+    m_discoveredPeers.clear();
+    for (auto& itGroup : m_groupMembers)
+    {
+        for (auto& itMember : itGroup.second)
+        {
+            itMember.second.expiryEvent.Cancel();
+        }
+    }
+    m_groupMembers.clear();
+    for (auto& itBatch : m_aggregatedDiscovery)
+    {
+        itBatch.second.flushEvent.Cancel();
+    }
+    m_aggregatedDiscovery.clear();
+    m_discoveryDuplicateCache.clear();
+    for (auto& itRelay : m_relayMap)
+    {
+        itRelay.second.responseEvent.Cancel();
+    }
+    m_pathSwitchEvent.Cancel();
+    m_u2nRelayScheduler = nullptr;
+    if (m_discoveryOracle)
+    {
+        m_discoveryOracle->RemoveUe(this);
+        m_discoveryOracle = nullptr;
+    }
     delete m_nrSlUeSvcRrcSapUser;
     delete m_nrSlUeSvcNasSapUser;
     delete m_nrSlUeProseDirLnkSapUser;
@@ -185,6 +580,97 @@ NrSlUeProse::SetDiscoveryInterval(Time val)
     m_discoveryInterval = val;
 }
 
+void
+NrSlUeProse::SetDiscoveryTxParameters(DiscoveryCodeType type,
+                                      uint32_t code,
+                                      DiscoveryTxParameters params)
+{
+    NS_LOG_FUNCTION(this << type << code << params.interval << +params.priority << params.pdb);
+
+    NS_ABORT_MSG_IF(params.priority > 8,
+                    "Discovery priority " << +params.priority << " out of range [1, 8]");
+    NS_ABORT_MSG_IF(params.interval.IsStrictlyNegative() || params.pdb.IsStrictlyNegative(),
+                    "Discovery interval and PDB cannot be negative");
+
+    m_discoveryTxParams[std::make_pair(type, code)] = params;
+
+    // Update the code if already registered. The new values are used from the next
+    // transmission onwards
+    std::map<uint32_t, DiscoveryInfo>::iterator it;
+    switch (type)
+    {
+    case ApplicationCode:
+        it = m_discoveryMap.find(code);
+        if (it != m_discoveryMap.end())
+        {
+            it->second.txParams = params;
+        }
+        break;
+    case U2nRelayCode:
+        it = m_relayMap.find(code);
+        if (it != m_relayMap.end())
+        {
+            it->second.txParams = params;
+        }
+        break;
+    case U2uRelayCode:
+        it = m_u2uRelayMap.find(code);
+        if (it != m_u2uRelayMap.end())
+        {
+            it->second.txParams = params;
+        }
+        break;
+    case GroupCode: {
+        auto itGroup = m_groupMap.find(code);
+        if (itGroup != m_groupMap.end())
+        {
+            itGroup->second.txParams = params;
+        }
+        break;
+    }
+    default:
+        NS_FATAL_ERROR("Invalid discovery code type " << type);
+    }
+}
+
+NrSlUeProse::DiscoveryTxParameters
+NrSlUeProse::GetDiscoveryTxParameters(DiscoveryCodeType type, uint32_t code) const
+{
+    NS_LOG_FUNCTION(this << type << code);
+
+    auto it = m_discoveryTxParams.find(std::make_pair(type, code));
+    if (it != m_discoveryTxParams.end())
+    {
+        return it->second;
+    }
+    return DiscoveryTxParameters();
+}
+
+NrSlUeProse::DiscoveryTxParameters
+NrSlUeProse::ResolveDiscoveryTxParameters(const DiscoveryTxParameters& params) const
+{
+    DiscoveryTxParameters resolved = params;
+    if (resolved.interval.IsZero())
+    {
+        resolved.interval = m_discoveryInterval;
+    }
+    if (resolved.priority == 0)
+    {
+        resolved.priority = m_discoveryPriority;
+    }
+    if (resolved.pdb.IsZero())
+    {
+        resolved.pdb = m_discoveryPdb;
+    }
+    return resolved;
+}
+
+Time
+NrSlUeProse::GetDiscoveryInterval(const DiscoveryInfo& info) const
+{
+    return ResolveDiscoveryTxParameters(info.txParams).interval;
+}
+
 void
 NrSlUeProse::DoNotifySvcNrSlDataRadioBearerActivated(uint32_t peerL2Id)
 {
@@ -241,10 +727,17 @@ NrSlUeProse::ConfigureL2IdMonitoringForDiscovery(uint32_t dstL2Id)
     NS_LOG_FUNCTION(this << dstL2Id);
 
     // Tell the RRC to inform the MAC to monitor the UE's own L2Id
-    m_nrSlUeSvcRrcSapProvider->MonitorSelfL2Id();
+    if (!m_monitoringSelfL2Id)
+    {
+        m_nrSlUeSvcRrcSapProvider->MonitorSelfL2Id();
+        m_monitoringSelfL2Id = true;
+    }
 
     // Tell the RRC to inform the MAC to monitor the UE's L2Id
-    m_nrSlUeSvcRrcSapProvider->MonitorL2Id(dstL2Id);
+    if (m_monitoredDiscoveryL2Ids.insert(dstL2Id).second)
+    {
+        m_nrSlUeSvcRrcSapProvider->MonitorL2Id(dstL2Id);
+    }
 }
 
 void
@@ -292,13 +785,15 @@ NrSlUeProse::AddDirectLinkConnection(uint32_t selfL2Id,
         {
             it->second->m_relayServiceCode = relayServiceCode;
         }
+        it->second->m_link->SetTargetUserInfo(GetU2uTargetUserInfo(peerL2Id, relayServiceCode));
         // reset link
         it->second->m_link->ResetCurrentLink();
     }
     else
     {
         NS_LOG_INFO("New direct link " << selfL2Id << " <--> " << peerL2Id);
-        if (isRelayConn && !isInitiating) // Relay UE
+        if (isRelayConn && !isInitiating &&
+            m_u2uRelayMap.find(relayServiceCode) == m_u2uRelayMap.end()) // Relay UE
         {
             auto it = m_l3U2nRelayProvidedSvcs.find(relayServiceCode);
             if (it == m_l3U2nRelayProvidedSvcs.end())
@@ -324,6 +819,7 @@ NrSlUeProse::AddDirectLinkConnection(uint32_t selfL2Id,
 
         // Connect SAPs
         link->SetNrSlUeProseDirLnkSapUser(GetNrSlUeProseDirLnkSapUser());
+        link->SetProseStats(m_stats);
 
         context->m_link = link;
         context->m_nrSlUeProseDirLnkSapProvider = link->GetNrSlUeProseDirLnkSapProvider();
@@ -339,6 +835,9 @@ NrSlUeProse::AddDirectLinkConnection(uint32_t selfL2Id,
         m_unicastDirectLinks.insert(
             std::pair<uint32_t, Ptr<NrSlUeProseDirLinkContext>>(peerL2Id, context));
 
+        // Signal the end UE on the other side of a UE-to-UE relay link
+        link->SetTargetUserInfo(GetU2uTargetUserInfo(peerL2Id, relayServiceCode));
+
         // Initiate connection establishment procedure if this UE is the initiating UE
         if (isInitiating)
         {
@@ -390,6 +889,21 @@ NrSlUeProse::DoSendNrSlPc5SMessage(Ptr<Packet> packet, uint32_t dstL2Id, uint8_t
         }
     }
     m_pc5SignallingPacketTrace(m_l2Id, dstL2Id, true, packet);
+    NrSlPc5SignallingMessageType pc5smt;
+    packet->PeekHeader(pc5smt);
+    m_stats->NotifyPc5SignallingTx(pc5smt.GetMessageType());
+
+    // Signal the source end UE to the target end UE of a UE-to-UE relay hop
+    auto itTarget = m_u2uLinkTargets.find(dstL2Id);
+    if (itTarget != m_u2uLinkTargets.end() && itTarget->second.relayedIp != Ipv4Address() &&
+        pc5smt.GetMessageType() ==
+            NrSlPc5SignallingMessageType::ProseDirectLinkEstablishmentRequest)
+    {
+        NrSlU2uEndUeTag endUeTag;
+        endUeTag.SetL2Id(itTarget->second.l2Id);
+        endUeTag.SetAddress(itTarget->second.relayedIp);
+        packet->AddPacketTag(endUeTag);
+    }
 
     // Pass the message to the RRC
     m_nrSlUeSvcRrcSapProvider->SendNrSlSignalling(packet, dstL2Id, lcId);
@@ -404,9 +918,14 @@ NrSlUeProse::AddDiscoveryApp(uint32_t appCode, uint32_t dstL2Id, DiscoveryRole r
     info.role = role;
     info.appCode = appCode;
     info.dstL2Id = dstL2Id;
+    info.txParams = GetDiscoveryTxParameters(ApplicationCode, appCode);
 
     NS_LOG_DEBUG("Adding app code");
-    m_discoveryMap.insert(std::pair<uint32_t, DiscoveryInfo>(appCode, info));
+    if (m_discoveryMap.insert(std::pair<uint32_t, DiscoveryInfo>(appCode, info)).second &&
+        IsReceivingRole(ApplicationCode, ModelA, role))
+    {
+        m_nListeningCodesPerRole[role]++;
+    }
 
     if (role == Announcing || role == Discoverer)
     {
@@ -429,6 +948,11 @@ NrSlUeProse::RemoveDiscoveryApp(uint32_t appCode, DiscoveryRole role)
         // found app to remove
         NS_LOG_DEBUG("Removing app code");
         m_discoveryMap.erase(itInfo);
+        if (IsReceivingRole(ApplicationCode, ModelA, role))
+        {
+            m_nListeningCodesPerRole[role]--;
+        }
+        ClearDiscoveredPeers(appCode);
     }
 }
 
@@ -469,7 +993,7 @@ NrSlUeProse::SendDiscovery(uint32_t appCode, uint32_t dstL2Id)
             discHeader.SetOpenDiscoveryAnnounceParameters(appCode);
 
             // reschedule
-            Simulator::Schedule(m_discoveryInterval,
+            Simulator::Schedule(GetDiscoveryInterval(it->second),
                                 &NrSlUeProse::SendDiscovery,
                                 this,
                                 appCode,
@@ -480,7 +1004,7 @@ NrSlUeProse::SendDiscovery(uint32_t appCode, uint32_t dstL2Id)
             discHeader.SetRestrictedDiscoveryQueryParameters(appCode);
 
             // reschedule
-            Simulator::Schedule(m_discoveryInterval,
+            Simulator::Schedule(GetDiscoveryInterval(it->second),
                                 &NrSlUeProse::SendDiscovery,
                                 this,
                                 appCode,
@@ -494,12 +1018,7 @@ NrSlUeProse::SendDiscovery(uint32_t appCode, uint32_t dstL2Id)
             // no reschedule
         }
 
-        // build message to transmit
-        Ptr<Packet> discoveryPacket = Create<Packet>();
-        discoveryPacket->AddHeader(discHeader);
-
-        DoSendNrSlDiscovery(discoveryPacket, dstL2Id);
-        m_discoveryTrace(m_l2Id, dstL2Id, true, discHeader);
+        TransmitDiscovery(discHeader, dstL2Id, it->second.txParams);
     }
 }
 
@@ -518,8 +1037,13 @@ NrSlUeProse::AddRelayDiscovery(uint32_t relayCode,
     info.role = role;
     info.appCode = relayCode;
     info.dstL2Id = dstL2Id;
+    info.txParams = GetDiscoveryTxParameters(U2nRelayCode, relayCode);
 
     m_relayMap.insert(std::pair<uint32_t, DiscoveryInfo>(relayCode, info));
+    if (IsReceivingRole(U2nRelayCode, model, role))
+    {
+        m_nListeningCodesPerRole[role]++;
+    }
 
     if ((model == ModelA && role == RelayUE) || (model == ModelB && role == RemoteUE))
     {
@@ -531,6 +1055,24 @@ NrSlUeProse::AddRelayDiscovery(uint32_t relayCode,
     ConfigureL2IdMonitoringForDiscovery(dstL2Id);
 }
 
+void
+NrSlUeProse::AddRelayDiscoveryCodes(const std::map<uint32_t, uint32_t>& relayCodes,
+                                    DiscoveryModel model,
+                                    DiscoveryRole role)
+{
+    NS_LOG_FUNCTION(this << relayCodes.size() << model << role);
+
+    for (const auto& itCode : relayCodes)
+    {
+        if (m_relayMap.find(itCode.first) != m_relayMap.end())
+        {
+            NS_LOG_DEBUG("Relay code " << itCode.first << " already added");
+            continue;
+        }
+        AddRelayDiscovery(itCode.first, itCode.second, model, role);
+    }
+}
+
 void
 NrSlUeProse::RemoveRelayDiscovery(uint32_t relayCode, DiscoveryRole role)
 {
@@ -540,6 +1082,11 @@ NrSlUeProse::RemoveRelayDiscovery(uint32_t relayCode, DiscoveryRole role)
     if (itCode != m_relayMap.end())
     {
         NS_ASSERT_MSG(itCode->second.role == role, "Wrong role.");
+        itCode->second.responseEvent.Cancel();
+        if (IsReceivingRole(U2nRelayCode, itCode->second.model, role))
+        {
+            m_nListeningCodesPerRole[role]--;
+        }
         m_relayMap.erase(itCode);
     }
 }
@@ -576,11 +1123,12 @@ NrSlUeProse::SendRelayDiscovery(uint32_t relayCode, uint32_t dstL2Id)
         // build message to transmit
         NrSlDiscoveryHeader discHeader;
 
+        uint8_t status = HasRelayBackhaul() ? 1 : 0;
         if (it->second.model == ModelA && it->second.role == RelayUE)
         {
-            discHeader.SetRelayAnnouncementParameters(relayCode, m_imsi, m_l2Id, 1);
+            discHeader.SetRelayAnnouncementParameters(relayCode, m_imsi, m_l2Id, status);
             // reschedule
-            Simulator::Schedule(m_discoveryInterval,
+            Simulator::Schedule(GetDiscoveryInterval(it->second),
                                 &NrSlUeProse::SendRelayDiscovery,
                                 this,
                                 relayCode,
@@ -591,7 +1139,7 @@ NrSlUeProse::SendRelayDiscovery(uint32_t relayCode, uint32_t dstL2Id)
         {
             discHeader.SetRelaySoliciationParameters(relayCode, m_imsi, m_l2Id);
             // reschedule
-            Simulator::Schedule(m_discoveryInterval,
+            Simulator::Schedule(GetDiscoveryInterval(it->second),
                                 &NrSlUeProse::SendRelayDiscovery,
                                 this,
                                 relayCode,
@@ -600,64 +1148,925 @@ NrSlUeProse::SendRelayDiscovery(uint32_t relayCode, uint32_t dstL2Id)
 
         else if (it->second.model == ModelB && it->second.role == RelayUE)
         {
-            discHeader.SetRelayResponseParameters(relayCode, m_imsi, m_l2Id, 1);
+            discHeader.SetRelayResponseParameters(relayCode, m_imsi, m_l2Id, status);
             // no reschedule
         }
 
+        if (it->second.role == RelayUE && status == 0 && m_gateRelayAnnouncements)
+        {
+            NS_LOG_LOGIC("Relay " << m_l2Id << " does not announce code " << relayCode
+                                  << " due to weak backhaul");
+            return;
+        }
+
         // send
-        Ptr<Packet> discoveryPacket = Create<Packet>();
-        discoveryPacket->AddHeader(discHeader);
-        DoSendNrSlDiscovery(discoveryPacket, dstL2Id);
-        m_discoveryTrace(m_l2Id, dstL2Id, true, discHeader);
+        TransmitDiscovery(discHeader, dstL2Id, it->second.txParams);
     }
 }
 
 void
-NrSlUeProse::DoSendNrSlDiscovery(Ptr<Packet> packet, uint32_t dstL2Id)
+NrSlUeProse::RespondToRelaySolicitation(uint32_t relayCode, uint32_t srcL2Id)
 {
-    NS_LOG_FUNCTION(this << packet << dstL2Id);
+    NS_LOG_FUNCTION(this << relayCode << srcL2Id);
 
-    // Activate the corresponding SL Discovery RB for the logical channel, if not active
-    auto it = std::find(m_activeSlDiscoveryRbs.begin(), m_activeSlDiscoveryRbs.end(), dstL2Id);
-    if (it == m_activeSlDiscoveryRbs.end()) // First SL Discovery RB for this destination
+    if (!m_relayResponseAggregation)
     {
-        // Instruct the RRC to activate the SL Disocvery RB
-        m_nrSlUeSvcRrcSapProvider->ActivateNrSlDiscoveryRadioBearer(dstL2Id);
+        SendRelayDiscovery(relayCode, srcL2Id);
+        return;
+    }
 
-        // Keep track of it
-        m_activeSlDiscoveryRbs.push_front(dstL2Id);
+    auto it = m_relayMap.find(relayCode);
+    if (it == m_relayMap.end())
+    {
+        return;
+    }
+    if (it->second.responseEvent.IsRunning())
+    {
+        // A response was already sent in this interval, the solicitor will be
+        // covered by the next one
+        it->second.responsePending = true;
+        return;
     }
+    SendRelayDiscovery(relayCode, it->second.dstL2Id);
+    it->second.responseEvent = Simulator::Schedule(GetDiscoveryInterval(it->second),
+                                                   &NrSlUeProse::RelayResponseIntervalExpiry,
+                                                   this,
+                                                   relayCode);
+}
 
-    // Pass the message to the RRC
-    NS_LOG_INFO("Discovery message sent by " << m_l2Id << " to " << dstL2Id);
-    m_nrSlUeSvcRrcSapProvider->SendNrSlDiscovery(packet, dstL2Id);
+void
+NrSlUeProse::RelayResponseIntervalExpiry(uint32_t relayCode)
+{
+    NS_LOG_FUNCTION(this << relayCode);
+
+    auto it = m_relayMap.find(relayCode);
+    if (it == m_relayMap.end() || !it->second.responsePending)
+    {
+        return;
+    }
+    it->second.responsePending = false;
+    SendRelayDiscovery(relayCode, it->second.dstL2Id);
+    it->second.responseEvent = Simulator::Schedule(GetDiscoveryInterval(it->second),
+                                                   &NrSlUeProse::RelayResponseIntervalExpiry,
+                                                   this,
+                                                   relayCode);
 }
 
 void
-NrSlUeProse::DoReceiveNrSlDiscovery(Ptr<Packet> packet, uint32_t srcL2Id)
+NrSlUeProse::AddU2uRelayDiscovery(uint32_t relayCode,
+                                  uint32_t dstL2Id,
+                                  DiscoveryModel model,
+                                  DiscoveryRole role)
 {
-    NS_LOG_FUNCTION(this << packet << srcL2Id);
-    NrSlDiscoveryHeader discHeader;
-    packet->RemoveHeader(discHeader);
+    NS_LOG_FUNCTION(this << relayCode << dstL2Id << model << role);
+    NS_ABORT_MSG_IF(role != RelayUE && role != RemoteUE,
+                    "Invalid role for UE-to-UE relay discovery");
+    NS_ABORT_MSG_IF(m_relayMap.find(relayCode) != m_relayMap.end(),
+                    "Relay code " << relayCode << " is already used for UE-to-Network relay");
+    NS_ASSERT_MSG(m_u2uRelayMap.find(relayCode) == m_u2uRelayMap.end(),
+                  "Cannot add already existing service " << relayCode);
 
-    uint8_t msgType = discHeader.GetDiscoveryMsgType();
+    DiscoveryInfo info;
+    info.model = model;
+    info.role = role;
+    info.appCode = relayCode;
+    info.dstL2Id = dstL2Id;
+    info.txParams = GetDiscoveryTxParameters(U2uRelayCode, relayCode);
 
-    // Discovery
-    if (msgType == NrSlDiscoveryHeader::DISC_OPEN_ANNOUNCEMENT ||
-        msgType == NrSlDiscoveryHeader::DISC_RESTRICTED_QUERY ||
-        msgType == NrSlDiscoveryHeader::DISC_RESTRICTED_RESPONSE)
+    m_u2uRelayMap.emplace(relayCode, info);
+    if (IsReceivingRole(U2uRelayCode, model, role))
     {
-        uint32_t appCode = discHeader.GetApplicationCode();
-
-        // open or restricted announcement
-        if (IsMonitoringApp(msgType, appCode))
-        {
-            // Check if this is a request I am interested in
-            std::map<uint32_t, DiscoveryInfo>::iterator itInfo = m_discoveryMap.find(appCode);
-            if (itInfo != m_discoveryMap.end())
-            {
-                NS_LOG_INFO("Discovery message received by " << m_l2Id << " from " << srcL2Id);
-                m_discoveryTrace(srcL2Id, m_l2Id, false, discHeader);
+        m_nListeningCodesPerRole[role]++;
+    }
+
+    if ((model == ModelA && role == RelayUE) || (model == ModelB && role == RemoteUE))
+    {
+        SendU2uRelayDiscovery(relayCode, dstL2Id);
+    }
+
+    // It instructs the MAC layer (and PHY therefore) to monitor packets directed the UE's own and
+    // other Layer 2 IDs
+    ConfigureL2IdMonitoringForDiscovery(dstL2Id);
+}
+
+void
+NrSlUeProse::RemoveU2uRelayDiscovery(uint32_t relayCode, DiscoveryRole role)
+{
+    NS_LOG_FUNCTION(this << relayCode << role);
+    auto it = m_u2uRelayMap.find(relayCode);
+    if (it != m_u2uRelayMap.end())
+    {
+        NS_ASSERT_MSG(it->second.role == role, "Wrong role.");
+        if (IsReceivingRole(U2uRelayCode, it->second.model, role))
+        {
+            m_nListeningCodesPerRole[role]--;
+        }
+        m_u2uRelayMap.erase(it);
+        m_u2uReachableUes.erase(relayCode);
+    }
+}
+
+bool
+NrSlUeProse::IsMonitoringU2uRelay(uint8_t msgType, uint32_t relayCode)
+{
+    NS_LOG_FUNCTION(this << msgType << relayCode);
+    auto it = m_u2uRelayMap.find(relayCode);
+    if (it != m_u2uRelayMap.end())
+    {
+        return ((msgType == NrSlDiscoveryHeader::DISC_U2U_RELAY_ANNOUNCEMENT &&
+                 it->second.model == ModelA && it->second.role == RemoteUE) ||
+                (msgType == NrSlDiscoveryHeader::DISC_U2U_RELAY_SOLICITATION &&
+                 it->second.model == ModelB && it->second.role == RelayUE) ||
+                (msgType == NrSlDiscoveryHeader::DISC_U2U_RELAY_RESPONSE &&
+                 it->second.model == ModelB && it->second.role == RemoteUE));
+    }
+    return false;
+}
+
+void
+NrSlUeProse::SendU2uRelayDiscovery(uint32_t relayCode, uint32_t dstL2Id)
+{
+    NS_LOG_FUNCTION(this << relayCode << dstL2Id);
+
+    auto it = m_u2uRelayMap.find(relayCode);
+    if (it == m_u2uRelayMap.end())
+    {
+        return;
+    }
+
+    if (it->second.role == RemoteUE)
+    {
+        if (it->second.model == ModelB)
+        {
+            NrSlDiscoveryHeader discHeader;
+            discHeader.SetU2uRelaySolicitationParameters(relayCode, m_imsi, 0);
+            TransmitDiscovery(discHeader, dstL2Id, it->second.txParams);
+            // reschedule
+            Simulator::Schedule(GetDiscoveryInterval(it->second),
+                                &NrSlUeProse::SendU2uRelayDiscovery,
+                                this,
+                                relayCode,
+                                dstL2Id);
+        }
+        return;
+    }
+
+    // Relay UE: one message per reachable end UE, which are aggregated if
+    // enabled, or a single one announcing no specific end UE
+    std::vector<uint32_t> targets;
+    for (uint32_t l2Id : GetU2uReachableUes(relayCode))
+    {
+        // A Model B response does not announce the solicitor to itself
+        if (it->second.model == ModelA || l2Id != dstL2Id)
+        {
+            targets.push_back(l2Id);
+        }
+    }
+    if (targets.empty())
+    {
+        targets.push_back(0);
+    }
+    for (uint32_t target : targets)
+    {
+        NrSlDiscoveryHeader discHeader;
+        if (it->second.model == ModelA)
+        {
+            discHeader.SetU2uRelayAnnouncementParameters(relayCode, m_imsi, m_l2Id, target);
+        }
+        else
+        {
+            discHeader.SetU2uRelayResponseParameters(relayCode, m_imsi, m_l2Id, target);
+        }
+        TransmitDiscovery(discHeader, dstL2Id, it->second.txParams);
+    }
+
+    if (it->second.model == ModelA)
+    {
+        // reschedule
+        Simulator::Schedule(GetDiscoveryInterval(it->second),
+                            &NrSlUeProse::SendU2uRelayDiscovery,
+                            this,
+                            relayCode,
+                            dstL2Id);
+    }
+}
+
+std::vector<uint32_t>
+NrSlUeProse::GetU2uReachableUes(uint32_t relayCode)
+{
+    NS_LOG_FUNCTION(this << relayCode);
+
+    std::vector<uint32_t> reachable;
+    auto itCode = m_u2uReachableUes.find(relayCode);
+    if (itCode == m_u2uReachableUes.end())
+    {
+        return reachable;
+    }
+    for (auto it = itCode->second.begin(); it != itCode->second.end();)
+    {
+        // The end UEs with a direct link with the relay remain reachable
+        bool linked = m_u2uLinkTargets.find(it->first) != m_u2uLinkTargets.end();
+        if (!linked && m_discoveredPeerTtl.IsStrictlyPositive() &&
+            Simulator::Now() - it->second > m_discoveredPeerTtl)
+        {
+            it = itCode->second.erase(it);
+            continue;
+        }
+        reachable.push_back(it->first);
+        ++it;
+    }
+    return reachable;
+}
+
+NrSlUeProse::RelayInfo
+NrSlUeProse::SelectU2uRoute(uint32_t targetL2Id)
+{
+    NS_LOG_FUNCTION(this << targetL2Id);
+
+    RelayInfo nextHop;
+    auto itTarget = m_rsrpMeasurementsMap.find(targetL2Id);
+    if (itTarget != m_rsrpMeasurementsMap.end() &&
+        itTarget->second.first >= m_u2uDirectPathRsrpThreshold)
+    {
+        nextHop.l2Id = targetL2Id;
+        nextHop.relayCode = 0;
+        nextHop.rsrp = itTarget->second.first;
+        nextHop.eligible = true;
+    }
+    else
+    {
+        // Relays announcing the target first, then the ones announcing no specific end UE
+        for (uint32_t announced : {targetL2Id, static_cast<uint32_t>(0)})
+        {
+            auto itRoutes = m_u2uRoutes.find(announced);
+            if (itRoutes == m_u2uRoutes.end())
+            {
+                continue;
+            }
+            for (auto it = itRoutes->second.begin(); it != itRoutes->second.end();)
+            {
+                if (m_discoveredPeerTtl.IsStrictlyPositive() &&
+                    Simulator::Now() - it->second.lastHeard > m_discoveredPeerTtl)
+                {
+                    it = itRoutes->second.erase(it);
+                    continue;
+                }
+                double rsrp = FindRsrpMeasurement(it->first).first;
+                if (nextHop.l2Id == std::numeric_limits<uint32_t>::max() || rsrp > nextHop.rsrp)
+                {
+                    nextHop.l2Id = it->first;
+                    nextHop.relayCode = it->second.relayCode;
+                    nextHop.rsrp = rsrp;
+                    nextHop.eligible = true;
+                }
+                ++it;
+            }
+            if (nextHop.eligible)
+            {
+                break;
+            }
+        }
+    }
+
+    if (nextHop.eligible)
+    {
+        NS_LOG_INFO("UE " << m_l2Id << " reaches " << targetL2Id << " through " << nextHop.l2Id);
+        m_u2uRouteSelectionTrace(m_l2Id, targetL2Id, nextHop.l2Id, nextHop.rsrp);
+    }
+    return nextHop;
+}
+
+void
+NrSlUeProse::ConnectToU2uTarget(uint32_t targetL2Id,
+                                Ipv4Address targetIp,
+                                const struct SidelinkInfo& slInfo)
+{
+    NS_LOG_FUNCTION(this << targetL2Id << targetIp);
+    NS_ABORT_MSG_IF(m_ueDevice == nullptr, "The net device of the UE is not set");
+
+    RelayInfo nextHop = SelectU2uRoute(targetL2Id);
+    if (!nextHop.eligible)
+    {
+        NS_LOG_INFO("No route from " << m_l2Id << " to " << targetL2Id);
+        return;
+    }
+
+    Ipv4Address selfIp =
+        m_ueDevice->GetNode()->GetObject<Ipv4L3Protocol>()->GetAddress(1, 0).GetLocal();
+    SidelinkInfo linkSlInfo = slInfo;
+    linkSlInfo.m_castType = SidelinkInfo::CastType::Unicast;
+    linkSlInfo.m_srcL2Id = m_l2Id;
+    linkSlInfo.m_dstL2Id = nextHop.l2Id;
+
+    if (nextHop.l2Id == targetL2Id)
+    {
+        AddDirectLinkConnection(m_l2Id, selfIp, targetL2Id, true, 0, linkSlInfo);
+    }
+    else
+    {
+        U2uLinkTarget target;
+        target.l2Id = targetL2Id;
+        target.ip = targetIp;
+        m_u2uLinkTargets[nextHop.l2Id] = target;
+        AddDirectLinkConnection(m_l2Id, selfIp, nextHop.l2Id, true, nextHop.relayCode, linkSlInfo);
+    }
+}
+
+uint32_t
+NrSlUeProse::GetU2uTargetUserInfo(uint32_t peerL2Id, uint32_t relayCode)
+{
+    NS_LOG_FUNCTION(this << peerL2Id << relayCode);
+
+    // Only the source end UE targets a UE other than the peer (the relay UE).
+    // The relay UE targets the peer (the target end UE) and signals the
+    // source end UE separately (see DoSendNrSlPc5SMessage)
+    auto itCode = m_u2uRelayMap.find(relayCode);
+    auto itTarget = m_u2uLinkTargets.find(peerL2Id);
+    if (relayCode == 0 || itCode == m_u2uRelayMap.end() || itCode->second.role != RemoteUE ||
+        itTarget == m_u2uLinkTargets.end())
+    {
+        return 0;
+    }
+    return itTarget->second.l2Id;
+}
+
+void
+NrSlUeProse::ConfigureU2uRelayHop(uint32_t peerL2Id,
+                                  uint32_t relayCode,
+                                  NrSlUeProseDirLnkSapUser::DirectLinkIpInfo ipInfo,
+                                  const struct SidelinkInfo& slInfo)
+{
+    NS_LOG_FUNCTION(this << peerL2Id << relayCode << ipInfo.peerIpv4Addr);
+
+    EnableU2uRelayIpHooks();
+
+    auto itCode = m_u2uRelayMap.find(relayCode);
+    NS_ASSERT_MSG(itCode != m_u2uRelayMap.end(), "Unknown UE-to-UE relay code " << relayCode);
+    auto itTarget = m_u2uLinkTargets.find(peerL2Id);
+
+    if (itCode->second.role == RemoteUE)
+    {
+        // End UE: the SL-DRB with the relay carries the traffic towards the
+        // end UE on the other side, whose address is known by the source end
+        // UE and is the one signalled by the relay UE for the target end UE
+        if (itTarget != m_u2uLinkTargets.end() && itTarget->second.ip != Ipv4Address())
+        {
+            ipInfo.peerIpv4Addr = itTarget->second.ip;
+        }
+        m_u2uTargetIps.insert(ipInfo.peerIpv4Addr);
+        NS_LOG_INFO("Traffic to " << ipInfo.peerIpv4Addr << " goes through relay " << peerL2Id);
+        ActivateDirectLinkDataRadioBearer(peerL2Id, ipInfo);
+        return;
+    }
+
+    // Relay UE: each hop has its own SL-DRB towards the end UE, and the
+    // packets are forwarded between them by the IP layer
+    m_u2uReachableUes[relayCode][peerL2Id] = Simulator::Now();
+    ActivateDirectLinkDataRadioBearer(peerL2Id, ipInfo);
+
+    if (itTarget == m_u2uLinkTargets.end())
+    {
+        return;
+    }
+    uint32_t targetL2Id = itTarget->second.l2Id;
+    auto itSource = m_u2uLinkTargets.find(targetL2Id);
+    if (itSource != m_u2uLinkTargets.end() && itSource->second.l2Id == peerL2Id)
+    {
+        NS_LOG_INFO("Relay " << m_l2Id << " already connects " << peerL2Id << " to "
+                             << targetL2Id);
+        return;
+    }
+
+    // Establish the second hop. The relay UE uses its own address in the
+    // link, and signals the source end UE to the target end UE in the
+    // establishment request (see DoSendNrSlPc5SMessage), so that the target
+    // end UE routes its traffic for the source end UE through the relay.
+    // If a link with the target end UE already exists, the establishment
+    // procedure is run again on it (see AddDirectLinkConnection), as the
+    // target UE processes a new request on an existing link (TS 24.554
+    // section 7.2.2.6.2)
+    NS_LOG_INFO("Relay " << m_l2Id << " connects " << peerL2Id << " to " << targetL2Id);
+    Ipv4Address selfIp =
+        m_ueDevice->GetNode()->GetObject<Ipv4L3Protocol>()->GetAddress(1, 0).GetLocal();
+    U2uLinkTarget source;
+    source.l2Id = peerL2Id;
+    source.relayedIp = ipInfo.peerIpv4Addr;
+    m_u2uLinkTargets[targetL2Id] = source;
+    SidelinkInfo hopSlInfo = slInfo;
+    hopSlInfo.m_srcL2Id = m_l2Id;
+    hopSlInfo.m_dstL2Id = targetL2Id;
+    AddDirectLinkConnection(m_l2Id, selfIp, targetL2Id, true, relayCode, hopSlInfo);
+}
+
+void
+NrSlUeProse::EnableU2uRelayIpHooks()
+{
+    NS_LOG_FUNCTION(this);
+
+    if (m_u2uRelayIpHooks)
+    {
+        return;
+    }
+    m_u2uRelayIpHooks = true;
+
+    Ptr<Ipv4L3Protocol> ipv4 = m_ueDevice->GetNode()->GetObject<Ipv4L3Protocol>();
+    NS_ABORT_MSG_IF(ipv4 == nullptr, "UE-to-UE relaying requires an IPv4 stack");
+    int32_t interface = ipv4->GetInterfaceForDevice(m_ueDevice);
+    NS_ABORT_MSG_IF(interface < 0, "The net device of the UE has no IPv4 interface");
+    // The relayed packets go in and out through the same interface
+    ipv4->SetForwarding(interface, true);
+
+    ipv4->TraceConnectWithoutContext("SendOutgoing",
+                                     MakeCallback(&NrSlUeProse::U2uIpSendOutgoing, this));
+    ipv4->TraceConnectWithoutContext("UnicastForward",
+                                     MakeCallback(&NrSlUeProse::U2uIpUnicastForward, this));
+    ipv4->TraceConnectWithoutContext("LocalDeliver",
+                                     MakeCallback(&NrSlUeProse::U2uIpLocalDeliver, this));
+}
+
+void
+NrSlUeProse::U2uIpSendOutgoing(const Ipv4Header& header, Ptr<const Packet> packet, uint32_t)
+{
+    if (m_u2uTargetIps.find(header.GetDestination()) == m_u2uTargetIps.end())
+    {
+        return;
+    }
+    NrSlU2uHopTag tag;
+    tag.SetOriginTime(Simulator::Now());
+    tag.SetHopTime(Simulator::Now());
+    packet->AddByteTag(tag);
+}
+
+void
+NrSlUeProse::U2uIpUnicastForward(const Ipv4Header& header, Ptr<const Packet> packet, uint32_t)
+{
+    NrSlU2uHopTag tag;
+    if (!FindLastU2uHopTag(packet, tag))
+    {
+        return;
+    }
+    uint8_t hop = tag.GetHops() + 1;
+    m_u2uHopLatencyTrace(m_l2Id,
+                         header.GetSource(),
+                         header.GetDestination(),
+                         hop,
+                         Simulator::Now() - tag.GetHopTime(),
+                         Simulator::Now() - tag.GetOriginTime());
+    // Restart the measurement for the next hop. The forwarded packet is not
+    // ours to modify, so the tag of the next hop is added next to the one of
+    // the previous hop, and FindLastU2uHopTag returns the one with most hops
+    tag.SetHopTime(Simulator::Now());
+    tag.SetHops(hop);
+    packet->AddByteTag(tag);
+}
+
+void
+NrSlUeProse::U2uIpLocalDeliver(const Ipv4Header& header, Ptr<const Packet> packet, uint32_t)
+{
+    NrSlU2uHopTag tag;
+    if (!FindLastU2uHopTag(packet, tag))
+    {
+        return;
+    }
+    m_u2uHopLatencyTrace(m_l2Id,
+                         header.GetSource(),
+                         header.GetDestination(),
+                         tag.GetHops() + 1,
+                         Simulator::Now() - tag.GetHopTime(),
+                         Simulator::Now() - tag.GetOriginTime());
+}
+
+void
+NrSlUeProse::AddGroupDiscovery(uint32_t groupId,
+                               uint32_t dstL2Id,
+                               DiscoveryModel model,
+                               DiscoveryRole role)
+{
+    NS_LOG_FUNCTION(this << groupId << dstL2Id << model << role);
+    NS_ABORT_MSG_IF(groupId > 0xFFFFFF, "Group ID " << groupId << " exceeds 24 bits");
+    NS_ABORT_MSG_IF(model == ModelA && role != Announcing && role != Monitoring,
+                    "Invalid role for group member discovery Model A");
+    NS_ABORT_MSG_IF(model == ModelB && role != Discoverer && role != Discoveree,
+                    "Invalid role for group member discovery Model B");
+    NS_ASSERT_MSG(m_groupMap.find(groupId) == m_groupMap.end(),
+                  "Cannot add already existing group " << groupId);
+
+    DiscoveryInfo info;
+    info.model = model;
+    info.role = role;
+    info.appCode = groupId;
+    info.dstL2Id = dstL2Id;
+    info.txParams = GetDiscoveryTxParameters(GroupCode, groupId);
+
+    m_groupMap.emplace(groupId, info);
+    if (IsReceivingRole(GroupCode, model, role))
+    {
+        m_nListeningCodesPerRole[role]++;
+    }
+
+    if (role == Announcing || role == Discoverer)
+    {
+        SendGroupDiscovery(groupId, dstL2Id);
+    }
+
+    // It instructs the MAC layer (and PHY therefore) to monitor packets directed the UE's own and
+    // other Layer 2 IDs
+    ConfigureL2IdMonitoringForDiscovery(dstL2Id);
+}
+
+void
+NrSlUeProse::RemoveGroupDiscovery(uint32_t groupId, DiscoveryRole role)
+{
+    NS_LOG_FUNCTION(this << groupId << role);
+    auto it = m_groupMap.find(groupId);
+    if (it != m_groupMap.end())
+    {
+        NS_ASSERT_MSG(it->second.role == role, "Wrong role.");
+        if (IsReceivingRole(GroupCode, it->second.model, role))
+        {
+            m_nListeningCodesPerRole[role]--;
+        }
+        m_groupMap.erase(it);
+
+        auto itMembers = m_groupMembers.find(groupId);
+        if (itMembers != m_groupMembers.end())
+        {
+            // Move the members out first, so the trace sinks see a consistent table
+            DiscoveredPeerMap members = std::move(itMembers->second);
+            m_groupMembers.erase(itMembers);
+            for (auto& itMember : members)
+            {
+                itMember.second.expiryEvent.Cancel();
+                m_groupMemberTrace(m_l2Id, groupId, itMember.first, false);
+            }
+        }
+    }
+}
+
+bool
+NrSlUeProse::IsMonitoringGroup(uint8_t msgType, uint32_t groupId)
+{
+    NS_LOG_FUNCTION(this << msgType << groupId);
+    // the announcing members also monitor the announcements of the other members
+    auto it = m_groupMap.find(groupId);
+    if (it != m_groupMap.end())
+    {
+        return ((msgType == NrSlDiscoveryHeader::DISC_GROUP_ANNOUNCEMENT &&
+                 (it->second.role == Monitoring || it->second.role == Announcing)) ||
+                (msgType == NrSlDiscoveryHeader::DISC_GROUP_SOLICITATION &&
+                 it->second.role == Discoveree) ||
+                (msgType == NrSlDiscoveryHeader::DISC_GROUP_RESPONSE &&
+                 it->second.role == Discoverer));
+    }
+    return false;
+}
+
+void
+NrSlUeProse::SendGroupDiscovery(uint32_t groupId, uint32_t dstL2Id)
+{
+    NS_LOG_FUNCTION(this << groupId << dstL2Id);
+
+    auto it = m_groupMap.find(groupId);
+    if (it != m_groupMap.end())
+    {
+        NrSlDiscoveryHeader discHeader;
+
+        if (it->second.role == Announcing)
+        {
+            discHeader.SetGroupAnnouncementParameters(groupId, m_imsi, m_l2Id);
+            // reschedule
+            Simulator::Schedule(GetDiscoveryInterval(it->second),
+                                &NrSlUeProse::SendGroupDiscovery,
+                                this,
+                                groupId,
+                                dstL2Id);
+        }
+        else if (it->second.role == Discoverer)
+        {
+            discHeader.SetGroupSolicitationParameters(groupId, m_imsi, m_l2Id);
+            // reschedule
+            Simulator::Schedule(GetDiscoveryInterval(it->second),
+                                &NrSlUeProse::SendGroupDiscovery,
+                                this,
+                                groupId,
+                                dstL2Id);
+        }
+        else if (it->second.role == Discoveree)
+        {
+            discHeader.SetGroupResponseParameters(groupId, m_imsi, m_l2Id);
+            // no reschedule
+        }
+        else
+        {
+            // monitoring members do not transmit
+            return;
+        }
+
+        // send
+        TransmitDiscovery(discHeader, dstL2Id, it->second.txParams);
+    }
+}
+
+void
+NrSlUeProse::SetMonitoringDutyCycle(DiscoveryRole role, MonitoringDutyCycle dutyCycle)
+{
+    NS_LOG_FUNCTION(this << role << dutyCycle.window << dutyCycle.period << dutyCycle.offset);
+    NS_ABORT_MSG_IF(!dutyCycle.period.IsStrictlyPositive(), "The period must be positive");
+    NS_ABORT_MSG_IF(dutyCycle.window > dutyCycle.period,
+                    "The listen window cannot be longer than the period");
+    m_monitoringDutyCycles[role] = dutyCycle;
+}
+
+void
+NrSlUeProse::RemoveMonitoringDutyCycle(DiscoveryRole role)
+{
+    NS_LOG_FUNCTION(this << role);
+    m_monitoringDutyCycles.erase(role);
+}
+
+bool
+NrSlUeProse::IsListeningToDiscovery() const
+{
+    if (m_monitoringDutyCycles.empty())
+    {
+        return true;
+    }
+
+    bool hasRole = false;
+    for (uint32_t role = 0; role < m_nListeningCodesPerRole.size(); ++role)
+    {
+        if (m_nListeningCodesPerRole[role] == 0)
+        {
+            continue;
+        }
+        hasRole = true;
+        auto it = m_monitoringDutyCycles.find(static_cast<DiscoveryRole>(role));
+        if (it == m_monitoringDutyCycles.end())
+        {
+            // this role listens continuously
+            return true;
+        }
+        int64_t period = it->second.period.GetNanoSeconds();
+        int64_t phase = (Simulator::Now() - it->second.offset).GetNanoSeconds() % period;
+        if (phase < 0)
+        {
+            phase += period;
+        }
+        if (phase < it->second.window.GetNanoSeconds())
+        {
+            return true;
+        }
+    }
+    // Without any receiving role, keep the original behavior and let the message be
+    // discarded after parsing
+    return !hasRole;
+}
+
+bool
+NrSlUeProse::IsReceivingRole(DiscoveryCodeType type, DiscoveryModel model, DiscoveryRole role)
+{
+    switch (type)
+    {
+    case ApplicationCode:
+        // Announcing UEs only transmit
+        return role != Announcing;
+    case U2nRelayCode:
+    case U2uRelayCode:
+        // Model A relay UEs only transmit
+        return role == RemoteUE || (model == ModelB && role == RelayUE);
+    case GroupCode:
+        // Announcing members also monitor the announcements of the other members
+        return true;
+    default:
+        NS_FATAL_ERROR("Invalid discovery code type " << type);
+    }
+    return false;
+}
+
+void
+NrSlUeProse::TransmitDiscovery(const NrSlDiscoveryHeader& discHeader,
+                               uint32_t dstL2Id,
+                               const DiscoveryTxParameters& txParams)
+{
+    NS_LOG_FUNCTION(this << +discHeader.GetDiscoveryMsgType() << dstL2Id);
+
+    if (m_discoveryAggregationMaxSize == 0)
+    {
+        Ptr<Packet> discoveryPacket = Create<Packet>();
+        discoveryPacket->AddHeader(discHeader);
+        DoSendNrSlDiscovery(discoveryPacket, dstL2Id);
+        m_discoveryTrace(m_l2Id, dstL2Id, true, discHeader);
+        m_stats->NotifyDiscoveryTx(discHeader.GetDiscoveryMsgType());
+        return;
+    }
+
+    // Only the messages with the same priority and PDB are aggregated, so a message is
+    // never delayed beyond its PDB or sent along with less urgent messages
+    DiscoveryTxParameters params = ResolveDiscoveryTxParameters(txParams);
+    AggregatedDiscoveryKey key(dstL2Id, params.priority, params.pdb);
+    AggregatedDiscovery& batch = m_aggregatedDiscovery[key];
+    NrSlDiscoveryAggregationHeader aggHeader;
+    uint32_t size =
+        aggHeader.GetSerializedSize() + (batch.headers.size() + 1) * discHeader.GetSerializedSize();
+    if (!batch.headers.empty() &&
+        (size > m_discoveryAggregationMaxSize ||
+         batch.headers.size() == std::numeric_limits<uint8_t>::max()))
+    {
+        // The message does not fit, transmit what has been collected so far
+        batch.flushEvent.Cancel();
+        FlushAggregatedDiscovery(key);
+    }
+    if (batch.headers.empty())
+    {
+        batch.flushEvent = Simulator::Schedule(std::min(m_discoveryAggregationWindow, params.pdb),
+                                               &NrSlUeProse::FlushAggregatedDiscovery,
+                                               this,
+                                               key);
+    }
+    batch.headers.push_back(discHeader);
+}
+
+void
+NrSlUeProse::FlushAggregatedDiscovery(AggregatedDiscoveryKey key)
+{
+    uint32_t dstL2Id = std::get<0>(key);
+    NS_LOG_FUNCTION(this << dstL2Id << +std::get<1>(key) << std::get<2>(key));
+
+    auto it = m_aggregatedDiscovery.find(key);
+    if (it == m_aggregatedDiscovery.end() || it->second.headers.empty())
+    {
+        return;
+    }
+    std::vector<NrSlDiscoveryHeader> headers;
+    headers.swap(it->second.headers);
+
+    Ptr<Packet> discoveryPacket = Create<Packet>();
+    if (headers.size() == 1)
+    {
+        // No need for the aggregation header
+        discoveryPacket->AddHeader(headers.front());
+    }
+    else
+    {
+        for (auto itHeader = headers.rbegin(); itHeader != headers.rend(); ++itHeader)
+        {
+            discoveryPacket->AddHeader(*itHeader);
+        }
+        NrSlDiscoveryAggregationHeader aggHeader;
+        aggHeader.SetNMessages(headers.size());
+        discoveryPacket->AddHeader(aggHeader);
+        m_stats->NotifyDiscoveryAggregatedTx();
+        NS_LOG_LOGIC("Aggregating " << headers.size() << " discovery messages to " << dstL2Id);
+    }
+    DoSendNrSlDiscovery(discoveryPacket, dstL2Id);
+
+    for (const auto& discHeader : headers)
+    {
+        m_discoveryTrace(m_l2Id, dstL2Id, true, discHeader);
+        m_stats->NotifyDiscoveryTx(discHeader.GetDiscoveryMsgType());
+    }
+}
+
+void
+NrSlUeProse::DoSendNrSlDiscovery(Ptr<Packet> packet, uint32_t dstL2Id)
+{
+    NS_LOG_FUNCTION(this << packet << dstL2Id);
+
+    if (m_discoveryOracle)
+    {
+        NS_LOG_INFO("Discovery message sent by " << m_l2Id << " to " << dstL2Id << " via oracle");
+        m_discoveryOracle->Transmit(this, packet, dstL2Id);
+        return;
+    }
+
+    // Activate the corresponding SL Discovery RB for the logical channel, if not active
+    if (m_activeSlDiscoveryRbs.insert(dstL2Id).second) // First SL Discovery RB for this destination
+    {
+        // Instruct the RRC to activate the SL Disocvery RB
+        m_nrSlUeSvcRrcSapProvider->ActivateNrSlDiscoveryRadioBearer(dstL2Id);
+    }
+
+    // Pass the message to the RRC
+    NS_LOG_INFO("Discovery message sent by " << m_l2Id << " to " << dstL2Id);
+    m_nrSlUeSvcRrcSapProvider->SendNrSlDiscovery(packet, dstL2Id);
+}
+
+void
+NrSlUeProse::DoReceiveNrSlDiscovery(Ptr<Packet> packet, uint32_t srcL2Id)
+{
+    NS_LOG_FUNCTION(this << packet << srcL2Id);
+
+    // Drop the message before any processing if no role is in its listen window
+    if (!IsListeningToDiscovery())
+    {
+        NS_LOG_LOGIC("Discovery message from " << srcL2Id << " dropped outside listen window");
+        m_stats->NotifyDiscoveryRxDropped();
+        return;
+    }
+
+    // Demultiplex the messages of an aggregated discovery packet
+    NrSlDiscoveryAggregationHeader aggHeader;
+    packet->PeekHeader(aggHeader);
+    if (aggHeader.IsAggregated())
+    {
+        packet->RemoveHeader(aggHeader);
+        NS_LOG_LOGIC("Aggregated discovery packet with " << +aggHeader.GetNMessages()
+                                                         << " messages from " << srcL2Id);
+        m_stats->NotifyDiscoveryAggregatedRx();
+        for (uint8_t n = 0; n < aggHeader.GetNMessages(); ++n)
+        {
+            NrSlDiscoveryHeader discHeader;
+            packet->RemoveHeader(discHeader);
+            ProcessNrSlDiscovery(discHeader, srcL2Id);
+        }
+    }
+    else
+    {
+        NrSlDiscoveryHeader discHeader;
+        packet->RemoveHeader(discHeader);
+        ProcessNrSlDiscovery(discHeader, srcL2Id);
+    }
+}
+
+void
+NrSlUeProse::SetDiscoveryOracle(Ptr<NrSlDiscoveryOracle> oracle)
+{
+    NS_LOG_FUNCTION(this << oracle);
+    m_discoveryOracle = oracle;
+}
+
+bool
+NrSlUeProse::IsMonitoringDiscoveryL2Id(uint32_t dstL2Id) const
+{
+    return (m_monitoringSelfL2Id && dstL2Id == m_l2Id) ||
+           m_monitoredDiscoveryL2Ids.find(dstL2Id) != m_monitoredDiscoveryL2Ids.end();
+}
+
+void
+NrSlUeProse::ReceiveOracleDiscovery(Ptr<Packet> packet,
+                                    uint32_t srcL2Id,
+                                    double rsrp,
+                                    bool eligible)
+{
+    NS_LOG_FUNCTION(this << packet << srcL2Id << rsrp << eligible);
+
+    // Record the RSRP before processing the message, so that the discovered
+    // relay is added to the list and selected with it
+    if (m_relaySelectionAlgorithm)
+    {
+        m_relayRsrpTrace(m_l2Id, srcL2Id, rsrp);
+        m_rsrpMeasurementsMap[srcL2Id] = std::make_pair(rsrp, eligible);
+    }
+    DoReceiveNrSlDiscovery(packet, srcL2Id);
+}
+
+void
+NrSlUeProse::ProcessNrSlDiscovery(const NrSlDiscoveryHeader& discHeader, uint32_t srcL2Id)
+{
+    NS_LOG_FUNCTION(this << srcL2Id);
+
+    uint8_t msgType = discHeader.GetDiscoveryMsgType();
+    m_stats->NotifyDiscoveryRx(msgType);
+
+    if (IsDuplicateDiscovery(discHeader, srcL2Id))
+    {
+        NS_LOG_LOGIC("Duplicate discovery message from " << srcL2Id << " suppressed");
+        m_stats->NotifyDiscoveryRxDuplicate();
+        // Keep the peer in the discovered peer table, which is cheap and does
+        // not fire any trace for a known peer
+        if ((msgType == NrSlDiscoveryHeader::DISC_OPEN_ANNOUNCEMENT ||
+             msgType == NrSlDiscoveryHeader::DISC_RESTRICTED_RESPONSE) &&
+            IsMonitoringApp(msgType, discHeader.GetApplicationCode()))
+        {
+            UpdateDiscoveredPeer(discHeader.GetApplicationCode(), srcL2Id);
+        }
+        return;
+    }
+
+    // Discovery
+    if (msgType == NrSlDiscoveryHeader::DISC_OPEN_ANNOUNCEMENT ||
+        msgType == NrSlDiscoveryHeader::DISC_RESTRICTED_QUERY ||
+        msgType == NrSlDiscoveryHeader::DISC_RESTRICTED_RESPONSE)
+    {
+        uint32_t appCode = discHeader.GetApplicationCode();
+
+        // open or restricted announcement
+        if (IsMonitoringApp(msgType, appCode))
+        {
+            // Check if this is a request I am interested in
+            std::map<uint32_t, DiscoveryInfo>::iterator itInfo = m_discoveryMap.find(appCode);
+            if (itInfo != m_discoveryMap.end())
+            {
+                NS_LOG_INFO("Discovery message received by " << m_l2Id << " from " << srcL2Id);
+                m_discoveryTrace(srcL2Id, m_l2Id, false, discHeader);
+
+                // keep track of the peers announcing or responding for this app
+                if (msgType == NrSlDiscoveryHeader::DISC_OPEN_ANNOUNCEMENT ||
+                    msgType == NrSlDiscoveryHeader::DISC_RESTRICTED_RESPONSE)
+                {
+                    UpdateDiscoveredPeer(appCode, srcL2Id);
+                    TriggerAutoDirectLink(appCode, srcL2Id);
+                }
 
                 // check if this is a request message for an app for which this UE is a Discoveree
                 if (msgType == NrSlDiscoveryHeader::DISC_RESTRICTED_QUERY &&
@@ -675,6 +2084,14 @@ NrSlUeProse::DoReceiveNrSlDiscovery(Ptr<Packet> packet, uint32_t srcL2Id)
     {
         uint32_t relayCode = discHeader.GetRelayServiceCode();
 
+        // Relay UEs keep track of the other relays providing the same service
+        auto itOwn = m_relayMap.find(relayCode);
+        if (itOwn != m_relayMap.end() && itOwn->second.role == RelayUE &&
+            msgType != NrSlDiscoveryHeader::DISC_RELAY_SOLICITATION)
+        {
+            UpdateNeighbourRelay(srcL2Id, relayCode, discHeader.GetStatusIndicator());
+        }
+
         if (IsMonitoringRelay(msgType, relayCode))
         {
             // Check if this is a relay announcement or relay response/solicitation I am interested
@@ -688,7 +2105,7 @@ NrSlUeProse::DoReceiveNrSlDiscovery(Ptr<Packet> packet, uint32_t srcL2Id)
                 if (msgType == NrSlDiscoveryHeader::DISC_RELAY_SOLICITATION &&
                     itInfo->second.role == RelayUE)
                 {
-                    SendRelayDiscovery(relayCode, srcL2Id);
+                    RespondToRelaySolicitation(relayCode, srcL2Id);
                 }
                 else
                 {
@@ -699,17 +2116,446 @@ NrSlUeProse::DoReceiveNrSlDiscovery(Ptr<Packet> packet, uint32_t srcL2Id)
                     m_relayDiscoveryTrace(m_l2Id, srcL2Id, relayCode, relayMeas.first);
 
                     // Update List of discovered relays
-                    UpdateDiscoveredRelaysList(srcL2Id, relayCode);
+                    UpdateDiscoveredRelaysList(srcL2Id,
+                                               relayCode,
+                                               discHeader.GetStatusIndicator());
+
+                    // Initiate relay selection procedure
+                    if (m_relaySelectionAlgorithm)
+                    {
+                        SelectRelay();
+                    }
+                }
+            }
+        }
+    }
+    // UE-to-UE relay discovery
+    else if (msgType == NrSlDiscoveryHeader::DISC_U2U_RELAY_ANNOUNCEMENT ||
+             msgType == NrSlDiscoveryHeader::DISC_U2U_RELAY_RESPONSE ||
+             msgType == NrSlDiscoveryHeader::DISC_U2U_RELAY_SOLICITATION)
+    {
+        uint32_t relayCode = discHeader.GetRelayServiceCode();
+
+        if (IsMonitoringU2uRelay(msgType, relayCode))
+        {
+            NS_LOG_INFO("UE-to-UE relay message received by " << m_l2Id << " from " << srcL2Id);
+            m_discoveryTrace(srcL2Id, m_l2Id, false, discHeader);
+
+            if (msgType == NrSlDiscoveryHeader::DISC_U2U_RELAY_SOLICITATION)
+            {
+                // The solicitor is reachable through this relay
+                m_u2uReachableUes[relayCode][srcL2Id] = Simulator::Now();
+                SendU2uRelayDiscovery(relayCode, srcL2Id);
+            }
+            else if (discHeader.GetTargetUeId() != m_l2Id)
+            {
+                U2uRouteEntry entry;
+                entry.relayCode = relayCode;
+                entry.lastHeard = Simulator::Now();
+                m_u2uRoutes[discHeader.GetTargetUeId()][srcL2Id] = entry;
+            }
+        }
+    }
+    // Group member discovery
+    else if (msgType == NrSlDiscoveryHeader::DISC_GROUP_ANNOUNCEMENT ||
+             msgType == NrSlDiscoveryHeader::DISC_GROUP_SOLICITATION ||
+             msgType == NrSlDiscoveryHeader::DISC_GROUP_RESPONSE)
+    {
+        uint32_t groupId = discHeader.GetGroup();
+
+        if (IsMonitoringGroup(msgType, groupId))
+        {
+            NS_LOG_INFO("Group discovery message received by " << m_l2Id << " from " << srcL2Id);
+            m_discoveryTrace(srcL2Id, m_l2Id, false, discHeader);
+
+            if (msgType == NrSlDiscoveryHeader::DISC_GROUP_SOLICITATION)
+            {
+                SendGroupDiscovery(groupId, srcL2Id);
+            }
+            else
+            {
+                // keep track of the members announcing or responding for this group
+                UpdateGroupMember(groupId, srcL2Id);
+            }
+        }
+    }
+}
+
+bool
+NrSlUeProse::IsDuplicateDiscovery(const NrSlDiscoveryHeader& discHeader, uint32_t srcL2Id)
+{
+    NS_LOG_FUNCTION(this << srcL2Id);
+
+    if (!m_discoveryDuplicateWindow.IsStrictlyPositive())
+    {
+        return false;
+    }
+
+    uint8_t msgType = discHeader.GetDiscoveryMsgType();
+    uint32_t code = 0;
+    uint8_t status = 0;
+    switch (msgType)
+    {
+    case NrSlDiscoveryHeader::DISC_OPEN_ANNOUNCEMENT:
+    case NrSlDiscoveryHeader::DISC_RESTRICTED_RESPONSE:
+        code = discHeader.GetApplicationCode();
+        break;
+    case NrSlDiscoveryHeader::DISC_RELAY_ANNOUNCEMENT:
+    case NrSlDiscoveryHeader::DISC_RELAY_RESPONSE:
+        code = discHeader.GetRelayServiceCode();
+        status = discHeader.GetStatusIndicator();
+        break;
+    case NrSlDiscoveryHeader::DISC_GROUP_ANNOUNCEMENT:
+    case NrSlDiscoveryHeader::DISC_GROUP_RESPONSE:
+        code = discHeader.GetGroup();
+        break;
+    default:
+        // Queries and solicitations are always processed, as the sender
+        // expects a response to each of them
+        return false;
+    }
+
+    DiscoveryDuplicateKey key(srcL2Id, msgType, code, status);
+    auto it = m_discoveryDuplicateCache.find(key);
+    if (it != m_discoveryDuplicateCache.end() &&
+        Simulator::Now() - it->second < m_discoveryDuplicateWindow)
+    {
+        return true;
+    }
+    // Remove the entries of the messages not heard for a window, at most once per
+    // window, so the cache only holds the messages received recently
+    if (Simulator::Now() >= m_discoveryDuplicatePurgeTime)
+    {
+        for (auto itEntry = m_discoveryDuplicateCache.begin();
+             itEntry != m_discoveryDuplicateCache.end();)
+        {
+            if (Simulator::Now() - itEntry->second >= m_discoveryDuplicateWindow)
+            {
+                itEntry = m_discoveryDuplicateCache.erase(itEntry);
+            }
+            else
+            {
+                ++itEntry;
+            }
+        }
+        m_discoveryDuplicatePurgeTime = Simulator::Now() + m_discoveryDuplicateWindow;
+    }
+    // The window starts at the last processed copy, so an unchanged message is
+    // still fully processed once per window
+    m_discoveryDuplicateCache[key] = Simulator::Now();
+    return false;
+}
+
+void
+NrSlUeProse::UpdateDiscoveredPeer(uint32_t appCode, uint32_t peerL2Id)
+{
+    NS_LOG_FUNCTION(this << appCode << peerL2Id);
+
+    DiscoveredPeerMap& peers = m_discoveredPeers[appCode];
+    auto it = peers.find(peerL2Id);
+    bool appeared = (it == peers.end());
+    if (appeared)
+    {
+        DiscoveredPeerInfo peer;
+        peer.l2Id = peerL2Id;
+        peer.firstHeard = Simulator::Now();
+        it = peers.emplace(peerL2Id, peer).first;
+    }
+    it->second.lastHeard = Simulator::Now();
+    it->second.count++;
+    it->second.rsrp = FindRsrpMeasurement(peerL2Id).first;
+
+    if (appeared)
+    {
+        NS_LOG_INFO("UE " << m_l2Id << " discovered peer " << peerL2Id << " for app code "
+                          << appCode);
+        // The expiry check is only rescheduled when it fires, which avoids
+        // cancelling and scheduling an event per received message
+        if (m_discoveredPeerTtl.IsStrictlyPositive())
+        {
+            it->second.expiryEvent = Simulator::Schedule(m_discoveredPeerTtl,
+                                                         &NrSlUeProse::CheckDiscoveredPeerExpiry,
+                                                         this,
+                                                         appCode,
+                                                         peerL2Id);
+        }
+        m_discoveredPeerTrace(m_l2Id, appCode, peerL2Id, true);
+    }
+}
+
+void
+NrSlUeProse::CheckDiscoveredPeerExpiry(uint32_t appCode, uint32_t peerL2Id)
+{
+    NS_LOG_FUNCTION(this << appCode << peerL2Id);
+
+    auto itCode = m_discoveredPeers.find(appCode);
+    NS_ASSERT_MSG(itCode != m_discoveredPeers.end(), "Unknown app code " << appCode);
+    auto it = itCode->second.find(peerL2Id);
+    NS_ASSERT_MSG(it != itCode->second.end(), "Unknown peer " << peerL2Id);
+
+    Time expiry = it->second.lastHeard + m_discoveredPeerTtl;
+    if (expiry > Simulator::Now())
+    {
+        // Heard in the meantime, check again later
+        it->second.expiryEvent = Simulator::Schedule(expiry - Simulator::Now(),
+                                                     &NrSlUeProse::CheckDiscoveredPeerExpiry,
+                                                     this,
+                                                     appCode,
+                                                     peerL2Id);
+        return;
+    }
+
+    NS_LOG_INFO("Peer " << peerL2Id << " for app code " << appCode << " expired in UE "
+                        << m_l2Id);
+    itCode->second.erase(it);
+    if (itCode->second.empty())
+    {
+        m_discoveredPeers.erase(itCode);
+    }
+    m_discoveredPeerTrace(m_l2Id, appCode, peerL2Id, false);
+}
+
+void
+NrSlUeProse::UpdateGroupMember(uint32_t groupId, uint32_t memberL2Id)
+{
+    NS_LOG_FUNCTION(this << groupId << memberL2Id);
+
+    DiscoveredPeerMap& members = m_groupMembers[groupId];
+    auto it = members.find(memberL2Id);
+    bool appeared = (it == members.end());
+    if (appeared)
+    {
+        DiscoveredPeerInfo member;
+        member.l2Id = memberL2Id;
+        member.firstHeard = Simulator::Now();
+        it = members.emplace(memberL2Id, member).first;
+    }
+    it->second.lastHeard = Simulator::Now();
+    it->second.count++;
+    it->second.rsrp = FindRsrpMeasurement(memberL2Id).first;
+
+    if (appeared)
+    {
+        NS_LOG_INFO("UE " << m_l2Id << " discovered member " << memberL2Id << " of group "
+                          << groupId);
+        if (m_discoveredPeerTtl.IsStrictlyPositive())
+        {
+            it->second.expiryEvent = Simulator::Schedule(m_discoveredPeerTtl,
+                                                         &NrSlUeProse::CheckGroupMemberExpiry,
+                                                         this,
+                                                         groupId,
+                                                         memberL2Id);
+        }
+        m_groupMemberTrace(m_l2Id, groupId, memberL2Id, true);
+    }
+}
+
+void
+NrSlUeProse::CheckGroupMemberExpiry(uint32_t groupId, uint32_t memberL2Id)
+{
+    NS_LOG_FUNCTION(this << groupId << memberL2Id);
+
+    auto itGroup = m_groupMembers.find(groupId);
+    NS_ASSERT_MSG(itGroup != m_groupMembers.end(), "Unknown group " << groupId);
+    auto it = itGroup->second.find(memberL2Id);
+    NS_ASSERT_MSG(it != itGroup->second.end(), "Unknown member " << memberL2Id);
+
+    Time expiry = it->second.lastHeard + m_discoveredPeerTtl;
+    if (expiry > Simulator::Now())
+    {
+        // Heard in the meantime, check again later
+        it->second.expiryEvent = Simulator::Schedule(expiry - Simulator::Now(),
+                                                     &NrSlUeProse::CheckGroupMemberExpiry,
+                                                     this,
+                                                     groupId,
+                                                     memberL2Id);
+        return;
+    }
+
+    NS_LOG_INFO("Member " << memberL2Id << " of group " << groupId << " expired in UE "
+                          << m_l2Id);
+    itGroup->second.erase(it);
+    if (itGroup->second.empty())
+    {
+        m_groupMembers.erase(itGroup);
+    }
+    m_groupMemberTrace(m_l2Id, groupId, memberL2Id, false);
+}
+
+void
+NrSlUeProse::EnableAutoDirectLink(uint32_t appCode, const struct SidelinkInfo& slInfo)
+{
+    NS_LOG_FUNCTION(this << appCode);
+    m_autoDirectLinkProfiles[appCode] = slInfo;
+}
+
+void
+NrSlUeProse::DisableAutoDirectLink(uint32_t appCode)
+{
+    NS_LOG_FUNCTION(this << appCode);
+    m_autoDirectLinkProfiles.erase(appCode);
+}
+
+void
+NrSlUeProse::TriggerAutoDirectLink(uint32_t appCode, uint32_t peerL2Id)
+{
+    NS_LOG_FUNCTION(this << appCode << peerL2Id);
+
+    auto itProfile = m_autoDirectLinkProfiles.find(appCode);
+    if (itProfile == m_autoDirectLinkProfiles.end())
+    {
+        return;
+    }
+
+    // De-duplication: a link with this peer exists and is not released. This
+    // also covers the links initiated by the peer
+    auto itLink = m_unicastDirectLinks.find(peerL2Id);
+    if (itLink != m_unicastDirectLinks.end() &&
+        itLink->second->m_link->GetState() != NrSlUeProseDirectLink::RELEASED)
+    {
+        NS_LOG_LOGIC("Direct link with peer " << peerL2Id << " already exists");
+        return;
+    }
+
+    // Rate limiting
+    auto itAttempt = m_autoDirectLinkAttempts.find(peerL2Id);
+    if (itAttempt != m_autoDirectLinkAttempts.end() &&
+        Simulator::Now() < itAttempt->second + m_autoDirectLinkHoldOff)
+    {
+        NS_LOG_LOGIC("Automatic direct link with peer " << peerL2Id << " attempted at "
+                                                        << itAttempt->second.GetSeconds()
+                                                        << " s. Holding off");
+        return;
+    }
+    if (itLink == m_unicastDirectLinks.end() &&
+        m_unicastDirectLinks.size() >= m_autoDirectLinkMaxLinks)
+    {
+        NS_LOG_LOGIC("Maximum number of direct links reached");
+        return;
+    }
+
+    NS_ABORT_MSG_IF(!m_ueDevice, "Net device not set. Did you enable the automatic direct link "
+                                 "through the NrSlProseHelper?");
+    m_autoDirectLinkAttempts[peerL2Id] = Simulator::Now();
+
+    SidelinkInfo slInfo = itProfile->second;
+    slInfo.m_castType = SidelinkInfo::CastType::Unicast;
+    slInfo.m_srcL2Id = m_l2Id;
+    slInfo.m_dstL2Id = peerL2Id;
+    Ipv4Address selfIp =
+        m_ueDevice->GetNode()->GetObject<Ipv4L3Protocol>()->GetAddress(1, 0).GetLocal();
+
+    NS_LOG_INFO("UE " << m_l2Id << " automatically initiating direct link with peer " << peerL2Id
+                      << " discovered for app code " << appCode);
+    AddDirectLinkConnection(m_l2Id, selfIp, peerL2Id, true, 0, slInfo);
+}
+
+bool
+NrSlUeProse::FindAutoDirectLinkProfile(uint32_t peerL2Id, struct SidelinkInfo& slInfo) const
+{
+    NS_LOG_FUNCTION(this << peerL2Id);
+
+    // Prefer a code for which the peer was discovered, e.g., when both UEs discovered
+    // each other, then any code this UE is announcing
+    const SidelinkInfo* profile = nullptr;
+    for (const auto& itProfile : m_autoDirectLinkProfiles)
+    {
+        auto itPeers = m_discoveredPeers.find(itProfile.first);
+        if (itPeers != m_discoveredPeers.end() &&
+            itPeers->second.find(peerL2Id) != itPeers->second.end())
+        {
+            slInfo = itProfile.second;
+            return true;
+        }
+        auto itApp = m_discoveryMap.find(itProfile.first);
+        if (!profile && itApp != m_discoveryMap.end() &&
+            (itApp->second.role == Announcing || itApp->second.role == Discoveree))
+        {
+            profile = &itProfile.second;
+        }
+    }
+    if (profile)
+    {
+        slInfo = *profile;
+        return true;
+    }
+    return false;
+}
+
+void
+NrSlUeProse::ClearDiscoveredPeers(uint32_t appCode)
+{
+    NS_LOG_FUNCTION(this << appCode);
+
+    auto itCode = m_discoveredPeers.find(appCode);
+    if (itCode == m_discoveredPeers.end())
+    {
+        return;
+    }
+    // Move the peers out first, so the trace sinks see a consistent table
+    DiscoveredPeerMap peers = std::move(itCode->second);
+    m_discoveredPeers.erase(itCode);
+    for (auto& itPeer : peers)
+    {
+        itPeer.second.expiryEvent.Cancel();
+        m_discoveredPeerTrace(m_l2Id, appCode, itPeer.first, false);
+    }
+}
+
+NrSlUeProse::DiscoveredPeerIterator
+NrSlUeProse::DiscoveredPeersBegin(uint32_t appCode) const
+{
+    auto it = m_discoveredPeers.find(appCode);
+    return it != m_discoveredPeers.end() ? it->second.begin() : g_noDiscoveredPeers.begin();
+}
+
+NrSlUeProse::DiscoveredPeerIterator
+NrSlUeProse::DiscoveredPeersEnd(uint32_t appCode) const
+{
+    auto it = m_discoveredPeers.find(appCode);
+    return it != m_discoveredPeers.end() ? it->second.end() : g_noDiscoveredPeers.end();
+}
+
+uint32_t
+NrSlUeProse::GetNDiscoveredPeers(uint32_t appCode) const
+{
+    auto it = m_discoveredPeers.find(appCode);
+    return it != m_discoveredPeers.end() ? it->second.size() : 0;
+}
+
+bool
+NrSlUeProse::IsPeerDiscovered(uint32_t appCode, uint32_t peerL2Id) const
+{
+    auto it = m_discoveredPeers.find(appCode);
+    return it != m_discoveredPeers.end() && it->second.find(peerL2Id) != it->second.end();
+}
+
+NrSlUeProse::DiscoveredPeerIterator
+NrSlUeProse::GroupMembersBegin(uint32_t groupId) const
+{
+    auto it = m_groupMembers.find(groupId);
+    return it != m_groupMembers.end() ? it->second.begin() : g_noDiscoveredPeers.begin();
+}
+
+NrSlUeProse::DiscoveredPeerIterator
+NrSlUeProse::GroupMembersEnd(uint32_t groupId) const
+{
+    auto it = m_groupMembers.find(groupId);
+    return it != m_groupMembers.end() ? it->second.end() : g_noDiscoveredPeers.end();
+}
+
+uint32_t
+NrSlUeProse::GetNGroupMembers(uint32_t groupId) const
+{
+    auto it = m_groupMembers.find(groupId);
+    return it != m_groupMembers.end() ? it->second.size() : 0;
+}
 
-                    // Initiate relay selection procedure
-                    if (m_relaySelectionAlgorithm)
-                    {
-                        SelectRelay();
-                    }
-                }
-            }
-        }
-    }
+bool
+NrSlUeProse::IsGroupMemberDiscovered(uint32_t groupId, uint32_t memberL2Id) const
+{
+    auto it = m_groupMembers.find(groupId);
+    return it != m_groupMembers.end() && it->second.find(memberL2Id) != it->second.end();
 }
 
 void
@@ -796,9 +2642,9 @@ NrSlUeProse::FindRsrpMeasurement(uint32_t l2Id)
 }
 
 void
-NrSlUeProse::UpdateDiscoveredRelaysList(uint32_t relayL2Id, uint32_t relayCode)
+NrSlUeProse::UpdateDiscoveredRelaysList(uint32_t relayL2Id, uint32_t relayCode, uint8_t status)
 {
-    NS_LOG_FUNCTION(this << relayL2Id << relayCode);
+    NS_LOG_FUNCTION(this << relayL2Id << relayCode << +status);
 
     std::pair<double, bool> relayMeas = FindRsrpMeasurement(relayL2Id);
 
@@ -807,6 +2653,7 @@ NrSlUeProse::UpdateDiscoveredRelaysList(uint32_t relayL2Id, uint32_t relayCode)
     discoveredRelay.relayCode = relayCode;
     discoveredRelay.rsrp = relayMeas.first;
     discoveredRelay.eligible = relayMeas.second;
+    discoveredRelay.status = status;
 
     // Update the list of discovered relays
     bool found = false;
@@ -843,6 +2690,12 @@ NrSlUeProse::SelectRelay()
     NS_LOG_FUNCTION(this);
     RelayInfo newRelay;
 
+    if (m_remotePathSwitching && m_onDirectPath)
+    {
+        NS_LOG_DEBUG("This remote is on the direct Uu path. Ignore relay selection request!");
+        return;
+    }
+
     if (m_connectingRelay.l2Id != 0)
     {
         // Ignore request
@@ -853,9 +2706,27 @@ NrSlUeProse::SelectRelay()
     else
     {
         // Check if the list of discovered relays is empty
-        if (m_discoveredRelaysList.empty())
+        if (!m_discoveredRelaysList.empty())
         {
-            newRelay = m_relaySelectionAlgorithm->SelectRelay(m_discoveredRelaysList);
+            std::vector<RelayInfo> candidates = GetRelaySelectionCandidates();
+            newRelay = m_relaySelectionAlgorithm->SelectRelay(candidates);
+
+            // Honour the relay suggested by the relay that redirected this remote
+            if (m_relayRedirection.alternativeRelayL2Id != 0 &&
+                Simulator::Now() < m_relayRedirection.expiry)
+            {
+                for (const auto& relay : candidates)
+                {
+                    if (relay.l2Id == m_relayRedirection.alternativeRelayL2Id)
+                    {
+                        NS_LOG_LOGIC("Selecting relay " << relay.l2Id
+                                                        << " suggested upon redirection");
+                        newRelay = relay;
+                        m_relayRedirection.alternativeRelayL2Id = 0;
+                        break;
+                    }
+                }
+            }
 
             // Check if it is an eligible relay
             if (newRelay.l2Id != std::numeric_limits<uint32_t>::max())
@@ -883,11 +2754,13 @@ NrSlUeProse::SelectRelay()
                     {
                         NS_LOG_LOGIC(
                             "This is the first time selecting a relay for this remote. Continue!");
+                        m_stats->NotifyRelaySelection();
                     }
                     else
                     {
                         NS_LOG_LOGIC("This remote is already connected to a different relay. Find "
                                      "the connection and release it!");
+                        m_stats->NotifyRelayReselection();
                         // Get existing link
                         auto it = m_unicastDirectLinks.find(m_currentSelectedRelay.l2Id);
                         if (it == m_unicastDirectLinks.end())
@@ -913,6 +2786,11 @@ NrSlUeProse::SelectRelay()
 
                     // Add the relay that this remote is trying to connect to
                     m_connectingRelay = newRelay;
+                    if (m_pathSwitchTracePending)
+                    {
+                        m_pathSwitchTracePending = false;
+                        m_remotePathSwitchTrace(m_l2Id, newRelay.l2Id, false, m_uuRsrp);
+                    }
 
                     // Create new link with newly selected relay
                     // Remote UE (Initiating UE)
@@ -960,11 +2838,181 @@ NrSlUeProse::SelectRelay()
     }
 }
 
+std::vector<NrSlUeProse::RelayInfo>
+NrSlUeProse::GetRelaySelectionCandidates() const
+{
+    std::vector<RelayInfo> candidates;
+    std::vector<RelayInfo> weakCandidates;
+    for (const auto& relay : m_discoveredRelaysList)
+    {
+        if (relay.l2Id == m_relayRedirection.fromRelayL2Id &&
+            Simulator::Now() < m_relayRedirection.expiry)
+        {
+            // This relay redirected the remote recently
+            continue;
+        }
+        if (relay.status != 0)
+        {
+            candidates.push_back(relay);
+        }
+        else
+        {
+            weakCandidates.push_back(relay);
+        }
+    }
+    if (candidates.empty())
+    {
+        // No relay with good backhaul, let the algorithm choose among all of them
+        return weakCandidates;
+    }
+    return candidates;
+}
+
+void
+NrSlUeProse::UpdateNeighbourRelay(uint32_t relayL2Id, uint32_t relayCode, uint8_t status)
+{
+    NS_LOG_FUNCTION(this << relayL2Id << relayCode << +status);
+
+    NeighbourRelayInfo& relay = m_neighbourRelays[relayCode][relayL2Id];
+    relay.rsrp = FindRsrpMeasurement(relayL2Id).first;
+    relay.status = status;
+    relay.lastHeard = Simulator::Now();
+}
+
+uint32_t
+NrSlUeProse::GetAlternativeRelay(uint32_t relayCode) const
+{
+    NS_LOG_FUNCTION(this << relayCode);
+
+    auto itCode = m_neighbourRelays.find(relayCode);
+    if (itCode == m_neighbourRelays.end())
+    {
+        return 0;
+    }
+    uint32_t alternativeRelay = 0;
+    double bestRsrp = -std::numeric_limits<double>::infinity();
+    uint8_t bestStatus = 0;
+    for (const auto& itRelay : itCode->second)
+    {
+        if (m_discoveredPeerTtl.IsStrictlyPositive() &&
+            Simulator::Now() - itRelay.second.lastHeard > m_discoveredPeerTtl)
+        {
+            // Not heard recently
+            continue;
+        }
+        // Relays announcing a good backhaul are preferred, then the highest RSRP
+        if (alternativeRelay == 0 || itRelay.second.status > bestStatus ||
+            (itRelay.second.status == bestStatus && itRelay.second.rsrp > bestRsrp))
+        {
+            alternativeRelay = itRelay.first;
+            bestRsrp = itRelay.second.rsrp;
+            bestStatus = itRelay.second.status;
+        }
+    }
+    return alternativeRelay;
+}
+
+void
+NrSlUeProse::AddRelayRemoteUe(uint32_t remoteL2Id)
+{
+    NS_LOG_FUNCTION(this << remoteL2Id);
+    RemoveRelayRemoteUe(remoteL2Id);
+    m_relayRemoteUeIndex[remoteL2Id] = m_relayRemoteUes.insert(m_relayRemoteUes.end(), remoteL2Id);
+}
+
+void
+NrSlUeProse::RemoveRelayRemoteUe(uint32_t remoteL2Id)
+{
+    NS_LOG_FUNCTION(this << remoteL2Id);
+    auto it = m_relayRemoteUeIndex.find(remoteL2Id);
+    if (it != m_relayRemoteUeIndex.end())
+    {
+        m_relayRemoteUes.erase(it->second);
+        m_relayRemoteUeIndex.erase(it);
+    }
+}
+
+void
+NrSlUeProse::RedirectRemoteUe(uint32_t remoteL2Id)
+{
+    NS_LOG_FUNCTION(this << remoteL2Id);
+
+    RemoveRelayRemoteUe(remoteL2Id);
+    auto it = m_unicastDirectLinks.find(remoteL2Id);
+    if (it == m_unicastDirectLinks.end() ||
+        (it->second->m_link->GetState() != NrSlUeProseDirectLink::ESTABLISHED &&
+         it->second->m_link->GetState() != NrSlUeProseDirectLink::ESTABLISHING))
+    {
+        NS_LOG_LOGIC("No connection with remote " << remoteL2Id);
+        return;
+    }
+
+    uint32_t alternativeRelay = GetAlternativeRelay(it->second->m_relayServiceCode);
+    NS_LOG_INFO("Relay " << m_l2Id << " redirects remote " << remoteL2Id << " to relay "
+                         << alternativeRelay);
+    m_relayRedirectionTrace(m_l2Id, remoteL2Id, alternativeRelay);
+
+    // According to 3GPP TS 24.554, cause #13: congestion situation
+    uint8_t cause = 13;
+    it->second->m_link->SetAlternativeRelayL2Id(alternativeRelay);
+    if (it->second->m_link->GetState() == NrSlUeProseDirectLink::ESTABLISHING)
+    {
+        it->second->m_link->SetEstablishmentRejectCause(cause);
+    }
+    else
+    {
+        it->second->m_link->StartConnectionRelease(cause);
+    }
+}
+
 void
 NrSlUeProse::DoReceiveNrSlSignalling(Ptr<Packet> packet, uint32_t srcL2Id)
 {
     NS_LOG_FUNCTION(this);
 
+    // Keep track of the end UE on the other side of a UE-to-UE relay link
+    if (!m_u2uRelayMap.empty())
+    {
+        NrSlPc5SignallingMessageType header;
+        packet->PeekHeader(header);
+        if (header.GetMessageType() ==
+            NrSlPc5SignallingMessageType::ProseDirectLinkEstablishmentRequest)
+        {
+            ProseDirectLinkEstablishmentRequest reqHeader;
+            packet->PeekHeader(reqHeader);
+            uint32_t relayCode = reqHeader.GetRelayServiceCode();
+            bool isU2uHop = m_u2uRelayMap.find(relayCode) != m_u2uRelayMap.end();
+            NrSlU2uEndUeTag endUeTag;
+            if (isU2uHop && reqHeader.GetTargetUserInfo() != m_l2Id)
+            {
+                // Relay UE: first hop, from the source end UE
+                U2uLinkTarget target;
+                target.l2Id = reqHeader.GetTargetUserInfo();
+                m_u2uLinkTargets[srcL2Id] = target;
+            }
+            else if (isU2uHop && packet->PeekPacketTag(endUeTag))
+            {
+                // Target end UE: second hop, from the relay UE
+                U2uLinkTarget source;
+                source.l2Id = endUeTag.GetL2Id();
+                source.ip = endUeTag.GetAddress();
+                m_u2uLinkTargets[srcL2Id] = source;
+
+                // The request on an existing link does not change its state,
+                // so the traffic of the new source end UE is mapped here
+                auto itLink = m_unicastDirectLinks.find(srcL2Id);
+                if (itLink != m_unicastDirectLinks.end() && itLink->second->m_hasActiveSlDrb &&
+                    m_u2uTargetIps.find(source.ip) == m_u2uTargetIps.end())
+                {
+                    ConfigureU2uRelayHop(srcL2Id,
+                                         relayCode,
+                                         itLink->second->m_ipInfo,
+                                         itLink->second->m_slInfo);
+                }
+            }
+        }
+    }
+
     // If PC5-S for unicast communication:
     auto it = m_unicastDirectLinks.find(srcL2Id);
     if (it == m_unicastDirectLinks.end())
@@ -993,17 +3041,23 @@ NrSlUeProse::DoReceiveNrSlSignalling(Ptr<Packet> packet, uint32_t srcL2Id)
 
             // Create the new link and related context
             SidelinkInfo slInfo;
+            // Links with a peer that discovered this UE (or was discovered by it)
+            // use the profile of the automatic direct link, if enabled
+            if (relayCode != 0 || !FindAutoDirectLinkProfile(srcL2Id, slInfo))
+            {
+                slInfo.m_dynamic = true;
+                slInfo.m_pdb = m_signallingPdb;
+            }
             slInfo.m_castType = SidelinkInfo::CastType::Unicast;
             // Create a SidelinkInfo in which the srcL2Id passed in (source of request) becomes
             // the dstL2Id of the direct link.
             slInfo.m_dstL2Id = srcL2Id;
             slInfo.m_srcL2Id = m_l2Id;
-            slInfo.m_dynamic = true;
-            slInfo.m_pdb = m_signallingPdb;
             AddDirectLinkConnection(m_l2Id, relayIp, srcL2Id, false, relayCode, slInfo);
 
             // Add trace for received establishment request
             m_pc5SignallingPacketTrace(srcL2Id, m_l2Id, false, packet);
+            m_stats->NotifyPc5SignallingRx(msgType);
 
             // Pass the packet to the corresponding direct link instance
             auto lnk = m_unicastDirectLinks.find(srcL2Id);
@@ -1014,6 +3068,9 @@ NrSlUeProse::DoReceiveNrSlSignalling(Ptr<Packet> packet, uint32_t srcL2Id)
     {
         NS_LOG_INFO("Context found!");
         m_pc5SignallingPacketTrace(srcL2Id, m_l2Id, false, packet);
+        NrSlPc5SignallingMessageType pc5smt;
+        packet->PeekHeader(pc5smt);
+        m_stats->NotifyPc5SignallingRx(pc5smt.GetMessageType());
 
         // Pass the packet to the corresponding direct link instance
         it->second->m_nrSlUeProseDirLnkSapProvider->ReceiveNrSlPc5Message(packet);
@@ -1034,6 +3091,25 @@ NrSlUeProse::DoNotifyChangeOfDirectLinkState(
         NS_FATAL_ERROR("Could not find the direct link");
     }
 
+    // The hops of a UE-to-UE relay path are released as unicast links
+    bool isU2uHop = info.relayInfo.isRelayConn &&
+                    m_u2uRelayMap.find(info.relayInfo.relayServiceCode) != m_u2uRelayMap.end();
+    if (isU2uHop)
+    {
+        info.relayInfo.isRelayConn = false;
+        auto itTarget = m_u2uLinkTargets.find(peerL2Id);
+        if (info.newStateEnum == NrSlUeProseDirectLink::RELEASED &&
+            itTarget != m_u2uLinkTargets.end())
+        {
+            if (itTarget->second.ip != Ipv4Address())
+            {
+                info.ipInfo.peerIpv4Addr = itTarget->second.ip;
+                m_u2uTargetIps.erase(itTarget->second.ip);
+            }
+            m_u2uLinkTargets.erase(itTarget);
+        }
+    }
+
     // Perform action depending on state
     switch (info.newStateEnum)
     {
@@ -1042,13 +3118,42 @@ NrSlUeProse::DoNotifyChangeOfDirectLinkState(
         break;
     case NrSlUeProseDirectLink::ESTABLISHING:
         NS_LOG_INFO("ESTABLISHING");
+
+        // Relay: check the capacity before configuring the bearers and the EPC for a new remote
+        if (info.relayInfo.isRelayConn &&
+            info.relayInfo.role == NrSlUeProseDirLnkSapUser::RelayUe &&
+            m_relayRemoteUeIndex.find(peerL2Id) == m_relayRemoteUeIndex.end())
+        {
+            if (m_relayRedirectionPolicy == RedirectOldest)
+            {
+                while (!m_relayRemoteUes.empty() &&
+                       m_relayRemoteUes.size() >= m_relayMaxRemoteUes)
+                {
+                    NS_LOG_LOGIC("Relay " << m_l2Id << " has too many remote UEs");
+                    RedirectRemoteUe(m_relayRemoteUes.front());
+                }
+            }
+            if (m_relayRemoteUes.size() >= m_relayMaxRemoteUes)
+            {
+                NS_LOG_LOGIC("Relay " << m_l2Id << " cannot accept remote " << peerL2Id);
+                RedirectRemoteUe(peerL2Id);
+            }
+        }
         break;
     case NrSlUeProseDirectLink::ESTABLISHED:
         NS_LOG_INFO("ESTABLISHED");
+        m_stats->NotifyLinkEstablishment();
 
         if (!it->second->m_hasActiveSlDrb && !it->second->m_hasPendingSlDrb)
         {
-            if (info.relayInfo.isRelayConn)
+            if (isU2uHop)
+            {
+                ConfigureU2uRelayHop(peerL2Id,
+                                     info.relayInfo.relayServiceCode,
+                                     info.ipInfo,
+                                     it->second->m_slInfo);
+            }
+            else if (info.relayInfo.isRelayConn)
             {
                 NS_LOG_INFO("info.ipInfo.selfIpv4Addr: " << info.ipInfo.selfIpv4Addr);
 
@@ -1072,6 +3177,24 @@ NrSlUeProse::DoNotifyChangeOfDirectLinkState(
                                                      info.relayInfo,
                                                      info.ipInfo,
                                                      it->second->m_slInfo);
+                it->second->m_hasU2nRelayDrbs = true;
+
+                if (info.relayInfo.role == NrSlUeProseDirLnkSapUser::RemoteUe)
+                {
+                    m_pathSwitchRelay.l2Id = peerL2Id;
+                    m_pathSwitchRelay.relayCode = info.relayInfo.relayServiceCode;
+                    m_pathSwitchSlInfo = it->second->m_slInfo;
+                    CompletePathSwitch(peerL2Id, false);
+                    if (m_remotePathSwitching && m_onDirectPath)
+                    {
+                        NS_LOG_LOGIC("The remote is on the direct path. Release the relay");
+                        Simulator::ScheduleNow(&NrSlUeProse::DoPathSwitch, this, true);
+                    }
+                }
+                else
+                {
+                    AddRelayRemoteUe(peerL2Id);
+                }
             }
             else
             {
@@ -1096,6 +3219,7 @@ NrSlUeProse::DoNotifyChangeOfDirectLinkState(
 
                 // Reconfigure data bearers to take into account the release of the link
                 RemoveDataRadioBearersForU2nRelay(peerL2Id, info.relayInfo, info.ipInfo);
+                CompletePathSwitch(peerL2Id, true);
             }
         }
         break;
@@ -1123,6 +3247,19 @@ NrSlUeProse::DoNotifyChangeOfDirectLinkState(
                     m_currentSelectedRelay.l2Id = 0;
                 }
 
+                // Keep the relay suggested by the relay if it redirected this remote
+                if (it->second->m_link->GetPeerReleaseCause() == 13)
+                {
+                    m_relayRedirection.fromRelayL2Id = peerL2Id;
+                    m_relayRedirection.alternativeRelayL2Id =
+                        it->second->m_link->GetPeerAlternativeRelayL2Id();
+                    m_relayRedirection.expiry = Simulator::Now() + m_relayRedirectionHoldOff;
+                    if (m_relaySelectionAlgorithm)
+                    {
+                        Simulator::ScheduleNow(&NrSlUeProse::SelectRelay, this);
+                    }
+                }
+
                 // Notify the RRC to delete the Rx sidelink data bearer for this remote in
                 // connection with the removed relay Pass the maximum value of lcId to remove
                 // bearers for all LCs
@@ -1138,6 +3275,7 @@ NrSlUeProse::DoNotifyChangeOfDirectLinkState(
             {
                 NS_LOG_FUNCTION(
                     "This is a relay in RELEASED state. A ReleaseAccept was sent to the remote!");
+                RemoveRelayRemoteUe(peerL2Id);
 
                 // Notify the RRC to delete the Rx sidelink data bearer for this relay in connection
                 // with the removed remote Pass the maximum value of lcId to remove bearers for all
@@ -1147,8 +3285,13 @@ NrSlUeProse::DoNotifyChangeOfDirectLinkState(
                     m_l2Id,
                     std::numeric_limits<uint8_t>::max());
 
-                // Reconfigure data bearers to take into account the release of the link
-                RemoveDataRadioBearersForU2nRelay(peerL2Id, info.relayInfo, info.ipInfo);
+                // Reconfigure data bearers to take into account the release of the link, unless
+                // the establishment request of the remote was rejected
+                if (it->second->m_hasU2nRelayDrbs)
+                {
+                    RemoveDataRadioBearersForU2nRelay(peerL2Id, info.relayInfo, info.ipInfo);
+                    it->second->m_hasU2nRelayDrbs = false;
+                }
                 // We don't remove context yet (in case the ReleaseAccept message doesn't get
                 // received by the remote) The context may get deleted after all possible
                 // retransmissions has ended For this, we would have to keep track of the
@@ -1227,6 +3370,40 @@ NrSlUeProse::ConfigureDataRadioBearersForU2nRelay(
         {
             relayDrbId = it->second.relayDrbId;
         }
+
+        // Schedule the packets of the remote UE in its own queue
+        if (m_u2nRelayScheduler)
+        {
+            m_u2nRelayScheduler->AddRemoteUe(peerL2Id, ipInfo.peerIpv4Addr);
+        }
+    }
+    else
+    {
+        // Restrict the redirection to the flows of interest, if any. Instead of
+        // reconfiguring all the UL traffic towards the relay UE, a SL data radio
+        // bearer towards the relay UE is activated per uplink packet filter, so
+        // the NAS sends the matching packets on the SL and the others on the Uu
+        auto itFilter = m_u2nRelayFlowFilters.find(relayInfo.relayServiceCode);
+        if (itFilter != m_u2nRelayFlowFilters.end())
+        {
+            NS_LOG_INFO("Only the flows matching the filter of relay service code "
+                        << relayInfo.relayServiceCode << " are redirected to relay " << peerL2Id);
+            std::vector<Ptr<LteSlTft>>& tfts = m_u2nRelayFlowTfts[peerL2Id];
+            for (const auto& filter : itFilter->second->GetPacketFilters())
+            {
+                if (filter.direction == EpcTft::DOWNLINK)
+                {
+                    continue;
+                }
+                Ptr<LteSlTft> tft = Create<LteSlTft>(LteSlTft::Direction::TRANSMIT,
+                                                     filter.remoteAddress,
+                                                     filter.remoteMask,
+                                                     slInfo);
+                m_nrSlUeSvcNasSapProvider->ActivateSvcNrSlDataRadioBearer(tft);
+                tfts.push_back(tft);
+            }
+            return;
+        }
     }
 
     // Tell the NAS to (re)configure the UL and SL data bearers to have the data packets
@@ -1258,6 +3435,74 @@ NrSlUeProse::AddL3U2nRelayServiceConfiguration(uint32_t relayServiceCode,
     }
 }
 
+void
+NrSlUeProse::SetU2nRelayFlowFilter(uint32_t relayServiceCode, Ptr<EpcTft> tft)
+{
+    NS_LOG_FUNCTION(this << relayServiceCode << tft);
+    NS_ABORT_MSG_IF(tft == nullptr, "Use RemoveU2nRelayFlowFilter to redirect all the traffic");
+    // The SL TFTs of the NAS classify the packets by destination address only
+    bool hasUplinkFilter = false;
+    for (const auto& filter : tft->GetPacketFilters())
+    {
+        NS_ABORT_MSG_IF(filter.remotePortStart != 0 || filter.remotePortEnd != 65535 ||
+                            filter.localPortStart != 0 || filter.localPortEnd != 65535 ||
+                            filter.typeOfServiceMask != 0 ||
+                            filter.localMask.Get() != 0,
+                        "The U2N relay flow filters only support remote address and mask");
+        hasUplinkFilter |= (filter.direction != EpcTft::DOWNLINK);
+    }
+    NS_ABORT_MSG_IF(!hasUplinkFilter, "The U2N relay flow filter has no uplink packet filter");
+    m_u2nRelayFlowFilters[relayServiceCode] = tft;
+}
+
+void
+NrSlUeProse::RemoveU2nRelayFlowFilter(uint32_t relayServiceCode)
+{
+    NS_LOG_FUNCTION(this << relayServiceCode);
+    m_u2nRelayFlowFilters.erase(relayServiceCode);
+}
+
+void
+NrSlUeProse::SetU2nRelayScheduler(Ptr<NrSlU2nRelayScheduler> scheduler)
+{
+    NS_LOG_FUNCTION(this << scheduler);
+    m_u2nRelayScheduler = scheduler;
+}
+
+Ptr<NrSlU2nRelayScheduler>
+NrSlUeProse::GetU2nRelayScheduler() const
+{
+    return m_u2nRelayScheduler;
+}
+
+uint32_t
+NrSlUeProse::GetNumDirectLinks() const
+{
+    return m_unicastDirectLinks.size();
+}
+
+uint64_t
+NrSlUeProse::GetDirectLinkMemoryUsage() const
+{
+    // Approximate overhead of a node of the node-based containers: the links
+    // of the node plus, for the hashed ones, the bucket pointer
+    const uint64_t nodeOverhead = 3 * sizeof(void*);
+
+    uint64_t usage = 0;
+    usage += m_unicastDirectLinks.size() *
+             (sizeof(NrSlDirectLinkContextMapPerPeerL2Id::value_type) + nodeOverhead +
+              sizeof(NrSlUeProseDirLinkContext) + sizeof(NrSlUeProseDirectLink));
+    usage += m_unicastDirectLinks.bucket_count() * sizeof(void*);
+    usage += m_activeSlSrbs.size() *
+             (sizeof(NrSlSingalingRadioBearersPerPeerL2Id::value_type) + nodeOverhead);
+    usage += m_relayRemoteUes.size() * (sizeof(uint32_t) + 2 * sizeof(void*));
+    usage += m_relayRemoteUeIndex.size() *
+             (sizeof(decltype(m_relayRemoteUeIndex)::value_type) + nodeOverhead);
+    usage += m_u2uLinkTargets.size() *
+             (sizeof(decltype(m_u2uLinkTargets)::value_type) + nodeOverhead);
+    return usage;
+}
+
 void
 NrSlUeProse::DeleteDirectLinkDataRadioBearer(uint32_t dstL2Id,
                                              NrSlUeProseDirLnkSapUser::DirectLinkIpInfo ipInfo)
@@ -1297,11 +3542,27 @@ NrSlUeProse::RemoveDataRadioBearersForU2nRelay(
     NS_LOG_FUNCTION(this << peerL2Id << relayInfo.role << ipInfo.peerIpv4Addr);
 
     uint8_t relayDrbId = 0;
+    auto itTfts = m_u2nRelayFlowTfts.find(peerL2Id);
+    if (itTfts != m_u2nRelayFlowTfts.end())
+    {
+        // Only the flows of the filter were redirected, remove their SL data radio bearers
+        for (const auto& tft : itTfts->second)
+        {
+            m_nrSlUeSvcNasSapProvider->DeleteSvcNrSlDataRadioBearer(tft);
+        }
+        m_u2nRelayFlowTfts.erase(itTfts);
+        return;
+    }
+
     if (relayInfo.role == NrSlUeProseDirLnkSapUser::RelayUe)
     {
         // Tell the EPC helper to configure the EpcPgwApplication to remove the link between the
         // remote UE and the relay UE
         m_epcHelper->RemoveRemoteUe(m_imsi, ipInfo.peerIpv4Addr);
+        if (m_u2nRelayScheduler)
+        {
+            m_u2nRelayScheduler->RemoveRemoteUe(peerL2Id);
+        }
 
         // Find data relay radio bearer id for the service
         auto it = m_l3U2nRelayProvidedSvcs.find(relayInfo.relayServiceCode);
@@ -1360,6 +3621,190 @@ NrSlUeProse::SetRelaySelectionAlgorithm(Ptr<NrSlUeProseRelaySelectionAlgorithm>
     m_relaySelectionAlgorithm = selectionAlgorithm;
 }
 
+Ptr<NrSlUeProseRelaySelectionAlgorithm>
+NrSlUeProse::GetRelaySelectionAlgorithm() const
+{
+    return m_relaySelectionAlgorithm;
+}
+
+void
+NrSlUeProse::EnableRelayBackhaulAwareness(bool connected)
+{
+    NS_LOG_FUNCTION(this << connected);
+    m_relayBackhaulAware = true;
+    m_uuConnected = connected;
+}
+
+void
+NrSlUeProse::UuRrcStateTransition(uint64_t imsi,
+                                  uint16_t cellId,
+                                  uint16_t rnti,
+                                  LteUeRrc::State oldState,
+                                  LteUeRrc::State newState)
+{
+    NS_LOG_FUNCTION(this << imsi << cellId << rnti << oldState << newState);
+    m_uuConnected = (newState == LteUeRrc::CONNECTED_NORMALLY);
+    EvaluatePathSwitch();
+}
+
+void
+NrSlUeProse::ReportUuServingCellRsrp(uint16_t cellId,
+                                     uint16_t rnti,
+                                     double rsrp,
+                                     double sinr,
+                                     uint16_t bwpId)
+{
+    NS_LOG_FUNCTION(this << cellId << rnti << rsrp << sinr << bwpId);
+    m_uuRsrp = rsrp;
+    EvaluatePathSwitch();
+}
+
+bool
+NrSlUeProse::HasRelayBackhaul() const
+{
+    if (!m_relayBackhaulAware)
+    {
+        return true;
+    }
+    return m_uuConnected && m_uuRsrp >= m_relayBackhaulRsrpThreshold;
+}
+
+void
+NrSlUeProse::EnableRemotePathSwitching(bool connected)
+{
+    NS_LOG_FUNCTION(this << connected);
+    m_remotePathSwitching = true;
+    m_uuConnected = connected;
+}
+
+bool
+NrSlUeProse::IsOnDirectPath() const
+{
+    return m_remotePathSwitching && m_onDirectPath;
+}
+
+void
+NrSlUeProse::EvaluatePathSwitch()
+{
+    if (!m_remotePathSwitching)
+    {
+        return;
+    }
+
+    bool switchNeeded = false;
+    if (m_onDirectPath)
+    {
+        switchNeeded =
+            !m_uuConnected || m_uuRsrp < m_pathSwitchUuRsrpThreshold - m_pathSwitchHysteresis;
+    }
+    else
+    {
+        switchNeeded =
+            m_uuConnected && m_uuRsrp >= m_pathSwitchUuRsrpThreshold + m_pathSwitchHysteresis;
+    }
+
+    if (!switchNeeded)
+    {
+        if (m_pathSwitchEvent.IsRunning())
+        {
+            NS_LOG_LOGIC("Path switch condition not met anymore. Cancel the path switch");
+            m_pathSwitchEvent.Cancel();
+        }
+        return;
+    }
+    if (!m_pathSwitchEvent.IsRunning())
+    {
+        NS_LOG_LOGIC("Path switch condition met. Switch to the "
+                     << (m_onDirectPath ? "relay" : "direct") << " path in "
+                     << m_pathSwitchTimeToTrigger.GetSeconds() << " s");
+        m_pathSwitchEvent = Simulator::Schedule(m_pathSwitchTimeToTrigger,
+                                                &NrSlUeProse::DoPathSwitch,
+                                                this,
+                                                !m_onDirectPath);
+    }
+}
+
+void
+NrSlUeProse::DoPathSwitch(bool toDirect)
+{
+    NS_LOG_FUNCTION(this << toDirect);
+    m_onDirectPath = toDirect;
+    m_pathSwitchTracePending = false;
+
+    if (toDirect)
+    {
+        // Release the connection with the relay, or the ongoing connection establishment
+        uint32_t relayL2Id = m_connectingRelay.l2Id != 0 ? m_connectingRelay.l2Id
+                                                         : m_pathSwitchRelay.l2Id;
+        auto it = m_unicastDirectLinks.find(relayL2Id);
+        if (it == m_unicastDirectLinks.end())
+        {
+            NS_LOG_LOGIC("No relay connection to release. The remote is on the direct path");
+            m_pathSwitchPending = false;
+            return;
+        }
+        m_pathSwitchPending = true;
+        m_pathSwitchStart = Simulator::Now();
+        m_remotePathSwitchTrace(m_l2Id, relayL2Id, true, m_uuRsrp);
+        // According to 3GPP TS 24.554, cause #2: direct communication to the target UE no
+        // longer needed. The data bearers are restored when the link enters RELEASING state
+        uint8_t cause = 2;
+        it->second->m_link->StartConnectionRelease(cause);
+    }
+    else
+    {
+        m_pathSwitchPending = true;
+        m_pathSwitchStart = Simulator::Now();
+        if (m_relaySelectionAlgorithm)
+        {
+            // The switch is traced once the algorithm selects a relay, which may happen
+            // later, upon discovery, if no relay is currently eligible
+            m_pathSwitchTracePending = true;
+            SelectRelay();
+        }
+        else if (m_pathSwitchRelay.l2Id != 0 &&
+                 m_pathSwitchRelay.l2Id != std::numeric_limits<uint32_t>::max())
+        {
+            m_remotePathSwitchTrace(m_l2Id, m_pathSwitchRelay.l2Id, false, m_uuRsrp);
+            Ipv4Address remoteIp =
+                m_ueDevice->GetNode()->GetObject<Ipv4L3Protocol>()->GetAddress(1, 0).GetLocal();
+            AddDirectLinkConnection(m_l2Id,
+                                    remoteIp,
+                                    m_pathSwitchRelay.l2Id,
+                                    true,
+                                    m_pathSwitchRelay.relayCode,
+                                    m_pathSwitchSlInfo);
+        }
+        else
+        {
+            NS_LOG_LOGIC("No relay selection algorithm nor previous relay. Cannot switch to a "
+                         "relay path");
+            m_remotePathSwitchTrace(m_l2Id, 0, false, m_uuRsrp);
+        }
+    }
+}
+
+void
+NrSlUeProse::CompletePathSwitch(uint32_t relayL2Id, bool toDirect)
+{
+    NS_LOG_FUNCTION(this << relayL2Id << toDirect);
+    if (!m_remotePathSwitching || !m_pathSwitchPending || toDirect != m_onDirectPath)
+    {
+        return;
+    }
+    m_pathSwitchPending = false;
+    m_remotePathSwitchInterruptionTrace(m_l2Id,
+                                        relayL2Id,
+                                        toDirect,
+                                        Simulator::Now() - m_pathSwitchStart);
+}
+
+Ptr<NrSlProseStats>
+NrSlUeProse::GetProseStats() const
+{
+    return m_stats;
+}
+
 void
 NrSlUeProse::SetNetDevice(Ptr<NetDevice> dev)
 {
@@ -37,16 +37,28 @@
 #define NR_SL_UE_PROSE_H
 
 #include "nr-sl-discovery-header.h"
+#include "nr-sl-prose-stats.h"
+#include "nr-sl-u2n-relay-scheduler.h"
 #include "nr-sl-ue-prose-direct-link.h"
 #include "nr-sl-ue-service.h"
 
+#include <ns3/epc-tft.h>
+#include <ns3/event-id.h>
+#include <ns3/ipv4-header.h>
+#include <ns3/lte-ue-rrc.h>
 #include <ns3/net-device.h>
 #include <ns3/nr-sl-ue-prose-dir-lnk-sap.h>
 #include <ns3/nr-sl-ue-svc-nas-sap.h>
 #include <ns3/nr-sl-ue-svc-rrc-sap.h>
+#include <ns3/nstime.h>
 #include <ns3/traced-callback.h>
 
+#include <array>
+#include <list>
+#include <set>
+#include <tuple>
 #include <unordered_map>
+#include <unordered_set>
 
 // #include <ns3/nr-sl-prose-relay-handle.h>
 
@@ -54,8 +66,113 @@ namespace ns3
 {
 
 class NrPointToPointEpcHelper;
+class NrSlDiscoveryOracle;
 class NrSlUeProseRelaySelectionAlgorithm;
 
+/**
+ * \ingroup nr
+ *
+ * Byte tag used to measure the latency of each hop of the packets relayed
+ * by a UE-to-UE relay. It is added by the source end UE, and each relay UE
+ * adds a new one for the next hop, so the tag with the most hops is the
+ * current one.
+ */
+class NrSlU2uHopTag : public Tag
+{
+  public:
+    NrSlU2uHopTag();
+
+    /**
+     * \brief Set the time the packet was sent by the source end UE
+     *
+     * \param time the time
+     */
+    void SetOriginTime(Time time);
+    /**
+     * \return the time the packet was sent by the source end UE
+     */
+    Time GetOriginTime() const;
+    /**
+     * \brief Set the time the packet was sent on its last hop
+     *
+     * \param time the time
+     */
+    void SetHopTime(Time time);
+    /**
+     * \return the time the packet was sent on its last hop
+     */
+    Time GetHopTime() const;
+    /**
+     * \brief Set the number of hops the packet completed
+     *
+     * \param hops the number of hops
+     */
+    void SetHops(uint8_t hops);
+    /**
+     * \return the number of hops the packet completed
+     */
+    uint8_t GetHops() const;
+
+    static TypeId GetTypeId(void);
+    virtual TypeId GetInstanceTypeId(void) const;
+    virtual uint32_t GetSerializedSize(void) const;
+    virtual void Serialize(TagBuffer i) const;
+    virtual void Deserialize(TagBuffer i);
+    virtual void Print(std::ostream& os) const;
+
+  private:
+    int64_t m_originTime; //!< time the packet was sent by the source, in ns
+    int64_t m_hopTime;    //!< time the packet was sent on its last hop, in ns
+    uint8_t m_hops;       //!< number of hops completed
+};
+
+/**
+ * \ingroup nr
+ *
+ * Packet tag used by a UE-to-UE relay to signal to the target end UE, in the
+ * direct link establishment request, the end UE on the other side of the
+ * relay, so that the target end UE routes its traffic for it through the
+ * relay UE. As with the Ipv4AddrTag of the direct link, this may be replaced
+ * by proper IP configuration protocols in the future.
+ */
+class NrSlU2uEndUeTag : public Tag
+{
+  public:
+    NrSlU2uEndUeTag();
+
+    /**
+     * \brief Set the layer 2 ID of the end UE
+     *
+     * \param l2Id the layer 2 ID
+     */
+    void SetL2Id(uint32_t l2Id);
+    /**
+     * \return the layer 2 ID of the end UE
+     */
+    uint32_t GetL2Id() const;
+    /**
+     * \brief Set the IPv4 address of the end UE
+     *
+     * \param addr the address
+     */
+    void SetAddress(Ipv4Address addr);
+    /**
+     * \return the IPv4 address of the end UE
+     */
+    Ipv4Address GetAddress() const;
+
+    static TypeId GetTypeId(void);
+    virtual TypeId GetInstanceTypeId(void) const;
+    virtual uint32_t GetSerializedSize(void) const;
+    virtual void Serialize(TagBuffer i) const;
+    virtual void Deserialize(TagBuffer i);
+    virtual void Print(std::ostream& os) const;
+
+  private:
+    uint32_t m_l2Id;    //!< layer 2 ID of the end UE
+    Ipv4Address m_addr; //!< IPv4 address of the end UE
+};
+
 /**
  * Store information of the active direct link instance
  * * \ingroup lte
@@ -80,6 +197,7 @@ class NrSlUeProseDirLinkContext : public Object
     bool
         m_hasPendingSlDrb; ///< Flag to indicate if the UE is having a SL-DRB pending for activation
     bool m_hasActiveSlDrb; ///< Flag to indicate if the UE has an active SL-DRB
+    bool m_hasU2nRelayDrbs; ///< Flag to indicate if the relay configured the bearers of the remote
     uint32_t m_relayServiceCode; ///< the relay service code associated to this direct link
     SidelinkInfo m_slInfo;       ///< Traffic profile used for this direct link
 };
@@ -120,13 +238,51 @@ class NrSlUeProse : public NrSlUeService
         ModelB      ///< request/response
     };
 
+    ///< The kinds of code identifying a discovery, each one with its own code space
+    enum DiscoveryCodeType
+    {
+        ApplicationCode = 0, ///< ProSe application code (AddDiscoveryApp)
+        U2nRelayCode,        ///< U2N relay service code (AddRelayDiscovery)
+        U2uRelayCode,        ///< U2U relay service code (AddU2uRelayDiscovery)
+        GroupCode            ///< group ID (AddGroupDiscovery)
+    };
+
+    ///< The remote UE redirected by a relay UE with more than RelayMaxRemoteUes remote UEs
+    enum RelayRedirectionPolicy
+    {
+        RedirectNewest = 0, ///< the remote UE requesting the connection, which is rejected
+        RedirectOldest      ///< the remote UE connected for the longest time
+    };
+
+    ///< Transmission parameters of the discovery messages of a given code
+    struct DiscoveryTxParameters
+    {
+        Time interval{Seconds(0)}; ///< interval between announcements/requests. A zero interval
+                                   ///< means the UE-wide DiscoveryInterval attribute is used
+        uint8_t priority{0};       ///< priority of the messages. Zero means the UE-wide
+                                   ///< DiscoveryPriority attribute is used
+        Time pdb{Seconds(0)};      ///< packet delay budget of the messages. A zero PDB means
+                                   ///< the UE-wide DiscoveryPacketDelayBudget attribute is used
+    };
+
     ///< Information for application discovery
     struct DiscoveryInfo
     {
-        DiscoveryModel model; ///< discovery model used
-        DiscoveryRole role;   ///< role in the discovery
-        uint32_t appCode;     ///< application code
-        uint32_t dstL2Id;     ///< destination L2 ID
+        DiscoveryModel model;           ///< discovery model used
+        DiscoveryRole role;             ///< role in the discovery
+        uint32_t appCode;               ///< application code
+        uint32_t dstL2Id;               ///< destination L2 ID
+        DiscoveryTxParameters txParams; ///< transmission parameters for this code
+        EventId responseEvent;          ///< end of the current relay response interval
+        bool responsePending{false};    ///< whether solicitations await the next response
+    };
+
+    ///< Duty cycle of the reception of discovery messages
+    struct MonitoringDutyCycle
+    {
+        Time window;          ///< duration of the listen window in each period
+        Time period;          ///< period of the listen windows
+        Time offset{Seconds(0)}; ///< start time of the first listen window
     };
 
     ///< Information about discovered relays
@@ -136,8 +292,27 @@ class NrSlUeProse : public NrSlUeService
         uint32_t relayCode{std::numeric_limits<uint32_t>::max()}; ///< relay code
         double rsrp{-std::numeric_limits<double>::infinity()};    ///< RSRP
         bool eligible{false}; ///< whether relay meets RSRP threshold/hysteresis criteria
+        uint8_t status{1};    ///< status indicator announced by the relay, 0 if weak backhaul
+    };
+
+    ///< Information about peers discovered through direct (non-relay) discovery
+    struct DiscoveredPeerInfo
+    {
+        uint32_t l2Id{0};   ///< layer 2 ID of the peer
+        Time firstHeard;    ///< time the peer was discovered
+        Time lastHeard;     ///< time the last discovery message from the peer was received
+        uint32_t count{0};  ///< number of discovery messages received from the peer
+        double rsrp{-std::numeric_limits<double>::infinity()}; ///< last RSRP known for the peer
+        EventId expiryEvent; ///< event checking the expiry of the entry
     };
 
+    /**
+     * Map to store the discovered peers of an application code, indexed by peer L2 ID
+     */
+    typedef std::unordered_map<uint32_t, DiscoveredPeerInfo> DiscoveredPeerMap;
+    /// Iterator over the discovered peers of an application code
+    typedef DiscoveredPeerMap::const_iterator DiscoveredPeerIterator;
+
   protected:
     virtual void DoDispose();
 
@@ -192,6 +367,25 @@ class NrSlUeProse : public NrSlUeService
      * \param val discovery interval
      */
     void SetDiscoveryInterval(Time val);
+    /**
+     * \brief Set the discovery transmission parameters of an application or relay code
+     *
+     * The parameters apply to the code from the next transmission onwards. If the
+     * code is not yet registered, they are stored and applied once the code is
+     * added. Fields left to zero fall back to the UE-wide DiscoveryInterval,
+     * DiscoveryPriority and DiscoveryPacketDelayBudget attributes.
+     *
+     * The priority and PDB are handled by this layer; the discovery radio
+     * bearers themselves are activated by the RRC per destination layer 2 ID
+     * with the RRC discovery profile.
+     *
+     * \param type the kind of code
+     * \param code the application code, relay service code or group ID
+     * \param params the transmission parameters
+     */
+    void SetDiscoveryTxParameters(DiscoveryCodeType type,
+                                  uint32_t code,
+                                  DiscoveryTxParameters params);
 
     /**
      * \brief Configure the parameters required by the UE to perform ProSe
@@ -203,6 +397,8 @@ class NrSlUeProse : public NrSlUeService
      * \brief Configure the monitoring of layer 2 IDs required by the UE to
      *        perform ProSe discovery
      *
+     * The RRC is only instructed once per layer 2 ID
+     *
      * \param dstL2Id a destination layer 2 ID to monitor
      */
     void ConfigureL2IdMonitoringForDiscovery(uint32_t dstL2Id);
@@ -229,6 +425,30 @@ class NrSlUeProse : public NrSlUeService
                                  bool isInitiating,
                                  uint32_t relayServiceCode,
                                  const struct SidelinkInfo& slInfo);
+    /**
+     * \brief Automatically establish a unicast direct link with the peers
+     *        discovered for an application code
+     *
+     * When a discovery message of the application code is received by a
+     * monitoring (Model A) or discoverer (Model B) UE, a direct link with the
+     * sender is initiated, unless a link with it already exists or was
+     * attempted less than AutoDirectLinkHoldOff ago, or the UE already has
+     * AutoDirectLinkMaxLinks direct links. The UE must be configured for
+     * unicast and its net device set.
+     *
+     * \param appCode the application code
+     * \param slInfo the traffic profile parameters to be used for the sidelink
+     *        data radio bearer. Source and destination L2 IDs are set upon connection
+     */
+    void EnableAutoDirectLink(uint32_t appCode, const struct SidelinkInfo& slInfo);
+    /**
+     * \brief Stop establishing direct links automatically for an application code
+     *
+     * Links already established are not released.
+     *
+     * \param appCode the application code
+     */
+    void DisableAutoDirectLink(uint32_t appCode);
     /**
      * Map to store direct link context instances indexed by direct link id
      */
@@ -265,6 +485,72 @@ class NrSlUeProse : public NrSlUeService
     void AddL3U2nRelayServiceConfiguration(uint32_t relayServiceCode,
                                            NrSlL3U2nServiceConfiguration config);
 
+    /**
+     * \brief Set the flows that a remote UE redirects through the relay UE
+     *
+     * When the UE connects as remote UE to a relay UE for the given relay
+     * service, only its uplink flows matching the packet filters of the TFT
+     * are redirected through the relay UE, while the other flows keep using
+     * the Uu. Without a filter, all the traffic of the remote UE is
+     * redirected. A SL data radio bearer towards the relay UE is activated per
+     * uplink packet filter, thus the filters can only match the remote
+     * address and mask (the SL TFTs of the NAS do not match ports or type of
+     * service).
+     *
+     * \param relayServiceCode the relay service code
+     * \param tft the TFT identifying the flows to redirect
+     */
+    void SetU2nRelayFlowFilter(uint32_t relayServiceCode, Ptr<EpcTft> tft);
+
+    /**
+     * \brief Remove the flow filter of a relay service, so that all the traffic
+     *        is redirected through the relay UE in the next connections
+     *
+     * \param relayServiceCode the relay service code
+     */
+    void RemoveU2nRelayFlowFilter(uint32_t relayServiceCode);
+
+    /**
+     * \brief Set the scheduler of the packets relayed by this L3 U2N relay UE
+     *
+     * The remote UEs are added to the scheduler upon connection and removed
+     * upon release. The NAS does not hand the relayed packets to the ProSe
+     * layer, thus the scheduler is put in the forwarding path of the relay UE
+     * with a NrSlU2nRelayRouting, as NrSlProseHelper::EnableU2nRelayScheduling
+     * does.
+     *
+     * \param scheduler the scheduler
+     */
+    void SetU2nRelayScheduler(Ptr<NrSlU2nRelayScheduler> scheduler);
+
+    /**
+     * \brief Get the scheduler of the packets relayed by this L3 U2N relay UE
+     *
+     * \return the scheduler, or nullptr if not set
+     */
+    Ptr<NrSlU2nRelayScheduler> GetU2nRelayScheduler() const;
+
+    /**
+     * \brief Get the number of unicast direct links of this UE
+     *
+     * \return the number of direct link contexts, whatever their state
+     */
+    uint32_t GetNumDirectLinks() const;
+
+    /**
+     * \brief Estimate the memory used by this ProSe layer for its unicast direct links
+     *
+     * This is a static estimate: the sizes of the types of the direct link
+     * contexts and instances, and of the entries of the per-peer containers
+     * of the ProSe layer, times their numbers, with an approximation of the
+     * container node overhead. The memory allocated by these objects (e.g.,
+     * their own containers and pending events) and by the lower layers for
+     * the bearers of the links is not included.
+     *
+     * \return the estimated memory in bytes
+     */
+    uint64_t GetDirectLinkMemoryUsage() const;
+
     /**
      * \brief Set the IMSI used by the UE
      *
@@ -357,6 +643,77 @@ class NrSlUeProse : public NrSlUeService
                                             uint32_t currentRelayL2Id,
                                             double rsrpValue);
 
+    /**
+     * TracedCallback signature for the redirection of remote UEs by a relay UE
+     *
+     * \param [in] relayL2Id layer 2 ID of the relay UE
+     * \param [in] remoteL2Id layer 2 ID of the redirected remote UE
+     * \param [in] alternativeRelayL2Id layer 2 ID of the relay UE suggested to
+     *             the remote UE, or 0 if none
+     */
+    typedef void (*RelayRedirectionTracedCallback)(uint32_t relayL2Id,
+                                                   uint32_t remoteL2Id,
+                                                   uint32_t alternativeRelayL2Id);
+
+    /**
+     * TracedCallback signature for UE-to-UE route selection
+     *
+     * \param [in] selfL2Id layer 2 ID of the source end UE
+     * \param [in] targetL2Id layer 2 ID of the target end UE
+     * \param [in] nextHopL2Id layer 2 ID of the selected relay UE, or of the target end
+     *             UE for the direct path
+     * \param [in] rsrpValue RSRP value of the next hop in dBm
+     */
+    typedef void (*U2uRouteSelectionTracedCallback)(uint32_t selfL2Id,
+                                                    uint32_t targetL2Id,
+                                                    uint32_t nextHopL2Id,
+                                                    double rsrpValue);
+
+    /**
+     * TracedCallback signature for the latency of the hops of UE-to-UE relayed packets
+     *
+     * \param [in] selfL2Id layer 2 ID of the UE completing the hop (relay or target end UE)
+     * \param [in] srcAddr IPv4 address of the source end UE
+     * \param [in] dstAddr IPv4 address of the target end UE
+     * \param [in] hop index of the hop, starting at 1
+     * \param [in] hopDelay latency of the hop
+     * \param [in] delay latency since the transmission by the source end UE
+     */
+    typedef void (*U2uHopLatencyTracedCallback)(uint32_t selfL2Id,
+                                                Ipv4Address srcAddr,
+                                                Ipv4Address dstAddr,
+                                                uint8_t hop,
+                                                Time hopDelay,
+                                                Time delay);
+
+    /**
+     * TracedCallback signature for the path switching of a remote UE
+     *
+     * \param [in] selfL2Id layer 2 ID of the remote UE
+     * \param [in] relayL2Id layer 2 ID of the relay UE released or connected to
+     * \param [in] toDirect true if switching to the direct Uu path, false if
+     *             switching to the relay path
+     * \param [in] uuRsrp last serving cell RSRP of the remote UE in dBm
+     */
+    typedef void (*RemotePathSwitchTracedCallback)(uint32_t selfL2Id,
+                                                   uint32_t relayL2Id,
+                                                   bool toDirect,
+                                                   double uuRsrp);
+
+    /**
+     * TracedCallback signature for the interruption time of a path switch
+     *
+     * \param [in] selfL2Id layer 2 ID of the remote UE
+     * \param [in] relayL2Id layer 2 ID of the relay UE released or connected to
+     * \param [in] toDirect true if the switch was to the direct Uu path
+     * \param [in] interruption time between the switch decision and the
+     *             reconfiguration of the data bearers on the new path
+     */
+    typedef void (*RemotePathSwitchInterruptionTracedCallback)(uint32_t selfL2Id,
+                                                               uint32_t relayL2Id,
+                                                               bool toDirect,
+                                                               Time interruption);
+
     /**
      * \brief Add discovery application
      * Add payload depending on the interest (monitoring or announcing)
@@ -402,6 +759,20 @@ class NrSlUeProse : public NrSlUeService
                            DiscoveryModel model,
                            DiscoveryRole role);
 
+    /**
+     * \brief Add several relay codes at once
+     *
+     * Unlike AddRelayDiscovery, the codes already added are ignored, so the
+     * codes shared by several relays can be passed without filtering.
+     *
+     * \param relayCodes the destination layer 2 ID of each relay code
+     * \param model can be model A or model B
+     * \param role Indicates if the UE acts as relay or remote
+     */
+    void AddRelayDiscoveryCodes(const std::map<uint32_t, uint32_t>& relayCodes,
+                                DiscoveryModel model,
+                                DiscoveryRole role);
+
     /**
      * \brief Remove Sidelink discovery relay
      * Remove relay code from list
@@ -418,6 +789,125 @@ class NrSlUeProse : public NrSlUeService
      */
     bool IsMonitoringRelay(uint8_t msgType, uint32_t relayCode);
 
+    /**
+     * \brief Add UE-to-UE relay discovery
+     *
+     * A relay UE announces (Model A) or responds with (Model B) the end UEs
+     * it can reach for the relay service code, i.e., the end UEs it heard a
+     * solicitation from or has a direct link with for the code. An end UE
+     * (role RemoteUE) monitors the announcements (Model A) or solicits the
+     * relays (Model B) to build its UE-to-UE routes.
+     *
+     * \param relayCode the UE-to-UE relay service code
+     * \param dstL2Id destination layer 2 ID
+     * \param model can be model A or model B
+     * \param role RelayUE for the relay UE, RemoteUE for an end UE
+     */
+    void AddU2uRelayDiscovery(uint32_t relayCode,
+                              uint32_t dstL2Id,
+                              DiscoveryModel model,
+                              DiscoveryRole role);
+
+    /**
+     * \brief Remove UE-to-UE relay discovery
+     *
+     * \param relayCode the UE-to-UE relay service code
+     * \param role role of the UE for the code
+     */
+    void RemoveU2uRelayDiscovery(uint32_t relayCode, DiscoveryRole role);
+
+    /**
+     * Indicates if the device is monitoring messages for the given UE-to-UE relay code
+     * \param msgType The message type received
+     * \param relayCode the UE-to-UE relay service code
+     * \return true if the node is monitoring for this message type and relayCode
+     */
+    bool IsMonitoringU2uRelay(uint8_t msgType, uint32_t relayCode);
+
+    /**
+     * \brief Send UE-to-UE relay discovery messages
+     * \param relayCode the UE-to-UE relay service code
+     * \param dstL2Id destination layer 2 ID
+     */
+    void SendU2uRelayDiscovery(uint32_t relayCode, uint32_t dstL2Id);
+
+    /**
+     * \brief Select the route towards an end UE
+     *
+     * The direct path is selected if the RSRP of the target UE is known and
+     * not below the U2uDirectPathRsrpThreshold attribute. Otherwise, the relay
+     * with the highest RSRP among the ones announcing the target UE is selected,
+     * or, if none announces it, among the ones announcing no specific end UE.
+     *
+     * \param targetL2Id the layer 2 ID of the target end UE
+     * \return the next hop, i.e., the target UE itself for the direct path or
+     *         the relay UE along with its relay service code. The L2 ID is the
+     *         maximum value if no route is known
+     */
+    RelayInfo SelectU2uRoute(uint32_t targetL2Id);
+
+    /**
+     * \brief Connect to an end UE through the route selected by SelectU2uRoute
+     *
+     * For a relayed route, the direct link with the relay UE carries the
+     * target UE in its establishment request, upon which the relay UE
+     * establishes the second hop towards the target UE and forwards the
+     * packets between the two hops at the IP layer.
+     *
+     * \param targetL2Id the layer 2 ID of the target end UE
+     * \param targetIp the IPv4 address of the target end UE
+     * \param slInfo the traffic profile parameters to be used for the sidelink
+     *        data radio bearer
+     */
+    void ConnectToU2uTarget(uint32_t targetL2Id,
+                            Ipv4Address targetIp,
+                            const struct SidelinkInfo& slInfo);
+
+    /**
+     * \brief Get an iterator to the first peer discovered for an application code
+     *
+     * Peers are added upon reception of open announcements (monitoring UEs) and
+     * restricted responses (discoverer UEs), and removed once they are not heard
+     * for DiscoveredPeerTtl.
+     *
+     * \param appCode the application code
+     * \return the iterator to the first discovered peer
+     */
+    DiscoveredPeerIterator DiscoveredPeersBegin(uint32_t appCode) const;
+    /**
+     * \brief Get an iterator past the last peer discovered for an application code
+     *
+     * \param appCode the application code
+     * \return the end iterator of the discovered peers
+     */
+    DiscoveredPeerIterator DiscoveredPeersEnd(uint32_t appCode) const;
+    /**
+     * \brief Get the number of peers currently discovered for an application code
+     *
+     * \param appCode the application code
+     * \return the number of discovered peers
+     */
+    uint32_t GetNDiscoveredPeers(uint32_t appCode) const;
+    /**
+     * \brief Check whether a peer is currently discovered for an application code
+     *
+     * \param appCode the application code
+     * \param peerL2Id the layer 2 ID of the peer
+     * \return true if the peer is in the discovered peer table
+     */
+    bool IsPeerDiscovered(uint32_t appCode, uint32_t peerL2Id) const;
+    /**
+     * TracedCallback signature for changes in the discovered peer table.
+     *
+     * \param [in] selfL2Id the layer 2 ID of this UE
+     * \param [in] appCode the application code
+     * \param [in] peerL2Id the layer 2 ID of the peer
+     * \param [in] appeared true if the peer was discovered, false if it expired
+     */
+    typedef void (*DiscoveredPeerTracedCallback)(uint32_t selfL2Id,
+                                                 uint32_t appCode,
+                                                 uint32_t peerL2Id,
+                                                 bool appeared);
     /**
      * \brief Initiate relay discovery
      * \param relayCode relay code to consider
@@ -425,6 +915,114 @@ class NrSlUeProse : public NrSlUeService
      */
     void SendRelayDiscovery(uint32_t relayCode, uint32_t dstL2Id);
 
+    /**
+     * \brief Add group member discovery
+     *
+     * Register the UE as member of a discovery group. In Model A, announcing
+     * members periodically announce themselves and also monitor the
+     * announcements of the other members, while monitoring members only listen.
+     * In Model B, discoverer members periodically solicit the group and
+     * discoveree members respond to the solicitations.
+     *
+     * \param groupId the discovery group ID (24 bits)
+     * \param dstL2Id destination layer 2 ID used by the group
+     * \param model can be model A or model B
+     * \param role Indicates the role of the UE in the group discovery
+     */
+    void AddGroupDiscovery(uint32_t groupId,
+                           uint32_t dstL2Id,
+                           DiscoveryModel model,
+                           DiscoveryRole role);
+    /**
+     * \brief Remove group member discovery
+     *
+     * \param groupId the discovery group ID
+     * \param role role of the UE in the group discovery
+     */
+    void RemoveGroupDiscovery(uint32_t groupId, DiscoveryRole role);
+    /**
+     * Indicates if the device is monitoring messages for the given group
+     * \param msgType The message type received
+     * \param groupId the discovery group ID
+     * \return true if the node is monitoring for this message type and group
+     */
+    bool IsMonitoringGroup(uint8_t msgType, uint32_t groupId);
+    /**
+     * \brief Send group member discovery message
+     * \param groupId the discovery group ID
+     * \param dstL2Id destination layer 2 ID
+     */
+    void SendGroupDiscovery(uint32_t groupId, uint32_t dstL2Id);
+    /**
+     * \brief Get an iterator to the first member discovered for a group
+     *
+     * Members are added upon reception of group announcements (Model A) and
+     * group responses (Model B), and removed once they are not heard for
+     * DiscoveredPeerTtl or when the UE leaves the group.
+     *
+     * \param groupId the discovery group ID
+     * \return the iterator to the first discovered member
+     */
+    DiscoveredPeerIterator GroupMembersBegin(uint32_t groupId) const;
+    /**
+     * \brief Get an iterator past the last member discovered for a group
+     *
+     * \param groupId the discovery group ID
+     * \return the end iterator of the discovered members
+     */
+    DiscoveredPeerIterator GroupMembersEnd(uint32_t groupId) const;
+    /**
+     * \brief Get the number of members currently discovered for a group
+     *
+     * \param groupId the discovery group ID
+     * \return the number of discovered members
+     */
+    uint32_t GetNGroupMembers(uint32_t groupId) const;
+    /**
+     * \brief Check whether a UE is currently discovered as member of a group
+     *
+     * \param groupId the discovery group ID
+     * \param memberL2Id the layer 2 ID of the member
+     * \return true if the UE is in the member table of the group
+     */
+    bool IsGroupMemberDiscovered(uint32_t groupId, uint32_t memberL2Id) const;
+    /**
+     * \brief Duty-cycle the reception of discovery messages for a role
+     *
+     * While all the receiving discovery roles configured in the UE are outside
+     * their listen window, the received discovery messages are dropped before
+     * being parsed. Transmit-only roles are not considered (see
+     * IsReceivingRole). Roles without a duty cycle listen continuously. The duty cycle can
+     * be changed at any time, e.g., once a remote UE has selected a relay.
+     *
+     * \param role the discovery role
+     * \param dutyCycle the listen window and period
+     */
+    void SetMonitoringDutyCycle(DiscoveryRole role, MonitoringDutyCycle dutyCycle);
+    /**
+     * \brief Remove the duty cycle of a role, which listens continuously afterwards
+     *
+     * \param role the discovery role
+     */
+    void RemoveMonitoringDutyCycle(DiscoveryRole role);
+    /**
+     * \brief Check whether the UE currently processes received discovery messages
+     *
+     * \return true if at least one discovery role of the UE is listening
+     */
+    bool IsListeningToDiscovery() const;
+    /**
+     * \brief Check whether a code with a given role receives discovery messages
+     *
+     * Transmit-only roles, such as announcing an application code or announcing
+     * a relay service code in Model A, do not keep the UE listening.
+     *
+     * \param type the kind of code
+     * \param model the discovery model of the code
+     * \param role the discovery role
+     * \return true if the role processes received discovery messages
+     */
+    static bool IsReceivingRole(DiscoveryCodeType type, DiscoveryModel model, DiscoveryRole role);
     /**
      * \brief Return the list of relays
      * \return the list of discovered relays along with their corresponding relay service codes
@@ -448,6 +1046,146 @@ class NrSlUeProse : public NrSlUeService
      */
     void SetRelaySelectionAlgorithm(Ptr<NrSlUeProseRelaySelectionAlgorithm> selectionAlgorithm);
 
+    /**
+     * \brief Get the relay selection algorithm
+     *
+     * The same algorithm instance may be shared by several UEs.
+     *
+     * \return the relay selection algorithm, or nullptr if not set
+     */
+    Ptr<NrSlUeProseRelaySelectionAlgorithm> GetRelaySelectionAlgorithm() const;
+
+    /**
+     * \brief Deliver the discovery messages of the UE with a discovery oracle
+     *
+     * Once set, the discovery messages transmitted by the UE are handed to
+     * the oracle instead of the RRC, and no SL Discovery RB is activated.
+     * The UE receives discovery messages from the oracle through
+     * ReceiveOracleDiscovery, and must be registered with it (see
+     * NrSlDiscoveryOracle::AddUe).
+     *
+     * \param oracle the discovery oracle
+     */
+    void SetDiscoveryOracle(Ptr<NrSlDiscoveryOracle> oracle);
+
+    /**
+     * \brief Check whether the UE receives the discovery messages sent to a layer 2 ID
+     *
+     * \param dstL2Id the destination layer 2 ID
+     * \return true if the UE monitors the layer 2 ID for discovery
+     */
+    bool IsMonitoringDiscoveryL2Id(uint32_t dstL2Id) const;
+
+    /**
+     * \brief Receive a discovery message delivered by the discovery oracle
+     *
+     * If a relay selection algorithm is set, the RSRP of the transmitter is
+     * recorded, and traced, as a measurement reported by the PHY would be,
+     * before the message is processed.
+     *
+     * \param packet the discovery packet
+     * \param srcL2Id the source layer 2 ID
+     * \param rsrp the RSRP of the transmitter in dBm
+     * \param eligible whether the transmitter is an eligible relay
+     */
+    void ReceiveOracleDiscovery(Ptr<Packet> packet, uint32_t srcL2Id, double rsrp, bool eligible);
+
+    /**
+     * \brief Make the relay discovery messages reflect the Uu connectivity of the UE
+     *
+     * Once enabled, the status indicator of the relay announcements and
+     * responses is set to 1 only if the UE is in RRC CONNECTED state and its
+     * serving cell RSRP is not below the RelayBackhaulRsrpThreshold
+     * attribute, and to 0 otherwise. The Uu information is provided through
+     * UuRrcStateTransition and ReportUuServingCellRsrp, which are meant to be
+     * connected to the corresponding trace sources of the RRC and PHY.
+     *
+     * \param connected whether the UE is currently in RRC CONNECTED state
+     */
+    void EnableRelayBackhaulAwareness(bool connected);
+    /**
+     * \brief Trace sink for the RRC state transitions of the UE on the Uu
+     *
+     * \param imsi the IMSI of the UE
+     * \param cellId the cell ID
+     * \param rnti the RNTI of the UE
+     * \param oldState the previous RRC state
+     * \param newState the new RRC state
+     */
+    void UuRrcStateTransition(uint64_t imsi,
+                              uint16_t cellId,
+                              uint16_t rnti,
+                              LteUeRrc::State oldState,
+                              LteUeRrc::State newState);
+    /**
+     * \brief Trace sink for the RSRP measurements of the serving cell of the UE
+     *
+     * \param cellId the cell ID
+     * \param rnti the RNTI of the UE
+     * \param rsrp the RSRP of the serving cell in dBm
+     * \param sinr the average SINR
+     * \param bwpId the BWP ID
+     */
+    void ReportUuServingCellRsrp(uint16_t cellId,
+                                 uint16_t rnti,
+                                 double rsrp,
+                                 double sinr,
+                                 uint16_t bwpId);
+    /**
+     * \brief Indicate if the UE has a backhaul good enough to act as relay
+     *
+     * \return true if backhaul awareness is disabled or the Uu connectivity is good
+     */
+    bool HasRelayBackhaul() const;
+
+    /**
+     * \brief Switch the path of the remote UE between its relay UE and the Uu
+     *
+     * Once enabled, the remote UE releases its U2N relay connection when its
+     * serving cell RSRP exceeds the PathSwitchUuRsrpThreshold attribute plus
+     * the PathSwitchHysteresis attribute during PathSwitchTimeToTrigger, which
+     * restores the direct Uu data bearers, and does not select a relay while
+     * on the direct path. When the UE leaves RRC CONNECTED state or its serving
+     * cell RSRP falls below the threshold minus the hysteresis during the same
+     * time, it connects again to a relay, either through the relay selection
+     * algorithm or to the last relay it was connected to. The Uu information
+     * is provided through UuRrcStateTransition and ReportUuServingCellRsrp.
+     *
+     * \param connected whether the UE is currently in RRC CONNECTED state
+     */
+    void EnableRemotePathSwitching(bool connected);
+    /**
+     * \brief Indicate if the remote UE is on the direct Uu path
+     *
+     * \return true if path switching is enabled and the direct path is preferred
+     */
+    bool IsOnDirectPath() const;
+
+    /**
+     * \brief Redirect a remote UE connected to this relay UE to another relay UE
+     *
+     * The relay UE releases the direct link with the remote UE with cause #13
+     * (congestion situation), or rejects its establishment request with this
+     * cause if the link is being established, suggesting the neighbour relay
+     * UE providing the same relay service with the highest RSRP, among those
+     * heard in the relay discovery messages with good backhaul. The remote UE
+     * then avoids this relay UE during RelayRedirectionHoldOff, and its relay
+     * selection picks the suggested relay UE if discovered. This is also done
+     * automatically when a remote UE requests a connection while
+     * RelayMaxRemoteUes remote UEs are connected, for the remote UE chosen by
+     * the RelayRedirectionPolicy, before the bearers and the EPC are
+     * configured for the new remote UE.
+     *
+     * \param remoteL2Id the layer 2 ID of the remote UE
+     */
+    void RedirectRemoteUe(uint32_t remoteL2Id);
+
+    /**
+     * \brief Get the ProSe counters of this UE
+     *
+     * \return the counters, which are updated as the simulation goes
+     */
+    Ptr<NrSlProseStats> GetProseStats() const;
     /**
      * \brief Set the Net Device of the this UE
      *
@@ -456,11 +1194,9 @@ class NrSlUeProse : public NrSlUeService
     void SetNetDevice(Ptr<NetDevice> dev);
 
     /**
-     * Map to keep track of the active SL Discovery RBs.
-     * A bit set of 4 bits representing each of the 4 LcIds of the SL-SRBs is stored per peerL2Id.
-     * Bit set to 1 means the SL-SRB of the corresponding LcId is active
+     * Set of the destination L2 IDs with an active SL Discovery RB
      */
-    typedef std::list<uint32_t> NrSlDiscoveryRadioBearers;
+    typedef std::unordered_set<uint32_t> NrSlDiscoveryRadioBearers;
 
     ///< Frequency of Discovery messages in seconds
     Time m_discoveryInterval;
@@ -479,6 +1215,129 @@ class NrSlUeProse : public NrSlUeService
                                          NrSlUeProseDirLnkSapUser::ChangeOfStateNotification info);
     void DoSendNrSlDiscovery(Ptr<Packet> packet, uint32_t dstL2Id);
 
+    /**
+     * \brief Transmit a discovery message, or queue it for aggregation if enabled
+     *
+     * \param discHeader the discovery message
+     * \param dstL2Id the destination L2 ID
+     * \param txParams the transmission parameters of the code of the message
+     */
+    void TransmitDiscovery(const NrSlDiscoveryHeader& discHeader,
+                           uint32_t dstL2Id,
+                           const DiscoveryTxParameters& txParams);
+    /// Destination L2 ID, priority and PDB of the discovery messages aggregated together
+    typedef std::tuple<uint32_t, uint8_t, Time> AggregatedDiscoveryKey;
+    /**
+     * \brief Transmit the discovery messages queued for a destination, priority
+     *        and PDB in one packet
+     *
+     * \param key the destination L2 ID, priority and PDB of the messages
+     */
+    void FlushAggregatedDiscovery(AggregatedDiscoveryKey key);
+    /**
+     * \brief Process a received discovery message
+     *
+     * \param discHeader the discovery message
+     * \param srcL2Id the L2 ID of the sender
+     */
+    void ProcessNrSlDiscovery(const NrSlDiscoveryHeader& discHeader, uint32_t srcL2Id);
+    /**
+     * \brief Check if a received discovery message duplicates a recently processed one
+     *
+     * The messages are identified by sender, message type, code and status
+     * indicator. A message not seen within the DiscoveryDuplicateWindow is
+     * recorded as the new reference.
+     *
+     * \param discHeader the discovery message
+     * \param srcL2Id the L2 ID of the sender
+     * \return true if the message should be suppressed
+     */
+    bool IsDuplicateDiscovery(const NrSlDiscoveryHeader& discHeader, uint32_t srcL2Id);
+    /**
+     * \brief Respond to a relay discovery solicitation
+     *
+     * Without response aggregation, the response is sent to the solicitor.
+     * Otherwise, at most one response per discovery interval is sent to the
+     * destination L2 ID of the relay code, covering all the solicitors.
+     *
+     * \param relayCode the relay service code solicited
+     * \param srcL2Id the L2 ID of the solicitor
+     */
+    void RespondToRelaySolicitation(uint32_t relayCode, uint32_t srcL2Id);
+    /**
+     * \brief End of a relay response aggregation interval
+     *
+     * \param relayCode the relay service code
+     */
+    void RelayResponseIntervalExpiry(uint32_t relayCode);
+    /**
+     * \brief Get the end UEs a UE-to-UE relay can currently reach for a code
+     *
+     * The end UEs not heard for DiscoveredPeerTtl are removed
+     *
+     * \param relayCode the UE-to-UE relay service code
+     * \return the layer 2 IDs of the reachable end UEs
+     */
+    std::vector<uint32_t> GetU2uReachableUes(uint32_t relayCode);
+    /**
+     * \brief Get the target user info of a direct link establishment request
+     *
+     * \param peerL2Id the layer 2 ID of the peer UE of the direct link
+     * \param relayCode the relay service code of the direct link, 0 if none
+     * \return the layer 2 ID of the end UE on the other side of the UE-to-UE
+     *         relay peer, or 0 to target the peer UE itself
+     */
+    uint32_t GetU2uTargetUserInfo(uint32_t peerL2Id, uint32_t relayCode);
+
+    /**
+     * \brief Configure a direct link that is a hop of a UE-to-UE relay path
+     *
+     * The hop uses a regular unicast SL-DRB. At the end UEs, it carries the
+     * traffic towards the end UE on the other side of the relay. At the relay
+     * UE, the first hop triggers the establishment of the second one, which
+     * signals the source end UE to the target end UE.
+     *
+     * \param peerL2Id the L2 ID of the peer UE in the link
+     * \param relayCode the UE-to-UE relay service code
+     * \param ipInfo the IP configuration of the link
+     * \param slInfo the traffic profile of the link
+     */
+    void ConfigureU2uRelayHop(uint32_t peerL2Id,
+                              uint32_t relayCode,
+                              NrSlUeProseDirLnkSapUser::DirectLinkIpInfo ipInfo,
+                              const struct SidelinkInfo& slInfo);
+    /**
+     * \brief Enable the IP forwarding and the hop latency measurement of
+     *        UE-to-UE relayed packets, once per UE
+     */
+    void EnableU2uRelayIpHooks();
+    /**
+     * \brief Trace sink for the packets sent by the IP layer of the UE
+     *
+     * \param header the IPv4 header
+     * \param packet the packet
+     * \param interface the interface index
+     */
+    void U2uIpSendOutgoing(const Ipv4Header& header, Ptr<const Packet> packet, uint32_t interface);
+    /**
+     * \brief Trace sink for the packets forwarded by the IP layer of the UE
+     *
+     * \param header the IPv4 header
+     * \param packet the packet
+     * \param interface the interface index
+     */
+    void U2uIpUnicastForward(const Ipv4Header& header,
+                             Ptr<const Packet> packet,
+                             uint32_t interface);
+    /**
+     * \brief Trace sink for the packets delivered locally by the IP layer of the UE
+     *
+     * \param header the IPv4 header
+     * \param packet the packet
+     * \param interface the interface index
+     */
+    void U2uIpLocalDeliver(const Ipv4Header& header, Ptr<const Packet> packet, uint32_t interface);
+
     /**
      * Trace information upon transmission and reception of PC5-S messages
      */
@@ -490,6 +1349,14 @@ class NrSlUeProse : public NrSlUeService
      */
     TracedCallback<uint32_t, uint32_t, bool, NrSlDiscoveryHeader> m_discoveryTrace;
 
+    /**
+     * Traces fired when a peer appears in or disappears from the discovered peer table
+     */
+    TracedCallback<uint32_t, uint32_t, uint32_t, bool> m_discoveredPeerTrace;
+    /**
+     * Traces fired when a member appears in or disappears from the member table of a group
+     */
+    TracedCallback<uint32_t, uint32_t, uint32_t, bool> m_groupMemberTrace;
     /**
      * Traces fired when the Remote UE discovers a new Relay UE
      */
@@ -499,11 +1366,33 @@ class NrSlUeProse : public NrSlUeService
      * Traces fired when the Remote UE selects a new Relay UE
      */
     TracedCallback<uint32_t, uint32_t, uint32_t, uint32_t, double> m_relaySelectionTrace;
+    /**
+     * Trace of the path switches of the remote UE between the relay and the Uu
+     */
+    TracedCallback<uint32_t, uint32_t, bool, double> m_remotePathSwitchTrace;
+    /**
+     * Trace of the interruption time of the path switches of the remote UE
+     */
+    TracedCallback<uint32_t, uint32_t, bool, Time> m_remotePathSwitchInterruptionTrace;
 
     /**
      * Traces fired when an RSRP value is available between a Remote UE and a Relay UE
      */
     TracedCallback<uint32_t, uint32_t, double> m_relayRsrpTrace;
+    /**
+     * Traces fired when a relay UE redirects one of its remote UEs
+     */
+    TracedCallback<uint32_t, uint32_t, uint32_t> m_relayRedirectionTrace;
+
+    /**
+     * Traces fired when an end UE selects the route towards another end UE
+     */
+    TracedCallback<uint32_t, uint32_t, uint32_t, double> m_u2uRouteSelectionTrace;
+
+    /**
+     * Traces fired when a UE-to-UE relayed packet completes a hop
+     */
+    TracedCallback<uint32_t, Ipv4Address, Ipv4Address, uint8_t, Time, Time> m_u2uHopLatencyTrace;
 
     // SAP pointers
     NrSlUeSvcNasSapUser* m_nrSlUeSvcNasSapUser; ///< NR SL UE SERVICE NAS SAP user
@@ -535,6 +1424,23 @@ class NrSlUeProse : public NrSlUeService
 
     ///< List of relay codes
     std::map<uint32_t, DiscoveryInfo> m_relayMap;
+    ///< Discovery groups of which the UE is member, indexed by group ID
+    std::unordered_map<uint32_t, DiscoveryInfo> m_groupMap;
+    ///< Members discovered through group member discovery, indexed by group ID
+    std::unordered_map<uint32_t, DiscoveredPeerMap> m_groupMembers;
+    ///< Number of application, relay and group codes receiving discovery messages per role
+    std::array<uint32_t, RelayUE + 1> m_nListeningCodesPerRole{};
+    ///< Duty cycles of the reception of discovery messages per role
+    std::map<DiscoveryRole, MonitoringDutyCycle> m_monitoringDutyCycles;
+    ///< Peers discovered through direct discovery, indexed by application code
+    std::unordered_map<uint32_t, DiscoveredPeerMap> m_discoveredPeers;
+    Time m_discoveredPeerTtl; ///< Time after which a peer not heard is removed from the table
+    ///< Traffic profiles of the application codes with automatic direct link establishment
+    std::map<uint32_t, SidelinkInfo> m_autoDirectLinkProfiles;
+    ///< Time of the last automatic direct link attempt, indexed by peer L2 ID
+    std::unordered_map<uint32_t, Time> m_autoDirectLinkAttempts;
+    Time m_autoDirectLinkHoldOff;     ///< Minimum time between two automatic attempts to a peer
+    uint32_t m_autoDirectLinkMaxLinks; ///< Maximum number of direct links for auto connection
 
     // List of discovered relays for this remote
     std::vector<RelayInfo> m_discoveredRelaysList;
@@ -550,11 +1456,137 @@ class NrSlUeProse : public NrSlUeService
 
     // Relay selection algorithm
     Ptr<NrSlUeProseRelaySelectionAlgorithm> m_relaySelectionAlgorithm;
+    Ptr<NrSlProseStats> m_stats; ///< ProSe counters of this UE
 
     SidelinkInfo
         m_slSrbSlInfo; ///< Default values for traffic profile used for signaling radio bearers
 
     Time m_signallingPdb; ///< Packet Delay Budget for signalling LCs
+    uint8_t m_discoveryPriority; ///< Default priority for discovery radio bearers
+    Time m_discoveryPdb;         ///< Default Packet Delay Budget for discovery radio bearers
+    ///< Discovery transmission parameters configured per code, indexed by code type and code
+    std::map<std::pair<DiscoveryCodeType, uint32_t>, DiscoveryTxParameters> m_discoveryTxParams;
+
+    /// Discovery messages waiting to be transmitted in one packet
+    struct AggregatedDiscovery
+    {
+        std::vector<NrSlDiscoveryHeader> headers; ///< Queued discovery messages
+        EventId flushEvent;                       ///< Transmission of the packet
+    };
+
+    ///< Discovery messages being aggregated, indexed by destination L2 ID, priority and PDB
+    std::map<AggregatedDiscoveryKey, AggregatedDiscovery> m_aggregatedDiscovery;
+    uint32_t m_discoveryAggregationMaxSize; ///< Maximum size of an aggregated discovery packet
+    Time m_discoveryAggregationWindow; ///< Time to collect messages for an aggregated packet
+
+    /// Sender L2 ID, message type, code and status indicator of a discovery message
+    typedef std::tuple<uint32_t, uint8_t, uint32_t, uint8_t> DiscoveryDuplicateKey;
+    ///< Time each received discovery message was last processed
+    std::map<DiscoveryDuplicateKey, Time> m_discoveryDuplicateCache;
+    Time m_discoveryDuplicateWindow; ///< Time during which identical messages are suppressed
+    Time m_discoveryDuplicatePurgeTime; ///< Time of the next removal of expired cache entries
+
+    bool m_relayBackhaulAware{false}; ///< Whether the relay status reflects the Uu connectivity
+    bool m_uuConnected{false};        ///< Whether the UE is in RRC CONNECTED state
+    double m_uuRsrp{std::numeric_limits<double>::infinity()}; ///< Last serving cell RSRP (dBm)
+    double m_relayBackhaulRsrpThreshold; ///< Serving cell RSRP below which backhaul is weak
+    bool m_gateRelayAnnouncements; ///< Whether relays with weak backhaul stop announcing
+    ///< Information about a relay heard by a relay UE in the relay discovery messages
+    struct NeighbourRelayInfo
+    {
+        double rsrp{-std::numeric_limits<double>::infinity()}; ///< RSRP of the relay
+        uint8_t status{1}; ///< status indicator announced by the relay
+        Time lastHeard;    ///< time the last discovery message from the relay was received
+    };
+    ///< Neighbour relays heard by this relay UE, indexed by relay service code and relay L2 ID
+    std::unordered_map<uint32_t, std::map<uint32_t, NeighbourRelayInfo>> m_neighbourRelays;
+    std::list<uint32_t> m_relayRemoteUes; ///< Remote UEs connected to this relay UE, oldest first
+    ///< Position of the remote UEs in m_relayRemoteUes, indexed by remote L2 ID
+    std::unordered_map<uint32_t, std::list<uint32_t>::iterator> m_relayRemoteUeIndex;
+    uint32_t m_relayMaxRemoteUes; ///< Number of remote UEs above which the relay redirects
+    RelayRedirectionPolicy m_relayRedirectionPolicy; ///< Remote UEs redirected over capacity
+    Time m_relayRedirectionHoldOff; ///< Time during which a redirected remote avoids the relay
+    ///< Last redirection of this remote UE by its relay UE
+    struct RelayRedirection
+    {
+        uint32_t fromRelayL2Id{0};        ///< L2 ID of the relay UE that redirected the remote
+        uint32_t alternativeRelayL2Id{0}; ///< L2 ID of the suggested relay UE, 0 if none
+        Time expiry;                      ///< end of the redirection hold-off
+    } m_relayRedirection;
+    bool m_remotePathSwitching{false}; ///< Whether the remote UE switches to the Uu path
+    bool m_onDirectPath{false};        ///< Whether the remote UE prefers the direct Uu path
+    double m_pathSwitchUuRsrpThreshold; ///< Serving cell RSRP around which the path switches
+    double m_pathSwitchHysteresis;      ///< Hysteresis (dB) of the path switching threshold
+    Time m_pathSwitchTimeToTrigger; ///< Time a switching condition must hold before switching
+    EventId m_pathSwitchEvent;      ///< Pending path switch, while its condition holds
+    RelayInfo m_pathSwitchRelay;    ///< Last relay UE the remote UE was connected to
+    SidelinkInfo m_pathSwitchSlInfo; ///< Traffic profile of the link with the last relay UE
+    bool m_pathSwitchPending{false}; ///< Whether a path switch waits for the new path
+    bool m_pathSwitchTracePending{false}; ///< Whether the relay of a switch is yet to be traced
+    Time m_pathSwitchStart;          ///< Time of the decision of the ongoing path switch
+    bool m_relayResponseAggregation; ///< Whether Model B relay responses are aggregated
+    bool m_monitoringSelfL2Id{false}; ///< Whether the RRC was told to monitor the own L2 ID
+    Ptr<NrSlDiscoveryOracle> m_discoveryOracle; ///< Discovery oracle, if any
+    ///< Flows redirected through the relay UE, indexed by relay service code
+    std::unordered_map<uint32_t, Ptr<EpcTft>> m_u2nRelayFlowFilters;
+    ///< SL TFTs of the flows redirected through each relay UE, indexed by relay UE L2 ID
+    std::unordered_map<uint32_t, std::vector<Ptr<LteSlTft>>> m_u2nRelayFlowTfts;
+    Ptr<NrSlU2nRelayScheduler> m_u2nRelayScheduler; ///< Scheduler of the relayed packets
+    ///< Layer 2 IDs the RRC was told to monitor for discovery
+    std::unordered_set<uint32_t> m_monitoredDiscoveryL2Ids;
+
+    ///< UE-to-UE relay codes
+    std::map<uint32_t, DiscoveryInfo> m_u2uRelayMap;
+    ///< Time each end UE was last heard by this UE-to-UE relay, indexed by relay code
+    std::unordered_map<uint32_t, std::unordered_map<uint32_t, Time>> m_u2uReachableUes;
+
+    /// Relay UE announcing an end UE
+    struct U2uRouteEntry
+    {
+        uint32_t relayCode; ///< UE-to-UE relay service code
+        Time lastHeard;     ///< time the relay last announced the end UE
+    };
+
+    ///< Relays announcing each end UE (0 for no specific end UE), indexed by end UE and relay
+    std::unordered_map<uint32_t, std::map<uint32_t, U2uRouteEntry>> m_u2uRoutes;
+
+    /// End UE on the other side of a UE-to-UE relay direct link
+    struct U2uLinkTarget
+    {
+        uint32_t l2Id{0};      ///< layer 2 ID of the end UE
+        Ipv4Address ip;        ///< IPv4 address of the end UE, if the link carries its traffic
+        Ipv4Address relayedIp; ///< IPv4 address of the end UE signalled to the peer (relay UE)
+    };
+
+    ///< End UEs on the other side of the UE-to-UE relay direct links, indexed by peer L2 ID
+    std::unordered_map<uint32_t, U2uLinkTarget> m_u2uLinkTargets;
+    ///< IPv4 addresses of the end UEs reached through a UE-to-UE relay
+    std::unordered_set<Ipv4Address, Ipv4AddressHash> m_u2uTargetIps;
+    double m_u2uDirectPathRsrpThreshold; ///< Minimum RSRP of the direct path to an end UE
+    bool m_u2uRelayIpHooks{false};       ///< Whether the IP hooks for U2U relaying are set
+    /**
+     * \brief Get the discovery transmission parameters configured for a code
+     *
+     * \param type the kind of code
+     * \param code the application code, relay service code or group ID
+     * \return the parameters configured for the code, empty if none were configured
+     */
+    DiscoveryTxParameters GetDiscoveryTxParameters(DiscoveryCodeType type, uint32_t code) const;
+    /**
+     * \brief Replace the unset fields of discovery transmission parameters by
+     *        the UE-wide defaults
+     *
+     * \param params the parameters configured for a code
+     * \return the parameters to use for the transmission
+     */
+    DiscoveryTxParameters ResolveDiscoveryTxParameters(const DiscoveryTxParameters& params) const;
+    /**
+     * \brief Get the interval to use between two discovery transmissions
+     *
+     * \param info the discovery information of the code
+     * \return the interval of the code, or the UE-wide discovery interval if not set
+     */
+    Time GetDiscoveryInterval(const DiscoveryInfo& info) const;
 
     /**
      * \brief Creates the TFT and instructs the activation of the corresponding
@@ -602,7 +1634,6 @@ class NrSlUeProse : public NrSlUeService
     void RemoveDataRadioBearersForU2nRelay(uint32_t peerL2Id,
                                            NrSlUeProseDirLnkSapUser::DirectLinkRelayInfo relayInfo,
                                            NrSlUeProseDirLnkSapUser::DirectLinkIpInfo ipInfo);
-
     /**
      *  Locate the RSRP measurement corresponding to the L2 ID
      *  return a pair <RSRP value, whether or not the relay passed the threshold/hysteris criteria>
@@ -619,13 +1650,126 @@ class NrSlUeProse : public NrSlUeService
      *
      * \param relayL2Id the L2 ID of the discovered relay
      * \param relayCode the service code of the discovered relay
+     * \param status the status indicator announced by the relay
+     */
+    void UpdateDiscoveredRelaysList(uint32_t relayL2Id, uint32_t relayCode, uint8_t status);
+    /**
+     * Get the relays among which the relay selection algorithm chooses. When
+     * at least one discovered relay announces a good backhaul, the relays
+     * announcing a weak backhaul are left out.
+     *
+     * \return the candidate relays
+     */
+    std::vector<RelayInfo> GetRelaySelectionCandidates() const;
+    /**
+     * Update the neighbour relays heard by this relay UE in the relay discovery
+     * messages of a relay service it provides
+     *
+     * \param relayL2Id the L2 ID of the neighbour relay
+     * \param relayCode the relay service code
+     * \param status the status indicator announced by the neighbour relay
+     */
+    void UpdateNeighbourRelay(uint32_t relayL2Id, uint32_t relayCode, uint8_t status);
+    /**
+     * Get the neighbour relay to suggest to the remote UEs redirected by this relay UE
+     *
+     * \param relayCode the relay service code of the remote UE connection
+     * \return the L2 ID of the neighbour relay, or 0 if none
      */
-    void UpdateDiscoveredRelaysList(uint32_t relayL2Id, uint32_t relayCode);
+    uint32_t GetAlternativeRelay(uint32_t relayCode) const;
+    /**
+     * Add a remote UE at the end of the list of remote UEs connected to this
+     * relay UE, moving it there if already present
+     *
+     * \param remoteL2Id the layer 2 ID of the remote UE
+     */
+    void AddRelayRemoteUe(uint32_t remoteL2Id);
+    /**
+     * Remove a remote UE from the list of remote UEs connected to this relay UE
+     *
+     * \param remoteL2Id the layer 2 ID of the remote UE
+     */
+    void RemoveRelayRemoteUe(uint32_t remoteL2Id);
 
+    /**
+     * Add or refresh a peer in the discovered peer table
+     *
+     * \param appCode the application code
+     * \param peerL2Id the layer 2 ID of the peer
+     */
+    void UpdateDiscoveredPeer(uint32_t appCode, uint32_t peerL2Id);
+    /**
+     * Remove a peer from the discovered peer table if it was not heard for the
+     * configured TTL, or reschedule the check otherwise
+     *
+     * \param appCode the application code
+     * \param peerL2Id the layer 2 ID of the peer
+     */
+    void CheckDiscoveredPeerExpiry(uint32_t appCode, uint32_t peerL2Id);
+    /**
+     * Add or refresh a member in the member table of a group
+     *
+     * \param groupId the discovery group ID
+     * \param memberL2Id the layer 2 ID of the member
+     */
+    void UpdateGroupMember(uint32_t groupId, uint32_t memberL2Id);
+    /**
+     * Remove a member from the member table of a group if it was not heard for
+     * the configured TTL, or reschedule the check otherwise
+     *
+     * \param groupId the discovery group ID
+     * \param memberL2Id the layer 2 ID of the member
+     */
+    void CheckGroupMemberExpiry(uint32_t groupId, uint32_t memberL2Id);
+    /**
+     * Initiate a direct link with a discovered peer if automatic direct link
+     * establishment is enabled for the application code and allowed by the
+     * de-duplication and rate limiting rules
+     *
+     * \param appCode the application code
+     * \param peerL2Id the layer 2 ID of the peer
+     */
+    void TriggerAutoDirectLink(uint32_t appCode, uint32_t peerL2Id);
+    /**
+     * Find the traffic profile to use for a direct link requested by a peer,
+     * when automatic direct link establishment is enabled for an application
+     * code this UE discovered the peer for, or announces
+     *
+     * \param peerL2Id the layer 2 ID of the peer
+     * \param slInfo the traffic profile found
+     * \return true if a profile was found
+     */
+    bool FindAutoDirectLinkProfile(uint32_t peerL2Id, struct SidelinkInfo& slInfo) const;
+    /**
+     * Remove all the peers discovered for an application code
+     *
+     * \param appCode the application code
+     */
+    void ClearDiscoveredPeers(uint32_t appCode);
     /**
      * Select relay according to the relay selection algorithm
      */
     void SelectRelay();
+    /**
+     * \brief Evaluate the Uu conditions of the path switching of the remote UE
+     *
+     * Schedules the path switch when the conditions of the other path are met,
+     * and cancels it when they are not met anymore.
+     */
+    void EvaluatePathSwitch();
+    /**
+     * \brief Switch the remote UE to the direct Uu path or to the relay path
+     *
+     * \param toDirect true to switch to the direct Uu path
+     */
+    void DoPathSwitch(bool toDirect);
+    /**
+     * \brief Report the end of the ongoing path switch, if any
+     *
+     * \param relayL2Id the layer 2 ID of the relay UE
+     * \param toDirect true if the new path is the direct Uu path
+     */
+    void CompletePathSwitch(uint32_t relayL2Id, bool toDirect);
 
 }; // end of NrSlUeProse class definition
 
@@ -19,6 +19,12 @@ cpp_examples = [
     ("nr-prose-discovery-l3-relay-selection", "True", "True"),
     ("nr-prose-l3-relay", "True", "True"),
     ("nr-prose-l3-relay-on-off", "True", "True"),
+    ("nr-prose-l3-relay-scale --remoteUeNum=10 --simTime=10", "True", "False"),
+    (
+        "$MPIEXEC $MPIFLAGS -np 2 nr-prose-l3-relay-scale --useMpi=1 --remoteUeNum=10 --simTime=10",
+        "ENABLE_MPI == True",
+        "False",
+    ),
     ("nr-prose-network-coex", "True", "True"),
     ("nr-prose-unicast-multi-link", "True", "True"),
     ("nr-prose-unicast-single-link", "True", "True"),
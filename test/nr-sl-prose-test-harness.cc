@@ -0,0 +1,478 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * NIST-developed software is provided by NIST as a public
+ * service. You may use, copy and distribute copies of the software in
+ * any medium, provided that you keep intact this entire notice. You
+ * may improve, modify and create derivative works of the software or
+ * any portion of the software, and you may copy and distribute such
+ * modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and
+ * nature of any such change. Please explicitly acknowledge the
+ * National Institute of Standards and Technology as the source of the
+ * software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES
+ * NO WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY
+ * OPERATION OF LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+ * WARRANTY OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE,
+ * NON-INFRINGEMENT AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR
+ * WARRANTS THAT THE OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED
+ * OR ERROR-FREE, OR THAT ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT
+ * WARRANT OR MAKE ANY REPRESENTATIONS REGARDING THE USE OF THE
+ * SOFTWARE OR THE RESULTS THEREOF, INCLUDING BUT NOT LIMITED TO THE
+ * CORRECTNESS, ACCURACY, RELIABILITY, OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of
+ * using and distributing the software and you assume all risks
+ * associated with its use, including but not limited to the risks and
+ * costs of program errors, compliance with applicable laws, damage to
+ * or loss of data, programs or equipment, and the unavailability or
+ * interruption of operation. This software is not intended to be used
+ * in any situation where a failure could cause risk of injury or
+ * damage to property. The software developed by NIST employees is not
+ * subject to copyright protection within the United States.
+ */
+
+#include "nr-sl-prose-test-harness.h"
+
+#include <ns3/abort.h>
+#include <ns3/double.h>
+#include <ns3/log.h>
+#include <ns3/lte-sl-tft.h>
+#include <ns3/nr-sl-ue-prose-direct-link.h>
+#include <ns3/nr-sl-ue-prose.h>
+#include <ns3/packet.h>
+#include <ns3/simulator.h>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("NrSlProseTestHarness");
+NS_OBJECT_ENSURE_REGISTERED(NrSlProseTestChannel);
+
+NrSlProseTestRrcSapProvider::NrSlProseTestRrcSapProvider(NrSlProseTestChannel* channel,
+                                                         uint32_t l2Id)
+    : m_channel(channel),
+      m_l2Id(l2Id)
+{
+}
+
+void
+NrSlProseTestRrcSapProvider::ActivateNrSlSignallingRadioBearer(const struct SidelinkInfo& slInfo)
+{
+    NS_LOG_FUNCTION(this << m_l2Id << slInfo.m_dstL2Id << +slInfo.m_lcId);
+    m_nSignallingBearers++;
+}
+
+void
+NrSlProseTestRrcSapProvider::SendNrSlSignalling(Ptr<Packet> packet,
+                                                uint32_t dstL2Id,
+                                                uint8_t lcId)
+{
+    NS_LOG_FUNCTION(this << m_l2Id << packet << dstL2Id << +lcId);
+    m_channel->SendSignalling(m_l2Id, packet, dstL2Id);
+}
+
+void
+NrSlProseTestRrcSapProvider::ActivateNrSlDiscoveryRadioBearer(uint32_t dstL2Id)
+{
+    NS_LOG_FUNCTION(this << m_l2Id << dstL2Id);
+    m_nDiscoveryBearers++;
+}
+
+void
+NrSlProseTestRrcSapProvider::SendNrSlDiscovery(Ptr<Packet> packet, uint32_t dstL2Id)
+{
+    NS_LOG_FUNCTION(this << m_l2Id << packet << dstL2Id);
+    m_channel->SendDiscovery(m_l2Id, packet, dstL2Id);
+}
+
+void
+NrSlProseTestRrcSapProvider::MonitorSelfL2Id()
+{
+    NS_LOG_FUNCTION(this << m_l2Id);
+    m_channel->MonitorL2Id(m_l2Id, m_l2Id);
+}
+
+void
+NrSlProseTestRrcSapProvider::MonitorL2Id(uint32_t dstL2Id)
+{
+    NS_LOG_FUNCTION(this << m_l2Id << dstL2Id);
+    m_channel->MonitorL2Id(m_l2Id, dstL2Id);
+}
+
+void
+NrSlProseTestRrcSapProvider::NotifySidelinkConnectionRelease(uint32_t peerL2Id,
+                                                             uint32_t selfL2Id,
+                                                             uint8_t lcId)
+{
+    NS_LOG_FUNCTION(this << peerL2Id << selfL2Id << +lcId);
+    m_nConnectionReleases++;
+}
+
+uint32_t
+NrSlProseTestRrcSapProvider::GetNSignallingBearers() const
+{
+    return m_nSignallingBearers;
+}
+
+uint32_t
+NrSlProseTestRrcSapProvider::GetNDiscoveryBearers() const
+{
+    return m_nDiscoveryBearers;
+}
+
+uint32_t
+NrSlProseTestRrcSapProvider::GetNConnectionReleases() const
+{
+    return m_nConnectionReleases;
+}
+
+NrSlProseTestNasSapProvider::NrSlProseTestNasSapProvider(NrSlUeSvcNasSapUser* user)
+    : m_user(user)
+{
+}
+
+void
+NrSlProseTestNasSapProvider::ActivateSvcNrSlDataRadioBearer(Ptr<LteSlTft> tft)
+{
+    NS_LOG_FUNCTION(this << tft);
+    m_nActivatedBearers++;
+    // The NAS notifies the ProSe layer once the bearer is configured
+    Simulator::ScheduleNow(&NrSlUeSvcNasSapUser::NotifySvcNrSlDataRadioBearerActivated,
+                           m_user,
+                           tft->GetSidelinkInfo().m_dstL2Id);
+}
+
+void
+NrSlProseTestNasSapProvider::DeleteSvcNrSlDataRadioBearer(Ptr<LteSlTft> tft)
+{
+    NS_LOG_FUNCTION(this << tft);
+    m_nDeletedBearers++;
+    Simulator::ScheduleNow(&NrSlUeSvcNasSapUser::NotifySvcNrSlDataRadioBearerRemoved,
+                           m_user,
+                           tft->GetSidelinkInfo().m_dstL2Id);
+}
+
+void
+NrSlProseTestNasSapProvider::ConfigureNrSlDataRadioBearersForU2nRelay(
+    uint32_t peerL2Id,
+    NrSlUeProseDirLnkSapUser::U2nRole role,
+    NrSlUeProseDirLnkSapUser::DirectLinkIpInfo ipInfo,
+    uint8_t relayDrbId,
+    const struct SidelinkInfo& slInfo)
+{
+    NS_FATAL_ERROR("The UE-to-Network relay is not supported by the test harness");
+}
+
+void
+NrSlProseTestNasSapProvider::RemoveNrSlDataRadioBearersForU2nRelay(
+    uint32_t peerL2Id,
+    NrSlUeProseDirLnkSapUser::U2nRole role,
+    NrSlUeProseDirLnkSapUser::DirectLinkIpInfo ipInfo,
+    uint8_t relayDrbId)
+{
+    NS_FATAL_ERROR("The UE-to-Network relay is not supported by the test harness");
+}
+
+uint32_t
+NrSlProseTestNasSapProvider::GetNActivatedBearers() const
+{
+    return m_nActivatedBearers;
+}
+
+uint32_t
+NrSlProseTestNasSapProvider::GetNDeletedBearers() const
+{
+    return m_nDeletedBearers;
+}
+
+NrSlProseTestDirLnkSapUser::NrSlProseTestDirLnkSapUser(NrSlProseTestChannel* channel,
+                                                       uint32_t l2Id)
+    : m_channel(channel),
+      m_l2Id(l2Id)
+{
+}
+
+void
+NrSlProseTestDirLnkSapUser::SendNrSlPc5SMessage(Ptr<Packet> packet, uint32_t dstL2Id, uint8_t lcId)
+{
+    NS_LOG_FUNCTION(this << m_l2Id << packet << dstL2Id << +lcId);
+    m_channel->SendSignalling(m_l2Id, packet, dstL2Id);
+}
+
+void
+NrSlProseTestDirLnkSapUser::NotifyChangeOfDirectLinkState(uint32_t peerL2Id,
+                                                          ChangeOfStateNotification info)
+{
+    NS_LOG_FUNCTION(this << m_l2Id << peerL2Id << info.newStateStr);
+    m_states.push_back(info.newStateEnum);
+    m_ipInfo = info.ipInfo;
+}
+
+const std::vector<uint8_t>&
+NrSlProseTestDirLnkSapUser::GetStates() const
+{
+    return m_states;
+}
+
+NrSlUeProseDirLnkSapUser::DirectLinkIpInfo
+NrSlProseTestDirLnkSapUser::GetIpInfo() const
+{
+    return m_ipInfo;
+}
+
+TypeId
+NrSlProseTestChannel::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::NrSlProseTestChannel")
+            .SetParent<Object>()
+            .SetGroupName("Nr")
+            .AddConstructor<NrSlProseTestChannel>()
+            .AddAttribute("Delay",
+                          "Delay of the delivery of the messages",
+                          TimeValue(MilliSeconds(1)),
+                          MakeTimeAccessor(&NrSlProseTestChannel::SetDelay),
+                          MakeTimeChecker())
+            .AddAttribute("LossProbability",
+                          "Probability of losing the delivery of a message",
+                          DoubleValue(0.0),
+                          MakeDoubleAccessor(&NrSlProseTestChannel::SetLossProbability),
+                          MakeDoubleChecker<double>(0.0, 1.0));
+    return tid;
+}
+
+NrSlProseTestChannel::NrSlProseTestChannel()
+{
+    NS_LOG_FUNCTION(this);
+    m_lossVariable = CreateObject<UniformRandomVariable>();
+}
+
+NrSlProseTestChannel::~NrSlProseTestChannel()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+void
+NrSlProseTestChannel::DoDispose()
+{
+    NS_LOG_FUNCTION(this);
+    m_endpoints.clear();
+    m_lossVariable = nullptr;
+    Object::DoDispose();
+}
+
+void
+NrSlProseTestChannel::AddUe(Ptr<NrSlUeProse> prose, uint32_t l2Id)
+{
+    NS_LOG_FUNCTION(this << prose << l2Id);
+    NS_ABORT_MSG_IF(m_endpoints.find(l2Id) != m_endpoints.end(),
+                    "UE with layer 2 ID " << l2Id << " already connected");
+
+    Endpoint& endpoint = m_endpoints[l2Id];
+    endpoint.prose = prose;
+    endpoint.rrc = std::make_unique<NrSlProseTestRrcSapProvider>(this, l2Id);
+    endpoint.nas = std::make_unique<NrSlProseTestNasSapProvider>(prose->GetNrSlUeSvcNasSapUser());
+    prose->SetL2Id(l2Id);
+    prose->SetNrSlUeSvcRrcSapProvider(endpoint.rrc.get());
+    prose->SetNrSlUeSvcNasSapProvider(endpoint.nas.get());
+}
+
+void
+NrSlProseTestChannel::AddDirectLink(Ptr<NrSlUeProseDirectLink> link, uint32_t l2Id)
+{
+    NS_LOG_FUNCTION(this << link << l2Id);
+    NS_ABORT_MSG_IF(m_endpoints.find(l2Id) != m_endpoints.end(),
+                    "UE with layer 2 ID " << l2Id << " already connected");
+
+    Endpoint& endpoint = m_endpoints[l2Id];
+    endpoint.link = link;
+    endpoint.dirLnk = std::make_unique<NrSlProseTestDirLnkSapUser>(this, l2Id);
+    endpoint.monitoredL2Ids.insert(l2Id);
+    link->SetNrSlUeProseDirLnkSapUser(endpoint.dirLnk.get());
+}
+
+const NrSlProseTestRrcSapProvider*
+NrSlProseTestChannel::GetRrcSapProvider(uint32_t l2Id) const
+{
+    auto it = m_endpoints.find(l2Id);
+    NS_ABORT_MSG_IF(it == m_endpoints.end() || !it->second.rrc,
+                    "No ProSe layer with layer 2 ID " << l2Id);
+    return it->second.rrc.get();
+}
+
+const NrSlProseTestNasSapProvider*
+NrSlProseTestChannel::GetNasSapProvider(uint32_t l2Id) const
+{
+    auto it = m_endpoints.find(l2Id);
+    NS_ABORT_MSG_IF(it == m_endpoints.end() || !it->second.nas,
+                    "No ProSe layer with layer 2 ID " << l2Id);
+    return it->second.nas.get();
+}
+
+const NrSlProseTestDirLnkSapUser*
+NrSlProseTestChannel::GetDirLnkSapUser(uint32_t l2Id) const
+{
+    auto it = m_endpoints.find(l2Id);
+    NS_ABORT_MSG_IF(it == m_endpoints.end() || !it->second.dirLnk,
+                    "No direct link with layer 2 ID " << l2Id);
+    return it->second.dirLnk.get();
+}
+
+void
+NrSlProseTestChannel::SetDelay(Time delay)
+{
+    NS_LOG_FUNCTION(this << delay);
+    m_delay = delay;
+}
+
+void
+NrSlProseTestChannel::SetLossProbability(double lossProbability)
+{
+    NS_LOG_FUNCTION(this << lossProbability);
+    NS_ABORT_MSG_IF(lossProbability < 0.0 || lossProbability > 1.0,
+                    "Invalid loss probability " << lossProbability);
+    m_lossProbability = lossProbability;
+}
+
+void
+NrSlProseTestChannel::MonitorL2Id(uint32_t l2Id, uint32_t dstL2Id)
+{
+    NS_LOG_FUNCTION(this << l2Id << dstL2Id);
+    auto it = m_endpoints.find(l2Id);
+    NS_ABORT_MSG_IF(it == m_endpoints.end(), "Unknown UE with layer 2 ID " << l2Id);
+    it->second.monitoredL2Ids.insert(dstL2Id);
+}
+
+bool
+NrSlProseTestChannel::IsLost()
+{
+    // Do not draw when the outcome is known, which keeps the losses of a
+    // lossy period independent of the messages sent before it
+    if (m_lossProbability <= 0.0)
+    {
+        return false;
+    }
+    if (m_lossProbability >= 1.0)
+    {
+        return true;
+    }
+    return m_lossVariable->GetValue() < m_lossProbability;
+}
+
+void
+NrSlProseTestChannel::SendSignalling(uint32_t srcL2Id, Ptr<Packet> packet, uint32_t dstL2Id)
+{
+    NS_LOG_FUNCTION(this << srcL2Id << packet << dstL2Id);
+
+    auto it = m_endpoints.find(dstL2Id);
+    if (it == m_endpoints.end() ||
+        it->second.monitoredL2Ids.find(dstL2Id) == it->second.monitoredL2Ids.end())
+    {
+        NS_LOG_LOGIC("No UE listening to " << dstL2Id);
+        m_nSignallingLost++;
+        return;
+    }
+    if (IsLost())
+    {
+        NS_LOG_LOGIC("Signalling message from " << srcL2Id << " to " << dstL2Id << " lost");
+        m_nSignallingLost++;
+        return;
+    }
+    Simulator::Schedule(m_delay,
+                        &NrSlProseTestChannel::DeliverSignalling,
+                        this,
+                        srcL2Id,
+                        packet->Copy(),
+                        dstL2Id);
+}
+
+void
+NrSlProseTestChannel::SendDiscovery(uint32_t srcL2Id, Ptr<Packet> packet, uint32_t dstL2Id)
+{
+    NS_LOG_FUNCTION(this << srcL2Id << packet << dstL2Id);
+
+    for (const auto& itEndpoint : m_endpoints)
+    {
+        if (itEndpoint.first == srcL2Id || !itEndpoint.second.prose ||
+            itEndpoint.second.monitoredL2Ids.find(dstL2Id) ==
+                itEndpoint.second.monitoredL2Ids.end())
+        {
+            continue;
+        }
+        if (IsLost())
+        {
+            NS_LOG_LOGIC("Discovery message from " << srcL2Id << " to " << itEndpoint.first
+                                                   << " lost");
+            m_nDiscoveryLost++;
+            continue;
+        }
+        Simulator::Schedule(m_delay,
+                            &NrSlProseTestChannel::DeliverDiscovery,
+                            this,
+                            srcL2Id,
+                            packet->Copy(),
+                            itEndpoint.first);
+    }
+}
+
+void
+NrSlProseTestChannel::DeliverSignalling(uint32_t srcL2Id, Ptr<Packet> packet, uint32_t dstL2Id)
+{
+    NS_LOG_FUNCTION(this << srcL2Id << packet << dstL2Id);
+
+    m_nSignallingDelivered++;
+    Endpoint& endpoint = m_endpoints.at(dstL2Id);
+    if (endpoint.prose)
+    {
+        endpoint.prose->GetNrSlUeSvcRrcSapUser()->ReceiveNrSlSignalling(packet, srcL2Id);
+    }
+    else
+    {
+        endpoint.link->GetNrSlUeProseDirLnkSapProvider()->ReceiveNrSlPc5Message(packet);
+    }
+}
+
+void
+NrSlProseTestChannel::DeliverDiscovery(uint32_t srcL2Id, Ptr<Packet> packet, uint32_t rxL2Id)
+{
+    NS_LOG_FUNCTION(this << srcL2Id << packet << rxL2Id);
+
+    m_nDiscoveryDelivered++;
+    m_endpoints.at(rxL2Id).prose->GetNrSlUeSvcRrcSapUser()->ReceiveNrSlDiscovery(packet, srcL2Id);
+}
+
+uint32_t
+NrSlProseTestChannel::GetNSignallingDelivered() const
+{
+    return m_nSignallingDelivered;
+}
+
+uint32_t
+NrSlProseTestChannel::GetNSignallingLost() const
+{
+    return m_nSignallingLost;
+}
+
+uint32_t
+NrSlProseTestChannel::GetNDiscoveryDelivered() const
+{
+    return m_nDiscoveryDelivered;
+}
+
+uint32_t
+NrSlProseTestChannel::GetNDiscoveryLost() const
+{
+    return m_nDiscoveryLost;
+}
+
+int64_t
+NrSlProseTestChannel::AssignStreams(int64_t stream)
+{
+    NS_LOG_FUNCTION(this << stream);
+    m_lossVariable->SetStream(stream);
+    return 1;
+}
+
+} // namespace ns3
@@ -0,0 +1,380 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * NIST-developed software is provided by NIST as a public
+ * service. You may use, copy and distribute copies of the software in
+ * any medium, provided that you keep intact this entire notice. You
+ * may improve, modify and create derivative works of the software or
+ * any portion of the software, and you may copy and distribute such
+ * modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and
+ * nature of any such change. Please explicitly acknowledge the
+ * National Institute of Standards and Technology as the source of the
+ * software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES
+ * NO WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY
+ * OPERATION OF LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+ * WARRANTY OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE,
+ * NON-INFRINGEMENT AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR
+ * WARRANTS THAT THE OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED
+ * OR ERROR-FREE, OR THAT ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT
+ * WARRANT OR MAKE ANY REPRESENTATIONS REGARDING THE USE OF THE
+ * SOFTWARE OR THE RESULTS THEREOF, INCLUDING BUT NOT LIMITED TO THE
+ * CORRECTNESS, ACCURACY, RELIABILITY, OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of
+ * using and distributing the software and you assume all risks
+ * associated with its use, including but not limited to the risks and
+ * costs of program errors, compliance with applicable laws, damage to
+ * or loss of data, programs or equipment, and the unavailability or
+ * interruption of operation. This software is not intended to be used
+ * in any situation where a failure could cause risk of injury or
+ * damage to property. The software developed by NIST employees is not
+ * subject to copyright protection within the United States.
+ */
+
+#ifndef NR_SL_PROSE_TEST_HARNESS_H
+#define NR_SL_PROSE_TEST_HARNESS_H
+
+#include <ns3/nr-sl-ue-prose-dir-lnk-sap.h>
+#include <ns3/nr-sl-ue-svc-nas-sap.h>
+#include <ns3/nr-sl-ue-svc-rrc-sap.h>
+#include <ns3/nstime.h>
+#include <ns3/object.h>
+#include <ns3/random-variable-stream.h>
+
+#include <map>
+#include <memory>
+#include <set>
+#include <vector>
+
+namespace ns3
+{
+
+class NrSlUeProse;
+class NrSlUeProseDirectLink;
+class NrSlProseTestChannel;
+
+/**
+ * \ingroup nr-prose-tests
+ *
+ * \brief Mock RRC SAP provider of a UE connected to a NrSlProseTestChannel
+ *
+ * The signalling and discovery messages are handed to the channel, and the
+ * bearer management primitives are only counted.
+ */
+class NrSlProseTestRrcSapProvider : public NrSlUeSvcRrcSapProvider
+{
+  public:
+    /**
+     * \brief Constructor
+     *
+     * \param channel the channel delivering the messages of the UE
+     * \param l2Id the layer 2 ID of the UE
+     */
+    NrSlProseTestRrcSapProvider(NrSlProseTestChannel* channel, uint32_t l2Id);
+
+    // inherited from NrSlUeSvcRrcSapProvider
+    void ActivateNrSlSignallingRadioBearer(const struct SidelinkInfo& slInfo) override;
+    void SendNrSlSignalling(Ptr<Packet> packet, uint32_t dstL2Id, uint8_t lcId) override;
+    void ActivateNrSlDiscoveryRadioBearer(uint32_t dstL2Id) override;
+    void SendNrSlDiscovery(Ptr<Packet> packet, uint32_t dstL2Id) override;
+    void MonitorSelfL2Id() override;
+    void MonitorL2Id(uint32_t dstL2Id) override;
+    void NotifySidelinkConnectionRelease(uint32_t peerL2Id,
+                                         uint32_t selfL2Id,
+                                         uint8_t lcId) override;
+
+    /**
+     * \return the number of signalling radio bearers activated
+     */
+    uint32_t GetNSignallingBearers() const;
+    /**
+     * \return the number of discovery radio bearers activated
+     */
+    uint32_t GetNDiscoveryBearers() const;
+    /**
+     * \return the number of sidelink connection releases notified
+     */
+    uint32_t GetNConnectionReleases() const;
+
+  private:
+    NrSlProseTestChannel* m_channel;   ///< Channel delivering the messages
+    uint32_t m_l2Id;                   ///< Layer 2 ID of the UE
+    uint32_t m_nSignallingBearers{0};  ///< Number of signalling radio bearers activated
+    uint32_t m_nDiscoveryBearers{0};   ///< Number of discovery radio bearers activated
+    uint32_t m_nConnectionReleases{0}; ///< Number of sidelink connection releases
+};
+
+/**
+ * \ingroup nr-prose-tests
+ *
+ * \brief Mock NAS SAP provider of a UE connected to a NrSlProseTestChannel
+ *
+ * The data radio bearers of the direct links are acknowledged to the ProSe
+ * layer right away, as the NAS would do once the RRC configured them. The
+ * UE-to-Network relay primitives need the EPC and are not supported.
+ */
+class NrSlProseTestNasSapProvider : public NrSlUeSvcNasSapProvider
+{
+  public:
+    /**
+     * \brief Constructor
+     *
+     * \param user the NAS SAP user of the ProSe layer of the UE
+     */
+    NrSlProseTestNasSapProvider(NrSlUeSvcNasSapUser* user);
+
+    // inherited from NrSlUeSvcNasSapProvider
+    void ActivateSvcNrSlDataRadioBearer(Ptr<LteSlTft> tft) override;
+    void DeleteSvcNrSlDataRadioBearer(Ptr<LteSlTft> tft) override;
+    void ConfigureNrSlDataRadioBearersForU2nRelay(
+        uint32_t peerL2Id,
+        NrSlUeProseDirLnkSapUser::U2nRole role,
+        NrSlUeProseDirLnkSapUser::DirectLinkIpInfo ipInfo,
+        uint8_t relayDrbId,
+        const struct SidelinkInfo& slInfo) override;
+    void RemoveNrSlDataRadioBearersForU2nRelay(uint32_t peerL2Id,
+                                               NrSlUeProseDirLnkSapUser::U2nRole role,
+                                               NrSlUeProseDirLnkSapUser::DirectLinkIpInfo ipInfo,
+                                               uint8_t relayDrbId) override;
+
+    /**
+     * \return the number of data radio bearers activated
+     */
+    uint32_t GetNActivatedBearers() const;
+    /**
+     * \return the number of data radio bearers deleted
+     */
+    uint32_t GetNDeletedBearers() const;
+
+  private:
+    NrSlUeSvcNasSapUser* m_user;     ///< NAS SAP user of the ProSe layer
+    uint32_t m_nActivatedBearers{0}; ///< Number of data radio bearers activated
+    uint32_t m_nDeletedBearers{0};   ///< Number of data radio bearers deleted
+};
+
+/**
+ * \ingroup nr-prose-tests
+ *
+ * \brief Mock ProSe layer of a direct link connected to a NrSlProseTestChannel
+ *
+ * It hands the PC5-S messages of the direct link to the channel and keeps the
+ * history of the states notified by the direct link.
+ */
+class NrSlProseTestDirLnkSapUser : public NrSlUeProseDirLnkSapUser
+{
+  public:
+    /**
+     * \brief Constructor
+     *
+     * \param channel the channel delivering the messages of the direct link
+     * \param l2Id the layer 2 ID of the UE owning the direct link
+     */
+    NrSlProseTestDirLnkSapUser(NrSlProseTestChannel* channel, uint32_t l2Id);
+
+    // inherited from NrSlUeProseDirLnkSapUser
+    void SendNrSlPc5SMessage(Ptr<Packet> packet, uint32_t dstL2Id, uint8_t lcId) override;
+    void NotifyChangeOfDirectLinkState(uint32_t peerL2Id,
+                                       ChangeOfStateNotification info) override;
+
+    /**
+     * \return the states notified by the direct link, in order
+     */
+    const std::vector<uint8_t>& GetStates() const;
+    /**
+     * \return the IP information of the last notification of the direct link
+     */
+    DirectLinkIpInfo GetIpInfo() const;
+
+  private:
+    NrSlProseTestChannel* m_channel; ///< Channel delivering the messages
+    uint32_t m_l2Id;                 ///< Layer 2 ID of the UE
+    std::vector<uint8_t> m_states;   ///< States notified by the direct link
+    DirectLinkIpInfo m_ipInfo;       ///< IP information of the last notification
+};
+
+/**
+ * \ingroup nr-prose-tests
+ *
+ * \brief In-memory sidelink delivering the PC5-S and discovery messages of
+ *        ProSe layers and direct links without the NR stack
+ *
+ * Each UE is identified by its layer 2 ID. A ProSe layer added to the channel
+ * gets mock RRC and NAS SAP providers, and a direct link added to the channel
+ * gets a mock ProSe layer. The signalling messages are delivered to the UE
+ * whose layer 2 ID is the destination, and the discovery messages to all the
+ * other UEs monitoring the destination layer 2 ID, like the MAC filters them.
+ * Every delivery is delayed by the same amount and independently lost with
+ * the same probability.
+ */
+class NrSlProseTestChannel : public Object
+{
+  public:
+    NrSlProseTestChannel();
+    ~NrSlProseTestChannel() override;
+
+    /**
+     * \brief Get the type ID.
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId();
+
+    /**
+     * \brief Connect a ProSe layer to the channel
+     *
+     * It sets the layer 2 ID of the ProSe layer and connects it to new mock
+     * RRC and NAS SAP providers.
+     *
+     * \param prose the ProSe layer
+     * \param l2Id the layer 2 ID of the UE
+     */
+    void AddUe(Ptr<NrSlUeProse> prose, uint32_t l2Id);
+
+    /**
+     * \brief Connect a direct link to the channel
+     *
+     * It connects the direct link to a new mock ProSe layer. The direct link
+     * receives the signalling messages sent to its layer 2 ID.
+     *
+     * \param link the direct link
+     * \param l2Id the layer 2 ID of the UE owning the direct link
+     */
+    void AddDirectLink(Ptr<NrSlUeProseDirectLink> link, uint32_t l2Id);
+
+    /**
+     * \param l2Id the layer 2 ID of a UE added with AddUe
+     * \return the mock RRC SAP provider of the UE
+     */
+    const NrSlProseTestRrcSapProvider* GetRrcSapProvider(uint32_t l2Id) const;
+
+    /**
+     * \param l2Id the layer 2 ID of a UE added with AddUe
+     * \return the mock NAS SAP provider of the UE
+     */
+    const NrSlProseTestNasSapProvider* GetNasSapProvider(uint32_t l2Id) const;
+
+    /**
+     * \param l2Id the layer 2 ID of a UE added with AddDirectLink
+     * \return the mock ProSe layer of the direct link of the UE
+     */
+    const NrSlProseTestDirLnkSapUser* GetDirLnkSapUser(uint32_t l2Id) const;
+
+    /**
+     * \brief Set the delay of the deliveries
+     *
+     * \param delay the delay
+     */
+    void SetDelay(Time delay);
+
+    /**
+     * \brief Set the probability of losing a delivery
+     *
+     * \param lossProbability the probability, between 0 and 1
+     */
+    void SetLossProbability(double lossProbability);
+
+    /**
+     * \brief Add a layer 2 ID to the ones monitored by a UE
+     *
+     * \param l2Id the layer 2 ID of the UE
+     * \param dstL2Id the monitored layer 2 ID
+     */
+    void MonitorL2Id(uint32_t l2Id, uint32_t dstL2Id);
+
+    /**
+     * \brief Send a signalling message
+     *
+     * \param srcL2Id the layer 2 ID of the sender
+     * \param packet the message
+     * \param dstL2Id the layer 2 ID of the receiver
+     */
+    void SendSignalling(uint32_t srcL2Id, Ptr<Packet> packet, uint32_t dstL2Id);
+
+    /**
+     * \brief Send a discovery message
+     *
+     * \param srcL2Id the layer 2 ID of the sender
+     * \param packet the message
+     * \param dstL2Id the destination layer 2 ID
+     */
+    void SendDiscovery(uint32_t srcL2Id, Ptr<Packet> packet, uint32_t dstL2Id);
+
+    /**
+     * \return the number of signalling messages delivered
+     */
+    uint32_t GetNSignallingDelivered() const;
+    /**
+     * \return the number of signalling messages lost
+     */
+    uint32_t GetNSignallingLost() const;
+    /**
+     * \return the number of discovery messages delivered
+     */
+    uint32_t GetNDiscoveryDelivered() const;
+    /**
+     * \return the number of discovery messages lost
+     */
+    uint32_t GetNDiscoveryLost() const;
+
+    /**
+     * \brief Assign a fixed random variable stream number to the random
+     *        variables used by this model
+     *
+     * \param stream first stream index to use
+     * \return the number of stream indices assigned by this model
+     */
+    int64_t AssignStreams(int64_t stream);
+
+  protected:
+    void DoDispose() override;
+
+  private:
+    /// A UE connected to the channel
+    struct Endpoint
+    {
+        Ptr<NrSlUeProse> prose;                             ///< ProSe layer, if any
+        Ptr<NrSlUeProseDirectLink> link;                    ///< Direct link, if any
+        std::unique_ptr<NrSlProseTestRrcSapProvider> rrc;   ///< Mock RRC of the ProSe layer
+        std::unique_ptr<NrSlProseTestNasSapProvider> nas;   ///< Mock NAS of the ProSe layer
+        std::unique_ptr<NrSlProseTestDirLnkSapUser> dirLnk; ///< Mock ProSe layer of the link
+        std::set<uint32_t> monitoredL2Ids;                  ///< Layer 2 IDs monitored by the UE
+    };
+
+    /**
+     * \brief Draw whether a delivery is lost
+     * \return true if the delivery is lost
+     */
+    bool IsLost();
+
+    /**
+     * \brief Deliver a signalling message to a UE
+     *
+     * \param srcL2Id the layer 2 ID of the sender
+     * \param packet the message
+     * \param dstL2Id the layer 2 ID of the receiver
+     */
+    void DeliverSignalling(uint32_t srcL2Id, Ptr<Packet> packet, uint32_t dstL2Id);
+
+    /**
+     * \brief Deliver a discovery message to a UE
+     *
+     * \param srcL2Id the layer 2 ID of the sender
+     * \param packet the message
+     * \param rxL2Id the layer 2 ID of the receiver
+     */
+    void DeliverDiscovery(uint32_t srcL2Id, Ptr<Packet> packet, uint32_t rxL2Id);
+
+    std::map<uint32_t, Endpoint> m_endpoints;  ///< UEs connected, indexed by layer 2 ID
+    Time m_delay;                              ///< Delay of the deliveries
+    double m_lossProbability;                  ///< Probability of losing a delivery
+    Ptr<UniformRandomVariable> m_lossVariable; ///< Random variable drawing the losses
+    uint32_t m_nSignallingDelivered{0};        ///< Number of signalling messages delivered
+    uint32_t m_nSignallingLost{0};             ///< Number of signalling messages lost
+    uint32_t m_nDiscoveryDelivered{0};         ///< Number of discovery messages delivered
+    uint32_t m_nDiscoveryLost{0};              ///< Number of discovery messages lost
+};
+
+} // namespace ns3
+
+#endif /* NR_SL_PROSE_TEST_HARNESS_H */
@@ -0,0 +1,609 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * NIST-developed software is provided by NIST as a public
+ * service. You may use, copy and distribute copies of the software in
+ * any medium, provided that you keep intact this entire notice. You
+ * may improve, modify and create derivative works of the software or
+ * any portion of the software, and you may copy and distribute such
+ * modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and
+ * nature of any such change. Please explicitly acknowledge the
+ * National Institute of Standards and Technology as the source of the
+ * software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES
+ * NO WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY
+ * OPERATION OF LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+ * WARRANTY OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE,
+ * NON-INFRINGEMENT AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR
+ * WARRANTS THAT THE OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED
+ * OR ERROR-FREE, OR THAT ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT
+ * WARRANT OR MAKE ANY REPRESENTATIONS REGARDING THE USE OF THE
+ * SOFTWARE OR THE RESULTS THEREOF, INCLUDING BUT NOT LIMITED TO THE
+ * CORRECTNESS, ACCURACY, RELIABILITY, OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of
+ * using and distributing the software and you assume all risks
+ * associated with its use, including but not limited to the risks and
+ * costs of program errors, compliance with applicable laws, damage to
+ * or loss of data, programs or equipment, and the unavailability or
+ * interruption of operation. This software is not intended to be used
+ * in any situation where a failure could cause risk of injury or
+ * damage to property. The software developed by NIST employees is not
+ * subject to copyright protection within the United States.
+ */
+
+#include <ns3/data-rate.h>
+#include <ns3/inet-socket-address.h>
+#include <ns3/internet-stack-helper.h>
+#include <ns3/ipv4-address-helper.h>
+#include <ns3/ipv4-header.h>
+#include <ns3/ipv4-l3-protocol.h>
+#include <ns3/ipv4-static-routing-helper.h>
+#include <ns3/ipv4-static-routing.h>
+#include <ns3/log.h>
+#include <ns3/mac48-address.h>
+#include <ns3/node.h>
+#include <ns3/nr-sl-u2n-relay-scheduler.h>
+#include <ns3/simple-channel.h>
+#include <ns3/simple-net-device.h>
+#include <ns3/simulator.h>
+#include <ns3/socket.h>
+#include <ns3/test.h>
+#include <ns3/udp-socket-factory.h>
+#include <ns3/uinteger.h>
+
+#include <cstdlib>
+#include <map>
+#include <sstream>
+#include <vector>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("NrSlU2nRelaySchedulerTest");
+
+namespace
+{
+
+/// Size of the test packets, IPv4 header included, equal to the default DRR quantum
+const uint32_t g_packetSize = 1500;
+
+/**
+ * \brief Get the IPv4 address of a remote UE
+ *
+ * \param remoteL2Id the layer 2 ID of the remote UE
+ * \return the IPv4 address of the remote UE
+ */
+Ipv4Address
+GetRemoteIp(uint32_t remoteL2Id)
+{
+    return Ipv4Address(0x07000000 + remoteL2Id);
+}
+
+/**
+ * \brief Create a packet sent by a remote UE
+ *
+ * \param remoteL2Id the layer 2 ID of the remote UE
+ * \return the IPv4 packet
+ */
+Ptr<Packet>
+CreateRemotePacket(uint32_t remoteL2Id)
+{
+    Ipv4Header header;
+    Ptr<Packet> packet = Create<Packet>(g_packetSize - header.GetSerializedSize());
+    header.SetSource(GetRemoteIp(remoteL2Id));
+    header.SetDestination(Ipv4Address("1.0.0.2"));
+    header.SetPayloadSize(packet->GetSize());
+    packet->AddHeader(header);
+    return packet;
+}
+
+/**
+ * \brief Create a scheduler with two remote UEs, of layer 2 IDs 1 and 2
+ *
+ * \param serviceRate the service rate of the scheduler
+ * \return the scheduler
+ */
+Ptr<NrSlU2nRelayScheduler>
+CreateScheduler(DataRate serviceRate)
+{
+    Ptr<NrSlU2nRelayScheduler> scheduler = CreateObject<NrSlU2nRelayScheduler>();
+    scheduler->SetAttribute("ServiceRate", DataRateValue(serviceRate));
+    scheduler->AddRemoteUe(1, GetRemoteIp(1));
+    scheduler->AddRemoteUe(2, GetRemoteIp(2));
+    return scheduler;
+}
+
+/**
+ * \brief Send a UDP packet of the size of the test packets
+ *
+ * \param socket the socket of the sender
+ * \param dst the address of the receiver
+ */
+void
+SendPacket(Ptr<Socket> socket, Ipv4Address dst)
+{
+    // 8 bytes of UDP header and 20 bytes of IPv4 header
+    socket->SendTo(Create<Packet>(g_packetSize - 28), 0, InetSocketAddress(dst, 9));
+}
+
+} // namespace
+
+/**
+ * \ingroup nr-prose-tests
+ *
+ * \brief Base class of the scheduler tests, recording the packets forwarded
+ *        by the scheduler
+ */
+class NrSlU2nRelaySchedulerTestCase : public TestCase
+{
+  public:
+    /**
+     * \brief Constructor
+     *
+     * \param name the name of the test case
+     */
+    NrSlU2nRelaySchedulerTestCase(std::string name);
+
+  protected:
+    /**
+     * \brief Forward callback of the scheduler
+     *
+     * \param packet the packet leaving the scheduler
+     */
+    void Forward(Ptr<Packet> packet);
+
+    /**
+     * \brief Trace sink of the packets leaving the scheduler
+     *
+     * \param remoteL2Id the layer 2 ID of the remote UE
+     * \param packet the packet
+     * \param sojourn the time spent by the packet in the queue
+     */
+    void Dequeue(uint32_t remoteL2Id, Ptr<const Packet> packet, Time sojourn);
+
+    /**
+     * \brief Trace sink of the packets dropped by the scheduler
+     *
+     * \param remoteL2Id the layer 2 ID of the remote UE
+     * \param packet the dropped packet
+     */
+    void Drop(uint32_t remoteL2Id, Ptr<const Packet> packet);
+
+    /**
+     * \brief Connect the callback and the trace sinks to a scheduler
+     *
+     * \param scheduler the scheduler
+     */
+    void Connect(Ptr<NrSlU2nRelayScheduler> scheduler);
+
+    std::vector<Ipv4Address> m_forwarded;     ///< Sources of the forwarded packets, in order
+    std::map<uint32_t, Time> m_lastDequeue;   ///< Time of the last dequeue per remote UE
+    std::map<uint32_t, uint32_t> m_nDequeued; ///< Number of dequeued packets per remote UE
+    std::map<uint32_t, uint32_t> m_nDropped;  ///< Number of dropped packets per remote UE
+};
+
+NrSlU2nRelaySchedulerTestCase::NrSlU2nRelaySchedulerTestCase(std::string name)
+    : TestCase(name)
+{
+}
+
+void
+NrSlU2nRelaySchedulerTestCase::Forward(Ptr<Packet> packet)
+{
+    Ipv4Header header;
+    packet->PeekHeader(header);
+    m_forwarded.push_back(header.GetSource());
+}
+
+void
+NrSlU2nRelaySchedulerTestCase::Dequeue(uint32_t remoteL2Id, Ptr<const Packet> packet, Time sojourn)
+{
+    NS_LOG_FUNCTION(this << remoteL2Id << packet << sojourn);
+    m_lastDequeue[remoteL2Id] = Simulator::Now();
+    m_nDequeued[remoteL2Id]++;
+}
+
+void
+NrSlU2nRelaySchedulerTestCase::Drop(uint32_t remoteL2Id, Ptr<const Packet> packet)
+{
+    NS_LOG_FUNCTION(this << remoteL2Id << packet);
+    m_nDropped[remoteL2Id]++;
+}
+
+void
+NrSlU2nRelaySchedulerTestCase::Connect(Ptr<NrSlU2nRelayScheduler> scheduler)
+{
+    scheduler->SetForwardCallback(MakeCallback(&NrSlU2nRelaySchedulerTestCase::Forward, this));
+    scheduler->TraceConnectWithoutContext(
+        "Dequeue",
+        MakeCallback(&NrSlU2nRelaySchedulerTestCase::Dequeue, this));
+    scheduler->TraceConnectWithoutContext("Drop",
+                                          MakeCallback(&NrSlU2nRelaySchedulerTestCase::Drop, this));
+}
+
+/**
+ * \ingroup nr-prose-tests
+ *
+ * \brief Test the DRR service of two backlogged remote UEs
+ *
+ * Both remote UEs queue the same number of packets at the same time. The
+ * packets are forwarded in proportion to the weights of the remote UEs, at
+ * any point of the service and not only on average.
+ */
+class NrSlU2nRelaySchedulerDrrTestCase : public NrSlU2nRelaySchedulerTestCase
+{
+  public:
+    /**
+     * \brief Constructor
+     *
+     * \param weight the weight of the first remote UE, the second one has a weight of 1
+     */
+    NrSlU2nRelaySchedulerDrrTestCase(uint32_t weight);
+
+  private:
+    /**
+     * \brief Builds the test name string based on provided parameter values
+     *
+     * \param weight the weight of the first remote UE
+     * \return the test name
+     */
+    static std::string BuildName(uint32_t weight);
+
+    void DoRun() override;
+
+    uint32_t m_weight; ///< Weight of the first remote UE
+};
+
+NrSlU2nRelaySchedulerDrrTestCase::NrSlU2nRelaySchedulerDrrTestCase(uint32_t weight)
+    : NrSlU2nRelaySchedulerTestCase(BuildName(weight)),
+      m_weight(weight)
+{
+}
+
+std::string
+NrSlU2nRelaySchedulerDrrTestCase::BuildName(uint32_t weight)
+{
+    std::ostringstream oss;
+    oss << "U2N relay scheduler DRR with weights " << weight << " and 1";
+    return oss.str();
+}
+
+void
+NrSlU2nRelaySchedulerDrrTestCase::DoRun()
+{
+    Ptr<NrSlU2nRelayScheduler> scheduler = CreateScheduler(DataRate("1Mb/s"));
+    Connect(scheduler);
+    scheduler->SetRemoteUeWeight(1, m_weight);
+
+    uint32_t nPackets = 30;
+    for (uint32_t i = 0; i < nPackets; ++i)
+    {
+        scheduler->Enqueue(CreateRemotePacket(1));
+    }
+    for (uint32_t i = 0; i < nPackets; ++i)
+    {
+        scheduler->Enqueue(CreateRemotePacket(2));
+    }
+    Simulator::Run();
+
+    NS_TEST_ASSERT_MSG_EQ(m_forwarded.size(), 2 * nPackets, "Not all the packets were forwarded");
+    NS_TEST_ASSERT_MSG_EQ(scheduler->GetForwardedPackets(1),
+                          nPackets,
+                          "Unexpected number of packets forwarded for the first remote UE");
+    NS_TEST_ASSERT_MSG_EQ(scheduler->GetForwardedPackets(2),
+                          nPackets,
+                          "Unexpected number of packets forwarded for the second remote UE");
+
+    // While both remote UEs are backlogged, the first one gets its weight
+    // times the share of the second one. The first packet of the first remote
+    // UE left before the second remote UE was backlogged, thus it is skipped
+    uint32_t nFirst = 0;
+    uint32_t nSecond = 0;
+    for (uint32_t i = 1; i < nPackets; ++i)
+    {
+        if (m_forwarded[i] == GetRemoteIp(1))
+        {
+            nFirst++;
+        }
+        else
+        {
+            nSecond++;
+        }
+        int32_t imbalance = static_cast<int32_t>(nFirst) - static_cast<int32_t>(m_weight * nSecond);
+        NS_TEST_ASSERT_MSG_LT_OR_EQ(std::abs(imbalance),
+                                    static_cast<int32_t>(m_weight),
+                                    "Unfair service after " << i + 1 << " packets");
+    }
+
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup nr-prose-tests
+ *
+ * \brief Test the rate limit of a remote UE
+ *
+ * The rate limited remote UE cannot send more than its token bucket and its
+ * rate allow, and it does not delay the remote UE without limit.
+ */
+class NrSlU2nRelaySchedulerRateLimitTestCase : public NrSlU2nRelaySchedulerTestCase
+{
+  public:
+    NrSlU2nRelaySchedulerRateLimitTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+NrSlU2nRelaySchedulerRateLimitTestCase::NrSlU2nRelaySchedulerRateLimitTestCase()
+    : NrSlU2nRelaySchedulerTestCase("U2N relay scheduler rate limit")
+{
+}
+
+void
+NrSlU2nRelaySchedulerRateLimitTestCase::DoRun()
+{
+    DataRate serviceRate("10Mb/s");
+    DataRate rateLimit("100kb/s");
+    uint32_t burst = 3000;
+    Time duration = Seconds(1);
+    Ptr<NrSlU2nRelayScheduler> scheduler = CreateScheduler(serviceRate);
+    scheduler->SetAttribute("RateLimitBurst", UintegerValue(burst));
+    Connect(scheduler);
+    scheduler->SetRemoteUeRateLimit(1, rateLimit);
+
+    uint32_t nPackets = 50;
+    for (uint32_t i = 0; i < nPackets; ++i)
+    {
+        scheduler->Enqueue(CreateRemotePacket(1));
+        scheduler->Enqueue(CreateRemotePacket(2));
+    }
+    Simulator::Stop(duration);
+    Simulator::Run();
+
+    // The bucket is full at the start, then refills at the rate limit
+    uint32_t maxLimited = static_cast<uint32_t>(
+        (burst + rateLimit.GetBitRate() * duration.GetSeconds() / 8) / g_packetSize);
+    NS_TEST_ASSERT_MSG_LT_OR_EQ(m_nDequeued[1],
+                                maxLimited,
+                                "The rate limited remote UE exceeded its rate");
+    NS_TEST_ASSERT_MSG_GT_OR_EQ(m_nDequeued[1],
+                                maxLimited - 1,
+                                "The rate limited remote UE did not get its rate");
+    NS_TEST_ASSERT_MSG_EQ(m_nDequeued[2], nPackets, "Not all the unlimited packets were forwarded");
+    // The unlimited remote UE is served at the service rate, with at most the
+    // packets of the limited remote UE allowed by its bucket in between
+    Time maxUnlimited = serviceRate.CalculateBytesTxTime((nPackets + maxLimited) * g_packetSize);
+    NS_TEST_ASSERT_MSG_LT_OR_EQ(m_lastDequeue[2],
+                                maxUnlimited,
+                                "The unlimited remote UE was delayed by the rate limit");
+
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup nr-prose-tests
+ *
+ * \brief Test the packets dropped by the scheduler
+ *
+ * The packets arriving to a full queue are dropped, as well as the packets
+ * still queued when the remote UE is removed. The packets from unknown
+ * sources bypass the queues.
+ */
+class NrSlU2nRelaySchedulerDropTestCase : public NrSlU2nRelaySchedulerTestCase
+{
+  public:
+    NrSlU2nRelaySchedulerDropTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+NrSlU2nRelaySchedulerDropTestCase::NrSlU2nRelaySchedulerDropTestCase()
+    : NrSlU2nRelaySchedulerTestCase("U2N relay scheduler drops")
+{
+}
+
+void
+NrSlU2nRelaySchedulerDropTestCase::DoRun()
+{
+    uint32_t maxQueueSize = 5;
+    Ptr<NrSlU2nRelayScheduler> scheduler = CreateScheduler(DataRate("1Mb/s"));
+    scheduler->SetAttribute("MaxQueueSize", UintegerValue(maxQueueSize));
+    Connect(scheduler);
+
+    // The first packet leaves at once, the next ones fill the queue
+    uint32_t nPackets = 10;
+    for (uint32_t i = 0; i < nPackets; ++i)
+    {
+        scheduler->Enqueue(CreateRemotePacket(1));
+    }
+    NS_TEST_ASSERT_MSG_EQ(scheduler->GetQueueDepth(1), maxQueueSize, "Unexpected queue depth");
+    NS_TEST_ASSERT_MSG_EQ(scheduler->GetQueueBytes(1),
+                          maxQueueSize * g_packetSize,
+                          "Unexpected queued bytes");
+    NS_TEST_ASSERT_MSG_EQ(scheduler->GetDroppedPackets(1),
+                          nPackets - maxQueueSize - 1,
+                          "Unexpected number of dropped packets");
+    NS_TEST_ASSERT_MSG_EQ(m_nDropped[1],
+                          nPackets - maxQueueSize - 1,
+                          "Unexpected number of traced drops");
+
+    // A packet from a source that is not a remote UE is forwarded immediately
+    scheduler->Enqueue(CreateRemotePacket(3));
+    NS_TEST_ASSERT_MSG_EQ(m_forwarded.size(), 2, "The unknown source was queued");
+
+    // Removing the second remote UE drops its queued packets
+    for (uint32_t i = 0; i < maxQueueSize; ++i)
+    {
+        scheduler->Enqueue(CreateRemotePacket(2));
+    }
+    scheduler->RemoveRemoteUe(2);
+    NS_TEST_ASSERT_MSG_EQ(scheduler->GetQueueDepth(2), 0, "The removed remote UE has packets");
+    NS_TEST_ASSERT_MSG_EQ(scheduler->GetDroppedPackets(2),
+                          maxQueueSize,
+                          "The packets of the removed remote UE were not dropped");
+    Simulator::Run();
+
+    NS_TEST_ASSERT_MSG_EQ(scheduler->GetForwardedPackets(1),
+                          maxQueueSize + 1,
+                          "The queued packets were not forwarded");
+    NS_TEST_ASSERT_MSG_EQ(scheduler->GetForwardedPackets(2),
+                          0,
+                          "Packets of the removed remote UE were forwarded");
+
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup nr-prose-tests
+ *
+ * \brief Test the scheduler in the IPv4 forwarding path of a relay node
+ *
+ * Two remote nodes send their packets to a server through a relay node, on
+ * a SimpleChannel, in place of the SL and the Uu. The scheduler is inserted
+ * in the forwarding path of the relay node with a NrSlU2nRelayRouting, as
+ * NrSlProseHelper::EnableU2nRelayScheduling does. After a first exchange
+ * resolving the MAC addresses, the first remote node sends a burst of
+ * packets, followed by the second one. Without the scheduler, the relay node
+ * would forward the whole burst of the first remote node first. With it, the
+ * server receives the packets of both remote nodes in turn.
+ */
+class NrSlU2nRelaySchedulerForwardingTestCase : public TestCase
+{
+  public:
+    NrSlU2nRelaySchedulerForwardingTestCase();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * \brief Trace sink of the packets delivered to the server
+     *
+     * \param header the IPv4 header of the packet
+     * \param packet the packet
+     * \param interface the interface of the server
+     */
+    void LocalDeliver(const Ipv4Header& header, Ptr<const Packet> packet, uint32_t interface);
+
+    std::vector<Ipv4Address> m_received; ///< Sources of the packets of the bursts, in order
+    Time m_burstStart;                   ///< Time the bursts are sent
+};
+
+NrSlU2nRelaySchedulerForwardingTestCase::NrSlU2nRelaySchedulerForwardingTestCase()
+    : TestCase("U2N relay scheduler in the forwarding path")
+{
+}
+
+void
+NrSlU2nRelaySchedulerForwardingTestCase::LocalDeliver(const Ipv4Header& header,
+                                                      Ptr<const Packet> packet,
+                                                      uint32_t interface)
+{
+    NS_LOG_FUNCTION(this << header.GetSource() << packet << interface);
+    if (Simulator::Now() >= m_burstStart)
+    {
+        m_received.push_back(header.GetSource());
+    }
+}
+
+void
+NrSlU2nRelaySchedulerForwardingTestCase::DoRun()
+{
+    // Nodes 0 and 1 are the remote nodes, node 2 the relay node and node 3 the server
+    InternetStackHelper internet;
+    Ipv4AddressHelper ipv4;
+    ipv4.SetBase(Ipv4Address("10.0.0.0"), Ipv4Mask("255.255.255.0"));
+    Ptr<SimpleChannel> channel = CreateObject<SimpleChannel>();
+    std::vector<Ptr<Node>> nodes;
+    std::vector<Ipv4Address> addresses;
+    for (uint32_t i = 0; i < 4; ++i)
+    {
+        Ptr<Node> node = CreateObject<Node>();
+        Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice>();
+        device->SetAddress(Mac48Address::Allocate());
+        device->SetChannel(channel);
+        node->AddDevice(device);
+        internet.Install(node);
+        addresses.push_back(ipv4.Assign(NetDeviceContainer(device)).GetAddress(0));
+        nodes.push_back(node);
+    }
+    Ipv4Address relayIp = addresses[2];
+    Ipv4Address serverIp = addresses[3];
+
+    Ptr<NrSlU2nRelayScheduler> scheduler = CreateObject<NrSlU2nRelayScheduler>();
+    scheduler->SetAttribute("ServiceRate", DataRateValue(DataRate("1Mb/s")));
+    scheduler->AddRemoteUe(1, addresses[0]);
+    scheduler->AddRemoteUe(2, addresses[1]);
+    Ptr<NrSlU2nRelayRouting> routing = CreateObject<NrSlU2nRelayRouting>();
+    routing->Install(nodes[2]->GetObject<Ipv4>(), scheduler);
+
+    nodes[3]->GetObject<Ipv4L3Protocol>()->TraceConnectWithoutContext(
+        "LocalDeliver",
+        MakeCallback(&NrSlU2nRelaySchedulerForwardingTestCase::LocalDeliver, this));
+    Ptr<Socket> sink = Socket::CreateSocket(nodes[3], UdpSocketFactory::GetTypeId());
+    sink->Bind(InetSocketAddress(Ipv4Address::GetAny(), 9));
+
+    Ipv4StaticRoutingHelper routingHelper;
+    uint32_t nPackets = 30;
+    m_burstStart = Seconds(2);
+    for (uint32_t i = 0; i < 2; ++i)
+    {
+        routingHelper.GetStaticRouting(nodes[i]->GetObject<Ipv4>())
+            ->AddHostRouteTo(serverIp, relayIp, 1);
+        Ptr<Socket> socket = Socket::CreateSocket(nodes[i], UdpSocketFactory::GetTypeId());
+        Simulator::Schedule(Seconds(1), &SendPacket, socket, serverIp);
+        for (uint32_t n = 0; n < nPackets; ++n)
+        {
+            Simulator::Schedule(m_burstStart, &SendPacket, socket, serverIp);
+        }
+    }
+    Simulator::Stop(Seconds(4));
+    Simulator::Run();
+
+    NS_TEST_ASSERT_MSG_EQ(m_received.size(), 2 * nPackets, "Not all the packets were received");
+    NS_TEST_ASSERT_MSG_EQ(scheduler->GetForwardedPackets(1),
+                          nPackets + 1,
+                          "The packets of the first remote node did not go through the scheduler");
+    NS_TEST_ASSERT_MSG_EQ(scheduler->GetForwardedPackets(2),
+                          nPackets + 1,
+                          "The packets of the second remote node did not go through the scheduler");
+
+    // The first packet of the first remote node left before the second remote
+    // node was backlogged, thus it is skipped
+    int32_t imbalance = 0;
+    for (uint32_t i = 1; i < m_received.size(); ++i)
+    {
+        imbalance += (m_received[i] == addresses[0] ? 1 : -1);
+        NS_TEST_ASSERT_MSG_LT_OR_EQ(std::abs(imbalance),
+                                    1,
+                                    "Unfair forwarding after " << i + 1 << " packets");
+    }
+
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup nr-prose-tests
+ *
+ * \brief Test suite of the U2N relay scheduler
+ */
+class NrSlU2nRelaySchedulerTestSuite : public TestSuite
+{
+  public:
+    NrSlU2nRelaySchedulerTestSuite();
+};
+
+NrSlU2nRelaySchedulerTestSuite::NrSlU2nRelaySchedulerTestSuite()
+    : TestSuite("nr-sl-u2n-relay-scheduler", TestSuite::UNIT)
+{
+    AddTestCase(new NrSlU2nRelaySchedulerDrrTestCase(1), TestCase::QUICK);
+    AddTestCase(new NrSlU2nRelaySchedulerDrrTestCase(2), TestCase::QUICK);
+    AddTestCase(new NrSlU2nRelaySchedulerRateLimitTestCase(), TestCase::QUICK);
+    AddTestCase(new NrSlU2nRelaySchedulerDropTestCase(), TestCase::QUICK);
+    AddTestCase(new NrSlU2nRelaySchedulerForwardingTestCase(), TestCase::QUICK);
+}
+
+/// Static variable for test initialization
+static NrSlU2nRelaySchedulerTestSuite g_nrSlU2nRelaySchedulerTestSuite;
@@ -0,0 +1,1905 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * NIST-developed software is provided by NIST as a public
+ * service. You may use, copy and distribute copies of the software in
+ * any medium, provided that you keep intact this entire notice. You
+ * may improve, modify and create derivative works of the software or
+ * any portion of the software, and you may copy and distribute such
+ * modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and
+ * nature of any such change. Please explicitly acknowledge the
+ * National Institute of Standards and Technology as the source of the
+ * software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES
+ * NO WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY
+ * OPERATION OF LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+ * WARRANTY OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE,
+ * NON-INFRINGEMENT AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR
+ * WARRANTS THAT THE OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED
+ * OR ERROR-FREE, OR THAT ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT
+ * WARRANT OR MAKE ANY REPRESENTATIONS REGARDING THE USE OF THE
+ * SOFTWARE OR THE RESULTS THEREOF, INCLUDING BUT NOT LIMITED TO THE
+ * CORRECTNESS, ACCURACY, RELIABILITY, OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of
+ * using and distributing the software and you assume all risks
+ * associated with its use, including but not limited to the risks and
+ * costs of program errors, compliance with applicable laws, damage to
+ * or loss of data, programs or equipment, and the unavailability or
+ * interruption of operation. This software is not intended to be used
+ * in any situation where a failure could cause risk of injury or
+ * damage to property. The software developed by NIST employees is not
+ * subject to copyright protection within the United States.
+ */
+
+#include "nr-sl-prose-test-harness.h"
+
+#include <ns3/constant-position-mobility-model.h>
+#include <ns3/double.h>
+#include <ns3/inet-socket-address.h>
+#include <ns3/internet-stack-helper.h>
+#include <ns3/ipv4-address-helper.h>
+#include <ns3/ipv4-static-routing-helper.h>
+#include <ns3/ipv4-static-routing.h>
+#include <ns3/mac48-address.h>
+#include <ns3/node.h>
+#include <ns3/nr-sl-discovery-header.h>
+#include <ns3/nr-sl-discovery-oracle.h>
+#include <ns3/nr-sl-pc5-signalling-header.h>
+#include <ns3/nr-sl-prose-stats.h>
+#include <ns3/nr-sl-ue-prose-direct-link.h>
+#include <ns3/nr-sl-ue-prose-relay-selection-algorithm.h>
+#include <ns3/nr-sl-ue-prose.h>
+#include <ns3/pointer.h>
+#include <ns3/propagation-loss-model.h>
+#include <ns3/simple-channel.h>
+#include <ns3/simple-net-device.h>
+#include <ns3/simulator.h>
+#include <ns3/socket.h>
+#include <ns3/test.h>
+#include <ns3/udp-socket-factory.h>
+
+#include <cmath>
+#include <sstream>
+
+/**
+ * \defgroup nr-prose-tests Tests for the ProSe protocols
+ * \ingroup nr
+ *
+ * The tests connect the ProSe layers and the direct links through a
+ * NrSlProseTestChannel instead of the NR stack, so that the protocols can be
+ * checked message by message in a few milliseconds of wall clock time.
+ */
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("NrSlUeProseTest");
+
+namespace
+{
+
+/// Application code used by the discovery tests
+const uint32_t g_appCode = 33;
+/// Destination layer 2 ID of the discovery messages
+const uint32_t g_discoveryL2Id = 500;
+/// Relay service code used by the relay discovery tests
+const uint32_t g_relayCode = 5;
+/// Group ID used by the group member discovery tests
+const uint32_t g_groupId = 7;
+
+/**
+ * \brief Create a direct link connected to a test channel
+ *
+ * \param channel the test channel
+ * \param selfL2Id the layer 2 ID of the UE owning the direct link
+ * \param peerL2Id the layer 2 ID of the peer UE
+ * \param isInitiating true if the UE initiates the direct link establishment
+ * \param stats the statistics of the UE
+ * \return the direct link
+ */
+Ptr<NrSlUeProseDirectLink>
+CreateDirectLink(Ptr<NrSlProseTestChannel> channel,
+                 uint32_t selfL2Id,
+                 uint32_t peerL2Id,
+                 bool isInitiating,
+                 Ptr<NrSlProseStats> stats)
+{
+    Ptr<NrSlUeProseDirectLink> link = CreateObject<NrSlUeProseDirectLink>();
+    link->SetParameters(selfL2Id, peerL2Id, isInitiating, false, 0, Ipv4Address(selfL2Id));
+    link->SetProseStats(stats);
+    channel->AddDirectLink(link, selfL2Id);
+    return link;
+}
+
+/**
+ * \brief Create the ProSe layers of a number of UEs connected to a test channel
+ *
+ * The layer 2 IDs of the UEs are 1, 2, ..., nUes.
+ *
+ * \param channel the test channel
+ * \param nUes the number of UEs
+ * \return the ProSe layers
+ */
+std::vector<Ptr<NrSlUeProse>>
+CreateUes(Ptr<NrSlProseTestChannel> channel, uint32_t nUes)
+{
+    std::vector<Ptr<NrSlUeProse>> ues;
+    for (uint32_t l2Id = 1; l2Id <= nUes; ++l2Id)
+    {
+        Ptr<NrSlUeProse> prose = CreateObject<NrSlUeProse>();
+        channel->AddUe(prose, l2Id);
+        prose->SetDiscoveryInterval(Seconds(1));
+        ues.push_back(prose);
+    }
+    return ues;
+}
+
+/**
+ * \brief Give the UEs a net device with an IPv4 address
+ *
+ * The ProSe layer mostly needs the device for the IP address of the UE, used
+ * when it creates a direct link on its own. The address of the UE with layer
+ * 2 ID n is 10.0.0.n. The devices share a SimpleChannel, which carries the IP
+ * packets of the tests that send data in place of the SL-DRBs.
+ *
+ * \param ues the ProSe layers of the UEs
+ * \param delay the delay of the SimpleChannel
+ * \return the nodes of the UEs
+ */
+std::vector<Ptr<Node>>
+InstallInternetStack(const std::vector<Ptr<NrSlUeProse>>& ues, Time delay = Seconds(0))
+{
+    InternetStackHelper internet;
+    Ipv4AddressHelper ipv4;
+    ipv4.SetBase(Ipv4Address("10.0.0.0"), Ipv4Mask("255.255.255.0"));
+    Ptr<SimpleChannel> channel = CreateObject<SimpleChannel>();
+    channel->SetAttribute("Delay", TimeValue(delay));
+    std::vector<Ptr<Node>> nodes;
+    for (const auto& prose : ues)
+    {
+        Ptr<Node> node = CreateObject<Node>();
+        Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice>();
+        device->SetAddress(Mac48Address::Allocate());
+        device->SetChannel(channel);
+        node->AddDevice(device);
+        internet.Install(node);
+        ipv4.Assign(NetDeviceContainer(device));
+        prose->SetNetDevice(device);
+        nodes.push_back(node);
+    }
+    return nodes;
+}
+
+/**
+ * \brief Get the traffic profile of a unicast direct link
+ *
+ * \param selfL2Id the layer 2 ID of the UE
+ * \param peerL2Id the layer 2 ID of the peer UE
+ * \return the traffic profile
+ */
+SidelinkInfo
+GetUnicastSlInfo(uint32_t selfL2Id, uint32_t peerL2Id)
+{
+    SidelinkInfo slInfo;
+    slInfo.m_castType = SidelinkInfo::CastType::Unicast;
+    slInfo.m_srcL2Id = selfL2Id;
+    slInfo.m_dstL2Id = peerL2Id;
+    slInfo.m_dynamic = true;
+    slInfo.m_priority = 1;
+    slInfo.m_pdb = MilliSeconds(20);
+    return slInfo;
+}
+
+/**
+ * \brief Send a UDP packet
+ *
+ * \param socket the socket of the sender
+ * \param dst the address of the receiver
+ * \param port the port of the receiver
+ */
+void
+SendPacket(Ptr<Socket> socket, Ipv4Address dst, uint16_t port)
+{
+    socket->SendTo(Create<Packet>(100), 0, InetSocketAddress(dst, port));
+}
+
+} // namespace
+
+/**
+ * \ingroup nr-prose-tests
+ *
+ * \brief Test the establishment of a direct link when the first requests are lost
+ *
+ * The messages are lost during a configurable time from the start, so that the
+ * initiating UE must retransmit its request every T5080 until one gets through.
+ */
+class NrSlUeProseDirectLinkEstablishmentTestCase : public TestCase
+{
+  public:
+    /**
+     * \brief Constructor
+     *
+     * \param lossDuration the time during which all the messages are lost
+     * \param expectedRtx the expected number of request retransmissions
+     */
+    NrSlUeProseDirectLinkEstablishmentTestCase(Time lossDuration, uint32_t expectedRtx);
+
+  private:
+    void DoRun() override;
+
+    /**
+     * \brief Build the name of the test case
+     * \param lossDuration the time during which all the messages are lost
+     * \return the name
+     */
+    static std::string BuildName(Time lossDuration);
+
+    Time m_lossDuration;    ///< Time during which all the messages are lost
+    uint32_t m_expectedRtx; ///< Expected number of request retransmissions
+};
+
+NrSlUeProseDirectLinkEstablishmentTestCase::NrSlUeProseDirectLinkEstablishmentTestCase(
+    Time lossDuration,
+    uint32_t expectedRtx)
+    : TestCase(BuildName(lossDuration)),
+      m_lossDuration(lossDuration),
+      m_expectedRtx(expectedRtx)
+{
+}
+
+std::string
+NrSlUeProseDirectLinkEstablishmentTestCase::BuildName(Time lossDuration)
+{
+    std::ostringstream oss;
+    oss << "Direct link establishment with all the messages lost during "
+        << lossDuration.GetSeconds() << " s";
+    return oss.str();
+}
+
+void
+NrSlUeProseDirectLinkEstablishmentTestCase::DoRun()
+{
+    Ptr<NrSlProseTestChannel> channel = CreateObject<NrSlProseTestChannel>();
+    if (m_lossDuration.IsStrictlyPositive())
+    {
+        channel->SetLossProbability(1.0);
+        Simulator::Schedule(m_lossDuration,
+                            &NrSlProseTestChannel::SetLossProbability,
+                            channel,
+                            0.0);
+    }
+    Ptr<NrSlProseStats> initiatorStats = Create<NrSlProseStats>();
+    Ptr<NrSlUeProseDirectLink> initiator = CreateDirectLink(channel, 1, 2, true, initiatorStats);
+    Ptr<NrSlUeProseDirectLink> target =
+        CreateDirectLink(channel, 2, 1, false, Create<NrSlProseStats>());
+
+    TimeValue t5080;
+    initiator->GetAttribute("T5080", t5080);
+
+    initiator->StartConnectionEstablishment();
+    // The first request sent after the lossy period is delivered
+    Simulator::Stop(m_lossDuration + t5080.Get() + Seconds(1));
+    Simulator::Run();
+
+    NS_TEST_ASSERT_MSG_EQ(initiator->GetState(),
+                          NrSlUeProseDirectLink::ESTABLISHED,
+                          "The initiating UE did not establish the direct link");
+    NS_TEST_ASSERT_MSG_EQ(target->GetState(),
+                          NrSlUeProseDirectLink::ESTABLISHED,
+                          "The target UE did not establish the direct link");
+    // ESTABLISHING then ESTABLISHED on both sides
+    NS_TEST_ASSERT_MSG_EQ(channel->GetDirLnkSapUser(1)->GetStates().size(),
+                          2,
+                          "Unexpected number of states of the initiating UE");
+    NS_TEST_ASSERT_MSG_EQ(channel->GetDirLnkSapUser(2)->GetStates().size(),
+                          2,
+                          "Unexpected number of states of the target UE");
+    NS_TEST_ASSERT_MSG_EQ(initiatorStats->GetPc5SignallingRetransmissions(),
+                          m_expectedRtx,
+                          "Unexpected number of request retransmissions");
+    NS_TEST_ASSERT_MSG_EQ(initiatorStats->GetLinkEstablishmentFailures(),
+                          0,
+                          "Unexpected establishment failure");
+    // The peers learn their IP addresses from the request and the accept
+    NS_TEST_ASSERT_MSG_EQ(channel->GetDirLnkSapUser(1)->GetIpInfo().peerIpv4Addr,
+                          Ipv4Address(2),
+                          "Wrong IP address of the target UE");
+    NS_TEST_ASSERT_MSG_EQ(channel->GetDirLnkSapUser(2)->GetIpInfo().peerIpv4Addr,
+                          Ipv4Address(1),
+                          "Wrong IP address of the initiating UE");
+
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup nr-prose-tests
+ *
+ * \brief Test the release of a direct link when all the requests are lost
+ *
+ * The initiating UE retransmits its establishment request up to the maximum,
+ * declares the establishment failed and releases the link on its own after
+ * retransmitting its release request up to the maximum.
+ */
+class NrSlUeProseDirectLinkFailureTestCase : public TestCase
+{
+  public:
+    NrSlUeProseDirectLinkFailureTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+NrSlUeProseDirectLinkFailureTestCase::NrSlUeProseDirectLinkFailureTestCase()
+    : TestCase("Direct link establishment with all the messages lost")
+{
+}
+
+void
+NrSlUeProseDirectLinkFailureTestCase::DoRun()
+{
+    Ptr<NrSlProseTestChannel> channel = CreateObject<NrSlProseTestChannel>();
+    channel->SetLossProbability(1.0);
+    Ptr<NrSlProseStats> initiatorStats = Create<NrSlProseStats>();
+    Ptr<NrSlUeProseDirectLink> initiator = CreateDirectLink(channel, 1, 2, true, initiatorStats);
+    Ptr<NrSlUeProseDirectLink> target =
+        CreateDirectLink(channel, 2, 1, false, Create<NrSlProseStats>());
+
+    UintegerValue esRtxMax;
+    UintegerValue reRtxMax;
+    TimeValue t5080;
+    TimeValue t5087;
+    initiator->GetAttribute("PdlEsReqRtxMax", esRtxMax);
+    initiator->GetAttribute("PdlReReqRtxMax", reRtxMax);
+    initiator->GetAttribute("T5080", t5080);
+    initiator->GetAttribute("T5087", t5087);
+
+    initiator->StartConnectionEstablishment();
+    // The link is released after the last release request retransmission
+    Time releaseTime = t5080.Get() * static_cast<int64_t>(esRtxMax.Get() + 1) +
+                       t5087.Get() * static_cast<int64_t>(reRtxMax.Get() + 1);
+    Simulator::Stop(releaseTime + Seconds(1));
+    Simulator::Run();
+
+    NS_TEST_ASSERT_MSG_EQ(initiator->GetState(),
+                          NrSlUeProseDirectLink::RELEASED,
+                          "The initiating UE did not release the direct link");
+    NS_TEST_ASSERT_MSG_EQ(target->GetState(),
+                          NrSlUeProseDirectLink::INIT,
+                          "The target UE should not have heard of the direct link");
+    // ESTABLISHING, RELEASING and RELEASED
+    NS_TEST_ASSERT_MSG_EQ(channel->GetDirLnkSapUser(1)->GetStates().size(),
+                          3,
+                          "Unexpected number of states of the initiating UE");
+    NS_TEST_ASSERT_MSG_EQ(initiatorStats->GetLinkEstablishmentFailures(),
+                          1,
+                          "The establishment failure was not counted");
+    NS_TEST_ASSERT_MSG_EQ(initiatorStats->GetPc5SignallingRetransmissions(),
+                          esRtxMax.Get() + reRtxMax.Get(),
+                          "Unexpected number of retransmissions");
+    NS_TEST_ASSERT_MSG_EQ(channel->GetNSignallingLost(),
+                          esRtxMax.Get() + reRtxMax.Get() + 2,
+                          "Unexpected number of messages sent");
+
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup nr-prose-tests
+ *
+ * \brief Test the release of an established direct link, possibly when the
+ *        first release accept is lost
+ */
+class NrSlUeProseDirectLinkReleaseTestCase : public TestCase
+{
+  public:
+    /**
+     * \brief Constructor
+     *
+     * \param loseAccept true to lose the first release accept
+     */
+    NrSlUeProseDirectLinkReleaseTestCase(bool loseAccept);
+
+  private:
+    void DoRun() override;
+
+    bool m_loseAccept; ///< True to lose the first release accept
+};
+
+NrSlUeProseDirectLinkReleaseTestCase::NrSlUeProseDirectLinkReleaseTestCase(bool loseAccept)
+    : TestCase(loseAccept ? "Direct link release with the first release accept lost"
+                          : "Direct link release"),
+      m_loseAccept(loseAccept)
+{
+}
+
+void
+NrSlUeProseDirectLinkReleaseTestCase::DoRun()
+{
+    Ptr<NrSlProseTestChannel> channel = CreateObject<NrSlProseTestChannel>();
+    Time delay = MilliSeconds(1);
+    channel->SetDelay(delay);
+    Ptr<NrSlProseStats> initiatorStats = Create<NrSlProseStats>();
+    Ptr<NrSlUeProseDirectLink> initiator = CreateDirectLink(channel, 1, 2, true, initiatorStats);
+    Ptr<NrSlUeProseDirectLink> target =
+        CreateDirectLink(channel, 2, 1, false, Create<NrSlProseStats>());
+
+    initiator->StartConnectionEstablishment();
+    Time releaseTime = Seconds(1);
+    Simulator::Schedule(releaseTime,
+                        &NrSlUeProseDirectLink::StartConnectionRelease,
+                        initiator,
+                        2); // Direct communication to the target UE no longer needed
+    if (m_loseAccept)
+    {
+        // The request is delivered after one delay, and the accept is sent
+        // right away
+        Simulator::Schedule(releaseTime + delay / 2,
+                            &NrSlProseTestChannel::SetLossProbability,
+                            channel,
+                            1.0);
+        Simulator::Schedule(releaseTime + delay * 2,
+                            &NrSlProseTestChannel::SetLossProbability,
+                            channel,
+                            0.0);
+    }
+    TimeValue t5087;
+    initiator->GetAttribute("T5087", t5087);
+    Simulator::Stop(releaseTime + t5087.Get() + Seconds(1));
+    Simulator::Run();
+
+    NS_TEST_ASSERT_MSG_EQ(initiator->GetState(),
+                          NrSlUeProseDirectLink::RELEASED,
+                          "The initiating UE did not release the direct link");
+    NS_TEST_ASSERT_MSG_EQ(target->GetState(),
+                          NrSlUeProseDirectLink::RELEASED,
+                          "The target UE did not release the direct link");
+    // ESTABLISHING, ESTABLISHED, RELEASING and RELEASED on both sides
+    NS_TEST_ASSERT_MSG_EQ(channel->GetDirLnkSapUser(1)->GetStates().size(),
+                          4,
+                          "Unexpected number of states of the initiating UE");
+    NS_TEST_ASSERT_MSG_EQ(channel->GetDirLnkSapUser(2)->GetStates().size(),
+                          4,
+                          "Unexpected number of states of the target UE");
+    NS_TEST_ASSERT_MSG_EQ(initiatorStats->GetPc5SignallingRetransmissions(),
+                          (m_loseAccept ? 1 : 0),
+                          "Unexpected number of release request retransmissions");
+
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup nr-prose-tests
+ *
+ * \brief Test a unicast direct link between the ProSe layers of two UEs
+ *
+ * Without losses, the link is established and the ProSe layers ask their NAS
+ * for the data radio bearer towards the peer. When all the messages are lost,
+ * the initiating UE gives up, releases the link and removes its bearers.
+ */
+class NrSlUeProseUnicastTestCase : public TestCase
+{
+  public:
+    /**
+     * \brief Constructor
+     *
+     * \param lossy true to lose all the messages
+     */
+    NrSlUeProseUnicastTestCase(bool lossy);
+
+  private:
+    void DoRun() override;
+
+    bool m_lossy; ///< True to lose all the messages
+};
+
+NrSlUeProseUnicastTestCase::NrSlUeProseUnicastTestCase(bool lossy)
+    : TestCase(lossy ? "ProSe unicast direct link with all the messages lost"
+                     : "ProSe unicast direct link"),
+      m_lossy(lossy)
+{
+}
+
+void
+NrSlUeProseUnicastTestCase::DoRun()
+{
+    Ptr<NrSlProseTestChannel> channel = CreateObject<NrSlProseTestChannel>();
+    channel->SetLossProbability(m_lossy ? 1.0 : 0.0);
+    std::vector<Ptr<NrSlUeProse>> ues = CreateUes(channel, 2);
+    Ptr<NrSlUeProse> initiator = ues[0];
+    Ptr<NrSlUeProse> target = ues[1];
+    initiator->ConfigureUnicast();
+    target->ConfigureUnicast();
+
+    // The target UE must know the link before it receives the request
+    target->AddDirectLinkConnection(2, Ipv4Address(2), 1, false, 0, GetUnicastSlInfo(2, 1));
+    initiator->AddDirectLinkConnection(1, Ipv4Address(1), 2, true, 0, GetUnicastSlInfo(1, 2));
+    Simulator::Stop(Seconds(60));
+    Simulator::Run();
+
+    uint8_t requestType = NrSlPc5SignallingMessageType::ProseDirectLinkEstablishmentRequest;
+    Ptr<NrSlProseStats> initiatorStats = initiator->GetProseStats();
+    Ptr<NrSlProseStats> targetStats = target->GetProseStats();
+    NS_TEST_ASSERT_MSG_EQ(initiator->GetNumDirectLinks(), 1, "Unexpected number of links");
+    // The request and its retransmissions
+    NS_TEST_ASSERT_MSG_EQ(initiatorStats->GetPc5SignallingTx(requestType),
+                          (m_lossy ? 4 : 1),
+                          "Unexpected number of establishment requests");
+    NS_TEST_ASSERT_MSG_GT(channel->GetRrcSapProvider(1)->GetNSignallingBearers(),
+                          0,
+                          "No signalling radio bearer activated");
+    if (!m_lossy)
+    {
+        NS_TEST_ASSERT_MSG_EQ(initiatorStats->GetLinkEstablishments(),
+                              1,
+                              "The initiating UE did not establish the direct link");
+        NS_TEST_ASSERT_MSG_EQ(targetStats->GetLinkEstablishments(),
+                              1,
+                              "The target UE did not establish the direct link");
+        NS_TEST_ASSERT_MSG_EQ(targetStats->GetPc5SignallingRx(requestType),
+                              1,
+                              "Unexpected number of establishment requests received");
+        NS_TEST_ASSERT_MSG_EQ(channel->GetNasSapProvider(1)->GetNActivatedBearers(),
+                              1,
+                              "The initiating UE did not activate its data radio bearer");
+        NS_TEST_ASSERT_MSG_EQ(channel->GetNasSapProvider(2)->GetNActivatedBearers(),
+                              1,
+                              "The target UE did not activate its data radio bearer");
+    }
+    else
+    {
+        NS_TEST_ASSERT_MSG_EQ(initiatorStats->GetLinkEstablishments(),
+                              0,
+                              "Unexpected link establishment");
+        NS_TEST_ASSERT_MSG_EQ(initiatorStats->GetLinkEstablishmentFailures(),
+                              1,
+                              "The establishment failure was not counted");
+        NS_TEST_ASSERT_MSG_EQ(targetStats->GetPc5SignallingRx(requestType),
+                              0,
+                              "Unexpected establishment request received");
+        NS_TEST_ASSERT_MSG_EQ(channel->GetNasSapProvider(1)->GetNActivatedBearers(),
+                              0,
+                              "Unexpected data radio bearer activation");
+        // The released link removes its bearers
+        NS_TEST_ASSERT_MSG_EQ(channel->GetNasSapProvider(1)->GetNDeletedBearers(),
+                              1,
+                              "The data radio bearer was not deleted");
+        NS_TEST_ASSERT_MSG_EQ(channel->GetRrcSapProvider(1)->GetNConnectionReleases(),
+                              1,
+                              "The sidelink connection release was not notified");
+    }
+
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup nr-prose-tests
+ *
+ * \brief Test the open (Model A) discovery between one announcing UE and
+ *        monitoring UEs
+ */
+class NrSlUeProseOpenDiscoveryTestCase : public TestCase
+{
+  public:
+    /**
+     * \brief Constructor
+     *
+     * \param nUes the number of UEs, including the announcing UE
+     * \param lossProbability the probability of losing a message
+     */
+    NrSlUeProseOpenDiscoveryTestCase(uint32_t nUes, double lossProbability);
+
+  private:
+    void DoRun() override;
+
+    /**
+     * \brief Build the name of the test case
+     * \param nUes the number of UEs, including the announcing UE
+     * \param lossProbability the probability of losing a message
+     * \return the name
+     */
+    static std::string BuildName(uint32_t nUes, double lossProbability);
+
+    uint32_t m_nUes;          ///< Number of UEs
+    double m_lossProbability; ///< Probability of losing a message
+};
+
+NrSlUeProseOpenDiscoveryTestCase::NrSlUeProseOpenDiscoveryTestCase(uint32_t nUes,
+                                                                   double lossProbability)
+    : TestCase(BuildName(nUes, lossProbability)),
+      m_nUes(nUes),
+      m_lossProbability(lossProbability)
+{
+}
+
+std::string
+NrSlUeProseOpenDiscoveryTestCase::BuildName(uint32_t nUes, double lossProbability)
+{
+    std::ostringstream oss;
+    oss << "Open discovery with " << nUes << " UEs and loss probability " << lossProbability;
+    return oss.str();
+}
+
+void
+NrSlUeProseOpenDiscoveryTestCase::DoRun()
+{
+    Ptr<NrSlProseTestChannel> channel = CreateObject<NrSlProseTestChannel>();
+    channel->SetLossProbability(m_lossProbability);
+    channel->AssignStreams(1);
+    std::vector<Ptr<NrSlUeProse>> ues = CreateUes(channel, m_nUes);
+
+    // The monitoring UEs listen before the first announcement. Their peers
+    // never expire, so that a peer is discovered if any announcement got through
+    for (uint32_t i = 1; i < m_nUes; ++i)
+    {
+        ues[i]->SetAttribute("DiscoveredPeerTtl", TimeValue(Seconds(0)));
+        ues[i]->AddDiscoveryApp(g_appCode, g_discoveryL2Id, NrSlUeProse::Monitoring);
+    }
+    ues[0]->AddDiscoveryApp(g_appCode, g_discoveryL2Id, NrSlUeProse::Announcing);
+
+    // One announcement per second
+    uint32_t nAnnouncements = 10;
+    Simulator::Stop(Seconds(nAnnouncements - 0.5));
+    Simulator::Run();
+
+    NS_TEST_ASSERT_MSG_EQ(ues[0]->GetProseStats()->GetDiscoveryTx(),
+                          nAnnouncements,
+                          "Unexpected number of announcements");
+    NS_TEST_ASSERT_MSG_EQ(channel->GetRrcSapProvider(1)->GetNDiscoveryBearers(),
+                          1,
+                          "Unexpected number of discovery radio bearers");
+    NS_TEST_ASSERT_MSG_EQ(channel->GetNDiscoveryDelivered() + channel->GetNDiscoveryLost(),
+                          nAnnouncements * (m_nUes - 1),
+                          "The announcements did not reach all the monitoring UEs");
+    uint64_t nReceived = 0;
+    for (uint32_t i = 1; i < m_nUes; ++i)
+    {
+        uint64_t nRx = ues[i]->GetProseStats()->GetDiscoveryRx();
+        nReceived += nRx;
+        NS_TEST_ASSERT_MSG_EQ(ues[i]->IsPeerDiscovered(g_appCode, 1),
+                              nRx > 0,
+                              "UE " << i + 1 << " received " << nRx << " announcements");
+        NS_TEST_ASSERT_MSG_EQ(ues[i]->GetNDiscoveredPeers(g_appCode),
+                              (nRx > 0 ? 1 : 0),
+                              "Unexpected number of peers discovered by UE " << i + 1);
+    }
+    NS_TEST_ASSERT_MSG_EQ(nReceived,
+                          channel->GetNDiscoveryDelivered(),
+                          "Some delivered announcements were not received");
+    if (m_lossProbability == 0.0)
+    {
+        NS_TEST_ASSERT_MSG_EQ(channel->GetNDiscoveryLost(), 0, "Unexpected loss");
+    }
+    else if (m_lossProbability == 1.0)
+    {
+        NS_TEST_ASSERT_MSG_EQ(channel->GetNDiscoveryDelivered(), 0, "Unexpected delivery");
+    }
+    NS_TEST_ASSERT_MSG_EQ(ues[0]->GetNDiscoveredPeers(g_appCode),
+                          0,
+                          "The announcing UE should not discover any peer");
+
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup nr-prose-tests
+ *
+ * \brief Test the restricted (Model B) discovery between one discoverer UE
+ *        and discoveree UEs
+ */
+class NrSlUeProseRestrictedDiscoveryTestCase : public TestCase
+{
+  public:
+    /**
+     * \brief Constructor
+     *
+     * \param nUes the number of UEs, including the discoverer UE
+     */
+    NrSlUeProseRestrictedDiscoveryTestCase(uint32_t nUes);
+
+  private:
+    void DoRun() override;
+
+    uint32_t m_nUes; ///< Number of UEs
+};
+
+NrSlUeProseRestrictedDiscoveryTestCase::NrSlUeProseRestrictedDiscoveryTestCase(uint32_t nUes)
+    : TestCase("Restricted discovery with " + std::to_string(nUes) + " UEs"),
+      m_nUes(nUes)
+{
+}
+
+void
+NrSlUeProseRestrictedDiscoveryTestCase::DoRun()
+{
+    Ptr<NrSlProseTestChannel> channel = CreateObject<NrSlProseTestChannel>();
+    std::vector<Ptr<NrSlUeProse>> ues = CreateUes(channel, m_nUes);
+
+    for (uint32_t i = 1; i < m_nUes; ++i)
+    {
+        ues[i]->AddDiscoveryApp(g_appCode, g_discoveryL2Id, NrSlUeProse::Discoveree);
+    }
+    ues[0]->AddDiscoveryApp(g_appCode, g_discoveryL2Id, NrSlUeProse::Discoverer);
+
+    // One query per second
+    uint32_t nQueries = 10;
+    Simulator::Stop(Seconds(nQueries - 0.5));
+    Simulator::Run();
+
+    Ptr<NrSlProseStats> discovererStats = ues[0]->GetProseStats();
+    NS_TEST_ASSERT_MSG_EQ(
+        discovererStats->GetDiscoveryTx(NrSlDiscoveryHeader::DISC_RESTRICTED_QUERY),
+        nQueries,
+        "Unexpected number of queries");
+    NS_TEST_ASSERT_MSG_EQ(
+        discovererStats->GetDiscoveryRx(NrSlDiscoveryHeader::DISC_RESTRICTED_RESPONSE),
+        nQueries * (m_nUes - 1),
+        "Unexpected number of responses");
+    NS_TEST_ASSERT_MSG_EQ(ues[0]->GetNDiscoveredPeers(g_appCode),
+                          m_nUes - 1,
+                          "The discoverer UE did not discover all the discoveree UEs");
+    for (uint32_t i = 1; i < m_nUes; ++i)
+    {
+        Ptr<NrSlProseStats> stats = ues[i]->GetProseStats();
+        NS_TEST_ASSERT_MSG_EQ(ues[0]->IsPeerDiscovered(g_appCode, i + 1),
+                              true,
+                              "UE " << i + 1 << " was not discovered");
+        NS_TEST_ASSERT_MSG_EQ(stats->GetDiscoveryRx(NrSlDiscoveryHeader::DISC_RESTRICTED_QUERY),
+                              nQueries,
+                              "Unexpected number of queries received by UE " << i + 1);
+        NS_TEST_ASSERT_MSG_EQ(stats->GetDiscoveryTx(NrSlDiscoveryHeader::DISC_RESTRICTED_RESPONSE),
+                              nQueries,
+                              "Unexpected number of responses sent by UE " << i + 1);
+        // The responses are sent to the discoverer UE only
+        NS_TEST_ASSERT_MSG_EQ(
+            stats->GetDiscoveryRx(NrSlDiscoveryHeader::DISC_RESTRICTED_RESPONSE),
+            0,
+            "UE " << i + 1 << " received a response sent to another UE");
+        NS_TEST_ASSERT_MSG_EQ(ues[i]->GetNDiscoveredPeers(g_appCode),
+                              0,
+                              "A discoveree UE should not discover any peer");
+    }
+
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup nr-prose-tests
+ *
+ * \brief Test the expiry of a discovered peer that stops announcing
+ */
+class NrSlUeProseDiscoveredPeerExpiryTestCase : public TestCase
+{
+  public:
+    NrSlUeProseDiscoveredPeerExpiryTestCase();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * \brief Trace sink of the changes of the discovered peer table
+     *
+     * \param selfL2Id the layer 2 ID of the UE
+     * \param appCode the application code
+     * \param peerL2Id the layer 2 ID of the peer
+     * \param appeared true if the peer was discovered, false if it expired
+     */
+    void DiscoveredPeer(uint32_t selfL2Id, uint32_t appCode, uint32_t peerL2Id, bool appeared);
+
+    Time m_appearedTime;    ///< Time the peer was discovered
+    Time m_disappearedTime; ///< Time the peer expired
+};
+
+NrSlUeProseDiscoveredPeerExpiryTestCase::NrSlUeProseDiscoveredPeerExpiryTestCase()
+    : TestCase("Expiry of a discovered peer")
+{
+}
+
+void
+NrSlUeProseDiscoveredPeerExpiryTestCase::DiscoveredPeer(uint32_t selfL2Id,
+                                                        uint32_t appCode,
+                                                        uint32_t peerL2Id,
+                                                        bool appeared)
+{
+    NS_LOG_FUNCTION(this << selfL2Id << appCode << peerL2Id << appeared);
+    if (appeared)
+    {
+        m_appearedTime = Simulator::Now();
+    }
+    else
+    {
+        m_disappearedTime = Simulator::Now();
+    }
+}
+
+void
+NrSlUeProseDiscoveredPeerExpiryTestCase::DoRun()
+{
+    Ptr<NrSlProseTestChannel> channel = CreateObject<NrSlProseTestChannel>();
+    Time delay = MilliSeconds(1);
+    channel->SetDelay(delay);
+    std::vector<Ptr<NrSlUeProse>> ues = CreateUes(channel, 2);
+    Time ttl = Seconds(3);
+    ues[1]->SetAttribute("DiscoveredPeerTtl", TimeValue(ttl));
+    ues[1]->TraceConnectWithoutContext(
+        "DiscoveredPeerTrace",
+        MakeCallback(&NrSlUeProseDiscoveredPeerExpiryTestCase::DiscoveredPeer, this));
+
+    ues[1]->AddDiscoveryApp(g_appCode, g_discoveryL2Id, NrSlUeProse::Monitoring);
+    ues[0]->AddDiscoveryApp(g_appCode, g_discoveryL2Id, NrSlUeProse::Announcing);
+    // The last announcement is sent at 4 s
+    Simulator::Schedule(Seconds(4.5),
+                        &NrSlUeProse::RemoveDiscoveryApp,
+                        ues[0],
+                        g_appCode,
+                        NrSlUeProse::Announcing);
+    Simulator::Stop(Seconds(10));
+    Simulator::Run();
+
+    NS_TEST_ASSERT_MSG_EQ(m_appearedTime, delay, "The peer was not discovered on time");
+    NS_TEST_ASSERT_MSG_EQ(m_disappearedTime,
+                          Seconds(4) + delay + ttl,
+                          "The peer did not expire on time");
+    NS_TEST_ASSERT_MSG_EQ(ues[1]->IsPeerDiscovered(g_appCode, 1),
+                          false,
+                          "The expired peer is still in the table");
+
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup nr-prose-tests
+ *
+ * \brief Test the automatic establishment of a direct link between two UEs
+ *        discovering each other
+ *
+ * Each UE announces its own application code and monitors the code of the
+ * other UE, with the automatic direct link enabled for it. When the UEs
+ * discover each other one after the other, the link initiated by the first UE
+ * is reused by the second one. When they discover each other at the same time,
+ * both UEs initiate the link and only the request of the UE with the lowest
+ * layer 2 ID completes.
+ */
+class NrSlUeProseAutoDirectLinkTestCase : public TestCase
+{
+  public:
+    /**
+     * \brief Constructor
+     *
+     * \param simultaneous true if the UEs discover each other at the same time
+     */
+    NrSlUeProseAutoDirectLinkTestCase(bool simultaneous);
+
+  private:
+    void DoRun() override;
+
+    bool m_simultaneous; ///< True if the UEs discover each other at the same time
+};
+
+NrSlUeProseAutoDirectLinkTestCase::NrSlUeProseAutoDirectLinkTestCase(bool simultaneous)
+    : TestCase(simultaneous ? "Automatic direct link with crossed establishment requests"
+                            : "Automatic direct link upon mutual discovery"),
+      m_simultaneous(simultaneous)
+{
+}
+
+void
+NrSlUeProseAutoDirectLinkTestCase::DoRun()
+{
+    Ptr<NrSlProseTestChannel> channel = CreateObject<NrSlProseTestChannel>();
+    std::vector<Ptr<NrSlUeProse>> ues = CreateUes(channel, 2);
+    InstallInternetStack(ues);
+    // UE 1 announces g_appCode and UE 2 announces g_appCode + 1
+    for (uint32_t i = 0; i < 2; ++i)
+    {
+        uint32_t peerL2Id = 2 - i;
+        uint32_t peerAppCode = g_appCode + peerL2Id - 1;
+        ues[i]->ConfigureUnicast();
+        ues[i]->EnableAutoDirectLink(peerAppCode, GetUnicastSlInfo(i + 1, peerL2Id));
+        ues[i]->AddDiscoveryApp(peerAppCode, g_discoveryL2Id, NrSlUeProse::Monitoring);
+    }
+    ues[0]->AddDiscoveryApp(g_appCode, g_discoveryL2Id, NrSlUeProse::Announcing);
+    // Otherwise, UE 2 discovers UE 1 and establishes the link before announcing
+    Simulator::Schedule(m_simultaneous ? Seconds(0) : MilliSeconds(500),
+                        &NrSlUeProse::AddDiscoveryApp,
+                        ues[1],
+                        g_appCode + 1,
+                        g_discoveryL2Id,
+                        NrSlUeProse::Announcing);
+    // Longer than T5080, so that a pending request would be retransmitted
+    Simulator::Stop(Seconds(10));
+    Simulator::Run();
+
+    uint8_t requestType = NrSlPc5SignallingMessageType::ProseDirectLinkEstablishmentRequest;
+    for (uint32_t i = 0; i < 2; ++i)
+    {
+        uint32_t peerL2Id = 2 - i;
+        Ptr<NrSlProseStats> stats = ues[i]->GetProseStats();
+        NS_TEST_ASSERT_MSG_EQ(ues[i]->IsPeerDiscovered(g_appCode + peerL2Id - 1, peerL2Id),
+                              true,
+                              "UE " << i + 1 << " did not discover its peer");
+        NS_TEST_ASSERT_MSG_EQ(ues[i]->GetNumDirectLinks(),
+                              1,
+                              "Unexpected number of links of UE " << i + 1);
+        NS_TEST_ASSERT_MSG_EQ(stats->GetLinkEstablishments(),
+                              1,
+                              "UE " << i + 1 << " did not establish the direct link once");
+        NS_TEST_ASSERT_MSG_EQ(stats->GetPc5SignallingRetransmissions(),
+                              0,
+                              "Unexpected retransmission by UE " << i + 1);
+        NS_TEST_ASSERT_MSG_EQ(channel->GetNasSapProvider(i + 1)->GetNActivatedBearers(),
+                              1,
+                              "UE " << i + 1 << " did not activate its data radio bearer once");
+    }
+    // UE 2 discovers UE 1 first and initiates the link
+    NS_TEST_ASSERT_MSG_EQ(ues[1]->GetProseStats()->GetPc5SignallingTx(requestType),
+                          1,
+                          "Unexpected number of establishment requests sent by UE 2");
+    NS_TEST_ASSERT_MSG_EQ(ues[0]->GetProseStats()->GetPc5SignallingTx(requestType),
+                          (m_simultaneous ? 1 : 0),
+                          "Unexpected number of establishment requests sent by UE 1");
+
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup nr-prose-tests
+ *
+ * \brief Test the duty cycle of the reception of discovery messages
+ *
+ * The monitoring UE listens during the first half second of every other
+ * second, and thus hears one announcement out of two, unless it has another
+ * receiving role without duty cycle. A transmit-only role does not keep the UE
+ * listening.
+ */
+class NrSlUeProseMonitoringDutyCycleTestCase : public TestCase
+{
+  public:
+    /**
+     * \brief Constructor
+     *
+     * \param otherRole the role of the monitoring UE for another application code
+     */
+    NrSlUeProseMonitoringDutyCycleTestCase(NrSlUeProse::DiscoveryRole otherRole);
+
+  private:
+    void DoRun() override;
+
+    NrSlUeProse::DiscoveryRole m_otherRole; ///< Role of the monitoring UE for another code
+};
+
+NrSlUeProseMonitoringDutyCycleTestCase::NrSlUeProseMonitoringDutyCycleTestCase(
+    NrSlUeProse::DiscoveryRole otherRole)
+    : TestCase(otherRole == NrSlUeProse::Announcing
+                   ? "Monitoring duty cycle with an announcing code"
+                   : "Monitoring duty cycle with a discoveree code"),
+      m_otherRole(otherRole)
+{
+}
+
+void
+NrSlUeProseMonitoringDutyCycleTestCase::DoRun()
+{
+    Ptr<NrSlProseTestChannel> channel = CreateObject<NrSlProseTestChannel>();
+    std::vector<Ptr<NrSlUeProse>> ues = CreateUes(channel, 2);
+
+    NrSlUeProse::MonitoringDutyCycle dutyCycle;
+    dutyCycle.window = MilliSeconds(500);
+    dutyCycle.period = Seconds(2);
+    ues[1]->SetMonitoringDutyCycle(NrSlUeProse::Monitoring, dutyCycle);
+    ues[1]->AddDiscoveryApp(g_appCode, g_discoveryL2Id, NrSlUeProse::Monitoring);
+    // Nobody else uses this code
+    ues[1]->AddDiscoveryApp(g_appCode + 1, g_discoveryL2Id + 1, m_otherRole);
+    ues[0]->AddDiscoveryApp(g_appCode, g_discoveryL2Id, NrSlUeProse::Announcing);
+
+    // One announcement per second
+    uint32_t nAnnouncements = 10;
+    Simulator::Stop(Seconds(nAnnouncements - 0.5));
+    Simulator::Run();
+
+    uint32_t expectedRx =
+        (m_otherRole == NrSlUeProse::Announcing ? nAnnouncements / 2 : nAnnouncements);
+    Ptr<NrSlProseStats> stats = ues[1]->GetProseStats();
+    NS_TEST_ASSERT_MSG_EQ(channel->GetNDiscoveryDelivered(),
+                          nAnnouncements,
+                          "Unexpected number of announcements delivered");
+    NS_TEST_ASSERT_MSG_EQ(stats->GetDiscoveryRx(),
+                          expectedRx,
+                          "Unexpected number of announcements received");
+    NS_TEST_ASSERT_MSG_EQ(stats->GetDiscoveryRxDropped(),
+                          nAnnouncements - expectedRx,
+                          "Unexpected number of announcements dropped");
+    NS_TEST_ASSERT_MSG_EQ(ues[1]->IsPeerDiscovered(g_appCode, 1),
+                          true,
+                          "The announcing UE was not discovered");
+
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup nr-prose-tests
+ *
+ * \brief Test the aggregation of the discovery messages towards the same
+ *        destination
+ *
+ * The announcing UE announces two application codes at the same time, which
+ * are transmitted in one packet if the maximum size allows it.
+ */
+class NrSlUeProseDiscoveryAggregationTestCase : public TestCase
+{
+  public:
+    /**
+     * \brief Constructor
+     *
+     * \param maxSize the maximum size of an aggregated discovery packet
+     * \param messagesPerPacket the expected number of messages per packet
+     */
+    NrSlUeProseDiscoveryAggregationTestCase(uint32_t maxSize, uint32_t messagesPerPacket);
+
+  private:
+    void DoRun() override;
+
+    uint32_t m_maxSize;           ///< Maximum size of an aggregated discovery packet
+    uint32_t m_messagesPerPacket; ///< Expected number of messages per packet
+};
+
+NrSlUeProseDiscoveryAggregationTestCase::NrSlUeProseDiscoveryAggregationTestCase(
+    uint32_t maxSize,
+    uint32_t messagesPerPacket)
+    : TestCase("Discovery aggregation with maximum size " + std::to_string(maxSize) + " bytes"),
+      m_maxSize(maxSize),
+      m_messagesPerPacket(messagesPerPacket)
+{
+}
+
+void
+NrSlUeProseDiscoveryAggregationTestCase::DoRun()
+{
+    Ptr<NrSlProseTestChannel> channel = CreateObject<NrSlProseTestChannel>();
+    std::vector<Ptr<NrSlUeProse>> ues = CreateUes(channel, 2);
+    ues[0]->SetAttribute("DiscoveryAggregationMaxSize", UintegerValue(m_maxSize));
+
+    uint32_t nCodes = 2;
+    for (uint32_t appCode = g_appCode; appCode < g_appCode + nCodes; ++appCode)
+    {
+        ues[1]->AddDiscoveryApp(appCode, g_discoveryL2Id, NrSlUeProse::Monitoring);
+    }
+    for (uint32_t appCode = g_appCode; appCode < g_appCode + nCodes; ++appCode)
+    {
+        ues[0]->AddDiscoveryApp(appCode, g_discoveryL2Id, NrSlUeProse::Announcing);
+    }
+
+    // One announcement per second and per code
+    uint32_t nAnnouncements = 10;
+    Simulator::Stop(Seconds(nAnnouncements - 0.5));
+    Simulator::Run();
+
+    uint32_t nPackets = nAnnouncements * nCodes / m_messagesPerPacket;
+    uint32_t nAggregated = (m_messagesPerPacket > 1 ? nPackets : 0);
+    Ptr<NrSlProseStats> txStats = ues[0]->GetProseStats();
+    Ptr<NrSlProseStats> rxStats = ues[1]->GetProseStats();
+    NS_TEST_ASSERT_MSG_EQ(channel->GetNDiscoveryDelivered(),
+                          nPackets,
+                          "Unexpected number of discovery packets");
+    NS_TEST_ASSERT_MSG_EQ(txStats->GetDiscoveryTx(),
+                          nAnnouncements * nCodes,
+                          "Unexpected number of announcements sent");
+    NS_TEST_ASSERT_MSG_EQ(txStats->GetDiscoveryAggregatedTx(),
+                          nAggregated,
+                          "Unexpected number of aggregated packets sent");
+    NS_TEST_ASSERT_MSG_EQ(rxStats->GetDiscoveryRx(),
+                          nAnnouncements * nCodes,
+                          "Unexpected number of announcements received");
+    NS_TEST_ASSERT_MSG_EQ(rxStats->GetDiscoveryAggregatedRx(),
+                          nAggregated,
+                          "Unexpected number of aggregated packets received");
+    for (uint32_t appCode = g_appCode; appCode < g_appCode + nCodes; ++appCode)
+    {
+        NS_TEST_ASSERT_MSG_EQ(ues[1]->IsPeerDiscovered(appCode, 1),
+                              true,
+                              "The announcing UE was not discovered for code " << appCode);
+    }
+
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup nr-prose-tests
+ *
+ * \brief Test the suppression of the duplicate discovery messages
+ *
+ * Two UEs announce the same application code every second. Within the
+ * duplicate window, the unchanged announcements of each UE are counted but not
+ * processed.
+ */
+class NrSlUeProseDiscoveryDuplicateTestCase : public TestCase
+{
+  public:
+    /**
+     * \brief Constructor
+     *
+     * \param window the duplicate window
+     * \param expectedDuplicates the expected number of duplicates per announcing UE
+     */
+    NrSlUeProseDiscoveryDuplicateTestCase(Time window, uint32_t expectedDuplicates);
+
+  private:
+    void DoRun() override;
+
+    Time m_window;                 ///< Duplicate window
+    uint32_t m_expectedDuplicates; ///< Expected number of duplicates per announcing UE
+};
+
+NrSlUeProseDiscoveryDuplicateTestCase::NrSlUeProseDiscoveryDuplicateTestCase(
+    Time window,
+    uint32_t expectedDuplicates)
+    : TestCase("Discovery duplicate window of " + std::to_string(window.GetSeconds()) + " s"),
+      m_window(window),
+      m_expectedDuplicates(expectedDuplicates)
+{
+}
+
+void
+NrSlUeProseDiscoveryDuplicateTestCase::DoRun()
+{
+    Ptr<NrSlProseTestChannel> channel = CreateObject<NrSlProseTestChannel>();
+    std::vector<Ptr<NrSlUeProse>> ues = CreateUes(channel, 3);
+    ues[2]->SetAttribute("DiscoveryDuplicateWindow", TimeValue(m_window));
+    ues[2]->AddDiscoveryApp(g_appCode, g_discoveryL2Id, NrSlUeProse::Monitoring);
+    ues[0]->AddDiscoveryApp(g_appCode, g_discoveryL2Id, NrSlUeProse::Announcing);
+    ues[1]->AddDiscoveryApp(g_appCode, g_discoveryL2Id, NrSlUeProse::Announcing);
+
+    // One announcement per second
+    uint32_t nAnnouncements = 10;
+    Simulator::Stop(Seconds(nAnnouncements - 0.5));
+    Simulator::Run();
+
+    Ptr<NrSlProseStats> stats = ues[2]->GetProseStats();
+    NS_TEST_ASSERT_MSG_EQ(stats->GetDiscoveryRx(),
+                          2 * nAnnouncements,
+                          "Unexpected number of announcements received");
+    NS_TEST_ASSERT_MSG_EQ(stats->GetDiscoveryRxDuplicates(),
+                          2 * m_expectedDuplicates,
+                          "Unexpected number of duplicates");
+    // The suppressed announcements keep the peers in the table
+    NS_TEST_ASSERT_MSG_EQ(ues[2]->GetNDiscoveredPeers(g_appCode),
+                          2,
+                          "The announcing UEs were not discovered");
+
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup nr-prose-tests
+ *
+ * \brief Test the responses of a Model B relay UE to the solicitations of
+ *        several remote UEs
+ *
+ * Without aggregation, the relay UE responds to each solicitation. With
+ * aggregation, it responds once per discovery interval to the destination of
+ * the relay code, which all the remote UEs monitor.
+ */
+class NrSlUeProseRelayResponseAggregationTestCase : public TestCase
+{
+  public:
+    /**
+     * \brief Constructor
+     *
+     * \param nRemoteUes the number of remote UEs
+     * \param aggregation true to aggregate the relay responses
+     */
+    NrSlUeProseRelayResponseAggregationTestCase(uint32_t nRemoteUes, bool aggregation);
+
+  private:
+    void DoRun() override;
+
+    uint32_t m_nRemoteUes; ///< Number of remote UEs
+    bool m_aggregation;    ///< True to aggregate the relay responses
+};
+
+NrSlUeProseRelayResponseAggregationTestCase::NrSlUeProseRelayResponseAggregationTestCase(
+    uint32_t nRemoteUes,
+    bool aggregation)
+    : TestCase("Relay responses to " + std::to_string(nRemoteUes) + " remote UEs" +
+               (aggregation ? " with aggregation" : "")),
+      m_nRemoteUes(nRemoteUes),
+      m_aggregation(aggregation)
+{
+}
+
+void
+NrSlUeProseRelayResponseAggregationTestCase::DoRun()
+{
+    Ptr<NrSlProseTestChannel> channel = CreateObject<NrSlProseTestChannel>();
+    std::vector<Ptr<NrSlUeProse>> ues = CreateUes(channel, m_nRemoteUes + 1);
+    ues[0]->SetAttribute("RelayResponseAggregation", BooleanValue(m_aggregation));
+    ues[0]->AddRelayDiscovery(g_relayCode,
+                              g_discoveryL2Id,
+                              NrSlUeProse::ModelB,
+                              NrSlUeProse::RelayUE);
+    for (uint32_t i = 1; i <= m_nRemoteUes; ++i)
+    {
+        ues[i]->AddRelayDiscovery(g_relayCode,
+                                  g_discoveryL2Id,
+                                  NrSlUeProse::ModelB,
+                                  NrSlUeProse::RemoteUE);
+    }
+
+    // One solicitation per second and per remote UE
+    uint32_t nSolicitations = 10;
+    Simulator::Stop(Seconds(nSolicitations - 0.5));
+    Simulator::Run();
+
+    Ptr<NrSlProseStats> relayStats = ues[0]->GetProseStats();
+    NS_TEST_ASSERT_MSG_EQ(
+        relayStats->GetDiscoveryRx(NrSlDiscoveryHeader::DISC_RELAY_SOLICITATION),
+        nSolicitations * m_nRemoteUes,
+        "Unexpected number of solicitations");
+    NS_TEST_ASSERT_MSG_EQ(relayStats->GetDiscoveryTx(NrSlDiscoveryHeader::DISC_RELAY_RESPONSE),
+                          (m_aggregation ? nSolicitations : nSolicitations * m_nRemoteUes),
+                          "Unexpected number of responses");
+    for (uint32_t i = 1; i <= m_nRemoteUes; ++i)
+    {
+        NS_TEST_ASSERT_MSG_EQ(
+            ues[i]->GetProseStats()->GetDiscoveryRx(NrSlDiscoveryHeader::DISC_RELAY_RESPONSE),
+            nSolicitations,
+            "Unexpected number of responses received by UE " << i + 1);
+        std::vector<NrSlUeProse::RelayInfo> relays = ues[i]->GetDiscoveredRelaysList();
+        NS_TEST_ASSERT_MSG_EQ(relays.size(), 1, "UE " << i + 1 << " did not discover the relay");
+        NS_TEST_ASSERT_MSG_EQ(relays.front().l2Id,
+                              1,
+                              "UE " << i + 1 << " discovered a wrong relay");
+    }
+
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup nr-prose-tests
+ *
+ * \brief Test the table of the members discovered for a group
+ *
+ * In Model A, all the UEs but the last one announce themselves, and the last
+ * one only monitors. In Model B, the first UE solicits the other members.
+ */
+class NrSlUeProseGroupMemberDiscoveryTestCase : public TestCase
+{
+  public:
+    /**
+     * \brief Constructor
+     *
+     * \param model the discovery model
+     * \param nUes the number of members of the group
+     */
+    NrSlUeProseGroupMemberDiscoveryTestCase(NrSlUeProse::DiscoveryModel model, uint32_t nUes);
+
+  private:
+    void DoRun() override;
+
+    NrSlUeProse::DiscoveryModel m_model; ///< Discovery model
+    uint32_t m_nUes;                     ///< Number of members of the group
+};
+
+NrSlUeProseGroupMemberDiscoveryTestCase::NrSlUeProseGroupMemberDiscoveryTestCase(
+    NrSlUeProse::DiscoveryModel model,
+    uint32_t nUes)
+    : TestCase(std::string("Group member discovery ") +
+               (model == NrSlUeProse::ModelA ? "Model A" : "Model B") + " with " +
+               std::to_string(nUes) + " UEs"),
+      m_model(model),
+      m_nUes(nUes)
+{
+}
+
+void
+NrSlUeProseGroupMemberDiscoveryTestCase::DoRun()
+{
+    Ptr<NrSlProseTestChannel> channel = CreateObject<NrSlProseTestChannel>();
+    std::vector<Ptr<NrSlUeProse>> ues = CreateUes(channel, m_nUes);
+
+    // The members transmitting first are heard from the second interval on
+    for (uint32_t i = 0; i < m_nUes; ++i)
+    {
+        NrSlUeProse::DiscoveryRole role;
+        if (m_model == NrSlUeProse::ModelA)
+        {
+            role = (i < m_nUes - 1 ? NrSlUeProse::Announcing : NrSlUeProse::Monitoring);
+        }
+        else
+        {
+            role = (i == 0 ? NrSlUeProse::Discoverer : NrSlUeProse::Discoveree);
+        }
+        ues[i]->AddGroupDiscovery(g_groupId, g_discoveryL2Id, m_model, role);
+    }
+    Simulator::Stop(Seconds(2.5));
+    Simulator::Run();
+
+    for (uint32_t i = 0; i < m_nUes; ++i)
+    {
+        uint32_t expectedMembers;
+        if (m_model == NrSlUeProse::ModelA)
+        {
+            // The monitoring member is not discovered
+            expectedMembers = (i < m_nUes - 1 ? m_nUes - 2 : m_nUes - 1);
+        }
+        else
+        {
+            // Only the discoverer member learns the members from their responses
+            expectedMembers = (i == 0 ? m_nUes - 1 : 0);
+        }
+        NS_TEST_ASSERT_MSG_EQ(ues[i]->GetNGroupMembers(g_groupId),
+                              expectedMembers,
+                              "Unexpected number of members discovered by UE " << i + 1);
+        NS_TEST_ASSERT_MSG_EQ(ues[i]->IsGroupMemberDiscovered(g_groupId, i + 1),
+                              false,
+                              "UE " << i + 1 << " discovered itself");
+    }
+    if (m_model == NrSlUeProse::ModelA)
+    {
+        NS_TEST_ASSERT_MSG_EQ(ues[0]->IsGroupMemberDiscovered(g_groupId, m_nUes),
+                              false,
+                              "The monitoring member was discovered");
+    }
+
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup nr-prose-tests
+ *
+ * \brief Test the redirection of a remote UE by a relay UE that cannot accept it
+ *
+ * Relays UEs 1, 2 and 3 announce the same relay service in Model A, and the
+ * remote UE 4 selects the relay with the highest RSRP. Relay UE 1 accepts no
+ * remote UE, so it rejects the establishment request of the remote UE with
+ * cause #13 (congestion situation), before configuring any bearer, and
+ * suggests relay UE 3, which has the highest RSRP among its neighbour relays.
+ * The remote UE then selects relay UE 3 instead of relay UE 2, which has a
+ * higher RSRP at the remote UE. The test stops once relay UE 3 is selected.
+ */
+class NrSlUeProseRelayRedirectionTestCase : public TestCase
+{
+  public:
+    /**
+     * \brief Constructor
+     */
+    NrSlUeProseRelayRedirectionTestCase();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * \brief Trace sink of the relay selections of the remote UE
+     *
+     * \param remoteL2Id the layer 2 ID of the remote UE
+     * \param currentRelayL2Id the layer 2 ID of the relay UE selected before
+     * \param newRelayL2Id the layer 2 ID of the selected relay UE
+     * \param relayCode the relay service code
+     * \param rsrp the RSRP of the selected relay UE
+     */
+    void RelaySelectionTrace(uint32_t remoteL2Id,
+                             uint32_t currentRelayL2Id,
+                             uint32_t newRelayL2Id,
+                             uint32_t relayCode,
+                             double rsrp);
+
+    /**
+     * \brief Trace sink of the redirections of the relay UEs
+     *
+     * \param relayL2Id the layer 2 ID of the relay UE
+     * \param remoteL2Id the layer 2 ID of the redirected remote UE
+     * \param alternativeRelayL2Id the layer 2 ID of the suggested relay UE
+     */
+    void RelayRedirectionTrace(uint32_t relayL2Id,
+                               uint32_t remoteL2Id,
+                               uint32_t alternativeRelayL2Id);
+
+    std::vector<uint32_t> m_selectedRelays; ///< Relay UEs selected by the remote UE
+    std::vector<uint32_t> m_alternativeRelays; ///< Relay UEs suggested by relay UE 1
+};
+
+NrSlUeProseRelayRedirectionTestCase::NrSlUeProseRelayRedirectionTestCase()
+    : TestCase("Relay UE rejecting a remote UE with an alternative relay UE")
+{
+}
+
+void
+NrSlUeProseRelayRedirectionTestCase::RelaySelectionTrace(uint32_t remoteL2Id,
+                                                         uint32_t currentRelayL2Id,
+                                                         uint32_t newRelayL2Id,
+                                                         uint32_t relayCode,
+                                                         double rsrp)
+{
+    NS_LOG_FUNCTION(this << remoteL2Id << currentRelayL2Id << newRelayL2Id << relayCode << rsrp);
+    m_selectedRelays.push_back(newRelayL2Id);
+    if (newRelayL2Id == 3)
+    {
+        // Relay UE 3 would accept the remote UE and configure the EPC
+        Simulator::Stop();
+    }
+}
+
+void
+NrSlUeProseRelayRedirectionTestCase::RelayRedirectionTrace(uint32_t relayL2Id,
+                                                           uint32_t remoteL2Id,
+                                                           uint32_t alternativeRelayL2Id)
+{
+    NS_LOG_FUNCTION(this << relayL2Id << remoteL2Id << alternativeRelayL2Id);
+    m_alternativeRelays.push_back(alternativeRelayL2Id);
+}
+
+void
+NrSlUeProseRelayRedirectionTestCase::DoRun()
+{
+    Ptr<NrSlProseTestChannel> channel = CreateObject<NrSlProseTestChannel>();
+    std::vector<Ptr<NrSlUeProse>> ues = CreateUes(channel, 4);
+    InstallInternetStack(ues);
+    for (uint32_t i = 0; i < 4; ++i)
+    {
+        ues[i]->ConfigureUnicast();
+        ues[i]->AddRelayDiscovery(g_relayCode,
+                                  g_discoveryL2Id,
+                                  NrSlUeProse::ModelA,
+                                  (i < 3 ? NrSlUeProse::RelayUE : NrSlUeProse::RemoteUE));
+    }
+    ues[0]->SetAttribute("RelayMaxRemoteUes", UintegerValue(0));
+    ues[0]->TraceConnectWithoutContext(
+        "RelayRedirectionTrace",
+        MakeCallback(&NrSlUeProseRelayRedirectionTestCase::RelayRedirectionTrace, this));
+    ues[3]->TraceConnectWithoutContext(
+        "RelaySelectionTrace",
+        MakeCallback(&NrSlUeProseRelayRedirectionTestCase::RelaySelectionTrace, this));
+
+    // Relay UE 2 is the best alternative for the remote UE, relay UE 3 for relay UE 1
+    ues[3]->GetNrSlUeSvcRrcSapUser()->ReceiveNrSlRsrpMeasurements(1, -70.0, true);
+    ues[3]->GetNrSlUeSvcRrcSapUser()->ReceiveNrSlRsrpMeasurements(2, -80.0, true);
+    ues[3]->GetNrSlUeSvcRrcSapUser()->ReceiveNrSlRsrpMeasurements(3, -90.0, true);
+    ues[0]->GetNrSlUeSvcRrcSapUser()->ReceiveNrSlRsrpMeasurements(2, -100.0, true);
+    ues[0]->GetNrSlUeSvcRrcSapUser()->ReceiveNrSlRsrpMeasurements(3, -60.0, true);
+
+    // Select a relay once the three relays were discovered
+    Simulator::Schedule(Seconds(2.5),
+                        &NrSlUeProse::SetRelaySelectionAlgorithm,
+                        ues[3],
+                        CreateObject<NrSlUeProseRelaySelectionAlgorithmMaxRsrp>());
+    Simulator::Stop(Seconds(5));
+    Simulator::Run();
+
+    NS_TEST_ASSERT_MSG_EQ(m_selectedRelays.size(), 2, "Unexpected number of relay selections");
+    NS_TEST_ASSERT_MSG_EQ(m_selectedRelays.front(), 1, "The remote UE did not select relay UE 1");
+    NS_TEST_ASSERT_MSG_EQ(m_selectedRelays.back(),
+                          3,
+                          "The remote UE did not select the relay UE suggested by relay UE 1");
+    NS_TEST_ASSERT_MSG_EQ(m_alternativeRelays.size(), 1, "Relay UE 1 did not redirect the remote");
+    NS_TEST_ASSERT_MSG_EQ(m_alternativeRelays.front(), 3, "Relay UE 1 suggested a wrong relay");
+
+    Ptr<NrSlProseStats> relayStats = ues[0]->GetProseStats();
+    uint8_t rejectType = NrSlPc5SignallingMessageType::ProseDirectLinkEstablishmentReject;
+    NS_TEST_ASSERT_MSG_EQ(relayStats->GetPc5SignallingTx(rejectType),
+                          1,
+                          "Relay UE 1 did not reject the establishment request");
+    NS_TEST_ASSERT_MSG_EQ(relayStats->GetLinkEstablishments(),
+                          0,
+                          "Relay UE 1 established a link with the remote UE");
+    NS_TEST_ASSERT_MSG_EQ(ues[3]->GetProseStats()->GetLinkEstablishmentFailures(),
+                          1,
+                          "The remote UE did not receive the reject");
+
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup nr-prose-tests
+ *
+ * \brief Test the delivery of the discovery messages by a discovery oracle
+ *
+ * Relay UE 1 announces its relay service in Model A to the remote UEs 2 to 5
+ * through a NrSlDiscoveryOracle whose grid cells are 150 m wide. The losses
+ * are set per pair of UEs with a MatrixPropagationLossModel, so that the RSRP
+ * does not depend on the distance:
+ * - UE 2, 20 m away in the neighbouring cell, has an RSRP of -80 dBm and
+ *   discovers an eligible relay,
+ * - UE 3, 40 m away, has an RSRP of -115 dBm, between MinRsrp and
+ *   RelayRsrpThreshold, and discovers a relay that is not eligible,
+ * - UE 4, 90 m away, has an RSRP of -125 dBm, below MinRsrp, and does not
+ *   receive the announcements,
+ * - UE 5 has an RSRP of -80 dBm but is 155 m away, in the neighbouring cell
+ *   but beyond MaxRange, until it moves 60 m away at 5 s, and then discovers
+ *   an eligible relay.
+ * The remote UEs have a relay selection algorithm, for their RSRP to be
+ * recorded, and the PC5 signalling of the test channel is delayed beyond the
+ * end of the test, so that their relay selections do not lead to direct links.
+ */
+class NrSlUeProseDiscoveryOracleTestCase : public TestCase
+{
+  public:
+    /**
+     * \brief Constructor
+     */
+    NrSlUeProseDiscoveryOracleTestCase();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * \brief Trace sink of the relay discoveries of the remote UEs
+     *
+     * \param remoteL2Id the layer 2 ID of the remote UE
+     * \param relayL2Id the layer 2 ID of the discovered relay UE
+     * \param relayCode the relay service code
+     * \param rsrp the RSRP of the relay UE
+     */
+    void RelayDiscoveryTrace(uint32_t remoteL2Id,
+                             uint32_t relayL2Id,
+                             uint32_t relayCode,
+                             double rsrp);
+
+    std::map<uint32_t, Time> m_firstDiscovery; ///< First relay discovery of each remote UE
+};
+
+NrSlUeProseDiscoveryOracleTestCase::NrSlUeProseDiscoveryOracleTestCase()
+    : TestCase("Discovery oracle delivery, RSRP thresholds and grid cells")
+{
+}
+
+void
+NrSlUeProseDiscoveryOracleTestCase::RelayDiscoveryTrace(uint32_t remoteL2Id,
+                                                        uint32_t relayL2Id,
+                                                        uint32_t relayCode,
+                                                        double rsrp)
+{
+    NS_LOG_FUNCTION(this << remoteL2Id << relayL2Id << relayCode << rsrp);
+    m_firstDiscovery.emplace(remoteL2Id, Simulator::Now());
+}
+
+void
+NrSlUeProseDiscoveryOracleTestCase::DoRun()
+{
+    Ptr<NrSlProseTestChannel> channel = CreateObject<NrSlProseTestChannel>();
+    channel->SetDelay(Seconds(100));
+    std::vector<Ptr<NrSlUeProse>> ues = CreateUes(channel, 5);
+    std::vector<Ptr<Node>> nodes = InstallInternetStack(ues);
+
+    // Positions along x, the relay UE being in the cell [0, 150) m
+    std::vector<double> positions = {140.0, 160.0, 100.0, 50.0, 295.0};
+    std::vector<double> rsrps = {0.0, -80.0, -115.0, -125.0, -80.0};
+    std::vector<Ptr<MobilityModel>> mobility;
+    for (uint32_t i = 0; i < nodes.size(); ++i)
+    {
+        Ptr<ConstantPositionMobilityModel> mm = CreateObject<ConstantPositionMobilityModel>();
+        mm->SetPosition(Vector(positions[i], 0.0, 1.5));
+        nodes[i]->AggregateObject(mm);
+        mobility.push_back(mm);
+    }
+
+    double txPower = 23.0;
+    double reOffset = 10 * std::log10(12.0 * 52);
+    Ptr<MatrixPropagationLossModel> loss = CreateObject<MatrixPropagationLossModel>();
+    for (uint32_t i = 1; i < nodes.size(); ++i)
+    {
+        loss->SetLoss(mobility[0], mobility[i], txPower - reOffset - rsrps[i]);
+    }
+    Ptr<NrSlDiscoveryOracle> oracle = CreateObject<NrSlDiscoveryOracle>();
+    oracle->SetAttribute("PropagationLossModel", PointerValue(loss));
+    oracle->SetAttribute("TxPower", DoubleValue(txPower));
+    oracle->SetAttribute("NumRbs", UintegerValue(52));
+    oracle->SetAttribute("MinRsrp", DoubleValue(-120.0));
+    oracle->SetAttribute("RelayRsrpThreshold", DoubleValue(-110.0));
+    oracle->SetAttribute("MaxRange", DoubleValue(150.0));
+
+    for (uint32_t i = 0; i < ues.size(); ++i)
+    {
+        oracle->AddUe(ues[i], nodes[i]);
+        ues[i]->SetDiscoveryOracle(oracle);
+        ues[i]->ConfigureUnicast();
+        ues[i]->AddRelayDiscovery(g_relayCode,
+                                  g_discoveryL2Id,
+                                  NrSlUeProse::ModelA,
+                                  (i == 0 ? NrSlUeProse::RelayUE : NrSlUeProse::RemoteUE));
+        if (i > 0)
+        {
+            ues[i]->SetRelaySelectionAlgorithm(
+                CreateObject<NrSlUeProseRelaySelectionAlgorithmMaxRsrp>());
+            ues[i]->TraceConnectWithoutContext(
+                "RelayDiscoveryTrace",
+                MakeCallback(&NrSlUeProseDiscoveryOracleTestCase::RelayDiscoveryTrace, this));
+        }
+    }
+
+    Ptr<ConstantPositionMobilityModel> movingUe =
+        DynamicCast<ConstantPositionMobilityModel>(mobility[4]);
+    Simulator::Schedule(Seconds(5),
+                        &ConstantPositionMobilityModel::SetPosition,
+                        movingUe,
+                        Vector(200.0, 0.0, 1.5));
+    Simulator::Stop(Seconds(9.5));
+    Simulator::Run();
+
+    NS_TEST_ASSERT_MSG_EQ(channel->GetNDiscoveryDelivered(),
+                          0,
+                          "Discovery message sent through the test channel");
+    NS_TEST_ASSERT_MSG_GT(oracle->GetTransmissions(), 0, "The relay UE did not announce");
+    uint64_t nRx = 0;
+    for (uint32_t i = 1; i < ues.size(); ++i)
+    {
+        nRx += ues[i]->GetProseStats()->GetDiscoveryRx();
+    }
+    NS_TEST_ASSERT_MSG_EQ(oracle->GetReceptions(), nRx, "Unexpected number of receptions");
+
+    // UEs 2 and 3, in range and above MinRsrp
+    for (uint32_t i = 1; i <= 2; ++i)
+    {
+        std::vector<NrSlUeProse::RelayInfo> relays = ues[i]->GetDiscoveredRelaysList();
+        NS_TEST_ASSERT_MSG_EQ(relays.size(), 1, "UE " << i + 1 << " did not discover the relay");
+        NS_TEST_ASSERT_MSG_EQ(relays.front().l2Id,
+                              1,
+                              "UE " << i + 1 << " discovered a wrong relay");
+        NS_TEST_ASSERT_MSG_EQ_TOL(relays.front().rsrp,
+                                  rsrps[i],
+                                  1e-6,
+                                  "Unexpected RSRP at UE " << i + 1);
+        NS_TEST_ASSERT_MSG_EQ(relays.front().eligible,
+                              (i == 1),
+                              "Unexpected relay eligibility at UE " << i + 1);
+    }
+
+    // UE 4, below MinRsrp
+    NS_TEST_ASSERT_MSG_EQ(ues[3]->GetProseStats()->GetDiscoveryRx(),
+                          0,
+                          "UE 4 received a message below MinRsrp");
+    NS_TEST_ASSERT_MSG_EQ(ues[3]->GetDiscoveredRelaysList().size(),
+                          0,
+                          "UE 4 discovered a relay below MinRsrp");
+
+    // UE 5, only once in range
+    std::vector<NrSlUeProse::RelayInfo> relays = ues[4]->GetDiscoveredRelaysList();
+    NS_TEST_ASSERT_MSG_EQ(relays.size(), 1, "UE 5 did not discover the relay after moving");
+    NS_TEST_ASSERT_MSG_EQ(relays.front().eligible, true, "UE 5 discovered a relay not eligible");
+    NS_TEST_ASSERT_MSG_EQ((m_firstDiscovery.find(5) != m_firstDiscovery.end()),
+                          true,
+                          "UE 5 did not trace the discovery of the relay");
+    NS_TEST_ASSERT_MSG_GT_OR_EQ(m_firstDiscovery[5],
+                                Seconds(5),
+                                "UE 5 discovered the relay beyond MaxRange");
+
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup nr-prose-tests
+ *
+ * \brief Test the latency of each hop of the packets relayed by a UE-to-UE relay
+ *
+ * UE 1 connects to UE 3 through the UE-to-UE relay UE 2, announced in Model
+ * A. The relay UE signals UE 1 to UE 3 in the establishment request of the
+ * second hop, either on a new direct link or, if UE 2 and UE 3 already have
+ * one, on the existing link. The IP packets go through the SimpleChannel of
+ * the UEs, with host routes through the relay UE in place of the SL-DRBs.
+ * After a first exchange resolving the MAC addresses, each end UE sends one
+ * packet to the other one, and the relay UE and the receiving end UE measure
+ * the delay of the channel on each hop.
+ */
+class NrSlUeProseU2uRelayTestCase : public TestCase
+{
+  public:
+    /**
+     * \brief Constructor
+     *
+     * \param existingLink true if the relay UE and UE 3 already have a direct link
+     */
+    NrSlUeProseU2uRelayTestCase(bool existingLink);
+
+  private:
+    void DoRun() override;
+
+    /// A hop latency measured by a UE
+    struct HopLatency
+    {
+        uint32_t selfL2Id; ///< Layer 2 ID of the UE measuring the latency
+        Ipv4Address src;   ///< Source address of the packet
+        uint8_t hop;       ///< Hop completed by the packet
+        Time hopDelay;     ///< Latency of the hop
+        Time e2eDelay;     ///< Latency from the source end UE
+    };
+
+    /**
+     * \brief Trace sink of the hop latencies
+     *
+     * \param selfL2Id the layer 2 ID of the UE
+     * \param src the source address of the packet
+     * \param dst the destination address of the packet
+     * \param hop the hop completed by the packet
+     * \param hopDelay the latency of the hop
+     * \param e2eDelay the latency from the source end UE
+     */
+    void HopLatencyTrace(uint32_t selfL2Id,
+                         Ipv4Address src,
+                         Ipv4Address dst,
+                         uint8_t hop,
+                         Time hopDelay,
+                         Time e2eDelay);
+
+    bool m_existingLink;                ///< True if UE 2 and UE 3 already have a direct link
+    std::vector<HopLatency> m_measured; ///< Latencies of the packets sent after the first exchange
+    Time m_measureStart;                ///< Time the packets of interest are sent
+};
+
+NrSlUeProseU2uRelayTestCase::NrSlUeProseU2uRelayTestCase(bool existingLink)
+    : TestCase(existingLink ? "UE-to-UE relay hop latency over an existing direct link"
+                            : "UE-to-UE relay hop latency"),
+      m_existingLink(existingLink)
+{
+}
+
+void
+NrSlUeProseU2uRelayTestCase::HopLatencyTrace(uint32_t selfL2Id,
+                                             Ipv4Address src,
+                                             Ipv4Address dst,
+                                             uint8_t hop,
+                                             Time hopDelay,
+                                             Time e2eDelay)
+{
+    NS_LOG_FUNCTION(this << selfL2Id << src << dst << +hop << hopDelay << e2eDelay);
+    if (Simulator::Now() >= m_measureStart)
+    {
+        m_measured.push_back({selfL2Id, src, hop, hopDelay, e2eDelay});
+    }
+}
+
+void
+NrSlUeProseU2uRelayTestCase::DoRun()
+{
+    Ptr<NrSlProseTestChannel> channel = CreateObject<NrSlProseTestChannel>();
+    std::vector<Ptr<NrSlUeProse>> ues = CreateUes(channel, 3);
+    Time delay = MilliSeconds(5);
+    std::vector<Ptr<Node>> nodes = InstallInternetStack(ues, delay);
+    for (uint32_t i = 0; i < 3; ++i)
+    {
+        ues[i]->ConfigureUnicast();
+        ues[i]->AddU2uRelayDiscovery(g_relayCode,
+                                     g_discoveryL2Id,
+                                     NrSlUeProse::ModelA,
+                                     (i == 1 ? NrSlUeProse::RelayUE : NrSlUeProse::RemoteUE));
+        ues[i]->TraceConnectWithoutContext(
+            "U2uHopLatencyTrace",
+            MakeCallback(&NrSlUeProseU2uRelayTestCase::HopLatencyTrace, this));
+    }
+    if (m_existingLink)
+    {
+        Simulator::Schedule(MilliSeconds(100),
+                            &NrSlUeProse::AddDirectLinkConnection,
+                            ues[1],
+                            2,
+                            Ipv4Address("10.0.0.2"),
+                            3,
+                            true,
+                            0,
+                            GetUnicastSlInfo(2, 3));
+    }
+    // After the first announcement of the relay UE
+    Simulator::Schedule(Seconds(1.5),
+                        &NrSlUeProse::ConnectToU2uTarget,
+                        ues[0],
+                        3,
+                        Ipv4Address("10.0.0.3"),
+                        GetUnicastSlInfo(1, 3));
+
+    // The end UEs reach each other through the relay UE
+    Ipv4StaticRoutingHelper routingHelper;
+    routingHelper.GetStaticRouting(nodes[0]->GetObject<Ipv4>())
+        ->AddHostRouteTo(Ipv4Address("10.0.0.3"), Ipv4Address("10.0.0.2"), 1);
+    routingHelper.GetStaticRouting(nodes[2]->GetObject<Ipv4>())
+        ->AddHostRouteTo(Ipv4Address("10.0.0.1"), Ipv4Address("10.0.0.2"), 1);
+    uint16_t port = 9;
+    std::vector<Ptr<Socket>> sockets;
+    for (uint32_t i : {0, 2})
+    {
+        Ptr<Socket> socket = Socket::CreateSocket(nodes[i], UdpSocketFactory::GetTypeId());
+        socket->Bind(InetSocketAddress(Ipv4Address::GetAny(), port));
+        sockets.push_back(socket);
+    }
+    m_measureStart = Seconds(4);
+    for (Time sendTime : {Seconds(3), m_measureStart})
+    {
+        Simulator::Schedule(sendTime, &SendPacket, sockets[0], Ipv4Address("10.0.0.3"), port);
+        Simulator::Schedule(sendTime, &SendPacket, sockets[1], Ipv4Address("10.0.0.1"), port);
+    }
+    Simulator::Stop(Seconds(5));
+    Simulator::Run();
+
+    uint8_t requestType = NrSlPc5SignallingMessageType::ProseDirectLinkEstablishmentRequest;
+    NS_TEST_ASSERT_MSG_EQ(ues[1]->GetNumDirectLinks(), 2, "Unexpected number of links of UE 2");
+    NS_TEST_ASSERT_MSG_EQ(ues[2]->GetNumDirectLinks(), 1, "Unexpected number of links of UE 3");
+    // The relay UE signals the source end UE even on the existing link
+    NS_TEST_ASSERT_MSG_EQ(ues[1]->GetProseStats()->GetPc5SignallingTx(requestType),
+                          (m_existingLink ? 2 : 1),
+                          "Unexpected number of establishment requests sent by UE 2");
+    // On the existing link, UE 3 adds the SL-DRB towards UE 1 to the one towards UE 2
+    NS_TEST_ASSERT_MSG_EQ(channel->GetNasSapProvider(3)->GetNActivatedBearers(),
+                          (m_existingLink ? 2 : 1),
+                          "Unexpected number of data radio bearers activated by UE 3");
+
+    // One measurement by the relay UE and one by the destination, per direction
+    NS_TEST_ASSERT_MSG_EQ(m_measured.size(), 4, "Unexpected number of hop latencies");
+    for (const auto& latency : m_measured)
+    {
+        bool atRelay = latency.selfL2Id == 2;
+        NS_TEST_ASSERT_MSG_EQ(+latency.hop,
+                              (atRelay ? 1 : 2),
+                              "Unexpected hop measured by UE " << latency.selfL2Id);
+        NS_TEST_ASSERT_MSG_EQ(latency.hopDelay,
+                              delay,
+                              "Unexpected hop latency measured by UE " << latency.selfL2Id);
+        NS_TEST_ASSERT_MSG_EQ(latency.e2eDelay,
+                              (atRelay ? delay : delay + delay),
+                              "Unexpected end-to-end latency measured by UE "
+                                  << latency.selfL2Id);
+        if (!atRelay)
+        {
+            NS_TEST_ASSERT_MSG_EQ(latency.src,
+                                  Ipv4Address(latency.selfL2Id == 1 ? "10.0.0.3" : "10.0.0.1"),
+                                  "Unexpected source of the packet received by UE "
+                                      << latency.selfL2Id);
+        }
+    }
+
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup nr-prose-tests
+ *
+ * \brief Test suite of the ProSe protocols over the test channel
+ */
+class NrSlUeProseTestSuite : public TestSuite
+{
+  public:
+    NrSlUeProseTestSuite();
+};
+
+NrSlUeProseTestSuite::NrSlUeProseTestSuite()
+    : TestSuite("nr-sl-ue-prose", TestSuite::UNIT)
+{
+    // With the default T5080 of 8 s, the requests at 0 and 8 s are lost
+    // during the first 10 s, and the requests at 0, 8 and 16 s during the first 20 s
+    AddTestCase(new NrSlUeProseDirectLinkEstablishmentTestCase(Seconds(0), 0), TestCase::QUICK);
+    AddTestCase(new NrSlUeProseDirectLinkEstablishmentTestCase(Seconds(10), 2), TestCase::QUICK);
+    AddTestCase(new NrSlUeProseDirectLinkEstablishmentTestCase(Seconds(20), 3), TestCase::QUICK);
+    AddTestCase(new NrSlUeProseDirectLinkFailureTestCase(), TestCase::QUICK);
+    AddTestCase(new NrSlUeProseDirectLinkReleaseTestCase(false), TestCase::QUICK);
+    AddTestCase(new NrSlUeProseDirectLinkReleaseTestCase(true), TestCase::QUICK);
+    AddTestCase(new NrSlUeProseUnicastTestCase(false), TestCase::QUICK);
+    AddTestCase(new NrSlUeProseUnicastTestCase(true), TestCase::QUICK);
+    AddTestCase(new NrSlUeProseOpenDiscoveryTestCase(2, 0.0), TestCase::QUICK);
+    AddTestCase(new NrSlUeProseOpenDiscoveryTestCase(10, 0.0), TestCase::QUICK);
+    AddTestCase(new NrSlUeProseOpenDiscoveryTestCase(10, 0.5), TestCase::QUICK);
+    AddTestCase(new NrSlUeProseOpenDiscoveryTestCase(10, 1.0), TestCase::QUICK);
+    AddTestCase(new NrSlUeProseRestrictedDiscoveryTestCase(5), TestCase::QUICK);
+    AddTestCase(new NrSlUeProseDiscoveredPeerExpiryTestCase(), TestCase::QUICK);
+    AddTestCase(new NrSlUeProseAutoDirectLinkTestCase(false), TestCase::QUICK);
+    AddTestCase(new NrSlUeProseAutoDirectLinkTestCase(true), TestCase::QUICK);
+    AddTestCase(new NrSlUeProseMonitoringDutyCycleTestCase(NrSlUeProse::Announcing),
+                TestCase::QUICK);
+    AddTestCase(new NrSlUeProseMonitoringDutyCycleTestCase(NrSlUeProse::Discoveree),
+                TestCase::QUICK);
+    AddTestCase(new NrSlUeProseDiscoveryAggregationTestCase(0, 1), TestCase::QUICK);
+    // Too small for two messages
+    AddTestCase(new NrSlUeProseDiscoveryAggregationTestCase(1, 1), TestCase::QUICK);
+    AddTestCase(new NrSlUeProseDiscoveryAggregationTestCase(1000, 2), TestCase::QUICK);
+    // The announcements at 0, 3, 6 and 9 s are processed with a window of 2.5 s
+    AddTestCase(new NrSlUeProseDiscoveryDuplicateTestCase(Seconds(0), 0), TestCase::QUICK);
+    AddTestCase(new NrSlUeProseDiscoveryDuplicateTestCase(Seconds(2.5), 6), TestCase::QUICK);
+    AddTestCase(new NrSlUeProseRelayResponseAggregationTestCase(4, false), TestCase::QUICK);
+    AddTestCase(new NrSlUeProseRelayResponseAggregationTestCase(4, true), TestCase::QUICK);
+    AddTestCase(new NrSlUeProseGroupMemberDiscoveryTestCase(NrSlUeProse::ModelA, 4),
+                TestCase::QUICK);
+    AddTestCase(new NrSlUeProseGroupMemberDiscoveryTestCase(NrSlUeProse::ModelB, 4),
+                TestCase::QUICK);
+    AddTestCase(new NrSlUeProseRelayRedirectionTestCase(), TestCase::QUICK);
+    AddTestCase(new NrSlUeProseDiscoveryOracleTestCase(), TestCase::QUICK);
+    AddTestCase(new NrSlUeProseU2uRelayTestCase(false), TestCase::QUICK);
+    AddTestCase(new NrSlUeProseU2uRelayTestCase(true), TestCase::QUICK);
+}
+
+/// Static variable for test initialization
+static NrSlUeProseTestSuite g_nrSlUeProseTestSuite;
@@ -0,0 +1,116 @@
+#! /usr/bin/env python3
+
+# NIST-developed software is provided by NIST as a public service. You may
+# use, copy and distribute copies of the software in any medium, provided
+# that you keep intact this entire notice. You may improve, modify and
+# create derivative works of the software or any portion of the software,
+# and you may copy and distribute such modifications or works. Modified
+# works should carry a notice stating that you changed the software and
+# should note the date and nature of any such change. Please explicitly
+# acknowledge the National Institute of Standards and Technology as the
+# source of the software.
+
+"""
+Merge the per-rank trace files of a distributed (MPI) simulation.
+
+In a distributed simulation, each process writes its traces in a file whose
+name has "-rank<N>" inserted before the extension (see
+NrSlProseHelper::GetPartitionFilename). This script merges the files of all
+the ranks into a single file, keeping a single header line and ordering the
+records by the value of their first column, which is the time for all the
+ProSe traces.
+
+Usage:
+    merge-rank-traces.py [--add-rank] [--output <file>] <file>...
+
+where each <file> is the name of the trace as it would have been written by a
+serial simulation, e.g., NrSlDiscoveryTrace.txt for the files
+NrSlDiscoveryTrace-rank0.txt, NrSlDiscoveryTrace-rank1.txt, ...
+"""
+
+import argparse
+import glob
+import heapq
+import os
+import re
+import sys
+
+
+def rank_files(filename):
+    """Return the list of (rank, path) of the per-rank files of a trace."""
+    base, ext = os.path.splitext(filename)
+    pattern = re.compile(re.escape(base) + r"-rank(\d+)" + re.escape(ext) + "$")
+    files = []
+    for path in glob.glob(glob.escape(base) + "-rank*" + ext):
+        match = pattern.match(path)
+        if match:
+            files.append((int(match.group(1)), path))
+    return sorted(files)
+
+
+def is_header(line):
+    """A header is a first line whose first column is not a number."""
+    try:
+        float(line.split("\t", 1)[0])
+        return False
+    except ValueError:
+        return True
+
+
+def records(rank, path, add_rank):
+    """Yield the (time, rank, line) records of a per-rank file."""
+    with open(path) as trace:
+        for number, line in enumerate(trace):
+            line = line.rstrip("\n")
+            if not line or (number == 0 and is_header(line)):
+                continue
+            if add_rank:
+                line = "{}\t{}".format(line, rank)
+            yield (float(line.split("\t", 1)[0]), rank, line)
+
+
+def header(files):
+    """Return the header line of the first file that has one."""
+    for _, path in files:
+        with open(path) as trace:
+            line = trace.readline().rstrip("\n")
+            if line and is_header(line):
+                return line
+    return None
+
+
+def merge(filename, output, add_rank):
+    files = rank_files(filename)
+    if not files:
+        print("No per-rank files found for " + filename, file=sys.stderr)
+        return False
+    with open(output, "w") as merged:
+        line = header(files)
+        if line is not None:
+            merged.write(line + ("\tRank" if add_rank else "") + "\n")
+        for _, _, line in heapq.merge(*[records(r, p, add_rank) for r, p in files]):
+            merged.write(line + "\n")
+    print("Merged {} files into {}".format(len(files), output))
+    return True
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Merge the per-rank trace files of an MPI run")
+    parser.add_argument("traces", nargs="+", help="name of the trace in a serial run")
+    parser.add_argument("--add-rank", action="store_true", help="append the rank to each record")
+    parser.add_argument(
+        "--output", help="name of the merged file (only with one trace, default: the trace name)"
+    )
+    args = parser.parse_args()
+
+    if args.output and len(args.traces) > 1:
+        parser.error("--output can only be used with a single trace")
+
+    ok = True
+    for trace in args.traces:
+        ok = merge(trace, args.output or trace, args.add_rank) and ok
+    return 0 if ok else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
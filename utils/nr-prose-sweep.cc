@@ -0,0 +1,520 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * NIST-developed software is provided by NIST as a public
+ * service. You may use, copy and distribute copies of the software in
+ * any medium, provided that you keep intact this entire notice. You
+ * may improve, modify and create derivative works of the software or
+ * any portion of the software, and you may copy and distribute such
+ * modifications or works. Modified works should carry a notice
+ * stating that you changed the software and should note the date and
+ * nature of any such change. Please explicitly acknowledge the
+ * National Institute of Standards and Technology as the source of the
+ * software.
+ *
+ * NIST-developed software is expressly provided "AS IS." NIST MAKES
+ * NO WARRANTY OF ANY KIND, EXPRESS, IMPLIED, IN FACT OR ARISING BY
+ * OPERATION OF LAW, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+ * WARRANTY OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE,
+ * NON-INFRINGEMENT AND DATA ACCURACY. NIST NEITHER REPRESENTS NOR
+ * WARRANTS THAT THE OPERATION OF THE SOFTWARE WILL BE UNINTERRUPTED
+ * OR ERROR-FREE, OR THAT ANY DEFECTS WILL BE CORRECTED. NIST DOES NOT
+ * WARRANT OR MAKE ANY REPRESENTATIONS REGARDING THE USE OF THE
+ * SOFTWARE OR THE RESULTS THEREOF, INCLUDING BUT NOT LIMITED TO THE
+ * CORRECTNESS, ACCURACY, RELIABILITY, OR USEFULNESS OF THE SOFTWARE.
+ *
+ * You are solely responsible for determining the appropriateness of
+ * using and distributing the software and you assume all risks
+ * associated with its use, including but not limited to the risks and
+ * costs of program errors, compliance with applicable laws, damage to
+ * or loss of data, programs or equipment, and the unavailability or
+ * interruption of operation. This software is not intended to be used
+ * in any situation where a failure could cause risk of injury or
+ * damage to property. The software developed by NIST employees is not
+ * subject to copyright protection within the United States.
+ */
+
+/**
+ * \file nr-prose-sweep.cc
+ * \ingroup nr-prose
+ *
+ * \brief Parallel runner of the replications and parameter sweeps of the
+ *        ProSe examples
+ *
+ * The sweep driver runs a ProSe example for every point of a parameter sweep
+ * and every replication, using up to 'jobs' worker processes on the local
+ * machine. Each run is executed in its own directory of the sweep directory
+ * 'outputDir', so that the output files of the example are kept apart, with
+ * the standard output and error of the run in stdout.txt and stderr.txt. The
+ * replications of a point use the distinct RNG runs runStart, runStart + 1,
+ * ..., which are the same for all the points of the sweep (common random
+ * numbers).
+ *
+ * The parameter sweep is given as a list of parameters separated by ';', each
+ * with a list of values separated by ',', and the example is run for every
+ * combination of values, e.g.:
+ * \code{.unparsed}
+$ ./ns3 run "nr-prose-sweep --program=nr-prose-l3-relay-on-off --runs=10
+    --sweep=nRelayUes=1,2;nRemoteUesPerRelay=2,4 --args=--simTime=20s"
+    \endcode
+ * The program is either the name of an example of the module, in which case
+ * it is looked up next to the sweep driver in the build tree, or the path of
+ * any ns-3 program.
+ *
+ * Once all the runs are done, the driver writes in the file summary.txt of
+ * the sweep directory one line per run with its parameters, RNG run, exit
+ * status and wall-clock time, and the statistics of the run:
+ * - the number of flows, packets transmitted and received, bytes received and
+ *   mean delay of the flows in the files *flowMonitorOutput.txt written by
+ *   the examples using the flow monitor,
+ * - the counters of the ProSe layer of the UEs, summed over the UEs, found in
+ *   the files written by NrSlProseHelper::DumpProseStats. When these files
+ *   have several snapshots, the last one of each UE is used.
+ */
+
+#include "ns3/core-module.h"
+
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <thread>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("NrProseSweep");
+
+/**
+ * \brief A run of the sweep
+ */
+struct SweepJob
+{
+    uint32_t point;                              //!< Index of the parameter point
+    std::vector<std::string> values;             //!< Values of the parameters of the point
+    uint32_t run;                                //!< RNG run
+    std::filesystem::path dir;                   //!< Directory of the run
+    std::vector<std::string> args;               //!< Arguments of the program
+    int status{-1};                              //!< Exit status of the program
+    double wallClock{0};                         //!< Wall-clock time of the run in seconds
+    std::chrono::steady_clock::time_point start; //!< Start of the run
+};
+
+/**
+ * \brief Flow monitor statistics of a run
+ */
+struct FlowSummary
+{
+    uint32_t flows{0};     //!< Number of flows
+    uint64_t txPackets{0}; //!< Packets transmitted
+    uint64_t rxPackets{0}; //!< Packets received
+    uint64_t rxBytes{0};   //!< Bytes received
+    double delaySum{0};    //!< Sum of the delays of the received packets in ms
+};
+
+/*
+ * \brief Split a string
+ *
+ * \param str the string
+ * \param sep the separator
+ * \return the non-empty tokens of the string
+ */
+std::vector<std::string>
+Split(const std::string& str, char sep)
+{
+    std::vector<std::string> tokens;
+    std::istringstream iss(str);
+    std::string token;
+    while (std::getline(iss, token, sep))
+    {
+        if (!token.empty())
+        {
+            tokens.push_back(token);
+        }
+    }
+    return tokens;
+}
+
+/*
+ * \brief Find the program to run
+ *
+ * A name without '/' is the name of an example of the module, whose
+ * executable has the same build profile suffix as the sweep driver one, and
+ * is either next to the sweep driver or in the examples directory of the
+ * module.
+ *
+ * \param program the name or path of the program
+ * \return the path of the program
+ */
+std::filesystem::path
+FindProgram(const std::string& program)
+{
+    if (program.find('/') != std::string::npos)
+    {
+        // The runs are executed in their own directories
+        return std::filesystem::absolute(program);
+    }
+    std::error_code ec;
+    std::filesystem::path self = std::filesystem::read_symlink("/proc/self/exe", ec);
+    NS_ABORT_MSG_IF(ec, "Can't find the sweep driver executable, use the path of the program");
+    std::string name = self.filename().string();
+    std::size_t pos = name.find("nr-prose-sweep");
+    NS_ABORT_MSG_IF(pos == std::string::npos, "Unexpected sweep driver executable " << name);
+    // The executables of the module share the build profile suffix, while
+    // their prefix depends on the build system version
+    std::string suffix = program + name.substr(pos + std::string("nr-prose-sweep").size());
+    for (const auto& dir : {self.parent_path(), self.parent_path().parent_path() / "examples"})
+    {
+        if (!std::filesystem::is_directory(dir))
+        {
+            continue;
+        }
+        for (const auto& entry : std::filesystem::directory_iterator(dir))
+        {
+            std::string candidate = entry.path().filename().string();
+            if (candidate.size() >= suffix.size() &&
+                candidate.compare(candidate.size() - suffix.size(), suffix.size(), suffix) == 0 &&
+                (candidate.size() == suffix.size() ||
+                 candidate[candidate.size() - suffix.size() - 1] == '-'))
+            {
+                return entry.path();
+            }
+        }
+    }
+    NS_FATAL_ERROR("Can't find the executable of the example " << program);
+}
+
+/*
+ * \brief Start a run in a worker process
+ *
+ * \param program the path of the program
+ * \param job the run
+ * \return the process ID of the worker
+ */
+pid_t
+StartJob(const std::filesystem::path& program, SweepJob& job)
+{
+    std::vector<char*> argv;
+    std::string path = program.string();
+    argv.push_back(path.data());
+    for (auto& arg : job.args)
+    {
+        argv.push_back(arg.data());
+    }
+    argv.push_back(nullptr);
+
+    job.start = std::chrono::steady_clock::now();
+    pid_t pid = fork();
+    NS_ABORT_MSG_IF(pid < 0, "Can't fork the worker process: " << std::strerror(errno));
+    if (pid == 0)
+    {
+        int out = open((job.dir / "stdout.txt").c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        int err = open((job.dir / "stderr.txt").c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (chdir(job.dir.c_str()) != 0 || out < 0 || err < 0 || dup2(out, STDOUT_FILENO) < 0 ||
+            dup2(err, STDERR_FILENO) < 0)
+        {
+            _exit(127);
+        }
+        execv(argv[0], argv.data());
+        _exit(127);
+    }
+    return pid;
+}
+
+/*
+ * \brief Parse the flow monitor statistics of a run
+ *
+ * \param dir the directory of the run
+ * \return the flow monitor statistics
+ */
+FlowSummary
+ParseFlowMonitor(const std::filesystem::path& dir)
+{
+    FlowSummary summary;
+    for (const auto& entry : std::filesystem::directory_iterator(dir))
+    {
+        std::string name = entry.path().filename().string();
+        if (name.size() < 21 || name.compare(name.size() - 21, 21, "flowMonitorOutput.txt") != 0)
+        {
+            continue;
+        }
+        std::ifstream file(entry.path());
+        std::string line;
+        uint64_t rxPackets = 0;
+        while (std::getline(file, line))
+        {
+            std::istringstream iss(line);
+            std::string key;
+            std::string field;
+            iss >> key >> field;
+            if (key == "Flow")
+            {
+                summary.flows++;
+            }
+            else if (key == "Tx" && field == "Packets:")
+            {
+                uint64_t value = 0;
+                iss >> value;
+                summary.txPackets += value;
+            }
+            else if (key == "Rx" && field == "Packets:")
+            {
+                iss >> rxPackets;
+                summary.rxPackets += rxPackets;
+            }
+            else if (key == "Rx" && field == "Bytes:")
+            {
+                uint64_t value = 0;
+                iss >> value;
+                summary.rxBytes += value;
+            }
+            else if (key == "Mean" && field == "delay:")
+            {
+                double value = 0;
+                iss >> value;
+                summary.delaySum += value * rxPackets;
+            }
+        }
+    }
+    return summary;
+}
+
+/*
+ * \brief Parse the ProSe statistics of a run
+ *
+ * \param dir the directory of the run
+ * \return the value of each counter, summed over the UEs
+ */
+std::map<std::string, uint64_t>
+ParseProseStats(const std::filesystem::path& dir)
+{
+    // Last snapshot (time, value) of each counter of each UE
+    std::map<std::pair<uint32_t, std::string>, std::pair<double, uint64_t>> last;
+    for (const auto& entry : std::filesystem::directory_iterator(dir))
+    {
+        if (!entry.is_regular_file() || entry.path().extension() != ".txt")
+        {
+            continue;
+        }
+        std::ifstream file(entry.path());
+        std::string line;
+        if (!std::getline(file, line) || line != "Time (s)\tL2Id\tCounter\tValue")
+        {
+            continue;
+        }
+        while (std::getline(file, line))
+        {
+            std::istringstream iss(line);
+            double time = 0;
+            uint32_t l2Id = 0;
+            std::string counter;
+            uint64_t value = 0;
+            if (!(iss >> time >> l2Id >> counter >> value))
+            {
+                continue;
+            }
+            auto& snapshot = last[std::make_pair(l2Id, counter)];
+            if (time >= snapshot.first)
+            {
+                snapshot = std::make_pair(time, value);
+            }
+        }
+    }
+    std::map<std::string, uint64_t> counters;
+    for (const auto& it : last)
+    {
+        counters[it.first.second] += it.second.second;
+    }
+    return counters;
+}
+
+int
+main(int argc, char* argv[])
+{
+    std::string program;
+    std::string args;
+    std::string sweep;
+    uint32_t runs = 1;
+    uint32_t runStart = 1;
+    uint32_t jobs = std::max(1U, std::thread::hardware_concurrency());
+    std::string outputDir;
+
+    CommandLine cmd;
+    cmd.AddValue("program", "Name of the example, or path of the program, to run", program);
+    cmd.AddValue("args", "Arguments of the program common to all the runs", args);
+    cmd.AddValue("sweep",
+                 "Parameter sweep, e.g., \"nRelayUes=1,2;nRemoteUesPerRelay=2,4\", empty for none",
+                 sweep);
+    cmd.AddValue("runs", "Number of replications of each point of the sweep", runs);
+    cmd.AddValue("runStart", "RNG run of the first replication", runStart);
+    cmd.AddValue("jobs", "Number of worker processes", jobs);
+    cmd.AddValue("outputDir",
+                 "Directory of the sweep, by default sweep-<program> in the current directory",
+                 outputDir);
+    cmd.Parse(argc, argv);
+
+    NS_ABORT_MSG_IF(program.empty(), "The program to run is needed");
+    NS_ABORT_MSG_IF(runs == 0 || jobs == 0, "At least one run and one worker are needed");
+    std::filesystem::path programPath = FindProgram(program);
+    if (outputDir.empty())
+    {
+        outputDir = "sweep-" + std::filesystem::path(program).filename().string();
+    }
+
+    // Expand the parameter sweep into the list of points
+    std::vector<std::string> names;
+    std::vector<std::vector<std::string>> points{{}};
+    for (const auto& param : Split(sweep, ';'))
+    {
+        std::size_t eq = param.find('=');
+        NS_ABORT_MSG_IF(eq == std::string::npos || eq == 0,
+                        "Parameter " << param << " of the sweep has no values");
+        names.push_back(param.substr(0, eq));
+        std::vector<std::string> values = Split(param.substr(eq + 1), ',');
+        NS_ABORT_MSG_IF(values.empty(), "Parameter " << names.back() << " has no values");
+        std::vector<std::vector<std::string>> expanded;
+        for (const auto& point : points)
+        {
+            for (const auto& value : values)
+            {
+                expanded.push_back(point);
+                expanded.back().push_back(value);
+            }
+        }
+        points = std::move(expanded);
+    }
+
+    std::vector<SweepJob> sweepJobs;
+    std::vector<std::string> commonArgs = Split(args, ' ');
+    for (uint32_t p = 0; p < points.size(); ++p)
+    {
+        for (uint32_t r = 0; r < runs; ++r)
+        {
+            SweepJob job;
+            job.point = p;
+            job.values = points[p];
+            job.run = runStart + r;
+            std::ostringstream dir;
+            dir << "point" << p << "-run" << job.run;
+            job.dir = std::filesystem::path(outputDir) / dir.str();
+            std::filesystem::create_directories(job.dir);
+            job.args = commonArgs;
+            for (uint32_t i = 0; i < names.size(); ++i)
+            {
+                job.args.push_back("--" + names[i] + "=" + points[p][i]);
+            }
+            job.args.push_back("--RngRun=" + std::to_string(job.run));
+
+            std::ofstream command(job.dir / "command.txt");
+            command << programPath.string();
+            for (const auto& arg : job.args)
+            {
+                command << " " << arg;
+            }
+            command << std::endl;
+            sweepJobs.push_back(std::move(job));
+        }
+    }
+
+    std::cout << "Running " << sweepJobs.size() << " runs of " << programPath.string() << " ("
+              << points.size() << " points x " << runs << " replications) with " << jobs
+              << " workers in " << outputDir << std::endl;
+
+    // Keep up to 'jobs' workers busy until all the runs are done
+    std::map<pid_t, std::size_t> running;
+    std::size_t next = 0;
+    std::size_t done = 0;
+    uint32_t failed = 0;
+    while (next < sweepJobs.size() || !running.empty())
+    {
+        while (running.size() < jobs && next < sweepJobs.size())
+        {
+            running[StartJob(programPath, sweepJobs[next])] = next;
+            next++;
+        }
+        int status = 0;
+        pid_t pid = waitpid(-1, &status, 0);
+        if (pid < 0)
+        {
+            NS_ABORT_MSG_IF(errno != EINTR, "Can't wait for the workers: " << std::strerror(errno));
+            continue;
+        }
+        auto it = running.find(pid);
+        if (it == running.end())
+        {
+            continue;
+        }
+        SweepJob& job = sweepJobs[it->second];
+        running.erase(it);
+        job.status = WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+        job.wallClock =
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - job.start).count();
+        done++;
+        if (job.status != 0)
+        {
+            failed++;
+        }
+        std::cout << "[" << done << "/" << sweepJobs.size() << "] " << job.dir.string()
+                  << (job.status == 0 ? " done" : " FAILED") << " in " << job.wallClock << " s"
+                  << std::endl;
+    }
+
+    // Merge the statistics of all the runs in a single table
+    std::vector<FlowSummary> flowSummaries;
+    std::vector<std::map<std::string, uint64_t>> proseCounters;
+    std::set<std::string> counterNames;
+    for (const auto& job : sweepJobs)
+    {
+        flowSummaries.push_back(ParseFlowMonitor(job.dir));
+        proseCounters.push_back(ParseProseStats(job.dir));
+        for (const auto& it : proseCounters.back())
+        {
+            counterNames.insert(it.first);
+        }
+    }
+
+    std::filesystem::path summaryPath = std::filesystem::path(outputDir) / "summary.txt";
+    std::ofstream summary(summaryPath);
+    summary << "point";
+    for (const auto& name : names)
+    {
+        summary << "\t" << name;
+    }
+    summary << "\trun\tstatus\twallClock(s)\tflows\ttxPackets\trxPackets\trxBytes\tmeanDelay(ms)";
+    for (const auto& name : counterNames)
+    {
+        summary << "\t" << name;
+    }
+    summary << std::endl;
+    for (std::size_t j = 0; j < sweepJobs.size(); ++j)
+    {
+        const SweepJob& job = sweepJobs[j];
+        const FlowSummary& flows = flowSummaries[j];
+        summary << job.point;
+        for (const auto& value : job.values)
+        {
+            summary << "\t" << value;
+        }
+        summary << "\t" << job.run << "\t" << job.status << "\t" << job.wallClock << "\t"
+                << flows.flows << "\t" << flows.txPackets << "\t" << flows.rxPackets << "\t"
+                << flows.rxBytes << "\t"
+                << (flows.rxPackets > 0 ? flows.delaySum / flows.rxPackets : 0);
+        for (const auto& name : counterNames)
+        {
+            auto it = proseCounters[j].find(name);
+            summary << "\t" << (it != proseCounters[j].end() ? it->second : 0);
+        }
+        summary << std::endl;
+    }
+
+    std::cout << "Sweep done, " << failed << " failed runs, summary in " << summaryPath.string()
+              << std::endl;
+    return failed > 0 ? 1 : 0;
+}